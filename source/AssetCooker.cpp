@@ -0,0 +1,511 @@
+#include "pch.h"
+#include "AssetCooker.h"
+#include "DDSFile.h"
+#include "Effect.h"
+#include "IndexCompression.h"
+#include "Json.h"
+#include "MappedFile.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "Parallel.h"
+#include "Simplifier.h"
+#include "Utils.h"
+#include "VertexCompression.h"
+#include "VertexQuantization.h"
+
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unordered_map>
+
+namespace dae
+{
+	namespace AssetCooker
+	{
+		namespace
+		{
+			namespace fs = std::filesystem;
+
+			//Bump when a cooked format changes without its source changing, so every asset is cooked again
+			constexpr uint64_t CookerVersion{ 3 };
+			constexpr int64_t ManifestVersion{ 1 };
+
+			enum class AssetType
+			{
+				Mesh,
+				Texture,
+				Material,
+				Effect,
+			};
+
+			struct Asset
+			{
+				//Relative to the source folder, with forward slashes
+				std::string source;
+				AssetType type;
+				uint64_t hash{};
+				std::vector<std::string> outputs{};
+				//Printed with the cook result, assets are processed in parallel
+				std::string report{};
+				bool isUpToDate{ false };
+				bool succeeded{ false };
+			};
+
+			struct ManifestEntry
+			{
+				uint64_t hash{};
+				std::vector<std::string> outputs{};
+			};
+
+			bool IsTextureExtension(std::string extension)
+			{
+				std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+				return extension == ".png" or extension == ".jpg" or extension == ".jpeg" or extension == ".tga" or extension == ".bmp";
+			}
+
+			bool GetAssetType(const fs::path& path, AssetType& type)
+			{
+				const std::string extension = path.extension().string();
+				if (extension == ".obj")
+					type = AssetType::Mesh;
+				else if (extension == ".mtl")
+					type = AssetType::Material;
+				else if (extension == ".fx")
+					type = AssetType::Effect;
+				else if (IsTextureExtension(extension))
+					type = AssetType::Texture;
+				else
+					return false;
+				return true;
+			}
+
+			std::string GetOutput(const Asset& asset)
+			{
+				fs::path output{ asset.source };
+				switch (asset.type)
+				{
+				case AssetType::Mesh: output.replace_extension(".mesh"); break;
+				case AssetType::Texture: output.replace_extension(".dds"); break;
+				case AssetType::Material: break;
+				case AssetType::Effect: output.replace_extension(".fxo"); break;
+				}
+				return output.generic_string();
+			}
+
+			bool IsBlendedMesh(const Asset& asset, const CookOptions& options)
+			{
+				return asset.type == AssetType::Mesh and std::find(options.blendedMeshes.begin(), options.blendedMeshes.end(), asset.source) != options.blendedMeshes.end();
+			}
+
+			//Everything that changes the output is part of the seed, next to the contents of the source
+			uint64_t HashAsset(const MappedFile& sourceFile, const Asset& asset, const CookOptions& options)
+			{
+				const AssetType type = asset.type;
+				const uint64_t settings[]{ CookerVersion, static_cast<uint64_t>(type), MeshCache::FormatVersion, sizeof(Vertex),
+					type == AssetType::Mesh and options.packVertices, type == AssetType::Mesh and options.compressIndices,
+					type == AssetType::Mesh and options.buildLevelsOfDetail, type == AssetType::Mesh and options.compressVertices,
+					IsBlendedMesh(asset, options) };
+				const uint64_t seed = Utils::HashBytes(reinterpret_cast<const char*>(settings), sizeof(settings));
+				return Utils::HashBytes(sourceFile.GetData(), sourceFile.GetSize(), seed);
+			}
+
+			bool CookMesh(const std::string& sourcePath, const std::string& outputPath, uint64_t hash, bool isBlended, const CookOptions& options, std::string& report)
+			{
+				std::vector<Vertex> vertices{};
+				std::vector<uint32_t> indices{};
+				Utils::OBJMaterialData materialData{};
+				Utils::OBJParseStats parseStats{};
+				if (!Utils::ParseOBJ(sourcePath, vertices, indices, {}, &materialData, &parseStats))
+					return false;
+
+				//Blending shades every covered pixel whatever the order, so only the vertex stages are optimized
+				MeshOptimizer::OptimizeOptions optimizeOptions{};
+				optimizeOptions.optimizeOverdraw = !isBlended;
+				optimizeOptions.cullBackFaces = !isBlended;
+				MeshOptimizer::OptimizeReport optimizeReport{};
+				vertices.resize(MeshOptimizer::OptimizeMesh(vertices, indices, materialData.submeshes, optimizeOptions, &optimizeReport));
+
+				std::ostringstream stream{};
+				stream << "welded " << parseStats.numCorners << " corners into " << parseStats.numVertices << " vertices; "
+					<< std::fixed << std::setprecision(3) << "vertex cache (" << (optimizeOptions.cacheModel == MeshOptimizer::CacheModel::FIFO ? "FIFO " : "LRU ")
+					<< optimizeOptions.cacheSize << "): ACMR " << optimizeReport.before.acmr << " -> " << optimizeReport.after.acmr
+					<< ", ATVR " << optimizeReport.before.atvr << " -> " << optimizeReport.after.atvr
+					<< "; overdraw " << (isBlended ? "without culling " : "") << optimizeReport.overdrawBefore.overdraw << " -> " << optimizeReport.overdrawAfter.overdraw
+					<< "; vertex fetch " << optimizeReport.fetchBefore.overfetch << " -> " << optimizeReport.fetchAfter.overfetch << "x unique bytes";
+
+				Vector3 boundsMin{}, boundsMax{};
+				if (!vertices.empty())
+					boundsMin = boundsMax = vertices.front().position;
+				for (const Vertex& vertex : vertices)
+				{
+					for (int axis = 0; axis < 3; ++axis)
+					{
+						boundsMin[axis] = std::min(boundsMin[axis], vertex.position[axis]);
+						boundsMax[axis] = std::max(boundsMax[axis], vertex.position[axis]);
+					}
+				}
+
+				//MeshCache::Write packs the same way, this only measures what the vertex shader will decode
+				std::vector<PackedVertex> packedVertices{};
+				if (options.packVertices and !vertices.empty())
+				{
+					const PositionQuantization quantization = VertexQuantization::ComputePositionQuantization(boundsMin, boundsMax);
+					packedVertices.resize(vertices.size());
+					VertexQuantization::Pack(vertices, quantization, packedVertices);
+					const VertexQuantization::QuantizationError error = VertexQuantization::MeasureError(vertices, packedVertices, quantization);
+
+					stream << "\n    packed " << sizeof(Vertex) << " -> " << sizeof(PackedVertex) << " bytes per vertex: position error max " << std::setprecision(6) << error.maxPositionError
+						<< " avg " << error.averagePositionError << ", uv error " << error.maxUVError << std::setprecision(3) << ", normal " << error.maxNormalErrorDegrees
+						<< " deg, tangent " << error.maxTangentErrorDegrees << " deg, " << error.numHandednessErrors << " handedness errors";
+				}
+
+				std::vector<Simplifier::LevelOfDetail> levelsOfDetail{};
+				if (options.buildLevelsOfDetail)
+				{
+					const size_t numFullIndices = indices.size();
+					levelsOfDetail = Simplifier::BuildLevelsOfDetail(vertices, indices, materialData.submeshes);
+
+					const float diagonal = (boundsMax - boundsMin).Magnitude();
+
+					stream << "\n    levels of detail:";
+					for (const Simplifier::LevelOfDetail& level : levelsOfDetail)
+					{
+						size_t numLevelIndices = 0;
+						for (const Utils::OBJSubmesh& submesh : level.submeshes)
+							numLevelIndices += submesh.numIndices;
+						stream << ' ' << std::setprecision(1) << 100.f * static_cast<float>(numLevelIndices) / static_cast<float>(numFullIndices)
+							<< "% (error " << std::setprecision(3) << level.error << ", " << 100.f * level.error / diagonal << "% of the bounds)";
+					}
+					if (levelsOfDetail.empty())
+						stream << " none, every collapse is blocked by seams or borders";
+				}
+
+				//Mesh narrows the indices the same way when it uploads them
+				std::vector<uint16_t> narrowIndices{};
+				std::vector<IndexCompression::IndexRange> indexRanges{};
+				const bool isNarrow = IndexCompression::NarrowIndices(indices, vertices.size(), narrowIndices, indexRanges);
+				stream << "\n    indices: " << (isNarrow ? 16 : 32) << " bit on the GPU";
+				if (isNarrow)
+					stream << " in " << indexRanges.size() << (indexRanges.size() == 1 ? " draw range" : " draw ranges");
+				if (options.compressIndices and !indices.empty())
+				{
+					std::string encodedIndices = IndexCompression::EncodeTriangles(indices);
+					if (encodedIndices.empty())
+						encodedIndices = IndexCompression::EncodeIndices(indices);
+					stream << ", " << encodedIndices.size() * 8.0 / static_cast<double>(indices.size()) << " bits per index on disk";
+				}
+
+				//Same bytes MeshCache::Write encodes
+				if (options.compressVertices and !vertices.empty())
+				{
+					const std::span<const char> vertexBytes = packedVertices.empty()
+						? std::span<const char>{ reinterpret_cast<const char*>(vertices.data()), vertices.size() * sizeof(Vertex) }
+						: std::span<const char>{ reinterpret_cast<const char*>(packedVertices.data()), packedVertices.size() * sizeof(PackedVertex) };
+					const size_t vertexSize = packedVertices.empty() ? sizeof(Vertex) : sizeof(PackedVertex);
+					const size_t encodedBytes = VertexCompression::EncodeVertices(vertexBytes, vertexSize).size();
+					stream << "\n    vertices: " << vertexBytes.size() << " -> " << encodedBytes << " bytes on disk ("
+						<< static_cast<double>(vertexBytes.size()) / static_cast<double>(encodedBytes) << "x)";
+				}
+				report = stream.str();
+
+				return MeshCache::Write(outputPath, vertices, indices, materialData, hash, options.packVertices, options.compressIndices,
+					options.compressVertices, levelsOfDetail);
+			}
+
+			//Box filtered mips down to 1x1, odd edges repeat their last texel
+			std::vector<uint32_t> BuildMipChain(std::vector<uint32_t> pixels, uint32_t width, uint32_t height, uint32_t& numMips)
+			{
+				numMips = DDSFile::GetNumMips(width, height);
+				std::vector<uint32_t> mipChain = pixels;
+
+				for (uint32_t level = 1; level < numMips; ++level)
+				{
+					const uint32_t mipWidth = std::max(width / 2, 1u);
+					const uint32_t mipHeight = std::max(height / 2, 1u);
+					std::vector<uint32_t> mip(size_t(mipWidth) * mipHeight);
+
+					for (uint32_t y = 0; y < mipHeight; ++y)
+					{
+						const uint32_t y0 = std::min(y * 2, height - 1);
+						const uint32_t y1 = std::min(y * 2 + 1, height - 1);
+						for (uint32_t x = 0; x < mipWidth; ++x)
+						{
+							const uint32_t x0 = std::min(x * 2, width - 1);
+							const uint32_t x1 = std::min(x * 2 + 1, width - 1);
+							const uint32_t texels[4]{ pixels[y0 * width + x0], pixels[y0 * width + x1], pixels[y1 * width + x0], pixels[y1 * width + x1] };
+
+							uint32_t result = 0;
+							for (uint32_t shift = 0; shift < 32; shift += 8)
+							{
+								uint32_t sum = 2;
+								for (const uint32_t texel : texels)
+									sum += (texel >> shift) & 0xFF;
+								result |= (sum / 4) << shift;
+							}
+							mip[size_t(y) * mipWidth + x] = result;
+						}
+					}
+
+					mipChain.insert(mipChain.end(), mip.begin(), mip.end());
+					pixels = std::move(mip);
+					width = mipWidth;
+					height = mipHeight;
+				}
+				return mipChain;
+			}
+
+			bool CookTexture(const std::string& sourcePath, const std::string& outputPath)
+			{
+				SDL_Surface* pDecoded = IMG_Load(sourcePath.c_str());
+				if (!pDecoded)
+				{
+					std::cout << "AssetCooker: failed to decode " << sourcePath << ": " << SDL_GetError() << '\n';
+					return false;
+				}
+
+				//The runtime uploads R8G8B8A8_UNORM, which is RGBA32 in SDL's byte order naming
+				SDL_Surface* pSurface = SDL_ConvertSurfaceFormat(pDecoded, SDL_PIXELFORMAT_RGBA32, 0);
+				SDL_FreeSurface(pDecoded);
+				if (!pSurface)
+					return false;
+
+				const uint32_t width = static_cast<uint32_t>(pSurface->w);
+				const uint32_t height = static_cast<uint32_t>(pSurface->h);
+				std::vector<uint32_t> pixels(size_t(width) * height);
+				SDL_LockSurface(pSurface);
+				for (uint32_t y = 0; y < height; ++y)
+					std::memcpy(&pixels[size_t(y) * width], static_cast<const char*>(pSurface->pixels) + size_t(y) * pSurface->pitch, width * sizeof(uint32_t));
+				SDL_UnlockSurface(pSurface);
+				SDL_FreeSurface(pSurface);
+
+				uint32_t numMips{};
+				const std::vector<uint32_t> mipChain = BuildMipChain(std::move(pixels), width, height, numMips);
+				return DDSFile::Write(outputPath, width, height, numMips, mipChain);
+			}
+
+			//Same file, but texture maps point at the cooked .dds next to the cooked .mtl
+			bool CookMaterial(const std::string& sourcePath, const std::string& outputPath)
+			{
+				std::ifstream input{ sourcePath };
+				if (!input)
+					return false;
+
+				std::ostringstream output{};
+				std::string line{};
+				while (std::getline(input, line))
+				{
+					const size_t keywordStart = line.find_first_not_of(" \t");
+					const bool isMap = keywordStart != std::string::npos
+						and (line.compare(keywordStart, 4, "map_") == 0 or line.compare(keywordStart, 4, "bump") == 0 or line.compare(keywordStart, 4, "norm") == 0);
+					const size_t nameEnd = line.find_last_not_of(" \t\r") + 1;
+					const size_t nameStart = line.find_last_of(" \t", nameEnd - 1) + 1;
+
+					if (isMap and nameStart > keywordStart and nameStart < nameEnd)
+					{
+						fs::path texture{ line.substr(nameStart, nameEnd - nameStart) };
+						if (IsTextureExtension(texture.extension().string()))
+						{
+							texture.replace_extension(".dds");
+							line = line.substr(0, nameStart) + texture.generic_string();
+						}
+					}
+					output << line << '\n';
+				}
+
+				std::ofstream file{ outputPath, std::ios::trunc };
+				file << output.str();
+				return static_cast<bool>(file);
+			}
+
+			bool CookEffect(const std::string& sourcePath, const std::string& outputPath)
+			{
+				ID3DBlob* compiledEffectPtr = Effect::CompileFromFile(fs::path{ sourcePath }.wstring());
+				const bool succeeded = Effect::WriteCompiled(compiledEffectPtr, fs::path{ outputPath }.wstring());
+				if (compiledEffectPtr)
+					compiledEffectPtr->Release();
+				return succeeded;
+			}
+
+			//Hashes the source and cooks it unless the manifest says the outputs are current
+			void ProcessAsset(Asset& asset, const CookOptions& options, const std::unordered_map<std::string, ManifestEntry>& manifest)
+			{
+				const fs::path sourcePath = fs::path{ options.sourceFolder } / asset.source;
+				asset.outputs = { GetOutput(asset) };
+				{
+					const MappedFile sourceFile{ sourcePath.string() };
+					if (!sourceFile.IsOpen())
+						return;
+					asset.hash = HashAsset(sourceFile, asset, options);
+				}
+
+				const auto entryIt = manifest.find(asset.source);
+				if (!options.force and entryIt != manifest.end() and entryIt->second.hash == asset.hash and entryIt->second.outputs == asset.outputs)
+				{
+					asset.isUpToDate = std::all_of(asset.outputs.begin(), asset.outputs.end(),
+						[&options](const std::string& output) { return fs::exists(fs::path{ options.outputFolder } / output); });
+				}
+				if (asset.isUpToDate)
+				{
+					asset.succeeded = true;
+					return;
+				}
+
+				const fs::path outputPath = fs::path{ options.outputFolder } / asset.outputs.front();
+				std::error_code error{};
+				fs::create_directories(outputPath.parent_path(), error);
+
+				switch (asset.type)
+				{
+				case AssetType::Mesh: asset.succeeded = CookMesh(sourcePath.string(), outputPath.string(), asset.hash, IsBlendedMesh(asset, options), options, asset.report); break;
+				case AssetType::Texture: asset.succeeded = CookTexture(sourcePath.string(), outputPath.string()); break;
+				case AssetType::Material: asset.succeeded = CookMaterial(sourcePath.string(), outputPath.string()); break;
+				case AssetType::Effect: asset.succeeded = CookEffect(sourcePath.string(), outputPath.string()); break;
+				}
+			}
+
+			std::vector<Asset> FindAssets(const CookOptions& options)
+			{
+				std::vector<Asset> assets{};
+				std::error_code error{};
+				const fs::path outputRoot = fs::weakly_canonical(options.outputFolder, error);
+
+				for (auto entryIt = fs::recursive_directory_iterator{ options.sourceFolder, error }; entryIt != fs::recursive_directory_iterator{}; entryIt.increment(error))
+				{
+					if (entryIt->is_directory())
+					{
+						if (fs::weakly_canonical(entryIt->path(), error) == outputRoot)
+							entryIt.disable_recursion_pending();
+						continue;
+					}
+
+					AssetType type{};
+					if (entryIt->is_regular_file() and GetAssetType(entryIt->path(), type))
+						assets.push_back({ fs::relative(entryIt->path(), options.sourceFolder).generic_string(), type });
+				}
+
+				std::sort(assets.begin(), assets.end(), [](const Asset& a, const Asset& b) { return a.source < b.source; });
+				return assets;
+			}
+
+			std::unordered_map<std::string, ManifestEntry> ReadManifest(const std::string& manifestPath)
+			{
+				std::unordered_map<std::string, ManifestEntry> manifest{};
+				const MappedFile manifestFile{ manifestPath };
+				JsonValue document{};
+				if (!manifestFile.IsOpen() or !JsonValue::Parse(manifestFile.GetView(), document) or document["version"].GetInt() != ManifestVersion)
+					return manifest;
+
+				for (const auto& [source, entry] : document["assets"].GetMembers())
+				{
+					ManifestEntry& manifestEntry = manifest[source];
+					manifestEntry.hash = std::strtoull(entry["hash"].GetString().c_str(), nullptr, 16);
+					for (const JsonValue& output : entry["outputs"].GetElements())
+						manifestEntry.outputs.push_back(output.GetString());
+				}
+				return manifest;
+			}
+
+			std::string Quote(const std::string& text)
+			{
+				std::ostringstream quoted{};
+				quoted << '"';
+				for (const char c : text)
+				{
+					if (c == '"' or c == '\\')
+						quoted << '\\' << c;
+					else if (static_cast<unsigned char>(c) < 0x20)
+						quoted << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec;
+					else
+						quoted << c;
+				}
+				quoted << '"';
+				return quoted.str();
+			}
+
+			bool WriteManifest(const std::string& manifestPath, const std::vector<Asset>& assets)
+			{
+				std::ostringstream json{};
+				json << "{\n  \"version\": " << ManifestVersion << ",\n  \"assets\": {";
+
+				bool isFirst = true;
+				for (const Asset& asset : assets)
+				{
+					if (!asset.succeeded)
+						continue;
+
+					json << (isFirst ? "\n" : ",\n") << "    " << Quote(asset.source) << ": { \"hash\": \""
+						<< std::hex << std::setw(16) << std::setfill('0') << asset.hash << std::dec << "\", \"outputs\": [";
+					for (size_t i = 0; i < asset.outputs.size(); ++i)
+						json << (i > 0 ? ", " : "") << Quote(asset.outputs[i]);
+					json << "] }";
+					isFirst = false;
+				}
+				json << "\n  }\n}\n";
+
+				std::ofstream file{ manifestPath, std::ios::trunc };
+				file << json.str();
+				return static_cast<bool>(file);
+			}
+		}
+
+		bool Cook(const CookOptions& options, CookStats& stats)
+		{
+			stats = {};
+			if (!fs::is_directory(options.sourceFolder))
+			{
+				std::cout << "AssetCooker: " << options.sourceFolder << " is not a folder\n";
+				return false;
+			}
+
+			const auto start = std::chrono::steady_clock::now();
+			std::error_code error{};
+			fs::create_directories(options.outputFolder, error);
+			const std::string manifestPath = (fs::path{ options.outputFolder } / "manifest.json").string();
+			const std::unordered_map<std::string, ManifestEntry> manifest = ReadManifest(manifestPath);
+
+			std::vector<Asset> assets = FindAssets(options);
+			ParallelFor(assets.size(), options.numThreads, [&](size_t assetIndex) { ProcessAsset(assets[assetIndex], options, manifest); });
+
+			for (const Asset& asset : assets)
+			{
+				if (asset.isUpToDate)
+				{
+					++stats.numUpToDate;
+					continue;
+				}
+
+				std::cout << (asset.succeeded ? "Cooked " : "FAILED ") << asset.source << " -> " << asset.outputs.front() << '\n';
+				if (asset.succeeded and !asset.report.empty())
+					std::cout << "    " << asset.report << '\n';
+				if (asset.succeeded)
+					++stats.numCooked;
+				else
+					++stats.numFailed;
+			}
+			stats.numAssets = assets.size();
+
+			//Outputs that no current source produces any more
+			for (const auto& [source, entry] : manifest)
+			{
+				const bool isCurrent = std::any_of(assets.begin(), assets.end(), [&source](const Asset& asset) { return asset.source == source; });
+				if (isCurrent)
+					continue;
+
+				for (const std::string& output : entry.outputs)
+				{
+					if (fs::remove(fs::path{ options.outputFolder } / output, error))
+						++stats.numRemoved;
+				}
+			}
+
+			const bool wroteManifest = WriteManifest(manifestPath, assets);
+			std::cout << "AssetCooker: " << stats.numCooked << " cooked, " << stats.numUpToDate << " up to date, " << stats.numFailed << " failed, "
+				<< stats.numRemoved << " stale outputs removed in " << std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms\n";
+			return wroteManifest and stats.numFailed == 0;
+		}
+	}
+}
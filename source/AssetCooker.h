@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+#include <vector>
+
+namespace dae
+{
+	//Offline conversion of the source assets into the files the runtime loads, so startup does no decoding or processing:
+	//OBJ -> .mesh (welded, tangents, per-material submeshes, optimized draw order, packed vertices, levels of detail), PNG/JPG/TGA/BMP -> .dds (RGBA8 with every mip),
+	//FX -> .fxo (compiled effect), MTL -> .mtl that references the cooked textures
+	namespace AssetCooker
+	{
+		struct CookOptions
+		{
+			std::string sourceFolder = "Resources";
+			//Mirrors the folder layout of the sources, never scanned for sources itself
+			std::string outputFolder = "Resources/Cooked";
+			//Independent assets are cooked in parallel, 0 uses every hardware thread
+			uint32_t numThreads = 0;
+			//Ignores the manifest and cooks everything again
+			bool force = false;
+			//Meshes store the 20 byte PackedVertex instead of Vertex
+			bool packVertices = true;
+			//Meshes store their indices through IndexCompression::EncodeTriangles, about a tenth of the size but decoded on load instead of mapped
+			bool compressIndices = false;
+			//Meshes store their vertices through VertexCompression::EncodeVertices, decoded on load like the indices
+			bool compressVertices = false;
+			//Meshes get Simplifier::BuildLevelsOfDetail levels behind their full detail indices
+			bool buildLevelsOfDetail = true;
+			//Meshes relative to the source folder that are drawn alpha blended without culling, like the FireFX pass. Their draw order
+			//is not optimized for overdraw, and their overdraw is measured with every face drawn
+			std::vector<std::string> blendedMeshes{ "fireFX.obj" };
+		};
+
+		struct CookStats
+		{
+			size_t numAssets{};
+			size_t numCooked{};
+			size_t numUpToDate{};
+			size_t numFailed{};
+			size_t numRemoved{};
+		};
+
+		//<outputFolder>/manifest.json keeps the content hash and outputs of every source, a source is only cooked again
+		//when its hash changed or an output is missing. Outputs of deleted sources are removed
+		//Returns false when any asset failed, those are left out of the manifest so the next run retries them
+		bool Cook(const CookOptions& options, CookStats& stats);
+	}
+}
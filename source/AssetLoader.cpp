@@ -0,0 +1,99 @@
+#include "pch.h"
+#include "AssetLoader.h"
+#include "Parallel.h"
+
+namespace dae
+{
+    AssetLoader::AssetLoader(uint32_t numThreads)
+    {
+        if (numThreads == 0)
+            numThreads = GetDefaultThreadCount();
+
+        m_Threads.reserve(numThreads);
+        for (uint32_t i = 0; i < numThreads; ++i)
+            m_Threads.emplace_back(&AssetLoader::WorkerLoop, this);
+    }
+
+    AssetLoader::~AssetLoader()
+    {
+        {
+            const std::lock_guard lock{ m_Mutex };
+            m_IsStopping = true;
+            m_Jobs.clear();
+        }
+        m_JobAvailable.notify_all();
+
+        for (std::thread& thread : m_Threads)
+            thread.join();
+    }
+
+    void AssetLoader::Enqueue(Job job)
+    {
+        {
+            const std::lock_guard lock{ m_Mutex };
+            m_Jobs.push_back(std::move(job));
+            ++m_NumPending;
+        }
+        m_JobAvailable.notify_one();
+    }
+
+    size_t AssetLoader::ProcessCompleted()
+    {
+        std::vector<Completion> completions{};
+        {
+            const std::lock_guard lock{ m_Mutex };
+            completions.swap(m_Completions);
+            m_NumPending -= completions.size();
+        }
+
+        // Completions may enqueue new jobs, so they run without holding the lock
+        for (const Completion& completion : completions)
+        {
+            if (completion)
+                completion();
+        }
+        return completions.size();
+    }
+
+    void AssetLoader::WaitAll()
+    {
+        while (GetNumPending() > 0)
+        {
+            {
+                std::unique_lock lock{ m_Mutex };
+                m_JobFinished.wait(lock, [this]() { return m_Completions.size() == m_NumPending; });
+            }
+            ProcessCompleted();
+        }
+    }
+
+    size_t AssetLoader::GetNumPending() const
+    {
+        const std::lock_guard lock{ m_Mutex };
+        return m_NumPending;
+    }
+
+    void AssetLoader::WorkerLoop()
+    {
+        while (true)
+        {
+            Job job{};
+            {
+                std::unique_lock lock{ m_Mutex };
+                m_JobAvailable.wait(lock, [this]() { return m_IsStopping or !m_Jobs.empty(); });
+                if (m_IsStopping)
+                    return;
+
+                job = std::move(m_Jobs.front());
+                m_Jobs.pop_front();
+            }
+
+            Completion completion = job();
+            {
+                const std::lock_guard lock{ m_Mutex };
+                m_Completions.push_back(std::move(completion));
+            }
+            m_JobFinished.notify_all();
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dae
+{
+    // Thread pool for the CPU side of asset loading (file reads, decoding, parsing, shader compilation)
+    // Every job returns a completion that runs later on the thread calling ProcessCompleted, which is where GPU resources get created
+    class AssetLoader final
+    {
+    public:
+        using Completion = std::function<void()>;
+        using Job = std::function<Completion()>;
+
+        // 0 uses every hardware thread
+        explicit AssetLoader(uint32_t numThreads = 0);
+        // Waits for running jobs, queued jobs and completions that did not run yet are dropped
+        ~AssetLoader();
+
+        AssetLoader(const AssetLoader& other) = delete;
+        AssetLoader(AssetLoader&& other) noexcept = delete;
+        AssetLoader& operator=(const AssetLoader& other) = delete;
+        AssetLoader& operator=(AssetLoader&& other) noexcept = delete;
+
+        void Enqueue(Job job);
+
+        // Runs the completions of every finished job in the order the jobs finished, returns how many ran
+        size_t ProcessCompleted();
+        // Blocks until every enqueued job finished, then runs all completions
+        void WaitAll();
+
+        // Jobs that were enqueued but whose completion did not run yet
+        size_t GetNumPending() const;
+
+    private:
+        void WorkerLoop();
+
+        mutable std::mutex m_Mutex{};
+        std::condition_variable m_JobAvailable{};
+        std::condition_variable m_JobFinished{};
+
+        std::deque<Job> m_Jobs{};
+        std::vector<Completion> m_Completions{};
+        size_t m_NumPending = 0;
+        bool m_IsStopping = false;
+
+        std::vector<std::thread> m_Threads{};
+    };
+}
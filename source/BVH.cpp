@@ -0,0 +1,451 @@
+#include "pch.h"
+#include "BVH.h"
+#include "Parallel.h"
+
+#include <array>
+#include <atomic>
+#include <cmath>
+
+namespace dae
+{
+	namespace BVH
+	{
+		namespace
+		{
+			constexpr size_t NumBins{ 16 };
+			//Relative to one ray triangle test
+			constexpr float TraversalCost{ 1.f };
+			//Binning stops finding splits in thin or clustered geometry, below this depth object median splits take over
+			//so the tree never gets deeper than the traversal stack
+			constexpr uint32_t MaxBinnedDepth{ 32 };
+			constexpr size_t MaxDepth{ 64 };
+			//Subtrees are handed to the threads once they get this small, or once there are enough of them
+			constexpr size_t MinTaskTriangles{ 1024 };
+			constexpr size_t TasksPerThread{ 8 };
+
+			//The Vector3 constructors, operators and indexing are not inlined, so the build and the queries work on plain floats
+			using Float3 = std::array<float, 3>;
+
+			Float3 ToFloat3(const Vector3& vector)
+			{
+				return { vector.x, vector.y, vector.z };
+			}
+
+			Vector3 ToVector3(const Float3& vector)
+			{
+				Vector3 result{};
+				result.x = vector[0];
+				result.y = vector[1];
+				result.z = vector[2];
+				return result;
+			}
+
+			float Dot(const Float3& a, const Float3& b)
+			{
+				return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+			}
+
+			Float3 Cross(const Float3& a, const Float3& b)
+			{
+				return { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+			}
+
+			Float3 Subtract(const Float3& a, const Float3& b)
+			{
+				return { a[0] - b[0], a[1] - b[1], a[2] - b[2] };
+			}
+
+			struct Bounds
+			{
+				Float3 min{ FLT_MAX, FLT_MAX, FLT_MAX };
+				Float3 max{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+				void Grow(const Float3& point)
+				{
+					for (size_t axis = 0; axis < 3; ++axis)
+					{
+						min[axis] = std::min(min[axis], point[axis]);
+						max[axis] = std::max(max[axis], point[axis]);
+					}
+				}
+
+				void Grow(const Bounds& bounds)
+				{
+					for (size_t axis = 0; axis < 3; ++axis)
+					{
+						min[axis] = std::min(min[axis], bounds.min[axis]);
+						max[axis] = std::max(max[axis], bounds.max[axis]);
+					}
+				}
+
+				//Proportional to the chance that a random ray hits the box, 0 when empty
+				float HalfArea() const
+				{
+					const Float3 extent = Subtract(max, min);
+					if (extent[0] < 0.f)
+						return 0.f;
+					return extent[0] * extent[1] + extent[1] * extent[2] + extent[2] * extent[0];
+				}
+			};
+
+			struct BuildTask
+			{
+				uint32_t node{};
+				uint32_t begin{};
+				uint32_t end{};
+				uint32_t depth{};
+			};
+
+			struct Builder
+			{
+				std::vector<Bounds> triangleBounds{};
+				std::vector<Float3> centroids{};
+				//Reordered into leaf order while building
+				std::vector<uint32_t> triangleIndices{};
+				std::vector<Node> nodes{};
+				std::atomic<uint32_t> numNodes{ 1 };
+			};
+
+			uint32_t GetBin(float centroid, float boundsMin, float binScale)
+			{
+				return std::min(static_cast<uint32_t>((centroid - boundsMin) * binScale), static_cast<uint32_t>(NumBins - 1));
+			}
+
+			//Either makes task.node a leaf or splits its triangles and allocates the two children, which are returned to be built next
+			bool SplitNode(Builder& builder, const BuildTask& task, BuildTask& left, BuildTask& right)
+			{
+				Bounds bounds{};
+				Bounds centroidBounds{};
+				for (uint32_t triangle = task.begin; triangle < task.end; ++triangle)
+				{
+					bounds.Grow(builder.triangleBounds[builder.triangleIndices[triangle]]);
+					centroidBounds.Grow(builder.centroids[builder.triangleIndices[triangle]]);
+				}
+
+				Node& node = builder.nodes[task.node];
+				node.boundsMin = ToVector3(bounds.min);
+				node.boundsMax = ToVector3(bounds.max);
+				node.first = task.begin;
+				node.numTriangles = task.end - task.begin;
+				if (node.numTriangles <= 1)
+					return false;
+
+				//Best plane over every axis: the cost of tracing both halves against the cost of testing every triangle here
+				const float leafCost = static_cast<float>(node.numTriangles);
+				float bestCost = FLT_MAX;
+				size_t bestAxis = 3;
+				uint32_t bestBin = 0;
+				for (size_t axis = 0; axis < 3; ++axis)
+				{
+					const float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+					if (extent <= 0.f)
+						continue;
+
+					std::array<Bounds, NumBins> bins{};
+					std::array<uint32_t, NumBins> binCounts{};
+					const float binScale = NumBins / extent;
+					for (uint32_t triangle = task.begin; triangle < task.end; ++triangle)
+					{
+						const uint32_t triangleIndex = builder.triangleIndices[triangle];
+						const uint32_t bin = GetBin(builder.centroids[triangleIndex][axis], centroidBounds.min[axis], binScale);
+						bins[bin].Grow(builder.triangleBounds[triangleIndex]);
+						++binCounts[bin];
+					}
+
+					//Everything right of each plane first, then sweep from the left
+					std::array<float, NumBins> rightCosts{};
+					Bounds rightBounds{};
+					uint32_t rightCount = 0;
+					for (size_t bin = NumBins - 1; bin > 0; --bin)
+					{
+						rightBounds.Grow(bins[bin]);
+						rightCount += binCounts[bin];
+						rightCosts[bin] = rightBounds.HalfArea() * static_cast<float>(rightCount);
+					}
+
+					Bounds leftBounds{};
+					uint32_t leftCount = 0;
+					for (uint32_t bin = 0; bin < NumBins - 1; ++bin)
+					{
+						leftBounds.Grow(bins[bin]);
+						leftCount += binCounts[bin];
+						const float cost = leftBounds.HalfArea() * static_cast<float>(leftCount) + rightCosts[bin + 1];
+						if (leftCount > 0 and leftCount < node.numTriangles and cost < bestCost)
+						{
+							bestCost = cost;
+							bestAxis = axis;
+							bestBin = bin;
+						}
+					}
+				}
+
+				const float nodeArea = bounds.HalfArea();
+				const float splitCost = nodeArea > 0.f ? TraversalCost + bestCost / nodeArea : FLT_MAX;
+				if (node.numTriangles <= MaxLeafTriangles and splitCost >= leafCost)
+					return false;
+
+				uint32_t middle{};
+				if (bestAxis < 3 and task.depth < MaxBinnedDepth)
+				{
+					const float binScale = NumBins / (centroidBounds.max[bestAxis] - centroidBounds.min[bestAxis]);
+					const auto first = builder.triangleIndices.begin();
+					middle = static_cast<uint32_t>(std::partition(first + task.begin, first + task.end, [&](uint32_t triangleIndex)
+						{
+							return GetBin(builder.centroids[triangleIndex][bestAxis], centroidBounds.min[bestAxis], binScale) <= bestBin;
+						}) - first);
+				}
+				else
+				{
+					//No plane separates the centroids, or the tree got too deep: halve along the longest axis
+					const Float3 extent = Subtract(centroidBounds.max, centroidBounds.min);
+					const size_t axis = std::max_element(extent.begin(), extent.end()) - extent.begin();
+					const auto first = builder.triangleIndices.begin();
+					middle = task.begin + node.numTriangles / 2;
+					std::nth_element(first + task.begin, first + middle, first + task.end, [&](uint32_t a, uint32_t b)
+						{
+							return builder.centroids[a][axis] < builder.centroids[b][axis];
+						});
+				}
+
+				const uint32_t leftNode = builder.numNodes.fetch_add(2);
+				node.first = leftNode;
+				node.numTriangles = 0;
+				left = { leftNode, task.begin, middle, task.depth + 1 };
+				right = { leftNode + 1, middle, task.end, task.depth + 1 };
+				return true;
+			}
+
+			void BuildSubtree(Builder& builder, const BuildTask& subtree)
+			{
+				std::vector<BuildTask> stack{ subtree };
+				while (!stack.empty())
+				{
+					const BuildTask task = stack.back();
+					stack.pop_back();
+
+					BuildTask left{}, right{};
+					if (SplitNode(builder, task, left, right))
+					{
+						stack.push_back(right);
+						stack.push_back(left);
+					}
+				}
+			}
+
+			//Distance to where the ray enters the box, FLT_MAX when it misses it or enters beyond maxDistance
+			float IntersectBox(const Node& node, const Float3& origin, const Float3& inverseDirection, float maxDistance)
+			{
+				const float x0 = (node.boundsMin.x - origin[0]) * inverseDirection[0];
+				const float x1 = (node.boundsMax.x - origin[0]) * inverseDirection[0];
+				const float y0 = (node.boundsMin.y - origin[1]) * inverseDirection[1];
+				const float y1 = (node.boundsMax.y - origin[1]) * inverseDirection[1];
+				const float z0 = (node.boundsMin.z - origin[2]) * inverseDirection[2];
+				const float z1 = (node.boundsMax.z - origin[2]) * inverseDirection[2];
+				const float enter = std::max(std::max(std::min(x0, x1), std::min(y0, y1)), std::max(std::min(z0, z1), 0.f));
+				const float exit = std::min(std::min(std::max(x0, x1), std::max(y0, y1)), std::min(std::max(z0, z1), maxDistance));
+				return enter <= exit ? enter : FLT_MAX;
+			}
+
+			//Moller-Trumbore, updates hit when the triangle is nearer
+			bool IntersectTriangle(const Triangle& triangle, const Float3& origin, const Float3& direction, Hit& hit)
+			{
+				const Float3 edge1 = ToFloat3(triangle.edge1);
+				const Float3 edge2 = ToFloat3(triangle.edge2);
+				const Float3 p = Cross(direction, edge2);
+				const float determinant = Dot(edge1, p);
+				if (determinant == 0.f)
+					return false;
+
+				const float inverseDeterminant = 1.f / determinant;
+				const Float3 s = Subtract(origin, ToFloat3(triangle.corner));
+				const float u = Dot(s, p) * inverseDeterminant;
+				if (u < 0.f or u > 1.f)
+					return false;
+
+				const Float3 q = Cross(s, edge1);
+				const float v = Dot(direction, q) * inverseDeterminant;
+				if (v < 0.f or u + v > 1.f)
+					return false;
+
+				const float distance = Dot(edge2, q) * inverseDeterminant;
+				if (distance < 0.f or distance >= hit.distance)
+					return false;
+
+				hit.distance = distance;
+				hit.u = u;
+				hit.v = v;
+				return true;
+			}
+
+			bool Pop(const std::array<std::pair<uint32_t, float>, MaxDepth>& stack, size_t& stackSize, float maxDistance, uint32_t& nodeIndex)
+			{
+				while (stackSize > 0)
+				{
+					const auto [node, distance] = stack[--stackSize];
+					if (distance < maxDistance)
+					{
+						nodeIndex = node;
+						return true;
+					}
+				}
+				return false;
+			}
+
+			//Visits the nearer child first. Returns true when anyHit is set and a triangle was hit
+			template<bool AnyHit>
+			bool Traverse(const Tree& tree, const Ray& ray, Hit& hit)
+			{
+				if (tree.nodes.empty())
+					return false;
+
+				const Float3 origin = ToFloat3(ray.origin);
+				const Float3 direction = ToFloat3(ray.direction);
+				const Float3 inverseDirection{ 1.f / direction[0], 1.f / direction[1], 1.f / direction[2] };
+				if (IntersectBox(tree.nodes.front(), origin, inverseDirection, hit.distance) == FLT_MAX)
+					return false;
+
+				//Far children with the distance to their box, a nearer hit found meanwhile skips them
+				std::array<std::pair<uint32_t, float>, MaxDepth> stack{};
+				size_t stackSize = 0;
+				uint32_t nodeIndex = 0;
+				bool isHit = false;
+				while (true)
+				{
+					const Node& node = tree.nodes[nodeIndex];
+					if (node.numTriangles > 0)
+					{
+						for (uint32_t triangle = node.first; triangle < node.first + node.numTriangles; ++triangle)
+						{
+							if (IntersectTriangle(tree.triangles[triangle], origin, direction, hit))
+							{
+								hit.triangle = tree.triangleIndices[triangle];
+								isHit = true;
+								if constexpr (AnyHit)
+									return true;
+							}
+						}
+						if (!Pop(stack, stackSize, hit.distance, nodeIndex))
+							return isHit;
+						continue;
+					}
+
+					uint32_t nearChild = node.first;
+					uint32_t farChild = node.first + 1;
+					float nearDistance = IntersectBox(tree.nodes[nearChild], origin, inverseDirection, hit.distance);
+					float farDistance = IntersectBox(tree.nodes[farChild], origin, inverseDirection, hit.distance);
+					if (farDistance < nearDistance)
+					{
+						std::swap(nearChild, farChild);
+						std::swap(nearDistance, farDistance);
+					}
+
+					if (nearDistance == FLT_MAX)
+					{
+						if (!Pop(stack, stackSize, hit.distance, nodeIndex))
+							return isHit;
+					}
+					else
+					{
+						nodeIndex = nearChild;
+						if (farDistance != FLT_MAX)
+							stack[stackSize++] = { farChild, farDistance };
+					}
+				}
+			}
+		}
+
+		Tree Build(std::span<const uint32_t> indices, std::span<const Vector3> positions, uint32_t numThreads)
+		{
+			Tree tree{};
+			const size_t numTriangles = indices.size() / 3;
+			if (numTriangles == 0)
+				return tree;
+			if (numThreads == 0)
+				numThreads = GetDefaultThreadCount();
+
+			Builder builder{};
+			builder.triangleBounds.resize(numTriangles);
+			builder.centroids.resize(numTriangles);
+			builder.triangleIndices.resize(numTriangles);
+			builder.nodes.resize(numTriangles * 2 - 1);
+
+			constexpr size_t TrianglesPerChunk{ 16384 };
+			ParallelFor((numTriangles + TrianglesPerChunk - 1) / TrianglesPerChunk, numThreads, [&](size_t chunk)
+				{
+					const size_t end = std::min(numTriangles, (chunk + 1) * TrianglesPerChunk);
+					for (size_t triangle = chunk * TrianglesPerChunk; triangle < end; ++triangle)
+					{
+						Bounds& bounds = builder.triangleBounds[triangle];
+						for (size_t corner = 0; corner < 3; ++corner)
+							bounds.Grow(ToFloat3(positions[indices[triangle * 3 + corner]]));
+						for (size_t axis = 0; axis < 3; ++axis)
+							builder.centroids[triangle][axis] = (bounds.min[axis] + bounds.max[axis]) * 0.5f;
+						builder.triangleIndices[triangle] = static_cast<uint32_t>(triangle);
+					}
+				});
+
+			//Breadth first until the subtrees are small or numerous enough to keep every thread busy, the largest are built first
+			const size_t maxTasks = static_cast<size_t>(numThreads) * TasksPerThread;
+			std::vector<BuildTask> tasks{ { 0, 0, static_cast<uint32_t>(numTriangles), 0 } };
+			std::vector<BuildTask> subtrees{};
+			for (size_t taskIndex = 0; taskIndex < tasks.size(); ++taskIndex)
+			{
+				const BuildTask task = tasks[taskIndex];
+				BuildTask left{}, right{};
+				if (numThreads == 1 or task.end - task.begin <= MinTaskTriangles or tasks.size() + subtrees.size() >= maxTasks)
+					subtrees.push_back(task);
+				else if (SplitNode(builder, task, left, right))
+					tasks.insert(tasks.end(), { left, right });
+			}
+			std::sort(subtrees.begin(), subtrees.end(), [](const BuildTask& a, const BuildTask& b) { return a.end - a.begin > b.end - b.begin; });
+			ParallelFor(subtrees.size(), numThreads, [&](size_t subtree) { BuildSubtree(builder, subtrees[subtree]); });
+
+			builder.nodes.resize(builder.numNodes);
+			tree.nodes = std::move(builder.nodes);
+			tree.triangleIndices = std::move(builder.triangleIndices);
+			tree.triangles.resize(numTriangles);
+			for (size_t triangle = 0; triangle < numTriangles; ++triangle)
+			{
+				const uint32_t* cornerPtr = &indices[size_t(tree.triangleIndices[triangle]) * 3];
+				const Float3 corner = ToFloat3(positions[cornerPtr[0]]);
+				tree.triangles[triangle] = { positions[cornerPtr[0]], ToVector3(Subtract(ToFloat3(positions[cornerPtr[1]]), corner)),
+					ToVector3(Subtract(ToFloat3(positions[cornerPtr[2]]), corner)) };
+			}
+			return tree;
+		}
+
+		std::optional<Hit> IntersectClosest(const Tree& tree, const Ray& ray)
+		{
+			Hit hit{ ray.maxDistance };
+			if (!Traverse<false>(tree, ray, hit))
+				return std::nullopt;
+			return hit;
+		}
+
+		bool IntersectAny(const Tree& tree, const Ray& ray)
+		{
+			Hit hit{ ray.maxDistance };
+			return Traverse<true>(tree, ray, hit);
+		}
+
+		float ComputeCost(const Tree& tree)
+		{
+			if (tree.nodes.empty())
+				return 0.f;
+
+			const auto halfArea = [](const Node& node)
+				{
+					const Bounds bounds{ ToFloat3(node.boundsMin), ToFloat3(node.boundsMax) };
+					return bounds.HalfArea();
+				};
+			const float rootArea = halfArea(tree.nodes.front());
+			if (rootArea <= 0.f)
+				return static_cast<float>(tree.triangles.size());
+
+			float cost = 0.f;
+			for (const Node& node : tree.nodes)
+				cost += halfArea(node) / rootArea * (node.numTriangles > 0 ? static_cast<float>(node.numTriangles) : TraversalCost);
+			return cost;
+		}
+	}
+}
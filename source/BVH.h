@@ -0,0 +1,75 @@
+#pragma once
+#include <cfloat>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace dae
+{
+	//Bounding volume hierarchy over the triangles of a mesh, for picking and other ray queries on the CPU
+	namespace BVH
+	{
+		//Leaves hold at most this many triangles, fewer when the surface area heuristic finds a split that is cheaper to trace
+		constexpr size_t MaxLeafTriangles{ 4 };
+
+		//32 bytes, so a pair of children is one cache line
+		struct Node
+		{
+			Vector3 boundsMin{};
+			//Leaves: first triangle in Tree::triangles, other nodes: the left child, the right child follows it
+			uint32_t first{};
+			Vector3 boundsMax{};
+			//0 for nodes that are not leaves
+			uint32_t numTriangles{};
+		};
+		static_assert(sizeof(Node) == 32);
+
+		//Ready for the ray triangle test: a corner and the two edges leaving it
+		struct Triangle
+		{
+			Vector3 corner{};
+			Vector3 edge1{};
+			Vector3 edge2{};
+		};
+
+		struct Tree
+		{
+			//The root is node 0
+			std::vector<Node> nodes{};
+			//In leaf order
+			std::vector<Triangle> triangles{};
+			//Index of every leaf triangle in the index buffer the tree was built from, divided by 3
+			std::vector<uint32_t> triangleIndices{};
+		};
+
+		//Hits are in [0, maxDistance), measured in lengths of direction, so a unit direction gives distances
+		struct Ray
+		{
+			Vector3 origin{};
+			Vector3 direction{};
+			float maxDistance{ FLT_MAX };
+		};
+
+		struct Hit
+		{
+			float distance{};
+			//In the index buffer the tree was built from, divided by 3
+			uint32_t triangle{};
+			//Barycentric weights of the second and third corner
+			float u{};
+			float v{};
+		};
+
+		//Binned surface area heuristic build. The top of the tree is split on the calling thread until there are enough subtrees
+		//to build the rest on numThreads threads, 0 uses every hardware thread. Only the node order depends on the thread count
+		Tree Build(std::span<const uint32_t> indices, std::span<const Vector3> positions, uint32_t numThreads = 0);
+
+		//Nearest triangle along the ray, both sides of a triangle are hit
+		std::optional<Hit> IntersectClosest(const Tree& tree, const Ray& ray);
+		//Stops at the first triangle found, for shadow and line of sight rays
+		bool IntersectAny(const Tree& tree, const Ray& ray);
+
+		//Expected cost of a random ray under the heuristic the build minimizes, in ray triangle tests
+		float ComputeCost(const Tree& tree);
+	}
+}
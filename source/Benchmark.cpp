@@ -0,0 +1,1405 @@
+#include "pch.h"
+#include "Benchmark.h"
+#include "BVH.h"
+#include "Utils.h"
+#include "MeshCache.h"
+#include "MeshOptimizer.h"
+#include "Parallel.h"
+#include "Rasterizer.h"
+#include "TangentSpace.h"
+#include "GLBFile.h"
+#include "DDSFile.h"
+#include "IndexCompression.h"
+#include "Meshlets.h"
+#include "Simplifier.h"
+#include "SoftwareRenderer.h"
+#include "Texture.h"
+#include "VertexCompression.h"
+#include "VertexQuantization.h"
+
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <tuple>
+
+namespace dae
+{
+	namespace Benchmark
+	{
+		namespace
+		{
+			using Clock = std::chrono::steady_clock;
+
+			//1, 2, 4, ... up to every hardware thread
+			std::vector<uint32_t> GetThreadCounts()
+			{
+				std::vector<uint32_t> threadCounts{};
+				for (uint32_t numThreads = 1; numThreads < GetDefaultThreadCount(); numThreads *= 2)
+					threadCounts.push_back(numThreads);
+				threadCounts.push_back(GetDefaultThreadCount());
+				return threadCounts;
+			}
+
+			double SecondsSince(Clock::time_point start)
+			{
+				return std::chrono::duration<double>(Clock::now() - start).count();
+			}
+
+			//Triangles rotated to start at their smallest index and sorted, equal for two index buffers that draw the same triangles
+			std::vector<std::array<uint32_t, 3>> SortedTriangles(std::span<const uint32_t> indices)
+			{
+				std::vector<std::array<uint32_t, 3>> triangles(indices.size() / 3);
+				for (size_t triangle = 0; triangle < triangles.size(); ++triangle)
+				{
+					std::array<uint32_t, 3>& corners = triangles[triangle];
+					std::copy_n(&indices[triangle * 3], 3, corners.begin());
+					std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end()), corners.end());
+				}
+				std::sort(triangles.begin(), triangles.end());
+				return triangles;
+			}
+
+			// Writes a gridSize x gridSize quad grid as triangles, to have an OBJ much larger than the shipped ones
+			std::string WriteSyntheticOBJ(int gridSize)
+			{
+				const std::string filename = (std::filesystem::temp_directory_path() / "benchmark_grid.obj").string();
+				std::ofstream file{ filename };
+
+				for (int y = 0; y <= gridSize; ++y)
+				{
+					for (int x = 0; x <= gridSize; ++x)
+					{
+						const float u = static_cast<float>(x) / gridSize;
+						const float v = static_cast<float>(y) / gridSize;
+						file << "v " << u * 100.f << ' ' << std::sin(u * 20.f) * std::cos(v * 20.f) << ' ' << v * 100.f << '\n';
+						file << "vt " << u << ' ' << v << '\n';
+						file << "vn 0 1 0\n";
+					}
+				}
+
+				const int stride = gridSize + 1;
+				for (int y = 0; y < gridSize; ++y)
+				{
+					for (int x = 0; x < gridSize; ++x)
+					{
+						const int i0 = y * stride + x + 1;
+						const int i1 = i0 + 1;
+						const int i2 = i0 + stride;
+						const int i3 = i2 + 1;
+						file << "f " << i0 << '/' << i0 << '/' << i0 << ' ' << i1 << '/' << i1 << '/' << i1 << ' ' << i3 << '/' << i3 << '/' << i3 << '\n';
+						file << "f " << i0 << '/' << i0 << '/' << i0 << ' ' << i3 << '/' << i3 << '/' << i3 << ' ' << i2 << '/' << i2 << '/' << i2 << '\n';
+					}
+				}
+
+				return filename;
+			}
+
+			//Closed UV sphere with numSegments around and numSegments / 2 from pole to pole, counterclockwise outside like the OBJ files
+			std::string WriteSyntheticSphereOBJ(int numSegments)
+			{
+				const std::string filename = (std::filesystem::temp_directory_path() / "benchmark_sphere.obj").string();
+				std::ofstream file{ filename };
+
+				const int numRings = numSegments / 2;
+				for (int ring = 0; ring <= numRings; ++ring)
+				{
+					const float phi = static_cast<float>(ring) / numRings * PI;
+					for (int segment = 0; segment <= numSegments; ++segment)
+					{
+						const float theta = static_cast<float>(segment) / numSegments * PI_2;
+						const Vector3 normal{ std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta) };
+						file << "v " << normal.x * 50.f << ' ' << normal.y * 50.f << ' ' << normal.z * 50.f << '\n';
+						file << "vt " << static_cast<float>(segment) / numSegments << ' ' << static_cast<float>(ring) / numRings << '\n';
+						file << "vn " << normal.x << ' ' << normal.y << ' ' << normal.z << '\n';
+					}
+				}
+
+				const int stride = numSegments + 1;
+				for (int ring = 0; ring < numRings; ++ring)
+				{
+					for (int segment = 0; segment < numSegments; ++segment)
+					{
+						const int i0 = ring * stride + segment + 1;
+						const int i1 = i0 + 1;
+						const int i2 = i0 + stride;
+						const int i3 = i2 + 1;
+						file << "f " << i0 << '/' << i0 << '/' << i0 << ' ' << i1 << '/' << i1 << '/' << i1 << ' ' << i3 << '/' << i3 << '/' << i3 << '\n';
+						file << "f " << i0 << '/' << i0 << '/' << i0 << ' ' << i3 << '/' << i3 << '/' << i3 << ' ' << i2 << '/' << i2 << '/' << i2 << '\n';
+					}
+				}
+
+				return filename;
+			}
+
+			//World to view matrix of a camera at eye looking at target, built like Camera::CalculateViewMatrix
+			Matrix CreateLookAtMatrix(const Vector3& eye, const Vector3& target)
+			{
+				Vector3 forward = target - eye;
+				forward.Normalize();
+				Vector3 right = Vector3::Cross(std::abs(forward.y) < 0.99f ? Vector3::UnitY : Vector3::UnitX, forward);
+				right.Normalize();
+				const Vector3 up = Vector3::Cross(forward, right);
+				return Matrix::Inverse({ Vector4{ right, 0.f }, Vector4{ up, 0.f }, Vector4{ forward, 0.f }, Vector4{ eye, 1.f } });
+			}
+
+			//A mesh in the order AssetCooker writes with flat gray maps, what the SoftwareRenderer benchmarks draw. The draw call points into the scene
+			struct SoftwareScene
+			{
+				std::vector<Vertex> vertices{};
+				std::vector<uint32_t> indices{};
+				std::unique_ptr<SoftwareRenderer::Texture> diffusePtr{};
+				std::unique_ptr<SoftwareRenderer::Texture> normalPtr{};
+				std::unique_ptr<SoftwareRenderer::Texture> blackPtr{};
+				SoftwareRenderer::DrawCall drawCall{};
+				Vector3 center{};
+				float radius{};
+			};
+
+			bool LoadSoftwareScene(const std::string& filename, SoftwareScene& scene)
+			{
+				Utils::OBJMaterialData materialData{};
+				if (!Utils::ParseOBJ(filename, scene.vertices, scene.indices, {}, &materialData) or scene.vertices.empty())
+					return false;
+				//Front faces of the overdraw optimized clusters come early
+				scene.vertices.resize(MeshOptimizer::OptimizeMesh(scene.vertices, scene.indices, materialData.submeshes));
+
+				Vector3 boundsMin = scene.vertices.front().position;
+				Vector3 boundsMax = scene.vertices.front().position;
+				for (const Vertex& vertex : scene.vertices)
+				{
+					for (int axis = 0; axis < 3; ++axis)
+					{
+						boundsMin[axis] = std::min(boundsMin[axis], vertex.position[axis]);
+						boundsMax[axis] = std::max(boundsMax[axis], vertex.position[axis]);
+					}
+				}
+				scene.center = (boundsMin + boundsMax) * 0.5f;
+				scene.radius = (boundsMax - boundsMin).Magnitude() * 0.5f;
+
+				//The shading cost only depends on the number of visible pixels
+				scene.diffusePtr = SoftwareRenderer::CreateSolidColor(ColorRGB{ 0.5f, 0.5f, 0.5f }, 1.f);
+				scene.normalPtr = SoftwareRenderer::CreateSolidColor(ColorRGB{ 0.5f, 0.5f, 1.f }, 1.f);
+				scene.blackPtr = SoftwareRenderer::CreateSolidColor(colors::Black, 1.f);
+				scene.drawCall.vertices = scene.vertices;
+				scene.drawCall.indices = scene.indices;
+				scene.drawCall.pass = SoftwareRenderer::Pass::Point;
+				scene.drawCall.submeshes.push_back({ 0, static_cast<uint32_t>(scene.indices.size()),
+					{ scene.diffusePtr.get(), scene.normalPtr.get(), scene.blackPtr.get(), scene.blackPtr.get() } });
+				return true;
+			}
+
+			//Fibonacci sphere direction of view out of numViews, spread evenly around the mesh
+			Vector3 GetViewDirection(int view, int numViews)
+			{
+				const float y = 1.f - (static_cast<float>(view) + 0.5f) * 2.f / static_cast<float>(numViews);
+				const float ringRadius = std::sqrt(std::max(0.f, 1.f - y * y));
+				const float angle = static_cast<float>(view) * 2.39996323f;
+				return { std::cos(angle) * ringRadius, y, std::sin(angle) * ringRadius };
+			}
+		}
+
+		void RunAll()
+		{
+			ParseOBJ("Resources/vehicle.obj", 20);
+			ParseOBJ("Resources/fireFX.obj", 200);
+			LoadMeshCache("Resources/vehicle.obj", 20);
+			LoadGLB("Resources/vehicle.obj", 20);
+			LoadCookedTextures("Resources", 5);
+			OptimizeVertexCache("Resources/vehicle.obj");
+			OptimizeOverdraw("Resources/vehicle.obj");
+			OptimizeVertexFetch("Resources/vehicle.obj", 200);
+			PackVertices("Resources/vehicle.obj", 100);
+			CompressIndices("Resources/vehicle.obj", 100);
+			CompressMesh("Resources/vehicle.obj", 100);
+			CullMeshlets("Resources/vehicle.obj", 8);
+			SimplifyMesh("Resources/vehicle.obj");
+			RaycastBVH("Resources/vehicle.obj", 1'000'000);
+			RasterizeTriangles(200'000);
+			CullHierarchicalDepth("Resources/vehicle.obj", 8);
+			ClipNearPlane("Resources/vehicle.obj", 8);
+
+			const std::string syntheticOBJ = WriteSyntheticOBJ(1000);
+			ParseOBJScaling(syntheticOBJ, 3);
+			StreamOBJ(syntheticOBJ, 16ull << 20);
+			GenerateTangents(syntheticOBJ, 3);
+			OptimizeVertexCache(syntheticOBJ);
+			OptimizeVertexFetch(syntheticOBJ, 5);
+			CompressIndices(syntheticOBJ, 5);
+			CompressMesh(syntheticOBJ, 5);
+			CullMeshlets(syntheticOBJ, 8);
+			std::filesystem::remove(syntheticOBJ);
+
+			const std::string sphereOBJ = WriteSyntheticSphereOBJ(1000);
+			CullMeshlets(sphereOBJ, 8);
+			SimplifyMesh(sphereOBJ);
+			RaycastBVH(sphereOBJ, 1'000'000);
+			std::filesystem::remove(sphereOBJ);
+		}
+
+		void ParseOBJ(const std::string& filename, int iterations)
+		{
+			std::error_code error{};
+			const double fileMB = static_cast<double>(std::filesystem::file_size(filename, error)) / (1024.0 * 1024.0);
+			if (error)
+			{
+				std::cout << "Benchmark::ParseOBJ() could not open " << filename << '\n';
+				return;
+			}
+
+			std::vector<Vertex> vertices{};
+			std::vector<uint32_t> indices{};
+			std::vector<Vertex> referenceVertices{};
+			std::vector<uint32_t> referenceIndices{};
+
+			Clock::time_point start = Clock::now();
+			for (int i = 0; i < iterations; ++i)
+				Utils::ParseOBJIfstream(filename, referenceVertices, referenceIndices);
+			const double ifstreamSeconds = SecondsSince(start);
+
+			// Welding changes the output, so the comparison against the old tokenizer runs without it
+			Utils::ParseOBJOptions options{};
+			options.weldVertices = false;
+
+			start = Clock::now();
+			for (int i = 0; i < iterations; ++i)
+				Utils::ParseOBJ(filename, vertices, indices, options);
+			const double mappedSeconds = SecondsSince(start);
+
+			const bool isIdentical = indices == referenceIndices and vertices.size() == referenceVertices.size()
+				and std::memcmp(vertices.data(), referenceVertices.data(), vertices.size() * sizeof(Vertex)) == 0;
+
+			Utils::OBJParseStats weldStats{};
+			std::vector<Vertex> weldedVertices{};
+			std::vector<uint32_t> weldedIndices{};
+			Utils::ParseOBJ(filename, weldedVertices, weldedIndices, {}, nullptr, &weldStats);
+
+			std::cout << "ParseOBJ " << filename << " (" << vertices.size() << " vertices, " << indices.size() / 3 << " triangles)\n";
+			std::cout << "  ifstream: " << fileMB * iterations / ifstreamSeconds << " MB/s\n";
+			std::cout << "  mapped:   " << fileMB * iterations / mappedSeconds << " MB/s\n";
+			std::cout << "  output is " << (isIdentical ? "identical" : "DIFFERENT") << '\n';
+			std::cout << "  welding: " << weldStats.numCorners << " corners -> " << weldStats.numVertices << " vertices\n";
+		}
+	
+		void ParseOBJScaling(const std::string& filename, int iterations)
+		{
+			std::error_code error{};
+			const double fileMB = static_cast<double>(std::filesystem::file_size(filename, error)) / (1024.0 * 1024.0);
+			if (error)
+			{
+				std::cout << "Benchmark::ParseOBJScaling() could not open " << filename << '\n';
+				return;
+			}
+
+			std::vector<Vertex> referenceVertices{};
+			std::vector<uint32_t> referenceIndices{};
+			std::vector<Vertex> vertices{};
+			std::vector<uint32_t> indices{};
+
+			Utils::ParseOBJOptions options{};
+			options.numThreads = 1;
+			Utils::ParseOBJ(filename, referenceVertices, referenceIndices, options);
+
+			std::cout << "ParseOBJ scaling " << filename << " (" << fileMB << " MB)\n";
+			double serialSeconds{};
+			for (const uint32_t numThreads : GetThreadCounts())
+			{
+				options.numThreads = numThreads;
+
+				const Clock::time_point start = Clock::now();
+				for (int i = 0; i < iterations; ++i)
+					Utils::ParseOBJ(filename, vertices, indices, options);
+				const double seconds = SecondsSince(start) / iterations;
+				if (numThreads == 1)
+					serialSeconds = seconds;
+
+				const bool isIdentical = indices == referenceIndices and vertices.size() == referenceVertices.size()
+					and std::memcmp(vertices.data(), referenceVertices.data(), vertices.size() * sizeof(Vertex)) == 0;
+
+				std::cout << "  " << numThreads << " threads: " << fileMB / seconds << " MB/s, "
+					<< serialSeconds / seconds << "x, output is " << (isIdentical ? "identical" : "DIFFERENT") << '\n';
+			}
+		}
+
+		void LoadMeshCache(const std::string& filename, int iterations)
+		{
+			std::vector<Vertex> vertices{};
+			std::vector<uint32_t> indices{};
+
+			Clock::time_point start = Clock::now();
+			for (int i = 0; i < iterations; ++i)
+				Utils::ParseOBJ(filename, vertices, indices);
+			const double parseSeconds = SecondsSince(start) / iterations;
+
+			// First load writes the cache when it is missing or out of date
+			MeshCache::Load(filename);
+
+			start = Clock::now();
+			size_t numVertices{};
+			for (int i = 0; i < iterations; ++i)
+				numVertices += MeshCache::Load(filename)->GetVertices().size();
+			const double cacheSeconds = SecondsSince(start) / iterations;
+
+			std::cout << "LoadMeshCache " << filename << " (" << numVertices / iterations << " vertices)\n";
+			std::cout << "  parse: " << parseSeconds * 1000.0 << " ms\n";
+			std::cout << "  cache: " << cacheSeconds * 1000.0 << " ms\n";
+		}
+
+		void StreamOBJ(const std::string& filename, size_t memoryBudget)
+		{
+			std::error_code error{};
+			const double fileMB = static_cast<double>(std::filesystem::file_size(filename, error)) / (1024.0 * 1024.0);
+			if (error)
+			{
+				std::cout << "Benchmark::StreamOBJ() could not open " << filename << '\n';
+				return;
+			}
+
+			size_t parseBytes{};
+			Clock::time_point start = Clock::now();
+			{
+				std::vector<Vertex> vertices{};
+				std::vector<uint32_t> indices{};
+				Utils::ParseOBJ(filename, vertices, indices);
+				parseBytes = vertices.capacity() * sizeof(Vertex) + indices.capacity() * sizeof(uint32_t);
+			}
+			const double parseSeconds = SecondsSince(start);
+
+			Utils::StreamOBJOptions options{};
+			options.memoryBudget = memoryBudget;
+			Utils::OBJStreamStats stats{};
+			size_t numTriangles{};
+			start = Clock::now();
+			Utils::StreamOBJ(filename, [&](const Utils::OBJBatch& batch) { numTriangles += batch.indices.size() / 3; }, options, &stats);
+			const double streamSeconds = SecondsSince(start);
+
+			std::cout << "StreamOBJ " << filename << " (" << fileMB << " MB, budget " << memoryBudget / (1024 * 1024) << " MB)\n";
+			std::cout << "  parse:  " << fileMB / parseSeconds << " MB/s, output " << parseBytes / (1024 * 1024) << " MB\n";
+			std::cout << "  stream: " << fileMB / streamSeconds << " MB/s, peak " << stats.peakBytes / (1024 * 1024) << " MB, "
+				<< stats.numBatches << " batches, " << numTriangles << " triangles, " << stats.numBlockLoads << " block loads\n";
+		}
+		void GenerateTangents(const std::string& filename, int iterations)
+		{
+			std::vector<Vertex> referenceVertices{};
+			std::vector<uint32_t> indices{};
+			if (!Utils::ParseOBJ(filename, referenceVertices, indices))
+			{
+				std::cout << "Benchmark::GenerateTangents() could not open " << filename << '\n';
+				return;
+			}
+
+			const double millionTriangles = static_cast<double>(indices.size() / 3) / 1'000'000.0;
+			std::vector<Vertex> vertices = referenceVertices;
+			TangentSpace::Generate(referenceVertices, indices, 1);
+
+			std::cout << "GenerateTangents " << filename << " (" << millionTriangles << " M triangles)\n";
+			for (const uint32_t numThreads : GetThreadCounts())
+			{
+				const Clock::time_point start = Clock::now();
+				for (int i = 0; i < iterations; ++i)
+					TangentSpace::Generate(vertices, indices, numThreads);
+				const double seconds = SecondsSince(start) / iterations;
+
+				const bool isIdentical = std::memcmp(vertices.data(), referenceVertices.data(), vertices.size() * sizeof(Vertex)) == 0;
+				std::cout << "  " << numThreads << " threads: " << millionTriangles / seconds << " M triangles/s, "
+					<< (isIdentical ? "output is identical" : "OUTPUT DIFFERS") << '\n';
+			}
+		}
+
+		void LoadGLB(const std::string& filename, int iterations)
+		{
+			std::vector<Vertex> vertices{};
+			std::vector<uint32_t> indices{};
+
+			Clock::time_point start = Clock::now();
+			for (int i = 0; i < iterations; ++i)
+				Utils::ParseOBJ(filename, vertices, indices);
+			const double parseSeconds = SecondsSince(start) / iterations;
+
+			const std::string glbPath = (std::filesystem::temp_directory_path() / "benchmark_mesh.glb").string();
+			if (!GLBFile::Write(glbPath, vertices, indices))
+			{
+				std::cout << "Benchmark::LoadGLB() could not write " << glbPath << '\n';
+				return;
+			}
+
+			bool isMapped{ true };
+			bool isIdentical{ true };
+			start = Clock::now();
+			for (int i = 0; i < iterations; ++i)
+			{
+				const std::unique_ptr<GLBFile> glbPtr = GLBFile::Open(glbPath);
+				if (!glbPtr)
+					return;
+
+				isMapped = isMapped and glbPtr->AreVerticesMapped() and glbPtr->AreIndicesMapped();
+				isIdentical = isIdentical and glbPtr->GetVertices().size() == vertices.size() and glbPtr->GetIndices().size() == indices.size()
+					and std::memcmp(glbPtr->GetVertices().data(), vertices.data(), vertices.size() * sizeof(Vertex)) == 0
+					and std::memcmp(glbPtr->GetIndices().data(), indices.data(), indices.size() * sizeof(uint32_t)) == 0;
+			}
+			const double glbSeconds = SecondsSince(start) / iterations;
+			std::filesystem::remove(glbPath);
+
+			std::cout << "LoadGLB " << filename << '\n';
+			std::cout << "  parse OBJ: " << parseSeconds * 1000.0 << " ms\n";
+			std::cout << "  open GLB:  " << glbSeconds * 1000.0 << " ms, " << (isMapped ? "zero-copy" : "repacked") << ", "
+				<< (isIdentical ? "output is identical" : "OUTPUT DIFFERS") << '\n';
+		}
+
+		void LoadCookedTextures(const std::string& folder, int iterations)
+		{
+			double decodeSeconds{};
+			double mapSeconds{};
+			size_t numTextures{};
+			size_t numMipBytes{};
+
+			for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator{ folder })
+			{
+				if (entry.path().extension() != ".png")
+					continue;
+
+				const std::string cookedPath = (std::filesystem::path{ folder } / "Cooked" / entry.path().stem()).string() + ".dds";
+				if (!std::filesystem::exists(cookedPath))
+				{
+					std::cout << "Benchmark::LoadCookedTextures() found no " << cookedPath << ", run AssetCooker first\n";
+					continue;
+				}
+
+				Clock::time_point start = Clock::now();
+				for (int i = 0; i < iterations; ++i)
+				{
+					SDL_Surface* pSurface = Texture::DecodeFromFile(entry.path().string());
+					if (pSurface)
+						SDL_FreeSurface(pSurface);
+				}
+				decodeSeconds += SecondsSince(start) / iterations;
+
+				// Reads one byte per page, so the mapping cost is paid like an upload would
+				start = Clock::now();
+				for (int i = 0; i < iterations; ++i)
+				{
+					const std::unique_ptr<DDSFile> ddsFilePtr = DDSFile::Open(cookedPath);
+					if (!ddsFilePtr)
+						return;
+
+					for (uint32_t level = 0; level < ddsFilePtr->GetNumMips(); ++level)
+					{
+						const std::span<const char> mipData = ddsFilePtr->GetMip(level).data;
+						const volatile char* pagePtr = mipData.data();
+						for (size_t offset = 0; offset < mipData.size(); offset += 4096)
+							static_cast<void>(pagePtr[offset]);
+						if (i == 0)
+							numMipBytes += mipData.size();
+					}
+				}
+				mapSeconds += SecondsSince(start) / iterations;
+				++numTextures;
+			}
+
+			std::cout << "LoadCookedTextures " << folder << " (" << numTextures << " textures, " << numMipBytes / (1024.0 * 1024.0) << " MB with mips)\n";
+			std::cout << "  decode PNG:        " << decodeSeconds * 1000.0 << " ms, one mip\n";
+			std::cout << "  map cooked DDS:    " << mapSeconds * 1000.0 << " ms, every mip\n";
+		}
+
+		void OptimizeVertexCache(const std::string& filename)
+		{
+			std::vector<Vertex> vertices{};
+			std::vector<uint32_t> originalIndices{};
+			if (!Utils::ParseOBJ(filename, vertices, originalIndices))
+			{
+				std::cout << "Benchmark::OptimizeVertexCache() could not open " << filename << '\n';
+				return;
+			}
+
+			std::vector<uint32_t> indices = originalIndices;
+			const Clock::time_point start = Clock::now();
+			MeshOptimizer::OptimizeVertexCache(indices, vertices.size());
+			const double seconds = SecondsSince(start);
+
+			const double millionTriangles = static_cast<double>(indices.size() / 3) / 1'000'000.0;
+			const bool isSameMesh = SortedTriangles(indices) == SortedTriangles(originalIndices);
+			std::cout << "OptimizeVertexCache " << filename << " (" << millionTriangles << " M triangles): " << millionTriangles / seconds << " M triangles/s, "
+				<< (isSameMesh ? "same triangles" : "TRIANGLES DIFFER") << '\n';
+
+			for (const MeshOptimizer::CacheModel cacheModel : { MeshOptimizer::CacheModel::FIFO, MeshOptimizer::CacheModel::LRU })
+			{
+				for (const uint32_t cacheSize : { 8u, 16u, 32u })
+				{
+					const MeshOptimizer::VertexCacheStats before = MeshOptimizer::AnalyzeVertexCache(originalIndices, vertices.size(), cacheSize, cacheModel);
+					const MeshOptimizer::VertexCacheStats after = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size(), cacheSize, cacheModel);
+					std::cout << "  " << (cacheModel == MeshOptimizer::CacheModel::FIFO ? "FIFO " : "LRU  ") << std::setw(2) << cacheSize
+						<< ": ACMR " << before.acmr << " -> " << after.acmr << ", ATVR " << before.atvr << " -> " << after.atvr << '\n';
+				}
+			}
+		}
+
+		void OptimizeOverdraw(const std::string& filename)
+		{
+			std::vector<Vertex> vertices{};
+			std::vector<uint32_t> originalIndices{};
+			if (!Utils::ParseOBJ(filename, vertices, originalIndices))
+			{
+				std::cout << "Benchmark::OptimizeOverdraw() could not open " << filename << '\n';
+				return;
+			}
+
+			std::vector<uint32_t> cacheOptimizedIndices = originalIndices;
+			MeshOptimizer::OptimizeVertexCache(cacheOptimizedIndices, vertices.size());
+
+			const auto printStats = [&vertices](const char* label, const std::vector<uint32_t>& indices)
+				{
+					const MeshOptimizer::VertexCacheStats cacheStats = MeshOptimizer::AnalyzeVertexCache(indices, vertices.size());
+					const MeshOptimizer::OverdrawStats overdrawStats = MeshOptimizer::AnalyzeOverdraw(indices, vertices);
+					std::cout << "  " << std::left << std::setw(22) << label << std::right << "ACMR " << cacheStats.acmr << ", overdraw " << overdrawStats.overdraw << '\n';
+				};
+
+			std::cout << "OptimizeOverdraw " << filename << " (" << originalIndices.size() / 3 << " triangles, 16 viewpoints)\n";
+			printStats("OBJ order:", originalIndices);
+			printStats("vertex cache:", cacheOptimizedIndices);
+			for (const float maxACMRLoss : { 0.f, 0.05f, 0.1f, 0.25f, 1.f })
+			{
+				std::vector<uint32_t> indices = cacheOptimizedIndices;
+				const Clock::time_point start = Clock::now();
+				MeshOptimizer::OptimizeOverdraw(indices, vertices, maxACMRLoss);
+				const double seconds = SecondsSince(start);
+
+				const std::string label = "overdraw, loss " + std::to_string(static_cast<int>(maxACMRLoss * 100.f)) + "%:";
+				printStats(label.c_str(), indices);
+				if (SortedTriangles(indices) != SortedTriangles(originalIndices))
+					std::cout << "    TRIANGLES DIFFER\n";
+				std::cout << "    optimized in " << seconds * 1000.0 << " ms\n";
+			}
+		}
+
+		void OptimizeVertexFetch(const std::string& filename, int iterations)
+		{
+			std::vector<Vertex> vertices{};
+			std::vector<uint32_t> indices{};
+			if (!Utils::ParseOBJ(filename, vertices, indices))
+			{
+				std::cout << "Benchmark::OptimizeVertexFetch() could not open " << filename << '\n';
+				return;
+			}
+
+			const double millionIndices = static_cast<double>(indices.size()) / 1'000'000.0;
+			std::cout << "OptimizeVertexFetch " << filename << " (" << vertices.size() << " vertices of " << sizeof(Vertex) << " bytes)\n";
+
+			const auto printStats = [&](const char* label)
+				{
+					const MeshOptimizer::VertexFetchStats gpuStats = MeshOptimizer::AnalyzeVertexFetch(indices, vertices.size(), sizeof(Vertex));
+					const MeshOptimizer::VertexFetchStats cpuStats = MeshOptimizer::AnalyzeVertexFetch(indices, vertices.size(), sizeof(Vertex), 0);
+
+					// Reads whole vertices in index order, like a software vertex stage without a post-transform cache
+					Vector3 checksum{};
+					const Clock::time_point start = Clock::now();
+					for (int i = 0; i < iterations; ++i)
+					{
+						for (const uint32_t index : indices)
+							checksum += vertices[index].position + vertices[index].normal;
+					}
+					const double seconds = SecondsSince(start) / iterations;
+
+					std::cout << "  " << std::left << std::setw(15) << label << std::right << "GPU overfetch " << gpuStats.overfetch << ", CPU overfetch " << cpuStats.overfetch
+						<< ", CPU read " << millionIndices / seconds << " M indices/s" << (checksum.x == -1.f ? " " : "") << '\n';
+				};
+
+			printStats("OBJ order:");
+			MeshOptimizer::OptimizeVertexCache(indices, vertices.size());
+			printStats("vertex cache:");
+			MeshOptimizer::OptimizeVertexFetch(vertices, indices);
+			printStats("vertex fetch:");
+		}
+
+		void PackVertices(const std::string& filename, int iterations)
+		{
+			const std::unique_ptr<MeshCache> meshCachePtr = MeshCache::Load(filename);
+			const std::span<const Vertex> vertices = meshCachePtr->GetVertices();
+			if (vertices.empty())
+			{
+				std::cout << "Benchmark::PackVertices() could not load " << filename << '\n';
+				return;
+			}
+
+			const PositionQuantization quantization = VertexQuantization::ComputePositionQuantization(meshCachePtr->GetBoundsMin(), meshCachePtr->GetBoundsMax());
+			std::vector<PackedVertex> packedVertices(vertices.size());
+			const Clock::time_point start = Clock::now();
+			for (int i = 0; i < iterations; ++i)
+				VertexQuantization::Pack(vertices, quantization, packedVertices);
+			const double seconds = SecondsSince(start) / iterations;
+
+			const VertexQuantization::QuantizationError error = VertexQuantization::MeasureError(vertices, packedVertices, quantization);
+			const Vector3 extent = meshCachePtr->GetBoundsMax() - meshCachePtr->GetBoundsMin();
+			std::cout << "PackVertices " << filename << " (" << vertices.size() << " vertices)\n";
+			std::cout << "  " << vertices.size_bytes() / 1024.0 << " KB -> " << packedVertices.size() * sizeof(PackedVertex) / 1024.0 << " KB ("
+				<< sizeof(Vertex) << " -> " << sizeof(PackedVertex) << " bytes per vertex), packed at " << static_cast<double>(vertices.size()) / seconds / 1'000'000.0 << " M vertices/s\n";
+			std::cout << "  position error: max " << error.maxPositionError << ", avg " << error.averagePositionError
+				<< " (bounds " << extent.x << " x " << extent.y << " x " << extent.z << ")\n";
+			std::cout << "  uv error: max " << error.maxUVError << ", normal error: max " << error.maxNormalErrorDegrees << " deg, tangent error: max "
+				<< error.maxTangentErrorDegrees << " deg, " << error.numHandednessErrors << " handedness errors\n";
+		}
+
+		void CompressIndices(const std::string& filename, int iterations)
+		{
+			std::vector<Vertex> vertices{};
+			std::vector<uint32_t> indices{};
+			if (!Utils::ParseOBJ(filename, vertices, indices))
+			{
+				std::cout << "Benchmark::CompressIndices() could not open " << filename << '\n';
+				return;
+			}
+
+			const double millionIndices = static_cast<double>(indices.size()) / 1'000'000.0;
+			std::cout << "CompressIndices " << filename << " (" << vertices.size() << " vertices, " << indices.size() << " indices, "
+				<< indices.size() * sizeof(uint32_t) / 1024.0 << " KB as 32 bit)\n";
+
+			const auto printStats = [&](const char* label)
+				{
+					std::vector<uint16_t> narrowIndices{};
+					std::vector<IndexCompression::IndexRange> ranges{};
+					const bool isNarrow = IndexCompression::NarrowIndices(indices, vertices.size(), narrowIndices, ranges);
+
+					std::string encodedIndices{};
+					Clock::time_point start = Clock::now();
+					for (int i = 0; i < iterations; ++i)
+						encodedIndices = IndexCompression::EncodeIndices(indices);
+					const double encodeSeconds = SecondsSince(start) / iterations;
+
+					std::vector<uint32_t> decodedIndices(indices.size());
+					bool isDecoded{ true };
+					start = Clock::now();
+					for (int i = 0; i < iterations; ++i)
+						isDecoded = IndexCompression::DecodeIndices(encodedIndices, decodedIndices) and isDecoded;
+					const double decodeSeconds = SecondsSince(start) / iterations;
+
+					std::cout << "  " << std::left << std::setw(15) << label << std::right;
+					if (isNarrow)
+						std::cout << "16 bit in " << ranges.size() << (ranges.size() == 1 ? " range, " : " ranges, ");
+					else
+						std::cout << "stays 32 bit, ";
+					std::cout << "encoded " << encodedIndices.size() * 8.0 / static_cast<double>(indices.size()) << " bits per index ("
+						<< encodedIndices.size() / 1024.0 << " KB), encode " << millionIndices / encodeSeconds << " M indices/s, decode "
+						<< millionIndices / decodeSeconds << " M indices/s, " << (isDecoded and decodedIndices == indices ? "round trip is identical" : "ROUND TRIP DIFFERS") << '\n';
+				};
+
+			printStats("OBJ order:");
+			MeshOptimizer::OptimizeVertexCache(indices, vertices.size());
+			printStats("vertex cache:");
+			MeshOptimizer::OptimizeVertexFetch(vertices, indices);
+			printStats("vertex fetch:");
+		}
+
+		void CompressMesh(const std::string& filename, int iterations)
+		{
+			std::error_code error{};
+			const uintmax_t objBytes = std::filesystem::file_size(filename, error);
+			std::vector<Vertex> vertices{};
+			std::vector<uint32_t> indices{};
+			Utils::OBJMaterialData materialData{};
+			if (error or !Utils::ParseOBJ(filename, vertices, indices, {}, &materialData) or vertices.empty())
+			{
+				std::cout << "Benchmark::CompressMesh() could not open " << filename << '\n';
+				return;
+			}
+			vertices.resize(MeshOptimizer::OptimizeMesh(vertices, indices, materialData.submeshes));
+
+			Vector3 boundsMin = vertices.front().position;
+			Vector3 boundsMax = vertices.front().position;
+			for (const Vertex& vertex : vertices)
+			{
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					boundsMin[axis] = std::min(boundsMin[axis], vertex.position[axis]);
+					boundsMax[axis] = std::max(boundsMax[axis], vertex.position[axis]);
+				}
+			}
+			std::vector<PackedVertex> packedVertices(vertices.size());
+			VertexQuantization::Pack(vertices, VertexQuantization::ComputePositionQuantization(boundsMin, boundsMax), packedVertices);
+
+			const size_t indexBytes = indices.size() * sizeof(uint32_t);
+			std::cout << "CompressMesh " << filename << " (" << vertices.size() << " vertices, " << indices.size() / 3 << " triangles, OBJ "
+				<< objBytes / 1024.0 << " KB)\n";
+
+			//Throughput in GB/s of the uncompressed bytes, like the file loading numbers elsewhere
+			const auto printVertexStats = [&](const char* label, std::span<const char> vertexBytes, size_t vertexSize)
+				{
+					std::string encodedVertices{};
+					Clock::time_point start = Clock::now();
+					for (int i = 0; i < iterations; ++i)
+						encodedVertices = VertexCompression::EncodeVertices(vertexBytes, vertexSize);
+					const double encodeSeconds = SecondsSince(start) / iterations;
+
+					std::vector<char> decodedVertices(vertexBytes.size());
+					bool isDecoded{ true };
+					start = Clock::now();
+					for (int i = 0; i < iterations; ++i)
+						isDecoded = VertexCompression::DecodeVertices(encodedVertices, decodedVertices, vertexSize) and isDecoded;
+					const double decodeSeconds = SecondsSince(start) / iterations;
+
+					const double gigabytes = static_cast<double>(vertexBytes.size()) / 1'000'000'000.0;
+					std::cout << "  " << std::left << std::setw(17) << label << std::right << vertexBytes.size() / 1024.0 << " KB -> " << encodedVertices.size() / 1024.0
+						<< " KB (" << static_cast<double>(vertexBytes.size()) / static_cast<double>(encodedVertices.size()) << "x), encode " << gigabytes / encodeSeconds
+						<< " GB/s, decode " << gigabytes / decodeSeconds << " GB/s, "
+						<< (isDecoded and std::equal(decodedVertices.begin(), decodedVertices.end(), vertexBytes.begin()) ? "round trip is identical" : "ROUND TRIP DIFFERS") << '\n';
+					return encodedVertices.size();
+				};
+
+			printVertexStats("float vertices:", { reinterpret_cast<const char*>(vertices.data()), vertices.size() * sizeof(Vertex) }, sizeof(Vertex));
+			const size_t packedBytes = printVertexStats("packed vertices:",
+				{ reinterpret_cast<const char*>(packedVertices.data()), packedVertices.size() * sizeof(PackedVertex) }, sizeof(PackedVertex));
+
+			std::string encodedIndices{};
+			Clock::time_point start = Clock::now();
+			for (int i = 0; i < iterations; ++i)
+				encodedIndices = IndexCompression::EncodeTriangles(indices);
+			const double encodeSeconds = SecondsSince(start) / iterations;
+
+			std::vector<uint32_t> decodedIndices(indices.size());
+			bool isDecoded{ true };
+			start = Clock::now();
+			for (int i = 0; i < iterations; ++i)
+				isDecoded = IndexCompression::DecodeTriangles(encodedIndices, decodedIndices) and isDecoded;
+			const double decodeSeconds = SecondsSince(start) / iterations;
+
+			const double indexGigabytes = static_cast<double>(indexBytes) / 1'000'000'000.0;
+			std::cout << "  " << std::left << std::setw(17) << "triangles:" << std::right << indexBytes / 1024.0 << " KB -> " << encodedIndices.size() / 1024.0 << " KB ("
+				<< encodedIndices.size() * 8.0 / static_cast<double>(indices.size()) << " bits per index), encode " << indexGigabytes / encodeSeconds
+				<< " GB/s, decode " << indexGigabytes / decodeSeconds << " GB/s, "
+				<< (isDecoded and SortedTriangles(decodedIndices) == SortedTriangles(indices) ? "same triangles" : "TRIANGLES DIFFER") << '\n';
+
+			const size_t rawBytes = vertices.size() * sizeof(Vertex) + indexBytes;
+			const size_t compressedBytes = packedBytes + encodedIndices.size();
+			std::cout << "  mesh: float " << rawBytes / 1024.0 << " KB, packed " << (packedVertices.size() * sizeof(PackedVertex) + indexBytes) / 1024.0
+				<< " KB, packed and compressed " << compressedBytes / 1024.0 << " KB (" << static_cast<double>(rawBytes) / static_cast<double>(compressedBytes)
+				<< "x smaller than float, " << static_cast<double>(objBytes) / static_cast<double>(compressedBytes) << "x smaller than the OBJ)\n";
+
+			//What loading a cooked mesh costs: mapping the packed file as is against mapping the compressed one and decoding it
+			const std::filesystem::path cachePath = std::filesystem::temp_directory_path() / "benchmark_compressed.mesh";
+			for (const bool compress : { false, true })
+			{
+				if (!MeshCache::Write(cachePath.string(), vertices, indices, materialData, 0, true, compress, compress))
+				{
+					std::cout << "Benchmark::CompressMesh() could not write " << cachePath.string() << '\n';
+					return;
+				}
+
+				size_t numIndices{};
+				start = Clock::now();
+				for (int i = 0; i < iterations; ++i)
+				{
+					const std::unique_ptr<MeshCache> meshCachePtr = MeshCache::Open(cachePath.string());
+					numIndices += meshCachePtr ? meshCachePtr->GetIndices().size() : 0;
+				}
+				const double openSeconds = SecondsSince(start) / iterations;
+
+				std::cout << "  " << std::left << std::setw(17) << (compress ? "compressed file:" : "packed file:") << std::right
+					<< std::filesystem::file_size(cachePath, error) / 1024.0 << " KB, MeshCache::Open " << openSeconds * 1000.0 << " ms"
+					<< (numIndices == indices.size() * iterations ? "" : ", OPEN FAILED") << '\n';
+			}
+			std::filesystem::remove(cachePath, error);
+		}
+
+		void CullMeshlets(const std::string& filename, int numViews)
+		{
+			std::vector<Vertex> vertices{};
+			std::vector<uint32_t> indices{};
+			Utils::OBJMaterialData materialData{};
+			if (!Utils::ParseOBJ(filename, vertices, indices, {}, &materialData) or vertices.empty())
+			{
+				std::cout << "Benchmark::CullMeshlets() could not open " << filename << '\n';
+				return;
+			}
+			vertices.resize(MeshOptimizer::OptimizeMesh(vertices, indices, materialData.submeshes));
+
+			std::vector<Vector3> positions(vertices.size());
+			std::transform(vertices.begin(), vertices.end(), positions.begin(), [](const Vertex& vertex) { return vertex.position; });
+
+			Clock::time_point start = Clock::now();
+			const std::vector<Meshlets::Meshlet> meshlets = Meshlets::Build(indices, positions, materialData.submeshes);
+			const double buildSeconds = SecondsSince(start);
+
+			Vector3 boundsMin = positions.front();
+			Vector3 boundsMax = positions.front();
+			for (const Vector3& position : positions)
+			{
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					boundsMin[axis] = std::min(boundsMin[axis], position[axis]);
+					boundsMax[axis] = std::max(boundsMax[axis], position[axis]);
+				}
+			}
+			const Vector3 center = (boundsMin + boundsMax) * 0.5f;
+			const float radius = (boundsMax - boundsMin).Magnitude() * 0.5f;
+
+			const size_t numTriangles = indices.size() / 3;
+			size_t numMeshletTriangles{};
+			for (const Meshlets::Meshlet& meshlet : meshlets)
+				numMeshletTriangles += meshlet.numIndices / 3;
+
+			std::cout << "CullMeshlets " << filename << " (" << numTriangles << " triangles in " << meshlets.size() << " meshlets, "
+				<< static_cast<double>(numMeshletTriangles) / static_cast<double>(meshlets.size()) << " triangles each, built in " << buildSeconds * 1000.0 << " ms)\n";
+
+			const auto toPercent = [numTriangles](size_t count) { return 100.0 * static_cast<double>(count) / static_cast<double>(numTriangles); };
+			const auto isFrontFacing = [&](size_t corner, const Vector3& cameraPosition)
+				{
+					const Vector3& v0 = positions[indices[corner]];
+					return Vector3::Dot(Vector3::Cross(positions[indices[corner + 1]] - v0, positions[indices[corner + 2]] - v0), v0 - cameraPosition) < 0.f;
+				};
+
+			Meshlets::OcclusionBuffer occlusionBuffer{ 320, 180 };
+			const Matrix projection = Matrix::CreatePerspectiveFovLH(std::tan(45.f * TO_RADIANS * 0.5f), 16.f / 9.f, radius * 0.01f, radius * 10.f);
+			double cullSeconds{};
+			double rasterizeSeconds{};
+			size_t totalRejected{};
+			size_t numErrors{};
+			for (int view = 0; view < numViews; ++view)
+			{
+				//Fibonacci sphere directions, every other view close enough that part of the mesh leaves the frustum
+				const float y = 1.f - (static_cast<float>(view) + 0.5f) * 2.f / static_cast<float>(numViews);
+				const float ringRadius = std::sqrt(std::max(0.f, 1.f - y * y));
+				const float angle = static_cast<float>(view) * 2.39996323f;
+				const Vector3 direction{ std::cos(angle) * ringRadius, y, std::sin(angle) * ringRadius };
+				const Vector3 cameraPosition = center + direction * (radius * (view % 2 == 0 ? 2.5f : 1.2f));
+				const Matrix viewProjection = CreateLookAtMatrix(cameraPosition, center) * projection;
+
+				start = Clock::now();
+				const Meshlets::Frustum frustum = Meshlets::ExtractFrustum(viewProjection);
+				std::vector<uint8_t> rejections(meshlets.size());
+				for (size_t meshlet = 0; meshlet < meshlets.size(); ++meshlet)
+				{
+					if (Meshlets::IsOutsideFrustum(meshlets[meshlet], frustum))
+						rejections[meshlet] = 1;
+					else if (Meshlets::IsBackFacing(meshlets[meshlet], cameraPosition))
+						rejections[meshlet] = 2;
+				}
+				cullSeconds += SecondsSince(start);
+
+				start = Clock::now();
+				Meshlets::RasterizeOccluders(occlusionBuffer, indices, positions, viewProjection, cameraPosition);
+				for (size_t meshlet = 0; meshlet < meshlets.size(); ++meshlet)
+				{
+					if (rejections[meshlet] == 0 and Meshlets::IsOccluded(meshlets[meshlet], occlusionBuffer, viewProjection))
+						rejections[meshlet] = 3;
+				}
+				rasterizeSeconds += SecondsSince(start);
+
+				size_t rejected[4]{};
+				for (size_t meshlet = 0; meshlet < meshlets.size(); ++meshlet)
+				{
+					const Meshlets::Meshlet& current = meshlets[meshlet];
+					rejected[rejections[meshlet]] += current.numIndices / 3;
+
+					//A triangle the camera sees inside the frustum must never be rejected by the frustum or backface tests
+					if (rejections[meshlet] == 1 or rejections[meshlet] == 2)
+					{
+						for (uint32_t corner = current.firstIndex; corner < current.firstIndex + current.numIndices; corner += 3)
+						{
+							bool isInside = true;
+							for (const Vector4& plane : frustum.planes)
+							{
+								bool isOutsidePlane = true;
+								for (uint32_t vertex = corner; vertex < corner + 3; ++vertex)
+									isOutsidePlane = isOutsidePlane and Vector3::Dot(plane.GetXYZ(), positions[indices[vertex]]) + plane.w < 0.f;
+								isInside = isInside and !isOutsidePlane;
+							}
+							numErrors += isInside and isFrontFacing(corner, cameraPosition);
+						}
+					}
+				}
+
+				size_t numBackFaces{};
+				for (size_t corner = 0; corner + 3 <= indices.size(); corner += 3)
+					numBackFaces += !isFrontFacing(corner, cameraPosition);
+
+				const size_t numRejected = rejected[1] + rejected[2] + rejected[3];
+				totalRejected += numRejected;
+				std::cout << "  view " << std::setw(2) << view << ": " << std::setw(5) << toPercent(numRejected) << "% rejected (frustum " << toPercent(rejected[1])
+					<< "%, backface " << toPercent(rejected[2]) << "%, occlusion " << toPercent(rejected[3]) << "%), " << toPercent(numBackFaces) << "% of the triangles face away\n";
+			}
+
+			std::cout << "  average " << toPercent(totalRejected) / numViews << "% rejected, frustum and backface tests " << cullSeconds / numViews * 1'000'000.0
+				<< " us per view, occlusion " << rasterizeSeconds / numViews * 1000.0 << " ms per view at " << occlusionBuffer.width << "x" << occlusionBuffer.height
+				<< (numErrors == 0 ? ", no visible triangle rejected" : ", VISIBLE TRIANGLES REJECTED") << '\n';
+		}
+
+		void SimplifyMesh(const std::string& filename)
+		{
+			std::vector<Vertex> vertices{};
+			std::vector<uint32_t> indices{};
+			Utils::OBJMaterialData materialData{};
+			if (!Utils::ParseOBJ(filename, vertices, indices, {}, &materialData) or vertices.empty())
+			{
+				std::cout << "Benchmark::SimplifyMesh() could not open " << filename << '\n';
+				return;
+			}
+			vertices.resize(MeshOptimizer::OptimizeMesh(vertices, indices, materialData.submeshes));
+			const size_t numFullIndices = indices.size();
+
+			Clock::time_point start = Clock::now();
+			const std::vector<Simplifier::LevelOfDetail> levelsOfDetail = Simplifier::BuildLevelsOfDetail(vertices, indices, materialData.submeshes);
+			const double buildSeconds = SecondsSince(start);
+
+			//Vertices at the same position get the same id, so the two sides of a UV or normal seam count as one edge
+			std::map<std::tuple<float, float, float>, uint32_t> positionIds{};
+			std::vector<uint32_t> positionRemap(vertices.size());
+			Vector3 boundsMin = vertices.front().position;
+			Vector3 boundsMax = vertices.front().position;
+			for (size_t vertex = 0; vertex < vertices.size(); ++vertex)
+			{
+				const Vector3& position = vertices[vertex].position;
+				positionRemap[vertex] = positionIds.try_emplace({ position.x, position.y, position.z }, static_cast<uint32_t>(vertex)).first->second;
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					boundsMin[axis] = std::min(boundsMin[axis], position[axis]);
+					boundsMax[axis] = std::max(boundsMax[axis], position[axis]);
+				}
+			}
+			const float diagonal = (boundsMax - boundsMin).Magnitude();
+
+			//Edges without a triangle on the other side, as position id pairs
+			const auto findOpenEdges = [&positionRemap, &indices](std::span<const Utils::OBJSubmesh> submeshes)
+				{
+					std::vector<std::pair<uint32_t, uint32_t>> edges{};
+					for (const Utils::OBJSubmesh& submesh : submeshes)
+					{
+						for (uint32_t corner = submesh.firstIndex; corner + 3 <= submesh.firstIndex + submesh.numIndices; corner += 3)
+						{
+							for (uint32_t side = 0; side < 3; ++side)
+								edges.emplace_back(positionRemap[indices[corner + side]], positionRemap[indices[corner + (side + 1) % 3]]);
+						}
+					}
+					std::sort(edges.begin(), edges.end());
+
+					std::vector<std::pair<uint32_t, uint32_t>> openEdges{};
+					for (const std::pair<uint32_t, uint32_t>& edge : edges)
+					{
+						if (!std::binary_search(edges.begin(), edges.end(), std::make_pair(edge.second, edge.first)))
+							openEdges.push_back(edge);
+					}
+					return openEdges;
+				};
+
+			//A crack is an open edge at a position that was closed at full detail, borders only get shorter
+			std::vector<uint8_t> isBorderPosition(vertices.size());
+			const std::vector<std::pair<uint32_t, uint32_t>> fullOpenEdges = findOpenEdges(materialData.submeshes);
+			for (const std::pair<uint32_t, uint32_t>& edge : fullOpenEdges)
+				isBorderPosition[edge.first] = isBorderPosition[edge.second] = 1;
+
+			//Level switch distance for a 1 pixel error at 1080p with a 45 degree vertical field of view
+			const float projectionScale = 1.f / std::tan(45.f * TO_RADIANS * 0.5f);
+			constexpr float viewportHeight{ 1080.f };
+
+			std::cout << "SimplifyMesh " << filename << " (" << numFullIndices / 3 << " triangles, " << fullOpenEdges.size() << " open edges, "
+				<< levelsOfDetail.size() << " levels built in " << buildSeconds * 1000.0 << " ms)\n";
+			for (size_t level = 0; level < levelsOfDetail.size(); ++level)
+			{
+				const Simplifier::LevelOfDetail& levelOfDetail = levelsOfDetail[level];
+				size_t numLevelIndices{};
+				for (const Utils::OBJSubmesh& submesh : levelOfDetail.submeshes)
+					numLevelIndices += submesh.numIndices;
+
+				size_t numCracks{};
+				for (const std::pair<uint32_t, uint32_t>& edge : findOpenEdges(levelOfDetail.submeshes))
+					numCracks += !isBorderPosition[edge.first] or !isBorderPosition[edge.second];
+
+				std::cout << "  level " << level + 1 << " (target " << levelOfDetail.ratio * 100.f << "%): " << numLevelIndices / 3 << " triangles, "
+					<< 100.0 * static_cast<double>(numLevelIndices) / static_cast<double>(numFullIndices) << "% kept, error " << levelOfDetail.error
+					<< " (" << 100.f * levelOfDetail.error / diagonal << "% of the bounds diagonal), used from " << levelOfDetail.error * projectionScale * viewportHeight * 0.5f
+					<< " units away, " << (numCracks == 0 ? "no cracks" : std::to_string(numCracks) + " CRACKED EDGES") << '\n';
+			}
+		}
+
+		void RaycastBVH(const std::string& filename, int numRays)
+		{
+			std::vector<Vertex> vertices{};
+			std::vector<uint32_t> indices{};
+			Utils::OBJMaterialData materialData{};
+			if (!Utils::ParseOBJ(filename, vertices, indices, {}, &materialData) or vertices.empty())
+			{
+				std::cout << "Benchmark::RaycastBVH() could not open " << filename << '\n';
+				return;
+			}
+			vertices.resize(MeshOptimizer::OptimizeMesh(vertices, indices, materialData.submeshes));
+
+			std::vector<Vector3> positions(vertices.size());
+			std::transform(vertices.begin(), vertices.end(), positions.begin(), [](const Vertex& vertex) { return vertex.position; });
+
+			Clock::time_point start = Clock::now();
+			BVH::Build(indices, positions, 1);
+			const double serialSeconds = SecondsSince(start);
+			start = Clock::now();
+			const BVH::Tree tree = BVH::Build(indices, positions);
+			const double parallelSeconds = SecondsSince(start);
+
+			size_t numLeaves{};
+			for (const BVH::Node& node : tree.nodes)
+				numLeaves += node.numTriangles > 0;
+			const size_t treeBytes = tree.nodes.size() * sizeof(BVH::Node) + tree.triangles.size() * (sizeof(BVH::Triangle) + sizeof(uint32_t));
+			std::cout << "RaycastBVH " << filename << " (" << indices.size() / 3 << " triangles)\n";
+			std::cout << "  " << tree.nodes.size() << " nodes, " << static_cast<double>(tree.triangles.size()) / static_cast<double>(numLeaves) << " triangles per leaf, "
+				<< treeBytes / 1024.0 << " KB, SAH cost " << BVH::ComputeCost(tree) << ", built in " << serialSeconds * 1000.0 << " ms on 1 thread, "
+				<< parallelSeconds * 1000.0 << " ms on " << GetDefaultThreadCount() << '\n';
+
+			//From a sphere around the mesh towards points spread through its bounds, about the rays a picking or visibility query casts
+			Vector3 boundsMin = positions.front();
+			Vector3 boundsMax = positions.front();
+			for (const Vector3& position : positions)
+			{
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					boundsMin[axis] = std::min(boundsMin[axis], position[axis]);
+					boundsMax[axis] = std::max(boundsMax[axis], position[axis]);
+				}
+			}
+			const Vector3 center = (boundsMin + boundsMax) * 0.5f;
+			const Vector3 extent = boundsMax - boundsMin;
+			const float radius = extent.Magnitude();
+			std::vector<BVH::Ray> rays(numRays);
+			for (int ray = 0; ray < numRays; ++ray)
+			{
+				const float height = 1.f - 2.f * (static_cast<float>(ray) + 0.5f) / static_cast<float>(numRays);
+				const float angle = static_cast<float>(ray) * 2.39996323f;
+				const float ringRadius = std::sqrt(1.f - height * height);
+				const Vector3 origin = center + Vector3{ ringRadius * std::cos(angle), height, ringRadius * std::sin(angle) } * radius;
+
+				const float fractions[3]{ std::fmod(ray * 0.618034f, 1.f), std::fmod(ray * 0.754878f, 1.f), std::fmod(ray * 0.569840f, 1.f) };
+				const Vector3 target{ boundsMin.x + extent.x * fractions[0], boundsMin.y + extent.y * fractions[1], boundsMin.z + extent.z * fractions[2] };
+				rays[ray] = { origin, (target - origin).Normalized() };
+			}
+
+			std::vector<std::optional<BVH::Hit>> hits(rays.size());
+			start = Clock::now();
+			for (size_t ray = 0; ray < rays.size(); ++ray)
+				hits[ray] = BVH::IntersectClosest(tree, rays[ray]);
+			const double closestSeconds = SecondsSince(start);
+
+			size_t numBlocked{};
+			start = Clock::now();
+			for (const BVH::Ray& ray : rays)
+				numBlocked += BVH::IntersectAny(tree, ray);
+			const double anySeconds = SecondsSince(start);
+
+			constexpr size_t RaysPerTask{ 4096 };
+			start = Clock::now();
+			ParallelFor((rays.size() + RaysPerTask - 1) / RaysPerTask, 0, [&](size_t task)
+				{
+					for (size_t ray = task * RaysPerTask; ray < std::min(rays.size(), (task + 1) * RaysPerTask); ++ray)
+						hits[ray] = BVH::IntersectClosest(tree, rays[ray]);
+				});
+			const double parallelClosestSeconds = SecondsSince(start);
+
+			//Every triangle against a sample of the rays, with the same two sided test
+			size_t numMismatches{};
+			const size_t numChecked = std::min<size_t>(rays.size(), 500);
+			for (size_t ray = 0; ray < numChecked; ++ray)
+			{
+				float nearest = FLT_MAX;
+				for (size_t corner = 0; corner < indices.size(); corner += 3)
+				{
+					const Vector3& v0 = positions[indices[corner]];
+					const Vector3 edge1 = positions[indices[corner + 1]] - v0;
+					const Vector3 edge2 = positions[indices[corner + 2]] - v0;
+					const Vector3 p = Vector3::Cross(rays[ray].direction, edge2);
+					const float determinant = Vector3::Dot(edge1, p);
+					if (determinant == 0.f)
+						continue;
+					const Vector3 toOrigin = rays[ray].origin - v0;
+					const float u = Vector3::Dot(toOrigin, p) / determinant;
+					const Vector3 q = Vector3::Cross(toOrigin, edge1);
+					const float v = Vector3::Dot(rays[ray].direction, q) / determinant;
+					const float distance = Vector3::Dot(edge2, q) / determinant;
+					if (u >= 0.f and v >= 0.f and u + v <= 1.f and distance >= 0.f)
+						nearest = std::min(nearest, distance);
+				}
+				const bool isHit = nearest != FLT_MAX;
+				if (isHit != hits[ray].has_value() or (isHit and std::abs(hits[ray]->distance - nearest) > radius * 1e-5f))
+					++numMismatches;
+			}
+
+			size_t numHits{};
+			for (const std::optional<BVH::Hit>& hit : hits)
+				numHits += hit.has_value();
+			const double millionRays = static_cast<double>(rays.size()) / 1'000'000.0;
+			std::cout << "  " << rays.size() << " rays, " << 100.0 * static_cast<double>(numHits) / static_cast<double>(rays.size()) << "% hit: closest hit "
+				<< millionRays / closestSeconds << " M rays/s, any hit " << millionRays / anySeconds << " M rays/s on 1 thread, closest hit "
+				<< millionRays / parallelClosestSeconds << " M rays/s on " << GetDefaultThreadCount() << '\n';
+			std::cout << "  " << (numBlocked == numHits ? "" : "ANY HIT DISAGREES, ") << numMismatches << " of " << numChecked << " rays differ from testing every triangle\n";
+		}
+
+		void RasterizeTriangles(int numTriangles)
+		{
+			std::vector<Rasterizer::Kernel> kernels{ Rasterizer::Kernel::Scalar };
+			if (Rasterizer::GetBestKernel() == Rasterizer::Kernel::AVX2)
+				kernels.push_back(Rasterizer::Kernel::AVX2);
+			std::cout << "RasterizeTriangles (" << numTriangles << " triangles per size" << (kernels.size() > 1 ? "" : ", no AVX2 on this build or CPU") << ")\n";
+
+			//Corners anywhere in a square of the size, placed anywhere in one SoftwareRenderer tile
+			constexpr int TilePixels{ 64 };
+			uint32_t state = 1;
+			const auto random = [&state]()
+				{
+					state = state * 1664525u + 1013904223u;
+					return static_cast<float>(state >> 8) / 16777216.f;
+				};
+
+			struct Triangle
+			{
+				Rasterizer::Edges edges{};
+				int minX{};
+				int minY{};
+				int maxX{};
+				int maxY{};
+			};
+
+			//Clockwise snapped vertices and the pixels of the tile their bounds cover, false for empty triangles
+			const auto setupTriangle = [](std::array<int32_t, 3> xs, std::array<int32_t, 3> ys, Triangle& triangle)
+				{
+					const int64_t area = static_cast<int64_t>(xs[1] - xs[0]) * (ys[2] - ys[0]) - static_cast<int64_t>(xs[2] - xs[0]) * (ys[1] - ys[0]);
+					if (area == 0)
+						return false;
+					if (area < 0)
+					{
+						std::swap(xs[1], xs[2]);
+						std::swap(ys[1], ys[2]);
+					}
+
+					constexpr float Scale{ static_cast<float>(Rasterizer::SubpixelScale) };
+					triangle.minX = static_cast<int>(std::max(std::ceil(static_cast<float>(*std::min_element(xs.begin(), xs.end())) / Scale - 0.5f), 0.f));
+					triangle.minY = static_cast<int>(std::max(std::ceil(static_cast<float>(*std::min_element(ys.begin(), ys.end())) / Scale - 0.5f), 0.f));
+					triangle.maxX = static_cast<int>(std::min(std::floor(static_cast<float>(*std::max_element(xs.begin(), xs.end())) / Scale - 0.5f), TilePixels - 1.f));
+					triangle.maxY = static_cast<int>(std::min(std::floor(static_cast<float>(*std::max_element(ys.begin(), ys.end())) / Scale - 0.5f), TilePixels - 1.f));
+					if (triangle.minX > triangle.maxX or triangle.minY > triangle.maxY)
+						return false;
+					Rasterizer::SetupEdges(xs, ys, triangle.edges);
+					return true;
+				};
+
+			for (const float size : { 2.f, 4.f, 8.f, 16.f, 32.f, 64.f })
+			{
+				std::vector<Triangle> triangles{};
+				while (triangles.size() < static_cast<size_t>(numTriangles))
+				{
+					const float originX = random() * (TilePixels - size);
+					const float originY = random() * (TilePixels - size);
+					std::array<int32_t, 3> xs{};
+					std::array<int32_t, 3> ys{};
+					for (size_t corner = 0; corner < 3; ++corner)
+					{
+						xs[corner] = Rasterizer::Snap(originX + random() * size);
+						ys[corner] = Rasterizer::Snap(originY + random() * size);
+					}
+
+					Triangle triangle{};
+					if (setupTriangle(xs, ys, triangle))
+						triangles.push_back(triangle);
+				}
+
+				std::cout << "  " << std::setw(2) << size << " pixel squares:";
+				std::array<Rasterizer::Block, (TilePixels / Rasterizer::BlockSize) * (TilePixels / Rasterizer::BlockSize)> blocks{};
+				std::vector<uint64_t> checksums{};
+				for (const Rasterizer::Kernel kernel : kernels)
+				{
+					uint64_t numPixels{};
+					uint64_t checksum{};
+					const Clock::time_point start = Clock::now();
+					for (const Triangle& triangle : triangles)
+					{
+						const size_t numBlocks = Rasterizer::CoverBlocks(triangle.edges, triangle.minX, triangle.minY, triangle.maxX, triangle.maxY, blocks, kernel);
+						for (size_t block = 0; block < numBlocks; ++block)
+						{
+							numPixels += std::popcount(blocks[block].coverage);
+							checksum = (checksum ^ blocks[block].coverage ^ (static_cast<uint64_t>(blocks[block].x) << 8 | blocks[block].y)) * 1099511628211ull;
+						}
+					}
+					const double seconds = SecondsSince(start);
+					checksums.push_back(checksum);
+
+					if (kernel == kernels.front())
+						std::cout << ' ' << static_cast<double>(numPixels) / static_cast<double>(triangles.size()) << " pixels per triangle,";
+					std::cout << ' ' << (kernel == Rasterizer::Kernel::AVX2 ? "AVX2 " : "scalar ") << static_cast<double>(triangles.size()) / seconds / 1e6 << " M triangles/s "
+						<< static_cast<double>(numPixels) / seconds / 1e6 << " M pixels/s";
+				}
+				const bool isSame = std::all_of(checksums.begin(), checksums.end(), [&checksums](uint64_t checksum) { return checksum == checksums.front(); });
+				std::cout << (isSame ? "" : ", KERNELS DISAGREE") << '\n';
+			}
+
+			//Two triangles per cell of a grid over the tile, the inner corners moved by whole and half pixels so that many edges run through pixel centers.
+			//The shared edges must cover every pixel center of the tile exactly once
+			constexpr int GridCells{ 8 };
+			constexpr int CellPixels{ TilePixels / GridCells };
+			std::vector<std::array<int32_t, 2>> corners{};
+			for (int row = 0; row <= GridCells; ++row)
+			{
+				for (int column = 0; column <= GridCells; ++column)
+				{
+					const bool isInner = row > 0 and row < GridCells and column > 0 and column < GridCells;
+					const auto jitter = [&random, isInner]() { return isInner ? static_cast<int32_t>(random() * 8.f - 4.f) * Rasterizer::SubpixelScale / 2 : 0; };
+					corners.push_back({ column * CellPixels * Rasterizer::SubpixelScale + jitter(), row * CellPixels * Rasterizer::SubpixelScale + jitter() });
+				}
+			}
+
+			std::vector<Triangle> grid{};
+			for (int row = 0; row < GridCells; ++row)
+			{
+				for (int column = 0; column < GridCells; ++column)
+				{
+					const std::array<int32_t, 2>& topLeft = corners[row * (GridCells + 1) + column];
+					const std::array<int32_t, 2>& topRight = corners[row * (GridCells + 1) + column + 1];
+					const std::array<int32_t, 2>& bottomLeft = corners[(row + 1) * (GridCells + 1) + column];
+					const std::array<int32_t, 2>& bottomRight = corners[(row + 1) * (GridCells + 1) + column + 1];
+					for (const auto& cell : { std::array{ topLeft, topRight, bottomRight }, std::array{ topLeft, bottomRight, bottomLeft } })
+					{
+						Triangle triangle{};
+						if (setupTriangle({ cell[0][0], cell[1][0], cell[2][0] }, { cell[0][1], cell[1][1], cell[2][1] }, triangle))
+							grid.push_back(triangle);
+					}
+				}
+			}
+
+			std::cout << "  " << grid.size() << " triangles sharing edges over a tile:";
+			std::array<Rasterizer::Block, (TilePixels / Rasterizer::BlockSize) * (TilePixels / Rasterizer::BlockSize)> blocks{};
+			for (const Rasterizer::Kernel kernel : kernels)
+			{
+				std::array<uint8_t, TilePixels * TilePixels> numCovers{};
+				for (const Triangle& triangle : grid)
+				{
+					const size_t numBlocks = Rasterizer::CoverBlocks(triangle.edges, triangle.minX, triangle.minY, triangle.maxX, triangle.maxY, blocks, kernel);
+					for (size_t block = 0; block < numBlocks; ++block)
+					{
+						for (uint64_t coverage = blocks[block].coverage; coverage != 0; coverage &= coverage - 1)
+						{
+							const int bit = std::countr_zero(coverage);
+							++numCovers[(blocks[block].y + bit / Rasterizer::BlockSize) * TilePixels + blocks[block].x + bit % Rasterizer::BlockSize];
+						}
+					}
+				}
+
+				const size_t numMissed = std::count(numCovers.begin(), numCovers.end(), uint8_t{ 0 });
+				const size_t numOverlapping = numCovers.size() - numMissed - std::count(numCovers.begin(), numCovers.end(), uint8_t{ 1 });
+				std::cout << ' ' << (kernel == Rasterizer::Kernel::AVX2 ? "AVX2 " : "scalar ") << numMissed << " pixels missed and " << numOverlapping << " covered twice"
+					<< (numMissed + numOverlapping == 0 ? "" : " NOT WATERTIGHT") << (kernel == kernels.back() ? "" : ",");
+			}
+			std::cout << '\n';
+		}
+
+		void CullHierarchicalDepth(const std::string& filename, int numViews)
+		{
+			SoftwareScene scene{};
+			if (!LoadSoftwareScene(filename, scene))
+			{
+				std::cout << "Benchmark::CullHierarchicalDepth() could not open " << filename << '\n';
+				return;
+			}
+			const Vector3& center = scene.center;
+			const float radius = scene.radius;
+			const SoftwareRenderer::DrawCall& drawCall = scene.drawCall;
+
+			std::cout << "CullHierarchicalDepth " << filename << " (" << scene.indices.size() / 3 << " triangles, 640x480 on 1 thread)\n";
+
+			SoftwareRenderer::Framebuffer withoutTest{ 640, 480 };
+			SoftwareRenderer::Framebuffer withTest{ 640, 480 };
+			const Matrix projection = Matrix::CreatePerspectiveFovLH(std::tan(45.f * TO_RADIANS * 0.5f), 4.f / 3.f, radius * 0.01f, radius * 10.f);
+			constexpr int Iterations{ 3 };
+			double totalWithout{};
+			double totalWith{};
+			SoftwareRenderer::Statistics total{};
+			size_t numDifferentViews{};
+			for (int view = 0; view < numViews; ++view)
+			{
+				//Every other view close enough that the mesh fills the screen
+				const Vector3 direction = GetViewDirection(view, numViews);
+
+				SoftwareRenderer::View renderView{};
+				renderView.cameraPosition = center + direction * (radius * (view % 2 == 0 ? 2.5f : 1.2f));
+				renderView.viewMatrix = CreateLookAtMatrix(renderView.cameraPosition, center);
+				renderView.projectionMatrix = projection;
+
+				SoftwareRenderer::Statistics statistics{};
+				Clock::time_point start = Clock::now();
+				for (int iteration = 0; iteration < Iterations; ++iteration)
+					SoftwareRenderer::Render({ &drawCall, 1 }, renderView, withoutTest, 1, false);
+				const double secondsWithout = SecondsSince(start) / Iterations;
+
+				start = Clock::now();
+				for (int iteration = 0; iteration < Iterations; ++iteration)
+					SoftwareRenderer::Render({ &drawCall, 1 }, renderView, withTest, 1, true, &statistics);
+				const double secondsWith = SecondsSince(start) / Iterations;
+
+				const bool isSame = withTest.colors == withoutTest.colors;
+				numDifferentViews += !isSame;
+				totalWithout += secondsWithout;
+				totalWith += secondsWith;
+				total.numTileTriangles += statistics.numTileTriangles;
+				total.numRejectedTriangles += statistics.numRejectedTriangles;
+				total.numBlocks += statistics.numBlocks;
+				total.numRejectedBlocks += statistics.numRejectedBlocks;
+
+				std::cout << "  view " << view << ": " << 100.0 * static_cast<double>(statistics.numRejectedTriangles) / static_cast<double>(std::max<size_t>(statistics.numTileTriangles, 1))
+					<< "% of the triangles in tiles and " << 100.0 * static_cast<double>(statistics.numRejectedBlocks) / static_cast<double>(std::max<size_t>(statistics.numBlocks, 1))
+					<< "% of the blocks rejected, " << secondsWithout * 1000.0 << " ms without the test, " << secondsWith * 1000.0 << " ms with it"
+					<< (isSame ? "" : ", IMAGES DIFFER") << '\n';
+			}
+
+			std::cout << "  total " << 100.0 * static_cast<double>(total.numRejectedTriangles) / static_cast<double>(std::max<size_t>(total.numTileTriangles, 1))
+				<< "% of the triangles in tiles and " << 100.0 * static_cast<double>(total.numRejectedBlocks) / static_cast<double>(std::max<size_t>(total.numBlocks, 1))
+				<< "% of the blocks rejected, " << (totalWithout - totalWith) / numViews * 1000.0 << " ms saved per frame ("
+				<< 100.0 * (totalWithout - totalWith) / totalWithout << "%), " << (numDifferentViews == 0 ? "every image is the same" : "IMAGES DIFFER") << '\n';
+		}
+
+		void ClipNearPlane(const std::string& filename, int numViews)
+		{
+			SoftwareScene scene{};
+			if (!LoadSoftwareScene(filename, scene))
+			{
+				std::cout << "Benchmark::ClipNearPlane() could not open " << filename << '\n';
+				return;
+			}
+
+			std::cout << "ClipNearPlane " << filename << " (" << scene.indices.size() / 3 << " triangles, 640x480, " << numViews << " paths through the mesh on 1 thread)\n";
+
+			SoftwareRenderer::Framebuffer serial{ 640, 480 };
+			SoftwareRenderer::Framebuffer parallel{ 640, 480 };
+			const Matrix projection = Matrix::CreatePerspectiveFovLH(std::tan(45.f * TO_RADIANS * 0.5f), 4.f / 3.f, scene.radius * 0.01f, scene.radius * 10.f);
+			constexpr int Iterations{ 3 };
+			size_t numDifferentViews{};
+			//Camera distances from the center in radii, from outside the mesh to halfway out of the other side, always looking the same way
+			for (const float distance : { 2.f, 1.f, 0.5f, 0.f, -0.5f })
+			{
+				SoftwareRenderer::Statistics total{};
+				double totalSeconds{};
+				for (int view = 0; view < numViews; ++view)
+				{
+					const Vector3 direction = GetViewDirection(view, numViews);
+					SoftwareRenderer::View renderView{};
+					renderView.cameraPosition = scene.center + direction * (scene.radius * distance);
+					renderView.viewMatrix = CreateLookAtMatrix(renderView.cameraPosition, renderView.cameraPosition - direction);
+					renderView.projectionMatrix = projection;
+
+					SoftwareRenderer::Statistics statistics{};
+					const Clock::time_point start = Clock::now();
+					for (int iteration = 0; iteration < Iterations; ++iteration)
+						SoftwareRenderer::Render({ &scene.drawCall, 1 }, renderView, serial, 1, true, &statistics);
+					totalSeconds += SecondsSince(start) / Iterations;
+
+					//Clipped vertices are made per chunk, the image must not depend on which thread made them
+					SoftwareRenderer::Render({ &scene.drawCall, 1 }, renderView, parallel, 0);
+					numDifferentViews += SoftwareRenderer::HashImage(serial) != SoftwareRenderer::HashImage(parallel);
+
+					total.numTriangles += statistics.numTriangles;
+					total.numCulledTriangles += statistics.numCulledTriangles;
+					total.numClippedTriangles += statistics.numClippedTriangles;
+					total.numClippedVertices += statistics.numClippedVertices;
+				}
+
+				const double numTriangles = static_cast<double>(std::max<size_t>(total.numTriangles, 1));
+				std::cout << "  " << std::setw(4) << distance << " radii from the center: " << 100.0 * static_cast<double>(total.numCulledTriangles) / numTriangles
+					<< "% of the triangles culled, " << 100.0 * static_cast<double>(total.numClippedTriangles) / numTriangles << "% clipped into "
+					<< static_cast<double>(total.numClippedVertices) / numViews << " vertices per frame, " << totalSeconds / numViews * 1000.0 << " ms per frame\n";
+			}
+			std::cout << "  " << (numDifferentViews == 0 ? "every view renders the same on 1 and every thread" : "IMAGES DIFFER BETWEEN THREAD COUNTS") << '\n';
+		}
+	}
+}
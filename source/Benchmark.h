@@ -0,0 +1,82 @@
+#pragma once
+#include <string>
+
+namespace dae
+{
+	namespace Benchmark
+	{
+		//Runs every benchmark on the shipped resources, started with the --benchmark argument
+		void RunAll();
+
+		//Compares the memory mapped OBJ parser against the std::ifstream tokenizer in MB/s
+		void ParseOBJ(const std::string& filename, int iterations);
+
+		//Chunked OBJ parsing with 1 to N threads, checks every thread count against the serial result
+		void ParseOBJScaling(const std::string& filename, int iterations);
+
+		//Time to get a mesh ready for upload, parsing the OBJ versus mapping its MeshCache
+		void LoadMeshCache(const std::string& filename, int iterations);
+
+		//Single pass streaming with a fixed memory budget against the full parse, in MB/s and peak parser bytes
+		void StreamOBJ(const std::string& filename, size_t memoryBudget);
+
+		//Tangent generation throughput with 1 to N threads, checked against the serial result
+		void GenerateTangents(const std::string& filename, int iterations);
+
+		//Converts the OBJ to a GLB in the Vertex layout, then compares opening that GLB against parsing the OBJ
+		void LoadGLB(const std::string& filename, int iterations);
+
+		//ACMR and ATVR of the OBJ order against the vertex cache optimized order for FIFO and LRU caches of a few sizes,
+		//checks that the optimized indices still hold every triangle with its winding
+		void OptimizeVertexCache(const std::string& filename);
+
+		//Overdraw measured from sampled viewpoints after vertex cache optimization alone and after overdraw optimization
+		//with a few ACMR budgets, the vertex cache cost of every budget next to it
+		void OptimizeOverdraw(const std::string& filename);
+
+		//Vertex fetch overfetch under the GPU (post-transform cache) and CPU (every index) cache line models, and the time a CPU
+		//loop takes to read every indexed vertex, for the OBJ order, after vertex cache optimization and after vertex fetch optimization
+		void OptimizeVertexFetch(const std::string& filename, int iterations);
+
+		//Packing into the 20 byte PackedVertex: throughput, bytes saved and the largest decode error against the float vertices
+		void PackVertices(const std::string& filename, int iterations);
+
+		//Index bytes in the OBJ order and after vertex cache and vertex fetch optimization: 32 bit, 16 bit split into base vertex ranges
+		//and delta/varint encoded on disk, with the encode and decode throughput and a round trip check
+		void CompressIndices(const std::string& filename, int iterations);
+
+		//Sizes of the OBJ, the float and packed vertices and indices and the vertex and triangle codecs of the cooked meshes, with the encode and decode
+		//throughput and a round trip check, then MeshCache::Open time of a packed cooked file against a compressed one
+		void CompressMesh(const std::string& filename, int iterations);
+
+		//Builds meshlets of at most 64 vertices and 124 triangles from the optimized order and reports the share of the triangles that frustum,
+		//backface cone and occlusion rejection remove per view, from numViews perspective views around the mesh, next to the share of triangles
+		//that really face away. Checks that no rejected meshlet holds a triangle that faces the camera inside the frustum
+		void CullMeshlets(const std::string& filename, int numViews);
+
+		//Builds the levels of detail the cooker stores and reports the triangles, error and 1080p switch distance of each level,
+		//and checks that no level opens an edge that was closed at full detail
+		void SimplifyMesh(const std::string& filename);
+
+		//Builds the triangle BVH a Mesh uses for picking on 1 and every thread and reports its size and heuristic cost, then the closest hit
+		//and any hit rays per second for numRays rays from around the mesh, checked against testing every triangle for some of them
+		void RaycastBVH(const std::string& filename, int numRays);
+
+		//Rasterizer::CoverBlocks throughput in triangles and covered pixels per second with the scalar and the AVX2 kernel, for triangles
+		//whose corners lie in squares of 2 to 64 pixels inside one SoftwareRenderer tile, and a check that both kernels cover the same pixels.
+		//Then checks that a grid of triangles sharing edges through pixel centers covers every pixel of a tile exactly once
+		void RasterizeTriangles(int numTriangles);
+
+		//Renders the mesh with the SoftwareRenderer from numViews cameras around it, with and without the hierarchical depth test, and reports the
+		//share of triangles and 8x8 blocks it rejects and the time it saves, checking that both give the same image
+		void CullHierarchicalDepth(const std::string& filename, int numViews);
+
+		//Moves the camera from outside the mesh through it along numViews directions and reports the share of triangles the vertex outcodes cull,
+		//the share clipped against the near plane and the guard band with the vertices that creates, and the frame time. Checks that every
+		//view renders the same on 1 and every thread
+		void ClipNearPlane(const std::string& filename, int numViews);
+
+		//Texture work at startup: decoding the source PNGs against mapping what AssetCooker wrote to <folder>/Cooked
+		void LoadCookedTextures(const std::string& folder, int iterations);
+	}
+}
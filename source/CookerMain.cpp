@@ -0,0 +1,63 @@
+#include "pch.h"
+
+#undef main
+#include "AssetCooker.h"
+
+#include <string_view>
+
+using namespace dae;
+
+//AssetCooker [sourceFolder [outputFolder]] [--force] [--threads N] [--float-vertices] [--compress-indices] [--compress-vertices] [--no-lods]
+//Runs after every DirectX build, so Resources/Cooked is always current; unchanged sources are skipped
+int main(int argc, char* args[])
+{
+	AssetCooker::CookOptions options{};
+	int numFolders = 0;
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string_view argument{ args[i] };
+		if (argument == "--force")
+		{
+			options.force = true;
+		}
+		else if (argument == "--float-vertices")
+		{
+			options.packVertices = false;
+		}
+		else if (argument == "--compress-indices")
+		{
+			options.compressIndices = true;
+		}
+		else if (argument == "--compress-vertices")
+		{
+			options.compressVertices = true;
+		}
+		else if (argument == "--no-lods")
+		{
+			options.buildLevelsOfDetail = false;
+		}
+		else if (argument == "--threads" and i + 1 < argc)
+		{
+			options.numThreads = static_cast<uint32_t>(std::strtoul(args[++i], nullptr, 10));
+		}
+		else if (numFolders == 0)
+		{
+			options.sourceFolder = args[i];
+			options.outputFolder = options.sourceFolder + "/Cooked";
+			++numFolders;
+		}
+		else if (numFolders == 1)
+		{
+			options.outputFolder = args[i];
+			++numFolders;
+		}
+		else
+		{
+			std::cout << "Usage: AssetCooker [sourceFolder [outputFolder]] [--force] [--threads N] [--float-vertices] [--compress-indices] [--compress-vertices] [--no-lods]\n";
+			return 1;
+		}
+	}
+
+	AssetCooker::CookStats stats{};
+	return AssetCooker::Cook(options, stats) ? 0 : 1;
+}
@@ -0,0 +1,171 @@
+#include "pch.h"
+#include "DDSFile.h"
+#include "MappedFile.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace dae
+{
+    namespace
+    {
+        constexpr uint32_t DDSMagic{ 0x20534444 };  // "DDS "
+        constexpr uint32_t DX10FourCC{ 0x30315844 }; // "DX10"
+
+        // Header flags, only the ones the cooker writes
+        constexpr uint32_t FlagCaps{ 0x1 };
+        constexpr uint32_t FlagHeight{ 0x2 };
+        constexpr uint32_t FlagWidth{ 0x4 };
+        constexpr uint32_t FlagPitch{ 0x8 };
+        constexpr uint32_t FlagPixelFormat{ 0x1000 };
+        constexpr uint32_t FlagMipMapCount{ 0x20000 };
+        constexpr uint32_t PixelFormatFourCC{ 0x4 };
+        constexpr uint32_t CapsComplex{ 0x8 };
+        constexpr uint32_t CapsTexture{ 0x1000 };
+        constexpr uint32_t CapsMipMap{ 0x400000 };
+        constexpr uint32_t ResourceDimensionTexture2D{ 3 };
+
+        struct DDSPixelFormat
+        {
+            uint32_t size;
+            uint32_t flags;
+            uint32_t fourCC;
+            uint32_t rgbBitCount;
+            uint32_t bitMasks[4];
+        };
+
+        struct DDSHeader
+        {
+            uint32_t magic;
+            uint32_t size;
+            uint32_t flags;
+            uint32_t height;
+            uint32_t width;
+            uint32_t pitchOrLinearSize;
+            uint32_t depth;
+            uint32_t mipMapCount;
+            uint32_t reserved1[11];
+            DDSPixelFormat pixelFormat;
+            uint32_t caps[4];
+            uint32_t reserved2;
+        };
+
+        struct DX10Header
+        {
+            uint32_t dxgiFormat;
+            uint32_t resourceDimension;
+            uint32_t miscFlag;
+            uint32_t arraySize;
+            uint32_t miscFlags2;
+        };
+
+        constexpr uint32_t BytesPerTexel{ 4 };
+        constexpr size_t DataOffset{ sizeof(DDSHeader) + sizeof(DX10Header) };
+    }
+
+    DDSFile::~DDSFile() = default;
+
+    std::unique_ptr<DDSFile> DDSFile::Open(const std::string& path)
+    {
+        auto mappedFilePtr = std::make_unique<MappedFile>(path);
+        if (!mappedFilePtr->IsOpen() or mappedFilePtr->GetSize() < DataOffset)
+        {
+            std::cout << "DDSFile: failed to open " << path << '\n';
+            return nullptr;
+        }
+
+        DDSHeader header{};
+        DX10Header dx10Header{};
+        std::memcpy(&header, mappedFilePtr->GetData(), sizeof(header));
+        std::memcpy(&dx10Header, mappedFilePtr->GetData() + sizeof(header), sizeof(dx10Header));
+
+        const bool isSupported = header.magic == DDSMagic
+            and header.size == sizeof(DDSHeader) - sizeof(header.magic)
+            and (header.pixelFormat.flags & PixelFormatFourCC) and header.pixelFormat.fourCC == DX10FourCC
+            and dx10Header.dxgiFormat == FormatR8G8B8A8Unorm
+            and dx10Header.resourceDimension == ResourceDimensionTexture2D and dx10Header.arraySize == 1
+            and header.width > 0 and header.height > 0
+            and header.mipMapCount <= GetNumMips(header.width, header.height);
+        if (!isSupported)
+        {
+            std::cout << "DDSFile: " << path << " is not a 2D R8G8B8A8_UNORM texture\n";
+            return nullptr;
+        }
+
+        std::unique_ptr<DDSFile> ddsFilePtr{ new DDSFile() };
+        ddsFilePtr->m_Mips.resize(std::max(header.mipMapCount, 1u));
+
+        size_t offset = DataOffset;
+        uint32_t width = header.width;
+        uint32_t height = header.height;
+        for (Mip& mip : ddsFilePtr->m_Mips)
+        {
+            const size_t mipBytes = size_t(width) * height * BytesPerTexel;
+            if (offset + mipBytes > mappedFilePtr->GetSize())
+            {
+                std::cout << "DDSFile: " << path << " is truncated\n";
+                return nullptr;
+            }
+
+            mip.data = { mappedFilePtr->GetData() + offset, mipBytes };
+            mip.width = width;
+            mip.height = height;
+            mip.rowPitch = width * BytesPerTexel;
+
+            offset += mipBytes;
+            width = std::max(width / 2, 1u);
+            height = std::max(height / 2, 1u);
+        }
+
+        ddsFilePtr->m_MappedFilePtr = std::move(mappedFilePtr);
+        return ddsFilePtr;
+    }
+
+    bool DDSFile::Write(const std::string& path, uint32_t width, uint32_t height, uint32_t numMips, std::span<const uint32_t> pixels)
+    {
+        if (width == 0 or height == 0 or numMips == 0 or numMips > GetNumMips(width, height))
+            return false;
+
+        DDSHeader header{};
+        header.magic = DDSMagic;
+        header.size = sizeof(DDSHeader) - sizeof(header.magic);
+        header.flags = FlagCaps | FlagHeight | FlagWidth | FlagPitch | FlagPixelFormat | FlagMipMapCount;
+        header.height = height;
+        header.width = width;
+        header.pitchOrLinearSize = width * BytesPerTexel;
+        header.mipMapCount = numMips;
+        header.pixelFormat.size = sizeof(DDSPixelFormat);
+        header.pixelFormat.flags = PixelFormatFourCC;
+        header.pixelFormat.fourCC = DX10FourCC;
+        header.caps[0] = CapsTexture | (numMips > 1 ? CapsComplex | CapsMipMap : 0);
+
+        DX10Header dx10Header{};
+        dx10Header.dxgiFormat = FormatR8G8B8A8Unorm;
+        dx10Header.resourceDimension = ResourceDimensionTexture2D;
+        dx10Header.arraySize = 1;
+
+        size_t numTexels = 0;
+        for (uint32_t level = 0; level < numMips; ++level)
+            numTexels += size_t(std::max(width >> level, 1u)) * std::max(height >> level, 1u);
+        if (pixels.size() != numTexels)
+            return false;
+
+        std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(&dx10Header), sizeof(dx10Header));
+        file.write(reinterpret_cast<const char*>(pixels.data()), static_cast<std::streamsize>(pixels.size_bytes()));
+        return static_cast<bool>(file);
+    }
+
+    uint32_t DDSFile::GetNumMips(uint32_t width, uint32_t height)
+    {
+        uint32_t numMips = 1;
+        while (width > 1 or height > 1)
+        {
+            width = std::max(width / 2, 1u);
+            height = std::max(height / 2, 1u);
+            ++numMips;
+        }
+        return numMips;
+    }
+}
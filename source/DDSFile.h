@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace dae
+{
+    class MappedFile;
+
+    // DirectDraw Surface with a DX10 header, the format the asset cooker writes textures in
+    // Only 2D R8G8B8A8_UNORM textures with tightly packed mips are read, which is all the cooker produces
+    class DDSFile final
+    {
+    public:
+        // DXGI_FORMAT_R8G8B8A8_UNORM, the DXGI headers are not needed to read or write the files
+        static constexpr uint32_t FormatR8G8B8A8Unorm{ 28 };
+
+        struct Mip
+        {
+            std::span<const char> data{};
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t rowPitch = 0;
+        };
+
+        ~DDSFile();
+
+        DDSFile(const DDSFile& other) = delete;
+        DDSFile(DDSFile&& other) noexcept = delete;
+        DDSFile& operator=(const DDSFile& other) = delete;
+        DDSFile& operator=(DDSFile&& other) noexcept = delete;
+
+        // Maps the file, the mips are views into it. Returns nullptr when it is not a DDS this class can read
+        static std::unique_ptr<DDSFile> Open(const std::string& path);
+
+        // pixels holds every mip from largest to 1x1, each one width * height RGBA8 texels
+        static bool Write(const std::string& path, uint32_t width, uint32_t height, uint32_t numMips, std::span<const uint32_t> pixels);
+
+        // Number of mips in a full chain down to 1x1
+        static uint32_t GetNumMips(uint32_t width, uint32_t height);
+
+        // A DXGI_FORMAT value
+        uint32_t GetFormat() const { return FormatR8G8B8A8Unorm; }
+        uint32_t GetWidth() const { return m_Mips.front().width; }
+        uint32_t GetHeight() const { return m_Mips.front().height; }
+        uint32_t GetNumMips() const { return static_cast<uint32_t>(m_Mips.size()); }
+        const Mip& GetMip(uint32_t level) const { return m_Mips[level]; }
+
+    private:
+        DDSFile() = default;
+
+        std::unique_ptr<MappedFile> m_MappedFilePtr{};
+        std::vector<Mip> m_Mips{};
+    };
+}
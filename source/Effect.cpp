@@ -8,6 +8,19 @@ namespace dae
         m_EffectPtr = LoadEffect(devicePtr, assetFile);
     }
 
+    Effect::Effect(ID3D11Device* devicePtr, ID3DBlob* compiledEffectPtr)
+    {
+        const HRESULT result = D3DX11CreateEffectFromMemory(
+            compiledEffectPtr->GetBufferPointer(),
+            compiledEffectPtr->GetBufferSize(),
+            0,
+            devicePtr,
+            &m_EffectPtr);
+
+        if (FAILED(result))
+            std::cout << "Effect::Effect() failed to create the effect from memory: " << result << '\n';
+    }
+
     Effect::~Effect()
     {
         if (m_EffectPtr)    
@@ -73,4 +86,57 @@ namespace dae
 
         return effectPtr;
     }
-}
\ No newline at end of file
+    ID3DBlob* Effect::CompileFromFile(const std::wstring& assetFile)
+    {
+        ID3DBlob* compiledEffectPtr = nullptr;
+        ID3DBlob* errorBlobPtr = nullptr;
+
+        DWORD shaderFlags = 0;
+#if defined( DEBUG ) || defined( _DEBUG )
+        shaderFlags |= D3DCOMPILE_DEBUG;
+        shaderFlags |= D3DCOMPILE_SKIP_OPTIMIZATION;
+#endif
+
+        const HRESULT result = D3DCompileFromFile(
+            assetFile.c_str(),
+            nullptr,
+            D3D_COMPILE_STANDARD_FILE_INCLUDE,
+            nullptr,
+            "fx_5_0",
+            shaderFlags,
+            0,
+            &compiledEffectPtr,
+            &errorBlobPtr);
+
+        if (errorBlobPtr != nullptr)
+        {
+            const char* errorsPtr = static_cast<const char*>(errorBlobPtr->GetBufferPointer());
+            std::cout << std::string(errorsPtr, errorBlobPtr->GetBufferSize()) << std::endl;
+            errorBlobPtr->Release();
+        }
+
+        if (FAILED(result))
+        {
+            std::wcout << L"EffectLoader: Failed to compile effect!\nPath: " << assetFile << std::endl;
+            return nullptr;
+        }
+
+        return compiledEffectPtr;
+    }
+
+    ID3DBlob* Effect::LoadCompiled(const std::wstring& compiledFile)
+    {
+        ID3DBlob* compiledEffectPtr = nullptr;
+        if (FAILED(D3DReadFileToBlob(compiledFile.c_str(), &compiledEffectPtr)))
+        {
+            std::wcout << L"EffectLoader: Failed to read compiled effect!\nPath: " << compiledFile << std::endl;
+            return nullptr;
+        }
+        return compiledEffectPtr;
+    }
+
+    bool Effect::WriteCompiled(ID3DBlob* compiledEffectPtr, const std::wstring& compiledFile)
+    {
+        return compiledEffectPtr and SUCCEEDED(D3DWriteBlobToFile(compiledEffectPtr, compiledFile.c_str(), TRUE));
+    }
+}
@@ -6,6 +6,8 @@ namespace dae
     {
     public:
         Effect(ID3D11Device* devicePtr, const std::wstring& assetFile);
+        // Creates the effect from the output of CompileFromFile, which is much cheaper than compiling it again
+        Effect(ID3D11Device* devicePtr, ID3DBlob* compiledEffectPtr);
         ~Effect();
 
         Effect(const Effect& other) = delete;
@@ -18,6 +20,11 @@ namespace dae
         ID3DX11EffectVariable* GetVariableByName(const std::string& name) const { return m_EffectPtr->GetVariableByName(name.c_str()); };
 
         static ID3DX11Effect* LoadEffect(ID3D11Device* devicePtr, const std::wstring& assetFile);
+        // Compiles the effect without touching the device, so it can run on a worker thread; the caller releases the blob
+        static ID3DBlob* CompileFromFile(const std::wstring& assetFile);
+        // Reads and writes compiled effects, so the asset cooker can compile them ahead of time
+        static ID3DBlob* LoadCompiled(const std::wstring& compiledFile);
+        static bool WriteCompiled(ID3DBlob* compiledEffectPtr, const std::wstring& compiledFile);
 
     private:
         ID3DX11Effect* m_EffectPtr = nullptr;
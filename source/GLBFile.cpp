@@ -0,0 +1,501 @@
+#include "pch.h"
+#include "GLBFile.h"
+#include "MappedFile.h"
+#include "TangentSpace.h"
+
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+
+namespace dae
+{
+    namespace
+    {
+        constexpr uint32_t GLBMagic{ 0x46546C67 };      // "glTF"
+        constexpr uint32_t GLBVersion{ 2 };
+        constexpr uint32_t JSONChunkType{ 0x4E4F534A }; // "JSON"
+        constexpr uint32_t BINChunkType{ 0x004E4942 };  // "BIN\0"
+        constexpr int64_t TrianglesMode{ 4 };
+
+        struct GLBHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t length;
+        };
+
+        struct ChunkHeader
+        {
+            uint32_t length;
+            uint32_t type;
+        };
+
+        uint32_t GetComponentSize(uint32_t componentType)
+        {
+            switch (componentType)
+            {
+            case GLBFile::Byte:
+            case GLBFile::UnsignedByte: return 1;
+            case GLBFile::Short:
+            case GLBFile::UnsignedShort: return 2;
+            case GLBFile::UnsignedInt:
+            case GLBFile::Float: return 4;
+            default: return 0;
+            }
+        }
+
+        uint32_t GetNumComponents(const std::string& type)
+        {
+            if (type == "SCALAR") return 1;
+            if (type == "VEC2") return 2;
+            if (type == "VEC3") return 3;
+            if (type == "VEC4") return 4;
+            if (type == "MAT4") return 16;
+            return 0;
+        }
+
+        template<typename T>
+        T Load(const char* dataPtr)
+        {
+            T value;
+            std::memcpy(&value, dataPtr, sizeof(T));
+            return value;
+        }
+
+        int GetIndex(const JsonValue& value)
+        {
+            return value.IsNumber() ? static_cast<int>(value.GetInt()) : -1;
+        }
+
+        // Vertex attribute types the glTF spec allows: floats, or normalized unsigned bytes and shorts where integers are allowed
+        bool IsAttributeType(const GLBFile::Accessor& accessor, uint32_t minComponents, uint32_t maxComponents, bool allowsIntegers)
+        {
+            if (accessor.numComponents < minComponents or accessor.numComponents > maxComponents)
+                return false;
+            if (accessor.componentType == GLBFile::Float)
+                return true;
+            return allowsIntegers and accessor.normalized and (accessor.componentType == GLBFile::UnsignedByte or accessor.componentType == GLBFile::UnsignedShort);
+        }
+
+        // Image behind a material texture slot, -1 when there is none
+        int GetTextureImage(const JsonValue& document, const JsonValue& textureInfo)
+        {
+            const int textureIndex = GetIndex(textureInfo["index"]);
+            if (textureIndex < 0)
+                return -1;
+            return GetIndex(document["textures"][static_cast<size_t>(textureIndex)]["source"]);
+        }
+    }
+
+    size_t GLBFile::Accessor::GetElementSize() const
+    {
+        return static_cast<size_t>(GetComponentSize(componentType)) * numComponents;
+    }
+
+    void GLBFile::Accessor::ReadFloats(size_t index, float* valuesPtr) const
+    {
+        const char* elementPtr = dataPtr + index * stride;
+        const uint32_t componentSize = GetComponentSize(componentType);
+        for (uint32_t component = 0; component < numComponents; ++component)
+        {
+            const char* componentPtr = elementPtr + component * componentSize;
+            float value{};
+            switch (componentType)
+            {
+            case Float: value = Load<float>(componentPtr); break;
+            case UnsignedInt: value = static_cast<float>(Load<uint32_t>(componentPtr)); break;
+            case UnsignedByte:
+                value = static_cast<float>(Load<uint8_t>(componentPtr));
+                if (normalized) value /= 255.f;
+                break;
+            case UnsignedShort:
+                value = static_cast<float>(Load<uint16_t>(componentPtr));
+                if (normalized) value /= 65535.f;
+                break;
+            case Byte:
+                value = static_cast<float>(Load<int8_t>(componentPtr));
+                if (normalized) value = std::max(value / 127.f, -1.f);
+                break;
+            case Short:
+                value = static_cast<float>(Load<int16_t>(componentPtr));
+                if (normalized) value = std::max(value / 32767.f, -1.f);
+                break;
+            default: break;
+            }
+            valuesPtr[component] = value;
+        }
+    }
+
+    uint32_t GLBFile::Accessor::ReadIndex(size_t index) const
+    {
+        const char* elementPtr = dataPtr + index * stride;
+        switch (componentType)
+        {
+        case UnsignedByte: return Load<uint8_t>(elementPtr);
+        case UnsignedShort: return Load<uint16_t>(elementPtr);
+        case UnsignedInt: return Load<uint32_t>(elementPtr);
+        default: return 0;
+        }
+    }
+
+    GLBFile::~GLBFile() = default;
+
+    std::unique_ptr<GLBFile> GLBFile::Open(const std::string& path, bool flipAxisAndWinding)
+    {
+        std::unique_ptr<GLBFile> fileObjectPtr{ new GLBFile() };
+        fileObjectPtr->m_MappedFilePtr = std::make_unique<MappedFile>(path);
+        if (!fileObjectPtr->m_MappedFilePtr->IsOpen())
+        {
+            std::cout << "GLBFile::Open() failed to open " << path << '\n';
+            return nullptr;
+        }
+
+        if (!fileObjectPtr->Parse(flipAxisAndWinding))
+        {
+            std::cout << "GLBFile::Open() " << path << " is not a supported GLB file\n";
+            return nullptr;
+        }
+        return fileObjectPtr;
+    }
+
+    bool GLBFile::Parse(bool flipAxisAndWinding)
+    {
+        const char* dataPtr = m_MappedFilePtr->GetData();
+        const size_t size = m_MappedFilePtr->GetSize();
+        if (size < sizeof(GLBHeader) + sizeof(ChunkHeader))
+            return false;
+
+        const GLBHeader header = Load<GLBHeader>(dataPtr);
+        if (header.magic != GLBMagic or header.version != GLBVersion or header.length > size)
+            return false;
+
+        // The JSON chunk comes first, the BIN chunk is optional, unknown chunks are skipped
+        std::string_view json{};
+        for (size_t offset = sizeof(GLBHeader); offset + sizeof(ChunkHeader) <= header.length;)
+        {
+            const ChunkHeader chunk = Load<ChunkHeader>(dataPtr + offset);
+            offset += sizeof(ChunkHeader);
+            if (chunk.length > header.length - offset)
+                return false;
+
+            if (chunk.type == JSONChunkType and json.empty())
+                json = { dataPtr + offset, chunk.length };
+            else if (chunk.type == BINChunkType and m_BinaryChunk.empty())
+                m_BinaryChunk = { dataPtr + offset, chunk.length };
+            offset += (chunk.length + 3) & ~size_t{ 3 };
+        }
+
+        if (json.empty() or !JsonValue::Parse(json, m_Document))
+            return false;
+
+        for (const JsonValue& mesh : m_Document["meshes"].GetElements())
+        {
+            for (const JsonValue& primitiveValue : mesh["primitives"].GetElements())
+            {
+                if (primitiveValue["mode"].GetInt(TrianglesMode) != TrianglesMode)
+                    continue;
+
+                const JsonValue& attributes = primitiveValue["attributes"];
+                Primitive primitive{};
+                primitive.position = GetIndex(attributes["POSITION"]);
+                primitive.normal = GetIndex(attributes["NORMAL"]);
+                primitive.tangent = GetIndex(attributes["TANGENT"]);
+                primitive.uv = GetIndex(attributes["TEXCOORD_0"]);
+                primitive.color = GetIndex(attributes["COLOR_0"]);
+                primitive.indices = GetIndex(primitiveValue["indices"]);
+
+                if (!HasValidAccessors(primitive))
+                    continue;
+
+                const int materialIndex = GetIndex(primitiveValue["material"]);
+                if (materialIndex >= 0)
+                {
+                    const JsonValue& material = m_Document["materials"][static_cast<size_t>(materialIndex)];
+                    primitive.baseColorImage = GetTextureImage(m_Document, material["pbrMetallicRoughness"]["baseColorTexture"]);
+                    primitive.normalImage = GetTextureImage(m_Document, material["normalTexture"]);
+                }
+
+                m_Primitives.push_back(primitive);
+            }
+        }
+
+        // Files from Write are already in the renderer's space
+        const bool flip = flipAxisAndWinding and !m_Document["asset"]["extras"]["leftHanded"].GetBool();
+
+        if (m_Primitives.size() == 1 and !flip and MapVertices(m_Primitives.front()))
+        {
+            m_Indices = GetSpan<uint32_t>(m_Primitives.front().indices, UnsignedInt, 1);
+            if (!m_Indices.empty() and m_Indices.size() % 3 == 0)
+            {
+                // Still no copy, but a mapped index has to be checked like the repacked ones below
+                const size_t numVertices = m_Vertices.size();
+                m_Primitives.front().numIndices = static_cast<uint32_t>(m_Indices.size());
+                return std::all_of(m_Indices.begin(), m_Indices.end(), [numVertices](uint32_t index) { return index < numVertices; });
+            }
+
+            // Vertices stay mapped, only the indices are rebuilt
+            m_Indices = {};
+            const Accessor indices = GetAccessor(m_Primitives.front().indices);
+            m_OwnedIndices.resize(indices.dataPtr ? indices.count / 3 * 3 : m_Vertices.size() / 3 * 3);
+            for (size_t i = 0; i < m_OwnedIndices.size(); ++i)
+            {
+                m_OwnedIndices[i] = indices.dataPtr ? indices.ReadIndex(i) : static_cast<uint32_t>(i);
+                if (m_OwnedIndices[i] >= m_Vertices.size())
+                    return false;
+            }
+            m_Indices = m_OwnedIndices;
+            m_Primitives.front().numIndices = static_cast<uint32_t>(m_Indices.size());
+            return true;
+        }
+
+        m_Vertices = {};
+        for (Primitive& primitive : m_Primitives)
+        {
+            if (!AppendPrimitive(primitive, flip))
+                return false;
+        }
+        m_Vertices = m_OwnedVertices;
+        m_Indices = m_OwnedIndices;
+        return true;
+    }
+
+    std::span<const char> GLBFile::GetBufferView(int bufferViewIndex, size_t& stride) const
+    {
+        if (bufferViewIndex < 0)
+            return {};
+
+        // Only the GLB's own buffer (no uri) lives in the BIN chunk
+        const JsonValue& bufferView = m_Document["bufferViews"][static_cast<size_t>(bufferViewIndex)];
+        const int64_t bufferIndex = bufferView["buffer"].GetInt(-1);
+        if (bufferIndex != 0 or m_Document["buffers"][0].Contains("uri"))
+            return {};
+
+        const int64_t byteOffset = bufferView["byteOffset"].GetInt(0);
+        const int64_t byteLength = bufferView["byteLength"].GetInt(-1);
+        if (byteOffset < 0 or byteLength < 0 or static_cast<uint64_t>(byteOffset) > m_BinaryChunk.size()
+            or static_cast<uint64_t>(byteLength) > m_BinaryChunk.size() - static_cast<size_t>(byteOffset))
+            return {};
+
+        stride = static_cast<size_t>(bufferView["byteStride"].GetInt(0));
+        return m_BinaryChunk.subspan(static_cast<size_t>(byteOffset), static_cast<size_t>(byteLength));
+    }
+
+    GLBFile::Accessor GLBFile::GetAccessor(int accessorIndex) const
+    {
+        if (accessorIndex < 0)
+            return {};
+
+        const JsonValue& accessorValue = m_Document["accessors"][static_cast<size_t>(accessorIndex)];
+        Accessor accessor{};
+        accessor.count = static_cast<size_t>(std::max<int64_t>(accessorValue["count"].GetInt(0), 0));
+        accessor.componentType = static_cast<uint32_t>(accessorValue["componentType"].GetInt(0));
+        accessor.numComponents = GetNumComponents(accessorValue["type"].GetString());
+        accessor.normalized = accessorValue["normalized"].GetBool();
+
+        size_t stride{};
+        const std::span<const char> bufferView = GetBufferView(GetIndex(accessorValue["bufferView"]), stride);
+        const size_t elementSize = accessor.GetElementSize();
+        const int64_t byteOffset = accessorValue["byteOffset"].GetInt(0);
+        if (bufferView.empty() or elementSize == 0 or byteOffset < 0 or static_cast<uint64_t>(byteOffset) > bufferView.size())
+            return {};
+
+        // The count is checked against what fits before it is multiplied, so a huge count cannot wrap past the check
+        accessor.stride = stride > 0 ? stride : elementSize;
+        const size_t availableBytes = bufferView.size() - static_cast<size_t>(byteOffset);
+        if (accessor.count > 0 and (elementSize > availableBytes or accessor.count - 1 > (availableBytes - elementSize) / accessor.stride))
+            return {};
+
+        accessor.dataPtr = bufferView.data() + byteOffset;
+        return accessor;
+    }
+
+    bool GLBFile::HasValidAccessors(const Primitive& primitive) const
+    {
+        // Optional attributes may be missing, but not broken
+        const auto isValid = [this](int accessorIndex, uint32_t minComponents, uint32_t maxComponents, bool allowsIntegers)
+            {
+                if (accessorIndex < 0)
+                    return true;
+                const Accessor accessor = GetAccessor(accessorIndex);
+                return accessor.dataPtr and IsAttributeType(accessor, minComponents, maxComponents, allowsIntegers);
+            };
+
+        const Accessor indices = GetAccessor(primitive.indices);
+        const bool hasValidIndices = primitive.indices < 0 or (indices.dataPtr and indices.numComponents == 1
+            and (indices.componentType == UnsignedByte or indices.componentType == UnsignedShort or indices.componentType == UnsignedInt));
+
+        return primitive.position >= 0 and isValid(primitive.position, 3, 3, false) and isValid(primitive.normal, 3, 3, false)
+            and isValid(primitive.tangent, 4, 4, false) and isValid(primitive.uv, 2, 2, true) and isValid(primitive.color, 3, 4, true) and hasValidIndices;
+    }
+
+    std::span<const char> GLBFile::GetImage(int imageIndex) const
+    {
+        if (imageIndex < 0)
+            return {};
+
+        size_t stride{};
+        return GetBufferView(GetIndex(m_Document["images"][static_cast<size_t>(imageIndex)]["bufferView"]), stride);
+    }
+
+    bool GLBFile::MapVertices(const Primitive& primitive)
+    {
+        const Accessor position = GetAccessor(primitive.position);
+        const char* basePtr = position.dataPtr;
+        if (reinterpret_cast<uintptr_t>(basePtr) % alignof(Vertex) != 0)
+            return false;
+
+        // Every attribute has to sit at its Vertex offset in one interleaved buffer view
+        const auto matches = [&](int accessorIndex, size_t offset, uint32_t numComponents)
+            {
+                const Accessor accessor = GetAccessor(accessorIndex);
+                return accessor.dataPtr == basePtr + offset and accessor.count == position.count and accessor.stride == sizeof(Vertex)
+                    and accessor.componentType == Float and accessor.numComponents == numComponents;
+            };
+
+        if (!matches(primitive.position, offsetof(Vertex, position), 3) or !matches(primitive.color, offsetof(Vertex, color), 3)
+            or !matches(primitive.uv, offsetof(Vertex, uv), 2) or !matches(primitive.normal, offsetof(Vertex, normal), 3)
+            or !matches(primitive.tangent, offsetof(Vertex, tangent), 4))
+            return false;
+
+        m_Vertices = { reinterpret_cast<const Vertex*>(basePtr), position.count };
+        return true;
+    }
+
+    bool GLBFile::AppendPrimitive(Primitive& primitive, bool flipAxisAndWinding)
+    {
+        const Accessor position = GetAccessor(primitive.position);
+        const Accessor normal = GetAccessor(primitive.normal);
+        const Accessor tangent = GetAccessor(primitive.tangent);
+        const Accessor uv = GetAccessor(primitive.uv);
+        const Accessor color = GetAccessor(primitive.color);
+        const Accessor indices = GetAccessor(primitive.indices);
+
+        const size_t baseVertex = m_OwnedVertices.size();
+        m_OwnedVertices.resize(baseVertex + position.count);
+        const std::span<Vertex> vertices = std::span<Vertex>{ m_OwnedVertices }.subspan(baseVertex);
+
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            Vertex& vertex = vertices[i];
+            float values[4]{};
+
+            position.ReadFloats(i, values);
+            vertex.position = { values[0], values[1], values[2] };
+            if (normal.dataPtr and normal.count == position.count)
+            {
+                normal.ReadFloats(i, values);
+                vertex.normal = { values[0], values[1], values[2] };
+            }
+            if (uv.dataPtr and uv.count == position.count)
+            {
+                uv.ReadFloats(i, values);
+                vertex.uv = { values[0], values[1] };
+            }
+            if (color.dataPtr and color.count == position.count)
+            {
+                color.ReadFloats(i, values);
+                vertex.color = { values[0], values[1], values[2] };
+            }
+            if (tangent.dataPtr and tangent.count == position.count)
+            {
+                tangent.ReadFloats(i, values);
+                vertex.tangent = { values[0], values[1], values[2], values[3] };
+            }
+
+            if (flipAxisAndWinding)
+            {
+                vertex.position.z *= -1.f;
+                vertex.normal.z *= -1.f;
+                vertex.tangent.z *= -1.f;
+                vertex.tangent.w *= -1.f;
+            }
+        }
+
+        std::vector<uint32_t> localIndices(indices.dataPtr ? indices.count / 3 * 3 : vertices.size() / 3 * 3);
+        for (size_t i = 0; i < localIndices.size(); ++i)
+        {
+            localIndices[i] = indices.dataPtr ? indices.ReadIndex(i) : static_cast<uint32_t>(i);
+            if (localIndices[i] >= vertices.size())
+                return false;
+        }
+
+        if (flipAxisAndWinding)
+        {
+            for (size_t i = 0; i < localIndices.size(); i += 3)
+                std::swap(localIndices[i + 1], localIndices[i + 2]);
+        }
+
+        if (!tangent.dataPtr or tangent.count != position.count)
+            TangentSpace::Generate(vertices, localIndices);
+
+        primitive.firstIndex = static_cast<uint32_t>(m_OwnedIndices.size());
+        primitive.numIndices = static_cast<uint32_t>(localIndices.size());
+        m_OwnedIndices.reserve(m_OwnedIndices.size() + localIndices.size());
+        for (const uint32_t index : localIndices)
+            m_OwnedIndices.push_back(static_cast<uint32_t>(baseVertex) + index);
+        return true;
+    }
+
+    bool GLBFile::Write(const std::string& path, std::span<const Vertex> vertices, std::span<const uint32_t> indices)
+    {
+        Vector3 boundsMin{}, boundsMax{};
+        if (!vertices.empty())
+            boundsMin = boundsMax = vertices.front().position;
+        for (const Vertex& vertex : vertices)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                boundsMin[axis] = std::min(boundsMin[axis], vertex.position[axis]);
+                boundsMax[axis] = std::max(boundsMax[axis], vertex.position[axis]);
+            }
+        }
+
+        const size_t vertexBytes = vertices.size_bytes();
+        const size_t indexBytes = indices.size_bytes();
+        const auto attribute = [&](size_t offset, const char* type)
+            {
+                std::ostringstream accessor{};
+                accessor << R"({"bufferView":0,"byteOffset":)" << offset << R"(,"componentType":)" << Float
+                    << R"(,"count":)" << vertices.size() << R"(,"type":")" << type << '"';
+                return accessor.str();
+            };
+
+        std::ostringstream json{};
+        json.precision(9);
+        json << R"({"asset":{"version":"2.0","generator":"DirectX","extras":{"leftHanded":true}},)"
+            << R"("scene":0,"scenes":[{"nodes":[0]}],"nodes":[{"mesh":0}],)"
+            << R"("meshes":[{"primitives":[{"attributes":{"POSITION":0,"COLOR_0":1,"TEXCOORD_0":2,"NORMAL":3,"TANGENT":4},"indices":5}]}],)"
+            << R"("buffers":[{"byteLength":)" << vertexBytes + indexBytes << "}],"
+            << R"("bufferViews":[{"buffer":0,"byteOffset":0,"byteLength":)" << vertexBytes << R"(,"byteStride":)" << sizeof(Vertex) << R"(,"target":34962},)"
+            << R"({"buffer":0,"byteOffset":)" << vertexBytes << R"(,"byteLength":)" << indexBytes << R"(,"target":34963}],)"
+            << R"("accessors":[)"
+            << attribute(offsetof(Vertex, position), "VEC3")
+            << R"(,"min":[)" << boundsMin.x << ',' << boundsMin.y << ',' << boundsMin.z
+            << R"(],"max":[)" << boundsMax.x << ',' << boundsMax.y << ',' << boundsMax.z << "]},"
+            << attribute(offsetof(Vertex, color), "VEC3") << "},"
+            << attribute(offsetof(Vertex, uv), "VEC2") << "},"
+            << attribute(offsetof(Vertex, normal), "VEC3") << "},"
+            << attribute(offsetof(Vertex, tangent), "VEC4") << "},"
+            << R"({"bufferView":1,"componentType":)" << UnsignedInt << R"(,"count":)" << indices.size() << R"(,"type":"SCALAR"}]})";
+
+        // Chunks are padded to 4 bytes, JSON with spaces and BIN with zeros
+        std::string jsonChunk = json.str();
+        jsonChunk.resize((jsonChunk.size() + 3) & ~size_t{ 3 }, ' ');
+        const size_t binaryBytes = (vertexBytes + indexBytes + 3) & ~size_t{ 3 };
+
+        const GLBHeader header{ GLBMagic, GLBVersion, static_cast<uint32_t>(sizeof(GLBHeader) + 2 * sizeof(ChunkHeader) + jsonChunk.size() + binaryBytes) };
+        const ChunkHeader jsonHeader{ static_cast<uint32_t>(jsonChunk.size()), JSONChunkType };
+        const ChunkHeader binaryHeader{ static_cast<uint32_t>(binaryBytes), BINChunkType };
+        const char padding[4]{};
+
+        std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(&jsonHeader), sizeof(jsonHeader));
+        file.write(jsonChunk.data(), static_cast<std::streamsize>(jsonChunk.size()));
+        file.write(reinterpret_cast<const char*>(&binaryHeader), sizeof(binaryHeader));
+        file.write(reinterpret_cast<const char*>(vertices.data()), static_cast<std::streamsize>(vertexBytes));
+        file.write(reinterpret_cast<const char*>(indices.data()), static_cast<std::streamsize>(indexBytes));
+        file.write(padding, static_cast<std::streamsize>(binaryBytes - vertexBytes - indexBytes));
+        return static_cast<bool>(file);
+    }
+}
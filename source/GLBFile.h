@@ -0,0 +1,120 @@
+#pragma once
+#include "Vertex.h"
+#include "Json.h"
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace dae
+{
+    class MappedFile;
+
+    // Binary glTF 2.0 file mapped into memory, accessors are views into the mapped BIN chunk
+    // The triangle primitives of every mesh are merged into one vertex and index array (node transforms are not applied)
+    class GLBFile final
+    {
+    public:
+        // glTF component types
+        static constexpr uint32_t Byte{ 5120 };
+        static constexpr uint32_t UnsignedByte{ 5121 };
+        static constexpr uint32_t Short{ 5122 };
+        static constexpr uint32_t UnsignedShort{ 5123 };
+        static constexpr uint32_t UnsignedInt{ 5125 };
+        static constexpr uint32_t Float{ 5126 };
+
+        struct Accessor
+        {
+            const char* dataPtr = nullptr;
+            size_t count = 0;
+            // Bytes from one element to the next
+            size_t stride = 0;
+            uint32_t componentType = 0;
+            uint32_t numComponents = 0;
+            bool normalized = false;
+
+            size_t GetElementSize() const;
+            // Converts up to numComponents values, normalized integers end up in [0, 1] or [-1, 1]
+            void ReadFloats(size_t index, float* valuesPtr) const;
+            uint32_t ReadIndex(size_t index) const;
+        };
+
+        // Accessor and image indices of one triangle primitive, -1 when missing
+        struct Primitive
+        {
+            int position = -1;
+            int normal = -1;
+            int tangent = -1;
+            int uv = -1;
+            int color = -1;
+            int indices = -1;
+            int baseColorImage = -1;
+            int normalImage = -1;
+            // Triangles of the primitive in GetIndices, set by Open
+            uint32_t firstIndex = 0;
+            uint32_t numIndices = 0;
+        };
+
+        ~GLBFile();
+
+        GLBFile(const GLBFile& other) = delete;
+        GLBFile(GLBFile&& other) noexcept = delete;
+        GLBFile& operator=(const GLBFile& other) = delete;
+        GLBFile& operator=(GLBFile&& other) noexcept = delete;
+
+        // glTF is right handed, so positions, normals, tangents and the winding are flipped like ParseOBJ does,
+        // unless the file was written by Write (asset.extras.leftHanded)
+        // Missing tangents are generated with TangentSpace::Generate. Returns nullptr when the file is not a valid GLB
+        static std::unique_ptr<GLBFile> Open(const std::string& path, bool flipAxisAndWinding = true);
+
+        // Stores the vertices interleaved in the Vertex layout, so Open hands them out without a copy
+        static bool Write(const std::string& path, std::span<const Vertex> vertices, std::span<const uint32_t> indices);
+
+        // Views straight into the file when the layout already matched Vertex / uint32_t, repacked arrays otherwise
+        std::span<const Vertex> GetVertices() const { return m_Vertices; }
+        std::span<const uint32_t> GetIndices() const { return m_Indices; }
+        bool AreVerticesMapped() const { return m_OwnedVertices.empty() and !m_Vertices.empty(); }
+        bool AreIndicesMapped() const { return m_OwnedIndices.empty() and !m_Indices.empty(); }
+
+        const JsonValue& GetDocument() const { return m_Document; }
+        const std::vector<Primitive>& GetPrimitives() const { return m_Primitives; }
+        // Accessor.dataPtr is nullptr for invalid indices or accessors that are not stored in the BIN chunk
+        Accessor GetAccessor(int accessorIndex) const;
+
+        // Typed view when the accessor is tightly packed, aligned and of the given type, empty otherwise
+        template<typename T>
+        std::span<const T> GetSpan(int accessorIndex, uint32_t componentType, uint32_t numComponents) const
+        {
+            const Accessor accessor = GetAccessor(accessorIndex);
+            if (!accessor.dataPtr or accessor.componentType != componentType or accessor.numComponents != numComponents
+                or accessor.stride != sizeof(T) or accessor.GetElementSize() != sizeof(T)
+                or reinterpret_cast<uintptr_t>(accessor.dataPtr) % alignof(T) != 0)
+                return {};
+            return { reinterpret_cast<const T*>(accessor.dataPtr), accessor.count };
+        }
+
+        // Encoded image (PNG/JPEG) embedded in the BIN chunk, decode it with Texture::DecodeFromMemory
+        std::span<const char> GetImage(int imageIndex) const;
+
+    private:
+        GLBFile() = default;
+
+        bool Parse(bool flipAxisAndWinding);
+        std::span<const char> GetBufferView(int bufferViewIndex, size_t& stride) const;
+        // POSITION and NORMAL VEC3, TANGENT VEC4, TEXCOORD_0 VEC2, COLOR_0 VEC3 or VEC4 and SCALAR unsigned indices, the types glTF allows
+        // Primitives with other types are skipped, so ReadFloats never converts more than 4 values for them
+        bool HasValidAccessors(const Primitive& primitive) const;
+        bool MapVertices(const Primitive& primitive);
+        bool AppendPrimitive(Primitive& primitive, bool flipAxisAndWinding);
+
+        std::unique_ptr<MappedFile> m_MappedFilePtr{};
+        JsonValue m_Document{};
+        std::span<const char> m_BinaryChunk{};
+        std::vector<Primitive> m_Primitives{};
+
+        std::vector<Vertex> m_OwnedVertices{};
+        std::vector<uint32_t> m_OwnedIndices{};
+        std::span<const Vertex> m_Vertices{};
+        std::span<const uint32_t> m_Indices{};
+    };
+}
@@ -0,0 +1,21 @@
+#include "pch.h"
+#include "SoftwareRenderer.h"
+
+using namespace dae;
+
+//HeadlessRenderer <image.ppm> [--time T] [--pass 0-2] [--threads N] [--reference image.ppm] [--hash H] [--cooked folder] [--no-normal-map] [--no-firefx] [--no-hierarchical-depth]
+//The CMake target for machines without D3D11 or SDL, renders one frame like DirectX --headless does. The assets have to be cooked already
+int main(int argc, char* args[])
+{
+	if (argc < 2 or args[1][0] == '-')
+	{
+		std::cout << "Usage: HeadlessRenderer " << SoftwareRenderer::HeadlessArguments << '\n';
+		return 1;
+	}
+
+	SoftwareRenderer::HeadlessOptions options{};
+	options.outputPath = args[1];
+	if (!SoftwareRenderer::ParseHeadlessOptions({ args + 2, args + argc }, options))
+		return 1;
+	return SoftwareRenderer::RenderHeadless(options) ? 0 : 1;
+}
@@ -0,0 +1,370 @@
+#include "pch.h"
+#include "IndexCompression.h"
+
+#include <array>
+#include <cstring>
+
+namespace dae
+{
+	namespace IndexCompression
+	{
+		namespace
+		{
+			//Largest difference between two indices of a range that still fits in 16 bits
+			constexpr uint32_t MaxIndexSpan{ 65535 };
+
+			//Small differences of either sign become small unsigned values: 0, -1, 1, -2, 2... -> 0, 1, 2, 3, 4...
+			uint32_t ZigzagEncode(uint32_t difference)
+			{
+				return (difference << 1) ^ (0u - (difference >> 31));
+			}
+
+			uint32_t ZigzagDecode(uint32_t value)
+			{
+				return (value >> 1) ^ (0u - (value & 1));
+			}
+
+			//LEB128: seven bits per byte, lowest first, the top bit marks that another byte follows
+			void AppendVarint(std::string& bytes, uint32_t value)
+			{
+				while (value >= 0x80)
+				{
+					bytes.push_back(static_cast<char>((value & 0x7F) | 0x80));
+					value >>= 7;
+				}
+				bytes.push_back(static_cast<char>(value));
+			}
+
+			bool ReadVarint(const uint8_t*& bytePtr, const uint8_t* endPtr, uint32_t& value)
+			{
+				value = 0;
+				for (uint32_t shift = 0; ; shift += 7)
+				{
+					//A 32 bit value never needs more than 5 bytes
+					if (bytePtr == endPtr or shift > 28)
+						return false;
+
+					const uint8_t byte = *bytePtr++;
+					value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+					if ((byte & 0x80) == 0)
+						return true;
+				}
+			}
+
+			constexpr uint32_t NoVertex{ ~0u };
+
+			//Triangle codes below EdgeCodes reuse an edge, the high nibble is its age and the low nibble the code of the third vertex
+			constexpr uint8_t EdgeCodes{ 0xF0 };
+			//Three vertices that were never seen, in order
+			constexpr uint8_t NewTriangleCode{ 0xF0 };
+			//Followed by two bytes with the vertex codes of the corners: first, then second << 4 | third
+			constexpr uint8_t FreeTriangleCode{ 0xFF };
+
+			//Vertex codes: the next unseen vertex, one of the last 14 vertices that were new or explicit, or an explicit zigzag varint delta
+			constexpr uint8_t NextVertexCode{ 0 };
+			constexpr uint8_t ExplicitVertexCode{ 15 };
+			constexpr size_t MaxVertexAge{ 14 };
+			constexpr size_t MaxEdgeAge{ 15 };
+
+			struct Edge
+			{
+				uint32_t first{ NoVertex };
+				uint32_t second{ NoVertex };
+			};
+
+			//Ring buffer indexed by age, 0 is the entry pushed last
+			template<typename T, size_t Size>
+			struct Fifo
+			{
+				std::array<T, Size> entries{};
+				size_t offset{};
+
+				Fifo() { entries.fill(T{}); }
+				void Push(const T& entry) { entries[offset++ % Size] = entry; }
+				const T& operator[](size_t age) const { return entries[(offset - 1 - age) % Size]; }
+			};
+
+			//Edges the next triangles can start with: the triangle after x y z across its edge y z starts with z y, across z x with x z
+			struct TriangleState
+			{
+				Fifo<Edge, 16> edges{};
+				Fifo<uint32_t, 16> vertices{};
+				uint32_t next{};
+				uint32_t last{};
+
+				TriangleState() { vertices.entries.fill(NoVertex); }
+			};
+		}
+
+		bool NarrowIndices(std::span<const uint32_t> indices, size_t numVertices, std::vector<uint16_t>& narrowIndices, std::vector<IndexRange>& ranges)
+		{
+			const size_t maxRanges = 2 * (numVertices / (MaxIndexSpan + 1) + 1);
+			narrowIndices.resize(indices.size());
+			ranges.clear();
+
+			size_t rangeStart = 0;
+			uint32_t rangeMin = 0;
+			uint32_t rangeMax = 0;
+			const auto closeRange = [&](size_t rangeEnd)
+				{
+					for (size_t index = rangeStart; index < rangeEnd; ++index)
+						narrowIndices[index] = static_cast<uint16_t>(indices[index] - rangeMin);
+					ranges.push_back({ static_cast<uint32_t>(rangeStart), static_cast<uint32_t>(rangeEnd - rangeStart), static_cast<int32_t>(rangeMin) });
+				};
+
+			for (size_t first = 0; first < indices.size(); first += 3)
+			{
+				const size_t last = std::min(first + 3, indices.size());
+				uint32_t triangleMin = indices[first];
+				uint32_t triangleMax = indices[first];
+				for (size_t index = first + 1; index < last; ++index)
+				{
+					triangleMin = std::min(triangleMin, indices[index]);
+					triangleMax = std::max(triangleMax, indices[index]);
+				}
+				if (triangleMax - triangleMin > MaxIndexSpan)
+					return false;
+
+				if (first == rangeStart)
+				{
+					rangeMin = triangleMin;
+					rangeMax = triangleMax;
+					continue;
+				}
+
+				const uint32_t newMin = std::min(rangeMin, triangleMin);
+				const uint32_t newMax = std::max(rangeMax, triangleMax);
+				if (newMax - newMin <= MaxIndexSpan)
+				{
+					rangeMin = newMin;
+					rangeMax = newMax;
+					continue;
+				}
+
+				closeRange(first);
+				if (ranges.size() >= maxRanges)
+					return false;
+				rangeStart = first;
+				rangeMin = triangleMin;
+				rangeMax = triangleMax;
+			}
+
+			if (rangeStart < indices.size())
+				closeRange(indices.size());
+			return ranges.size() <= maxRanges;
+		}
+
+		std::string EncodeIndices(std::span<const uint32_t> indices)
+		{
+			std::string bytes{};
+			bytes.reserve(indices.size() + indices.size() / 8);
+
+			uint32_t previous = 0;
+			for (const uint32_t index : indices)
+			{
+				AppendVarint(bytes, ZigzagEncode(index - previous));
+				previous = index;
+			}
+			return bytes;
+		}
+
+		bool DecodeIndices(std::string_view bytes, std::span<uint32_t> indices)
+		{
+			const auto* bytePtr = reinterpret_cast<const uint8_t*>(bytes.data());
+			const auto* endPtr = bytePtr + bytes.size();
+
+			uint32_t previous = 0;
+			for (uint32_t& index : indices)
+			{
+				uint32_t value = 0;
+				if (!ReadVarint(bytePtr, endPtr, value))
+					return false;
+				previous += ZigzagDecode(value);
+				index = previous;
+			}
+			return bytePtr == endPtr;
+		}
+
+		std::string EncodeTriangles(std::span<const uint32_t> indices)
+		{
+			if (indices.size() % 3 != 0)
+				return {};
+
+			//Codes and vertex data are two streams, the codes go first behind their size
+			std::string codes{};
+			std::string data{};
+			codes.reserve(indices.size() / 3 + indices.size() / 24);
+
+			TriangleState state{};
+			const auto encodeVertex = [&state, &data](uint32_t vertex)
+				{
+					if (vertex == state.next)
+					{
+						++state.next;
+						state.vertices.Push(vertex);
+						return NextVertexCode;
+					}
+					for (size_t age = 0; age < MaxVertexAge; ++age)
+					{
+						if (state.vertices[age] == vertex)
+							return static_cast<uint8_t>(age + 1);
+					}
+					AppendVarint(data, ZigzagEncode(vertex - state.last));
+					state.last = vertex;
+					state.vertices.Push(vertex);
+					return ExplicitVertexCode;
+				};
+
+			for (size_t corner = 0; corner < indices.size(); corner += 3)
+			{
+				const uint32_t triangle[3]{ indices[corner], indices[corner + 1], indices[corner + 2] };
+
+				//The rotation with the cheapest third vertex among those that start with a recent edge, the youngest edge on a tie
+				size_t bestRotation = 0;
+				size_t bestAge = MaxEdgeAge;
+				int bestCost = 3;
+				for (size_t rotation = 0; rotation < 3; ++rotation)
+				{
+					const uint32_t first = triangle[rotation];
+					const uint32_t second = triangle[(rotation + 1) % 3];
+					const uint32_t third = triangle[(rotation + 2) % 3];
+					for (size_t age = 0; age < MaxEdgeAge; ++age)
+					{
+						if (state.edges[age].first != first or state.edges[age].second != second)
+							continue;
+
+						int cost = third == state.next ? 0 : 2;
+						for (size_t vertexAge = 0; cost == 2 and vertexAge < MaxVertexAge; ++vertexAge)
+							cost = state.vertices[vertexAge] == third ? 1 : 2;
+						if (cost < bestCost or (cost == bestCost and age < bestAge))
+						{
+							bestRotation = rotation;
+							bestAge = age;
+							bestCost = cost;
+						}
+						break;
+					}
+				}
+
+				if (bestAge < MaxEdgeAge)
+				{
+					const uint32_t first = triangle[bestRotation];
+					const uint32_t second = triangle[(bestRotation + 1) % 3];
+					const uint32_t third = triangle[(bestRotation + 2) % 3];
+					codes.push_back(static_cast<char>(bestAge << 4 | encodeVertex(third)));
+					state.edges.Push({ third, second });
+					state.edges.Push({ first, third });
+					continue;
+				}
+
+				const uint8_t firstCode = encodeVertex(triangle[0]);
+				const uint8_t secondCode = encodeVertex(triangle[1]);
+				const uint8_t thirdCode = encodeVertex(triangle[2]);
+				if (firstCode == NextVertexCode and secondCode == NextVertexCode and thirdCode == NextVertexCode)
+				{
+					codes.push_back(static_cast<char>(NewTriangleCode));
+				}
+				else
+				{
+					codes.push_back(static_cast<char>(FreeTriangleCode));
+					codes.push_back(static_cast<char>(firstCode));
+					codes.push_back(static_cast<char>(secondCode << 4 | thirdCode));
+				}
+				state.edges.Push({ triangle[1], triangle[0] });
+				state.edges.Push({ triangle[2], triangle[1] });
+				state.edges.Push({ triangle[0], triangle[2] });
+			}
+
+			std::string bytes(sizeof(uint32_t), '\0');
+			const uint32_t numCodeBytes = static_cast<uint32_t>(codes.size());
+			std::memcpy(bytes.data(), &numCodeBytes, sizeof(numCodeBytes));
+			bytes += codes;
+			bytes += data;
+			return bytes;
+		}
+
+		bool DecodeTriangles(std::string_view bytes, std::span<uint32_t> indices)
+		{
+			uint32_t numCodeBytes{};
+			if (indices.size() % 3 != 0 or bytes.size() < sizeof(numCodeBytes))
+				return false;
+			std::memcpy(&numCodeBytes, bytes.data(), sizeof(numCodeBytes));
+			if (bytes.size() - sizeof(numCodeBytes) < numCodeBytes)
+				return false;
+
+			const auto* codePtr = reinterpret_cast<const uint8_t*>(bytes.data()) + sizeof(numCodeBytes);
+			const auto* codeEndPtr = codePtr + numCodeBytes;
+			const auto* dataPtr = codeEndPtr;
+			const auto* endPtr = reinterpret_cast<const uint8_t*>(bytes.data()) + bytes.size();
+
+			TriangleState state{};
+			const auto decodeVertex = [&state, &dataPtr, endPtr](uint8_t code, uint32_t& vertex)
+				{
+					if (code == NextVertexCode)
+					{
+						vertex = state.next++;
+						state.vertices.Push(vertex);
+						return true;
+					}
+					if (code != ExplicitVertexCode)
+					{
+						vertex = state.vertices[code - 1];
+						return vertex != NoVertex;
+					}
+
+					uint32_t value{};
+					if (!ReadVarint(dataPtr, endPtr, value))
+						return false;
+					state.last += ZigzagDecode(value);
+					vertex = state.last;
+					state.vertices.Push(vertex);
+					return true;
+				};
+
+			for (size_t corner = 0; corner < indices.size(); corner += 3)
+			{
+				if (codePtr == codeEndPtr)
+					return false;
+
+				const uint8_t code = *codePtr++;
+				uint32_t* trianglePtr = indices.data() + corner;
+				if (code < EdgeCodes)
+				{
+					const Edge edge = state.edges[code >> 4];
+					if (edge.first == NoVertex or !decodeVertex(code & 15, trianglePtr[2]))
+						return false;
+					trianglePtr[0] = edge.first;
+					trianglePtr[1] = edge.second;
+					state.edges.Push({ trianglePtr[2], trianglePtr[1] });
+					state.edges.Push({ trianglePtr[0], trianglePtr[2] });
+					continue;
+				}
+
+				uint8_t vertexCodes[3]{ NextVertexCode, NextVertexCode, NextVertexCode };
+				if (code == FreeTriangleCode)
+				{
+					if (codeEndPtr - codePtr < 2)
+						return false;
+					vertexCodes[0] = codePtr[0] & 15;
+					vertexCodes[1] = codePtr[1] >> 4;
+					vertexCodes[2] = codePtr[1] & 15;
+					codePtr += 2;
+				}
+				else if (code != NewTriangleCode)
+				{
+					return false;
+				}
+
+				for (size_t vertex = 0; vertex < 3; ++vertex)
+				{
+					if (!decodeVertex(vertexCodes[vertex], trianglePtr[vertex]))
+						return false;
+				}
+				state.edges.Push({ trianglePtr[1], trianglePtr[0] });
+				state.edges.Push({ trianglePtr[2], trianglePtr[1] });
+				state.edges.Push({ trianglePtr[0], trianglePtr[2] });
+			}
+			return codePtr == codeEndPtr and dataPtr == endPtr;
+		}
+	}
+}
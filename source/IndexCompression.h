@@ -0,0 +1,41 @@
+#pragma once
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dae
+{
+	//Narrower index buffers for the GPU and a smaller index stream on disk
+	namespace IndexCompression
+	{
+		//Indices [firstIndex, firstIndex + numIndices) are drawn with DrawIndexed(numIndices, firstIndex, baseVertex)
+		struct IndexRange
+		{
+			uint32_t firstIndex{};
+			uint32_t numIndices{};
+			int32_t baseVertex{};
+		};
+
+		//Splits the triangles into consecutive ranges whose vertices lie within 65536 of each other and stores every index
+		//relative to the lowest vertex of its range. Vertex fetch optimized meshes reference their vertices in order,
+		//so they need about one range per 65536 vertices
+		//Returns false when a single triangle spans more than that, or when it would take more than twice the ranges numVertices needs at best,
+		//as more draws would cost more than the smaller index buffer saves
+		bool NarrowIndices(std::span<const uint32_t> indices, size_t numVertices, std::vector<uint16_t>& narrowIndices, std::vector<IndexRange>& ranges);
+
+		//Every index as the zigzag encoded difference to the one before it in LEB128 varints: one byte for a step of up to 63
+		//in either direction, which is nearly every step in vertex cache and vertex fetch optimized order
+		std::string EncodeIndices(std::span<const uint32_t> indices);
+		//Fails on truncated or corrupt data, or when bytes does not hold exactly indices.size() indices
+		bool DecodeIndices(std::string_view bytes, std::span<uint32_t> indices);
+
+		//Triangle codec in the style of meshoptimizer's index codec, about a byte per triangle in vertex cache and vertex fetch optimized order
+		//Every triangle is one code byte: an edge of a recent triangle plus the third vertex as the next unseen vertex, one of the last 14 new
+		//vertices or an explicit varint delta. Triangles may be rotated to start at a shared edge, the winding and triangle order are kept
+		//Returns an empty string when indices does not hold whole triangles
+		std::string EncodeTriangles(std::span<const uint32_t> indices);
+		//Fails on truncated or corrupt data, or when bytes does not hold exactly indices.size() / 3 triangles
+		bool DecodeTriangles(std::string_view bytes, std::span<uint32_t> indices);
+	}
+}
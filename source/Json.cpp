@@ -0,0 +1,261 @@
+#include "pch.h"
+#include "Json.h"
+
+#include <charconv>
+
+namespace dae
+{
+    namespace
+    {
+        constexpr int MaxDepth{ 256 };
+
+        void AppendUTF8(std::string& text, uint32_t codePoint)
+        {
+            if (codePoint < 0x80)
+            {
+                text += static_cast<char>(codePoint);
+            }
+            else if (codePoint < 0x800)
+            {
+                text += static_cast<char>(0xC0 | (codePoint >> 6));
+                text += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else if (codePoint < 0x10000)
+            {
+                text += static_cast<char>(0xE0 | (codePoint >> 12));
+                text += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                text += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else
+            {
+                text += static_cast<char>(0xF0 | (codePoint >> 18));
+                text += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+                text += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                text += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+        }
+    }
+
+    // Recursive descent over the text, every Parse function leaves m_Pos right after what it read
+    class JsonParser
+    {
+    public:
+        explicit JsonParser(std::string_view text) : m_Pos{ text.data() }, m_End{ text.data() + text.size() } {}
+
+        bool ParseDocument(JsonValue& value)
+        {
+            if (!ParseValue(value, 0))
+                return false;
+            SkipWhitespace();
+            return m_Pos == m_End;
+        }
+
+    private:
+        const char* m_Pos;
+        const char* m_End;
+
+        void SkipWhitespace()
+        {
+            while (m_Pos < m_End and (*m_Pos == ' ' or *m_Pos == '\t' or *m_Pos == '\n' or *m_Pos == '\r'))
+                ++m_Pos;
+        }
+
+        bool Consume(std::string_view token)
+        {
+            if (static_cast<size_t>(m_End - m_Pos) < token.size() or std::string_view{ m_Pos, token.size() } != token)
+                return false;
+            m_Pos += token.size();
+            return true;
+        }
+
+        bool ParseValue(JsonValue& value, int depth)
+        {
+            if (depth > MaxDepth)
+                return false;
+
+            SkipWhitespace();
+            if (m_Pos == m_End)
+                return false;
+
+            switch (*m_Pos)
+            {
+            case '{': return ParseObject(value, depth);
+            case '[': return ParseArray(value, depth);
+            case '"':
+                value.m_Type = JsonValue::Type::String;
+                return ParseString(value.m_String);
+            case 't':
+                value.m_Type = JsonValue::Type::Bool;
+                value.m_Bool = true;
+                return Consume("true");
+            case 'f':
+                value.m_Type = JsonValue::Type::Bool;
+                value.m_Bool = false;
+                return Consume("false");
+            case 'n':
+                return Consume("null");
+            default:
+                return ParseNumber(value);
+            }
+        }
+
+        bool ParseNumber(JsonValue& value)
+        {
+            const std::from_chars_result result = std::from_chars(m_Pos, m_End, value.m_Number);
+            if (result.ec != std::errc{})
+                return false;
+
+            value.m_Type = JsonValue::Type::Number;
+            m_Pos = result.ptr;
+            return true;
+        }
+
+        bool ParseHex4(uint32_t& codeUnit)
+        {
+            if (m_End - m_Pos < 4)
+                return false;
+
+            const std::from_chars_result result = std::from_chars(m_Pos, m_Pos + 4, codeUnit, 16);
+            if (result.ec != std::errc{} or result.ptr != m_Pos + 4)
+                return false;
+
+            m_Pos += 4;
+            return true;
+        }
+
+        bool ParseString(std::string& text)
+        {
+            ++m_Pos;
+            while (m_Pos < m_End and *m_Pos != '"')
+            {
+                if (*m_Pos != '\\')
+                {
+                    text += *m_Pos++;
+                    continue;
+                }
+
+                if (++m_Pos == m_End)
+                    return false;
+
+                switch (*m_Pos++)
+                {
+                case '"': text += '"'; break;
+                case '\\': text += '\\'; break;
+                case '/': text += '/'; break;
+                case 'b': text += '\b'; break;
+                case 'f': text += '\f'; break;
+                case 'n': text += '\n'; break;
+                case 'r': text += '\r'; break;
+                case 't': text += '\t'; break;
+                case 'u':
+                {
+                    uint32_t codePoint{};
+                    if (!ParseHex4(codePoint))
+                        return false;
+
+                    // A high surrogate has to be followed by the low half of the pair
+                    if (codePoint >= 0xD800 and codePoint < 0xDC00)
+                    {
+                        uint32_t lowSurrogate{};
+                        if (!Consume("\\u") or !ParseHex4(lowSurrogate) or lowSurrogate < 0xDC00 or lowSurrogate >= 0xE000)
+                            return false;
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+                    }
+                    AppendUTF8(text, codePoint);
+                    break;
+                }
+                default:
+                    return false;
+                }
+            }
+
+            if (m_Pos == m_End)
+                return false;
+            ++m_Pos;
+            return true;
+        }
+
+        bool ParseArray(JsonValue& value, int depth)
+        {
+            value.m_Type = JsonValue::Type::Array;
+            ++m_Pos;
+
+            SkipWhitespace();
+            if (Consume("]"))
+                return true;
+
+            while (true)
+            {
+                if (!ParseValue(value.m_Elements.emplace_back(), depth + 1))
+                    return false;
+
+                SkipWhitespace();
+                if (Consume("]"))
+                    return true;
+                if (!Consume(","))
+                    return false;
+            }
+        }
+
+        bool ParseObject(JsonValue& value, int depth)
+        {
+            value.m_Type = JsonValue::Type::Object;
+            ++m_Pos;
+
+            SkipWhitespace();
+            if (Consume("}"))
+                return true;
+
+            while (true)
+            {
+                SkipWhitespace();
+                if (m_Pos == m_End or *m_Pos != '"')
+                    return false;
+
+                std::pair<std::string, JsonValue>& member = value.m_Members.emplace_back();
+                if (!ParseString(member.first))
+                    return false;
+
+                SkipWhitespace();
+                if (!Consume(":") or !ParseValue(member.second, depth + 1))
+                    return false;
+
+                SkipWhitespace();
+                if (Consume("}"))
+                    return true;
+                if (!Consume(","))
+                    return false;
+            }
+        }
+    };
+
+    bool JsonValue::Parse(std::string_view text, JsonValue& value)
+    {
+        value = JsonValue{};
+        if (JsonParser{ text }.ParseDocument(value))
+            return true;
+
+        value = JsonValue{};
+        return false;
+    }
+
+    const JsonValue& JsonValue::operator[](size_t index) const
+    {
+        static const JsonValue null{};
+        return m_Type == Type::Array and index < m_Elements.size() ? m_Elements[index] : null;
+    }
+
+    const JsonValue& JsonValue::operator[](std::string_view key) const
+    {
+        static const JsonValue null{};
+        if (m_Type != Type::Object)
+            return null;
+
+        for (const std::pair<std::string, JsonValue>& member : m_Members)
+        {
+            if (member.first == key)
+                return member.second;
+        }
+        return null;
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace dae
+{
+    // Minimal JSON document, enough for the glTF headers and the asset manifests
+    // Lookups never fail: a missing key or index returns a null value, so chains like doc["a"][0]["b"] are safe
+    class JsonValue
+    {
+    public:
+        enum class Type
+        {
+            Null,
+            Bool,
+            Number,
+            String,
+            Array,
+            Object,
+        };
+
+        // Returns false (and leaves value null) on malformed input
+        static bool Parse(std::string_view text, JsonValue& value);
+
+        Type GetType() const { return m_Type; }
+        bool IsNull() const { return m_Type == Type::Null; }
+        bool IsNumber() const { return m_Type == Type::Number; }
+        bool IsString() const { return m_Type == Type::String; }
+        bool IsArray() const { return m_Type == Type::Array; }
+        bool IsObject() const { return m_Type == Type::Object; }
+
+        bool GetBool(bool defaultValue = false) const { return m_Type == Type::Bool ? m_Bool : defaultValue; }
+        double GetNumber(double defaultValue = 0.0) const { return m_Type == Type::Number ? m_Number : defaultValue; }
+        int64_t GetInt(int64_t defaultValue = 0) const { return m_Type == Type::Number ? static_cast<int64_t>(m_Number) : defaultValue; }
+        const std::string& GetString() const { return m_String; }
+
+        // Number of array elements or object members
+        size_t GetSize() const { return m_Type == Type::Array ? m_Elements.size() : m_Members.size(); }
+        const std::vector<JsonValue>& GetElements() const { return m_Elements; }
+        const std::vector<std::pair<std::string, JsonValue>>& GetMembers() const { return m_Members; }
+
+        const JsonValue& operator[](size_t index) const;
+        const JsonValue& operator[](std::string_view key) const;
+        bool Contains(std::string_view key) const { return !(*this)[key].IsNull(); }
+
+    private:
+        friend class JsonParser;
+
+        Type m_Type = Type::Null;
+        bool m_Bool = false;
+        double m_Number = 0.0;
+        std::string m_String{};
+        std::vector<JsonValue> m_Elements{};
+        std::vector<std::pair<std::string, JsonValue>> m_Members{};
+    };
+}
@@ -0,0 +1,86 @@
+#include "pch.h"
+#include "MappedFile.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dae
+{
+#if defined(_WIN32)
+    MappedFile::MappedFile(const std::string& path)
+    {
+        m_FileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_FileHandle == INVALID_HANDLE_VALUE)
+        {
+            m_FileHandle = nullptr;
+            return;
+        }
+
+        LARGE_INTEGER fileSize{};
+        if (!GetFileSizeEx(m_FileHandle, &fileSize))
+            return;
+
+        m_Size = static_cast<size_t>(fileSize.QuadPart);
+        m_IsOpen = true;
+
+        // Windows refuses to map empty files, an empty view is still a valid result
+        if (m_Size == 0)
+            return;
+
+        m_MappingHandle = CreateFileMappingA(m_FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!m_MappingHandle)
+        {
+            m_IsOpen = false;
+            return;
+        }
+
+        m_DataPtr = static_cast<const char*>(MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+        if (!m_DataPtr)
+            m_IsOpen = false;
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (m_DataPtr) UnmapViewOfFile(m_DataPtr);
+        if (m_MappingHandle) CloseHandle(m_MappingHandle);
+        if (m_FileHandle) CloseHandle(m_FileHandle);
+    }
+#else
+    MappedFile::MappedFile(const std::string& path)
+    {
+        m_FileDescriptor = open(path.c_str(), O_RDONLY);
+        if (m_FileDescriptor < 0)
+            return;
+
+        struct stat fileStat {};
+        if (fstat(m_FileDescriptor, &fileStat) != 0)
+            return;
+
+        m_Size = static_cast<size_t>(fileStat.st_size);
+        m_IsOpen = true;
+
+        if (m_Size == 0)
+            return;
+
+        void* dataPtr = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, m_FileDescriptor, 0);
+        if (dataPtr == MAP_FAILED)
+        {
+            m_IsOpen = false;
+            return;
+        }
+
+        madvise(dataPtr, m_Size, MADV_SEQUENTIAL);
+        m_DataPtr = static_cast<const char*>(dataPtr);
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (m_DataPtr) munmap(const_cast<char*>(m_DataPtr), m_Size);
+        if (m_FileDescriptor >= 0) close(m_FileDescriptor);
+    }
+#endif
+}
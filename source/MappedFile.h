@@ -0,0 +1,36 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+namespace dae
+{
+    // Read-only view of a whole file mapped into the address space
+    class MappedFile
+    {
+    public:
+        MappedFile(const std::string& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile& other) = delete;
+        MappedFile(MappedFile&& other) noexcept = delete;
+        MappedFile& operator=(const MappedFile& other) = delete;
+        MappedFile& operator=(MappedFile&& other) noexcept = delete;
+
+        bool IsOpen() const { return m_IsOpen; }
+        const char* GetData() const { return m_DataPtr; }
+        size_t GetSize() const { return m_Size; }
+        std::string_view GetView() const { return { m_DataPtr, m_Size }; }
+
+    private:
+        const char* m_DataPtr = nullptr;
+        size_t m_Size = 0;
+        bool m_IsOpen = false;
+
+#if defined(_WIN32)
+        void* m_FileHandle = nullptr;
+        void* m_MappingHandle = nullptr;
+#else
+        int m_FileDescriptor = -1;
+#endif
+    };
+}
@@ -1,20 +1,124 @@
 #include "pch.h"
 #include "Mesh.h"
 #include "Effect.h"
+#include "Meshlets.h"
+#include "Simplifier.h"
 #include "Texture.h"
+#include "VertexQuantization.h"
 
 #include <cassert>
 
 namespace dae
 {
     Mesh::Mesh(ID3D11Device* devicePtr, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+        : Mesh(devicePtr, std::span<const Vertex>{ vertices }, std::span<const uint32_t>{ indices })
+    {
+    }
+
+    Mesh::Mesh(ID3D11Device* devicePtr, std::span<const Vertex> vertices, std::span<const uint32_t> indices)
+        : Mesh(devicePtr, new Effect(devicePtr, L"Resources/PosCol3D.fx"), vertices, indices)
+    {
+    }
+
+    Mesh::Mesh(ID3D11Device* devicePtr, Effect* effectPtr, std::span<const Vertex> vertices, std::span<const uint32_t> indices)
+        : m_DevicePtr{ devicePtr }
+        , m_EffectPtr{ effectPtr }
+    {
+        //Create Vertex Layout
+        static constexpr uint32_t numElements{ 5 };
+        D3D11_INPUT_ELEMENT_DESC vertexDesc[numElements]{};
+
+        vertexDesc[0].SemanticName = "POSITION";
+        vertexDesc[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+        vertexDesc[0].AlignedByteOffset = 0;
+        vertexDesc[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+
+        vertexDesc[1].SemanticName = "COLOR";
+        vertexDesc[1].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+        vertexDesc[1].AlignedByteOffset = 12;
+        vertexDesc[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+
+        vertexDesc[2].SemanticName = "TEXCOORD";
+        vertexDesc[2].Format = DXGI_FORMAT_R32G32_FLOAT;
+        vertexDesc[2].AlignedByteOffset = 24;
+        vertexDesc[2].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+
+        vertexDesc[3].SemanticName = "NORMAL";
+        vertexDesc[3].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+        vertexDesc[3].AlignedByteOffset = 32;
+        vertexDesc[3].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+
+        vertexDesc[4].SemanticName = "TANGENT";
+        vertexDesc[4].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+        vertexDesc[4].AlignedByteOffset = 44;
+        vertexDesc[4].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+
+        Initialize("DefaultTechnique", vertexDesc, vertices.data(), sizeof(Vertex), vertices.size(), indices);
+        ComputeBounds(vertices.size(), [vertices](size_t vertex) { return vertices[vertex].position; });
+    }
+
+    Mesh::Mesh(ID3D11Device* devicePtr, Effect* effectPtr, std::vector<Vertex>&& vertices, std::vector<uint32_t>&& indices, bool keepGeometry)
+        : Mesh(devicePtr, effectPtr, std::span<const Vertex>{ vertices }, std::span<const uint32_t>{ indices })
+    {
+        if (keepGeometry)
+        {
+            m_Vertices = std::move(vertices);
+            m_Indices = std::move(indices);
+        }
+        else
+        {
+            vertices = {};
+            indices = {};
+        }
+    }
+
+    Mesh::Mesh(ID3D11Device* devicePtr, Effect* effectPtr, std::span<const PackedVertex> vertices, const PositionQuantization& quantization, std::span<const uint32_t> indices)
         : m_DevicePtr{ devicePtr }
-        , m_Vertices{ vertices }
-        , m_Indices{ indices }
+        , m_EffectPtr{ effectPtr }
+    {
+        //Create Vertex Layout
+        static constexpr uint32_t numElements{ 4 };
+        D3D11_INPUT_ELEMENT_DESC vertexDesc[numElements]{};
+
+        vertexDesc[0].SemanticName = "POSITION";
+        vertexDesc[0].Format = DXGI_FORMAT_R16G16B16A16_UNORM;
+        vertexDesc[0].AlignedByteOffset = 0;
+        vertexDesc[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+
+        vertexDesc[1].SemanticName = "TEXCOORD";
+        vertexDesc[1].Format = DXGI_FORMAT_R16G16_FLOAT;
+        vertexDesc[1].AlignedByteOffset = 8;
+        vertexDesc[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+
+        vertexDesc[2].SemanticName = "NORMAL";
+        vertexDesc[2].Format = DXGI_FORMAT_R16G16_SNORM;
+        vertexDesc[2].AlignedByteOffset = 12;
+        vertexDesc[2].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+
+        vertexDesc[3].SemanticName = "TANGENT";
+        vertexDesc[3].Format = DXGI_FORMAT_R16G16_SNORM;
+        vertexDesc[3].AlignedByteOffset = 16;
+        vertexDesc[3].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+
+        Initialize("PackedTechnique", vertexDesc, vertices.data(), sizeof(PackedVertex), vertices.size(), indices);
+        // The decoded positions, not the quantization range, which can be a little larger
+        ComputeBounds(vertices.size(), [vertices, &quantization](size_t vertex) { return VertexQuantization::UnpackPosition(vertices[vertex], quantization); });
+
+        //Position decode, the effect belongs to this mesh so it is set once
+        ID3DX11EffectVectorVariable* positionOffsetPtr = m_EffectPtr->GetVariableByName("gPositionOffset")->AsVector();
+        ID3DX11EffectVectorVariable* positionScalePtr = m_EffectPtr->GetVariableByName("gPositionScale")->AsVector();
+        if (!positionOffsetPtr->IsValid() or !positionScalePtr->IsValid())
+            assert(false and "Failed to find the position quantization!");
+
+        positionOffsetPtr->SetFloatVector(reinterpret_cast<const float*>(&quantization.offset));
+        positionScalePtr->SetFloatVector(reinterpret_cast<const float*>(&quantization.scale));
+    }
+
+    void Mesh::Initialize(const char* techniqueName, std::span<const D3D11_INPUT_ELEMENT_DESC> vertexDesc, const void* verticesPtr, UINT vertexStride, size_t numVertices,
+        std::span<const uint32_t> indices)
     {
         // Shader
-        m_EffectPtr = new Effect(m_DevicePtr, L"Resources/PosCol3D.fx");
-        m_TechniquePtr = m_EffectPtr->GetTechniqueByName("DefaultTechnique");
+        m_TechniquePtr = m_EffectPtr->GetTechniqueByName(techniqueName);
         if (!m_TechniquePtr->IsValid())
             assert(false and "Technique not valid!");
 
@@ -55,42 +159,13 @@ namespace dae
 
         m_DevicePtr->GetImmediateContext(&m_DeviceContextPtr);
 
-        //Create Vertex Layout
-        static constexpr uint32_t numElements{ 5 };
-        D3D11_INPUT_ELEMENT_DESC vertexDesc[numElements]{};
-
-        vertexDesc[0].SemanticName = "POSITION";
-        vertexDesc[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-        vertexDesc[0].AlignedByteOffset = 0;
-        vertexDesc[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-
-        vertexDesc[1].SemanticName = "COLOR";
-        vertexDesc[1].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-        vertexDesc[1].AlignedByteOffset = 12;
-        vertexDesc[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-
-        vertexDesc[2].SemanticName = "TEXCOORD";
-        vertexDesc[2].Format = DXGI_FORMAT_R32G32_FLOAT;
-        vertexDesc[2].AlignedByteOffset = 24;
-        vertexDesc[2].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-
-        vertexDesc[3].SemanticName = "NORMAL";
-        vertexDesc[3].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-        vertexDesc[3].AlignedByteOffset = 32;
-        vertexDesc[3].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-
-        vertexDesc[4].SemanticName = "TANGENT";
-        vertexDesc[4].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-        vertexDesc[4].AlignedByteOffset = 44;
-        vertexDesc[4].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-
         //Create Input Layout
         D3DX11_PASS_DESC passDesc{};
         m_TechniquePtr->GetPassByIndex(0)->GetDesc(&passDesc);
 
         HRESULT result = m_DevicePtr->CreateInputLayout(
-            vertexDesc,
-            numElements,
+            vertexDesc.data(),
+            static_cast<UINT>(vertexDesc.size()),
             passDesc.pIAInputSignature,
             passDesc.IAInputSignatureSize,
             &m_InputLayoutPtr);
@@ -101,26 +176,35 @@ namespace dae
         //Create vertex buffer
         D3D11_BUFFER_DESC bd{};
         bd.Usage = D3D11_USAGE_IMMUTABLE;
-        bd.ByteWidth = sizeof(Vertex) * static_cast<uint32_t>(m_Vertices.size());
+        m_VertexStride = vertexStride;
+        m_VertexBufferBytes = numVertices * vertexStride;
+        bd.ByteWidth = static_cast<uint32_t>(m_VertexBufferBytes);
         bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
         bd.CPUAccessFlags = 0;
         bd.MiscFlags = 0;
 
         D3D11_SUBRESOURCE_DATA initData{};
-        initData.pSysMem = m_Vertices.data();
+        initData.pSysMem = verticesPtr;
 
         result = m_DevicePtr->CreateBuffer(&bd, &initData, &m_VertexBufferPtr);
         if (FAILED(result))
             assert(false and "Failed to create vertex buffer!");
 
-        // Create index buffer
-        m_NumIndices = static_cast<uint32_t>(m_Indices.size());
+        // Create index buffer, 16 bit whenever IndexCompression can split the indices into few enough ranges
+        m_NumIndices = static_cast<uint32_t>(indices.size());
+        std::vector<uint16_t> narrowIndices{};
+        const bool isNarrow = IndexCompression::NarrowIndices(indices, numVertices, narrowIndices, m_IndexRanges);
+        if (!isNarrow)
+            m_IndexRanges = { { 0, m_NumIndices, 0 } };
+        m_IndexFormat = isNarrow ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+
         bd.Usage = D3D11_USAGE_IMMUTABLE;
-        bd.ByteWidth = sizeof(uint32_t) * m_NumIndices;
+        m_IndexBufferBytes = (isNarrow ? sizeof(uint16_t) : sizeof(uint32_t)) * m_NumIndices;
+        bd.ByteWidth = static_cast<uint32_t>(m_IndexBufferBytes);
         bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
         bd.CPUAccessFlags = 0;
         bd.MiscFlags = 0;
-        initData.pSysMem = m_Indices.data();
+        initData.pSysMem = isNarrow ? static_cast<const void*>(narrowIndices.data()) : indices.data();
         result = m_DevicePtr->CreateBuffer(&bd, &initData, &m_IndexBufferPtr);
         if (FAILED(result))
             assert(false and "Failed to create index buffer!");
@@ -156,51 +240,258 @@ namespace dae
         m_DeviceContextPtr->IASetInputLayout(m_InputLayoutPtr);
 
         //3. Set VertexBuffer
-        constexpr UINT stride = sizeof(Vertex);
         constexpr UINT offset = 0;
-        m_DeviceContextPtr->IASetVertexBuffers(0, 1, &m_VertexBufferPtr, &stride, &offset);
+        m_DeviceContextPtr->IASetVertexBuffers(0, 1, &m_VertexBufferPtr, &m_VertexStride, &offset);
 
         //4. Set IndexBuffer
-        m_DeviceContextPtr->IASetIndexBuffer(m_IndexBufferPtr, DXGI_FORMAT_R32_UINT, 0);
+        m_DeviceContextPtr->IASetIndexBuffer(m_IndexBufferPtr, m_IndexFormat, 0);
 
         //5. Draw
         D3DX11_TECHNIQUE_DESC techDesc;
         m_TechniquePtr->GetDesc(&techDesc);
-        if (m_PassIdx < techDesc.Passes)
+        if (m_PassIdx >= techDesc.Passes)
+            return;
+
+        ID3DX11EffectPass* passPtr = m_TechniquePtr->GetPassByIndex(m_PassIdx);
+        const LevelOfDetail* levelPtr = m_LevelOfDetail > 0 ? &m_LevelsOfDetail[m_LevelOfDetail - 1] : nullptr;
+        if (m_Submeshes.empty())
+        {
+            passPtr->Apply(0, m_DeviceContextPtr);
+            if (levelPtr)
+                DrawIndices(levelPtr->submeshRanges.front().firstIndex, levelPtr->submeshRanges.front().numIndices);
+            else
+                DrawVisibleIndices(0, m_NumIndices);
+            return;
+        }
+
+        // Apply binds the shader resources, so the textures have to be set before every submesh
+        for (size_t submeshIndex = 0; submeshIndex < m_Submeshes.size(); ++submeshIndex)
+        {
+            const Submesh& submesh = m_Submeshes[submeshIndex];
+            for (size_t slot = 0; slot < NumTextureSlots; ++slot)
+            {
+                const Texture* texturePtr = submesh.texturePtrs[slot] ? submesh.texturePtrs[slot] : m_DefaultTexturePtrs[slot];
+                SetTexture(static_cast<TextureSlot>(slot), texturePtr);
+            }
+            passPtr->Apply(0, m_DeviceContextPtr);
+            if (levelPtr)
+                DrawIndices(levelPtr->submeshRanges[submeshIndex].firstIndex, levelPtr->submeshRanges[submeshIndex].numIndices);
+            else
+                DrawVisibleIndices(submesh.firstIndex, submesh.numIndices);
+        }
+    }
+
+    void Mesh::DrawIndices(uint32_t firstIndex, uint32_t numIndices) const
+    {
+        // One draw for every index range the requested indices overlap
+        const uint32_t endIndex = firstIndex + numIndices;
+        for (const IndexCompression::IndexRange& range : m_IndexRanges)
+        {
+            const uint32_t rangeStart = std::max(firstIndex, range.firstIndex);
+            const uint32_t rangeEnd = std::min(endIndex, range.firstIndex + range.numIndices);
+            if (rangeStart < rangeEnd)
+                m_DeviceContextPtr->DrawIndexed(rangeEnd - rangeStart, rangeStart, range.baseVertex);
+        }
+    }
+
+    void Mesh::DrawVisibleIndices(uint32_t firstIndex, uint32_t numIndices) const
+    {
+        if (m_Meshlets.empty())
+        {
+            DrawIndices(firstIndex, numIndices);
+            return;
+        }
+
+        const uint32_t endIndex = firstIndex + numIndices;
+        for (const IndexCompression::IndexRange& range : m_VisibleRanges)
         {
-            m_TechniquePtr->GetPassByIndex(m_PassIdx)->Apply(0, m_DeviceContextPtr);
-            m_DeviceContextPtr->DrawIndexed(m_NumIndices, 0, 0);
+            const uint32_t rangeStart = std::max(firstIndex, range.firstIndex);
+            const uint32_t rangeEnd = std::min(endIndex, range.firstIndex + range.numIndices);
+            if (rangeStart < rangeEnd)
+                DrawIndices(rangeStart, rangeEnd - rangeStart);
         }
     }
 
+    void Mesh::SetMeshlets(std::vector<Meshlets::Meshlet> meshlets)
+    {
+        m_Meshlets = std::move(meshlets);
+        ResetMeshletCulling();
+    }
+
+    uint32_t Mesh::CullMeshlets(const Matrix& worldViewProjection, const Vector3& cameraPosition, bool cullBackFaces)
+    {
+        m_VisibleRanges.clear();
+        const Meshlets::Frustum frustum = Meshlets::ExtractFrustum(worldViewProjection);
+
+        uint32_t numVisibleIndices = 0;
+        for (const Meshlets::Meshlet& meshlet : m_Meshlets)
+        {
+            if (Meshlets::IsOutsideFrustum(meshlet, frustum) or (cullBackFaces and Meshlets::IsBackFacing(meshlet, cameraPosition)))
+                continue;
+
+            numVisibleIndices += meshlet.numIndices;
+            if (!m_VisibleRanges.empty() and m_VisibleRanges.back().firstIndex + m_VisibleRanges.back().numIndices == meshlet.firstIndex)
+                m_VisibleRanges.back().numIndices += meshlet.numIndices;
+            else
+                m_VisibleRanges.push_back({ meshlet.firstIndex, meshlet.numIndices, 0 });
+        }
+        return numVisibleIndices / 3;
+    }
+
+    void Mesh::ResetMeshletCulling()
+    {
+        // Meshlets follow each other through the submeshes, so everything is one range
+        m_VisibleRanges.clear();
+        if (!m_Meshlets.empty())
+            m_VisibleRanges.push_back({ m_Meshlets.front().firstIndex, m_Meshlets.back().firstIndex + m_Meshlets.back().numIndices - m_Meshlets.front().firstIndex, 0 });
+    }
+
+    void Mesh::AddLevelOfDetail(float error, std::vector<IndexCompression::IndexRange> submeshRanges)
+    {
+        assert(submeshRanges.size() == std::max<size_t>(m_Submeshes.size(), 1) and "Level of detail needs one range per submesh!");
+        m_LevelsOfDetail.push_back({ std::move(submeshRanges) });
+        m_LevelErrors.push_back(error);
+    }
+
+    template<typename GetPosition>
+    void Mesh::ComputeBounds(size_t numVertices, const GetPosition& getPosition)
+    {
+        if (numVertices == 0)
+            return;
+
+        m_BoundsMin = m_BoundsMax = getPosition(0);
+        for (size_t vertex = 1; vertex < numVertices; ++vertex)
+        {
+            const Vector3 position = getPosition(vertex);
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                m_BoundsMin[axis] = std::min(m_BoundsMin[axis], position[axis]);
+                m_BoundsMax[axis] = std::max(m_BoundsMax[axis], position[axis]);
+            }
+        }
+
+        // Tighter than half the diagonal, the corners of the box are rarely all taken
+        m_BoundsCenter = (m_BoundsMin + m_BoundsMax) * 0.5f;
+        m_BoundsRadius = 0.f;
+        for (size_t vertex = 0; vertex < numVertices; ++vertex)
+            m_BoundsRadius = std::max(m_BoundsRadius, (getPosition(vertex) - m_BoundsCenter).SqrMagnitude());
+        m_BoundsRadius = std::sqrt(m_BoundsRadius);
+    }
+
+    void Mesh::BuildBVH(std::span<const Vector3> positions, std::span<const uint32_t> indices, uint32_t numThreads)
+    {
+        m_BVHPtr = std::make_unique<BVH::Tree>(BVH::Build(indices, positions, numThreads));
+    }
+
+    std::optional<BVH::Hit> Mesh::Raycast(const BVH::Ray& ray) const
+    {
+        if (!m_BVHPtr)
+            return std::nullopt;
+        return BVH::IntersectClosest(*m_BVHPtr, ray);
+    }
+
+    bool Mesh::IsRayBlocked(const BVH::Ray& ray) const
+    {
+        return m_BVHPtr and BVH::IntersectAny(*m_BVHPtr, ray);
+    }
+
+    Mesh::MemoryUsage Mesh::GetMemoryUsage() const
+    {
+        MemoryUsage usage{};
+        usage.gpuBytes = m_VertexBufferBytes + m_IndexBufferBytes;
+
+        // Capacities, that is what the allocations hold on to
+        usage.cpuBytes = m_Vertices.capacity() * sizeof(Vertex) + m_Indices.capacity() * sizeof(uint32_t)
+            + m_Meshlets.capacity() * sizeof(Meshlets::Meshlet) + (m_IndexRanges.capacity() + m_VisibleRanges.capacity()) * sizeof(IndexCompression::IndexRange)
+            + m_Submeshes.capacity() * sizeof(Submesh) + m_LevelsOfDetail.capacity() * sizeof(LevelOfDetail)
+            + m_LevelErrors.capacity() * sizeof(float);
+        for (const LevelOfDetail& level : m_LevelsOfDetail)
+            usage.cpuBytes += level.submeshRanges.capacity() * sizeof(IndexCompression::IndexRange);
+        if (m_BVHPtr)
+        {
+            usage.cpuBytes += sizeof(BVH::Tree) + m_BVHPtr->nodes.capacity() * sizeof(BVH::Node)
+                + m_BVHPtr->triangles.capacity() * sizeof(BVH::Triangle) + m_BVHPtr->triangleIndices.capacity() * sizeof(uint32_t);
+        }
+        return usage;
+    }
+
+    size_t Mesh::SelectLevelOfDetail(const Vector3& cameraPosition, float projectionScale, float viewportHeight, float maxPixelError)
+    {
+        if (m_ForcedLevelOfDetail)
+        {
+            m_LevelOfDetail = std::min(*m_ForcedLevelOfDetail, m_LevelsOfDetail.size());
+            return m_LevelOfDetail;
+        }
+
+        // The nearest point of the bounding sphere, inside it everything is at full detail
+        const float distance = std::max((cameraPosition - m_BoundsCenter).Magnitude() - m_BoundsRadius, 0.f);
+
+        m_LevelOfDetail = Simplifier::SelectLevelOfDetail(m_LevelErrors, distance, projectionScale, viewportHeight, maxPixelError);
+        return m_LevelOfDetail;
+    }
+
+    void Mesh::ForceLevelOfDetail(std::optional<size_t> level)
+    {
+        m_ForcedLevelOfDetail = level;
+        if (level)
+            m_LevelOfDetail = std::min(*level, m_LevelsOfDetail.size());
+    }
+
     void Mesh::UpdateMatrix(const Matrix& viewMatrix, const Matrix& projectionMatrix) const
     {
         const Matrix worldViewProjectionMatrix = viewMatrix * projectionMatrix;
         m_WorldViewProjectionMatrixPtr->SetMatrix(reinterpret_cast<const float*>(&worldViewProjectionMatrix));
     }
 
-    void Mesh::SetDiffuseMap(const Texture* diffuseTexturePtr) const
+    void Mesh::SetDiffuseMap(const Texture* diffuseTexturePtr)
+    {
+        m_DefaultTexturePtrs[static_cast<size_t>(TextureSlot::Diffuse)] = diffuseTexturePtr;
+        SetTexture(TextureSlot::Diffuse, diffuseTexturePtr);
+    }
+
+    void Mesh::SetNormalMap(const Texture* normalMapTexturePtr)
+    {
+        m_DefaultTexturePtrs[static_cast<size_t>(TextureSlot::Normal)] = normalMapTexturePtr;
+        SetTexture(TextureSlot::Normal, normalMapTexturePtr);
+    }
+
+    void Mesh::SetSpecularMap(const Texture* specularTexturePtr)
+    {
+        m_DefaultTexturePtrs[static_cast<size_t>(TextureSlot::Specular)] = specularTexturePtr;
+        SetTexture(TextureSlot::Specular, specularTexturePtr);
+    }
+
+    void Mesh::SetGlossinessMap(const Texture* glossinessTexturePtr)
     {
-        if (diffuseTexturePtr)
-            m_DiffuseMapPtr->SetResource(diffuseTexturePtr->GetSRV());
+        m_DefaultTexturePtrs[static_cast<size_t>(TextureSlot::Glossiness)] = glossinessTexturePtr;
+        SetTexture(TextureSlot::Glossiness, glossinessTexturePtr);
     }
 
-    void Mesh::SetNormalMap(const Texture* normalMapTexturePtr) const
+    uint32_t Mesh::AddSubmesh(uint32_t firstIndex, uint32_t numIndices)
     {
-        if (normalMapTexturePtr)
-            m_NormalMapPtr->SetResource(normalMapTexturePtr->GetSRV());
+        assert(uint64_t(firstIndex) + numIndices <= m_NumIndices and "Submesh is out of the index buffer!");
+        m_Submeshes.push_back({ firstIndex, numIndices });
+        return static_cast<uint32_t>(m_Submeshes.size() - 1);
     }
 
-    void Mesh::SetSpecularMap(const Texture* specularTexturePtr) const
+    void Mesh::SetSubmeshTexture(uint32_t submeshIndex, TextureSlot slot, const Texture* texturePtr)
     {
-        if (specularTexturePtr)
-            m_SpecularMapPtr->SetResource(specularTexturePtr->GetSRV());
+        if (submeshIndex < m_Submeshes.size())
+            m_Submeshes[submeshIndex].texturePtrs[static_cast<size_t>(slot)] = texturePtr;
     }
 
-    void Mesh::SetGlossinessMap(const Texture* glossinessTexturePtr) const
+    void Mesh::SetTexture(TextureSlot slot, const Texture* texturePtr) const
     {
-        if (glossinessTexturePtr)
-            m_GlossinessMapPtr->SetResource(glossinessTexturePtr->GetSRV());
+        if (!texturePtr)
+            return;
+
+        switch (slot)
+        {
+        case TextureSlot::Diffuse: m_DiffuseMapPtr->SetResource(texturePtr->GetSRV()); break;
+        case TextureSlot::Normal: m_NormalMapPtr->SetResource(texturePtr->GetSRV()); break;
+        case TextureSlot::Specular: m_SpecularMapPtr->SetResource(texturePtr->GetSRV()); break;
+        case TextureSlot::Glossiness: m_GlossinessMapPtr->SetResource(texturePtr->GetSRV()); break;
+        }
     }
 
 }
\ No newline at end of file
@@ -1,24 +1,40 @@
 #pragma once
+#include "BVH.h"
+#include "IndexCompression.h"
+#include "Vertex.h"
+#include <array>
+#include <memory>
+#include <optional>
+#include <span>
 
 namespace dae
 {
     // Forward declarations
     class Effect;
     class Texture;
-
-    struct Vertex
-    {
-        Vector3  position = { 0.0f, 0.0f, 0.0f };
-        ColorRGB color = colors::White;
-        Vector2  uv = { 0.0f, 1.0f };
-        Vector3  normal = { 0.0f, 0.0f, 1.0f };
-        Vector3  tangent = { 0.0f, 0.0f, 1.0f };
-    };
+    namespace Meshlets { struct Meshlet; }
 
     class Mesh
     {
     public:
+        enum class TextureSlot
+        {
+            Diffuse,
+            Normal,
+            Specular,
+            Glossiness,
+        };
+        static constexpr size_t NumTextureSlots{ 4 };
+
         Mesh(ID3D11Device* devicePtr, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+        // Uploads straight from the given memory (e.g. a mapped MeshCache), only indices that fit in 16 bits are copied to narrow them
+        Mesh(ID3D11Device* devicePtr, std::span<const Vertex> vertices, std::span<const uint32_t> indices);
+        // Takes ownership of an effect that was already created, e.g. from a blob compiled on a loader thread
+        Mesh(ID3D11Device* devicePtr, Effect* effectPtr, std::span<const Vertex> vertices, std::span<const uint32_t> indices);
+        // Takes the arrays over: they are uploaded and freed with the constructor, unless keepGeometry keeps them for CPU work like picking or software rendering
+        Mesh(ID3D11Device* devicePtr, Effect* effectPtr, std::vector<Vertex>&& vertices, std::vector<uint32_t>&& indices, bool keepGeometry = false);
+        // Draws with PackedTechnique, which decodes the vertices in the vertex shader
+        Mesh(ID3D11Device* devicePtr, Effect* effectPtr, std::span<const PackedVertex> vertices, const PositionQuantization& quantization, std::span<const uint32_t> indices);
         ~Mesh();
 
         Mesh(const Mesh& other) = delete;
@@ -29,10 +45,59 @@ namespace dae
         void Render() const;
         void UpdateMatrix(const Matrix& viewMatrix, const Matrix& projectionMatrix) const;
 
-        void SetDiffuseMap(const Texture* diffuseTexturePtr) const;
-        void SetNormalMap(const Texture* normalMapTexturePtr) const;
-        void SetSpecularMap(const Texture* specularTexturePtr) const;
-        void SetGlossinessMap(const Texture* glossinessTexturePtr) const;
+        // Used for the whole mesh, or for every submesh slot without a texture of its own
+        void SetDiffuseMap(const Texture* diffuseTexturePtr);
+        void SetNormalMap(const Texture* normalMapTexturePtr);
+        void SetSpecularMap(const Texture* specularTexturePtr);
+        void SetGlossinessMap(const Texture* glossinessTexturePtr);
+
+        // Once submeshes are added, Render draws only their index ranges, one draw call each with its own textures
+        uint32_t AddSubmesh(uint32_t firstIndex, uint32_t numIndices);
+        void SetSubmeshTexture(uint32_t submeshIndex, TextureSlot slot, const Texture* texturePtr);
+
+        // Meshlets built from this mesh's indices, in index order. Once they are set, Render only draws the meshlets that passed the last CullMeshlets
+        void SetMeshlets(std::vector<Meshlets::Meshlet> meshlets);
+        // Frustum and backface rejection, the camera is in object space. Returns the number of triangles that will be drawn
+        uint32_t CullMeshlets(const Matrix& worldViewProjection, const Vector3& cameraPosition, bool cullBackFaces = true);
+        // Draws every meshlet again until the next CullMeshlets
+        void ResetMeshletCulling();
+
+        // A coarser copy of the indices with one range per submesh, in the order they were added, or a single range without submeshes
+        // Levels are added from fine to coarse, error is how far the level moves the surface in mesh units
+        void AddLevelOfDetail(float error, std::vector<IndexCompression::IndexRange> submeshRanges);
+        // Picks the coarsest level that moves the surface by at most maxPixelError pixels on screen, the camera is in object space
+        // projectionScale is the y scale of the projection matrix. Returns the level Render will draw, 0 for full detail
+        size_t SelectLevelOfDetail(const Vector3& cameraPosition, float projectionScale, float viewportHeight, float maxPixelError = 1.f);
+        // Overrides SelectLevelOfDetail, std::nullopt goes back to picking by distance
+        void ForceLevelOfDetail(std::optional<size_t> level);
+        // Including the full detail mesh
+        size_t GetNumLevelsOfDetail() const { return m_LevelsOfDetail.size() + 1; }
+
+        // Object space bounds of the vertices, computed when the mesh is created. The sphere is centered on the box
+        const Vector3& GetBoundsMin() const { return m_BoundsMin; }
+        const Vector3& GetBoundsMax() const { return m_BoundsMax; }
+        const Vector3& GetBoundsCenter() const { return m_BoundsCenter; }
+        float GetBoundsRadius() const { return m_BoundsRadius; }
+
+        // The mesh keeps no positions of its own, so the BVH is built from the ones it was created from, e.g. MeshCache::GetPositions
+        void BuildBVH(std::span<const Vector3> positions, std::span<const uint32_t> indices, uint32_t numThreads = 0);
+        bool HasBVH() const { return m_BVHPtr != nullptr; }
+        // Rays in object space, both miss when there is no BVH. Hit::triangle counts from the start of the index buffer
+        std::optional<BVH::Hit> Raycast(const BVH::Ray& ray) const;
+        bool IsRayBlocked(const BVH::Ray& ray) const;
+
+        // Only filled when the mesh was asked to keep its geometry, nothing else holds a CPU copy after the upload
+        std::span<const Vertex> GetVertices() const { return m_Vertices; }
+        std::span<const uint32_t> GetIndices() const { return m_Indices; }
+
+        struct MemoryUsage
+        {
+            // Vertex and index buffers
+            size_t gpuBytes{};
+            // Kept geometry, meshlets, draw ranges, levels of detail and the BVH
+            size_t cpuBytes{};
+        };
+        MemoryUsage GetMemoryUsage() const;
 
         void SetPassIdx(UINT passIdx) { m_PassIdx = passIdx; }
         void SetDeltaTime(float dt) const { m_TimePtr->SetFloat(dt); };
@@ -59,9 +124,54 @@ namespace dae
         ID3DX11EffectVectorVariable* m_CameraPosPtr = nullptr;
         ID3DX11EffectScalarVariable* m_UseNormalMapPtr = nullptr;
 
-        std::vector<Vertex> m_Vertices;
-        std::vector<uint32_t> m_Indices;
         uint32_t m_NumIndices = 0;
+        UINT m_VertexStride = 0;
+        size_t m_VertexBufferBytes = 0;
+        size_t m_IndexBufferBytes = 0;
+        std::vector<Vertex> m_Vertices{};
+        std::vector<uint32_t> m_Indices{};
+        // R16_UINT whenever the indices fit, meshes with more vertices are drawn in ranges with their own base vertex
+        DXGI_FORMAT m_IndexFormat = DXGI_FORMAT_R32_UINT;
+        std::vector<IndexCompression::IndexRange> m_IndexRanges{};
+
+        // No initializer, it would need the complete Meshlet type here
+        std::vector<Meshlets::Meshlet> m_Meshlets;
+        // Runs of consecutive meshlets that passed culling, merged so they take one draw
+        std::vector<IndexCompression::IndexRange> m_VisibleRanges{};
+
+        // Coarser levels are drawn without meshlet culling, their triangles are not in any meshlet
+        struct LevelOfDetail
+        {
+            std::vector<IndexCompression::IndexRange> submeshRanges{};
+        };
+        std::vector<LevelOfDetail> m_LevelsOfDetail{};
+        // Object space error of every level in m_LevelsOfDetail, kept apart so SelectLevelOfDetail hands them over without a copy
+        std::vector<float> m_LevelErrors{};
+        size_t m_LevelOfDetail = 0;
+        std::optional<size_t> m_ForcedLevelOfDetail{};
+        Vector3 m_BoundsMin{};
+        Vector3 m_BoundsMax{};
+        Vector3 m_BoundsCenter{};
+        float m_BoundsRadius = 0.f;
+        std::unique_ptr<BVH::Tree> m_BVHPtr{};
+
+        struct Submesh
+        {
+            uint32_t firstIndex = 0;
+            uint32_t numIndices = 0;
+            // nullptr falls back to the mesh wide texture
+            std::array<const Texture*, NumTextureSlots> texturePtrs{};
+        };
+        std::vector<Submesh> m_Submeshes{};
+        std::array<const Texture*, NumTextureSlots> m_DefaultTexturePtrs{};
+
+        void Initialize(const char* techniqueName, std::span<const D3D11_INPUT_ELEMENT_DESC> vertexDesc, const void* verticesPtr, UINT vertexStride, size_t numVertices,
+            std::span<const uint32_t> indices);
+        template<typename GetPosition>
+        void ComputeBounds(size_t numVertices, const GetPosition& getPosition);
+        void SetTexture(TextureSlot slot, const Texture* texturePtr) const;
+        void DrawIndices(uint32_t firstIndex, uint32_t numIndices) const;
+        void DrawVisibleIndices(uint32_t firstIndex, uint32_t numIndices) const;
 
         UINT m_PassIdx = 0;
     };
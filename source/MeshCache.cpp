@@ -0,0 +1,587 @@
+#include "pch.h"
+#include "MeshCache.h"
+#include "IndexCompression.h"
+#include "MappedFile.h"
+#include "MeshOptimizer.h"
+#include "VertexCompression.h"
+#include "VertexQuantization.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace dae
+{
+    namespace
+    {
+        constexpr char CacheMagic[4]{ 'D', 'A', 'E', 'M' };
+        constexpr uint32_t DataAlignment{ 16 };
+
+        enum class VertexEncoding : uint32_t
+        {
+            Raw,
+            // VertexCompression::EncodeVertices
+            ByteDelta,
+        };
+
+        enum class IndexEncoding : uint32_t
+        {
+            Raw,
+            // IndexCompression::EncodeIndices
+            DeltaVarint,
+            // IndexCompression::EncodeTriangles
+            Triangles,
+        };
+
+        struct CacheHeader
+        {
+            char magic[4]{};
+            uint32_t version{};
+            uint64_t sourceHash{};
+            uint32_t vertexStride{};
+            VertexEncoding vertexEncoding{};
+            IndexEncoding indexEncoding{};
+            uint32_t numVertices{};
+            uint32_t numIndices{};
+            uint32_t vertexOffset{};
+            uint64_t vertexBytes{};
+            uint64_t indexOffset{};
+            uint64_t indexBytes{};
+            // Submeshes, material libraries and levels of detail follow right after the indices
+            uint64_t materialBytes{};
+            Vector3 boundsMin{};
+            Vector3 boundsMax{};
+        };
+
+        uint64_t AlignUp(uint64_t value, uint64_t alignment)
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        void ComputeBounds(std::span<const Vertex> vertices, Vector3& boundsMin, Vector3& boundsMax)
+        {
+            if (vertices.empty())
+                return;
+
+            boundsMin = boundsMax = vertices.front().position;
+            for (const Vertex& vertex : vertices)
+            {
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    boundsMin[axis] = std::min(boundsMin[axis], vertex.position[axis]);
+                    boundsMax[axis] = std::max(boundsMax[axis], vertex.position[axis]);
+                }
+            }
+        }
+
+        // Changes whenever the OBJ, the way it is turned into vertices or the cache layout change
+        uint64_t HashSource(const MappedFile& objFile, bool flipAxisAndWinding, bool weldVertices, size_t streamBudget)
+        {
+            const uint64_t settings[]{ MeshCache::FormatVersion, sizeof(Vertex), flipAxisAndWinding, weldVertices, streamBudget };
+            const uint64_t seed = Utils::HashBytes(reinterpret_cast<const char*>(settings), sizeof(settings), 0);
+            return Utils::HashBytes(objFile.GetData(), objFile.GetSize(), seed);
+        }
+
+        bool HashSourceFile(const std::string& objPath, bool flipAxisAndWinding, bool weldVertices, size_t streamBudget, uint64_t& sourceHash)
+        {
+            const MappedFile objFile{ objPath };
+            if (!objFile.IsOpen())
+            {
+                std::cout << "MeshCache: failed to open " << objPath << '\n';
+                return false;
+            }
+            sourceHash = HashSource(objFile, flipAxisAndWinding, weldVertices, streamBudget);
+            return true;
+        }
+
+        void AppendUInt32(std::string& bytes, uint32_t value)
+        {
+            bytes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        void AppendString(std::string& bytes, const std::string& text)
+        {
+            AppendUInt32(bytes, static_cast<uint32_t>(text.size()));
+            bytes += text;
+        }
+
+        bool ReadUInt32(std::string_view& bytes, uint32_t& value)
+        {
+            if (bytes.size() < sizeof(value))
+                return false;
+            std::memcpy(&value, bytes.data(), sizeof(value));
+            bytes.remove_prefix(sizeof(value));
+            return true;
+        }
+
+        bool ReadString(std::string_view& bytes, std::string& text)
+        {
+            uint32_t length{};
+            if (!ReadUInt32(bytes, length) or bytes.size() < length)
+                return false;
+            text.assign(bytes.data(), length);
+            bytes.remove_prefix(length);
+            return true;
+        }
+
+        void AppendFloat(std::string& bytes, float value)
+        {
+            bytes.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        bool ReadFloat(std::string_view& bytes, float& value)
+        {
+            if (bytes.size() < sizeof(value))
+                return false;
+            std::memcpy(&value, bytes.data(), sizeof(value));
+            bytes.remove_prefix(sizeof(value));
+            return true;
+        }
+
+        void AppendSubmesh(std::string& bytes, const Utils::OBJSubmesh& submesh)
+        {
+            AppendString(bytes, submesh.material);
+            AppendUInt32(bytes, submesh.firstIndex);
+            AppendUInt32(bytes, submesh.numIndices);
+        }
+
+        bool ReadSubmesh(std::string_view& bytes, uint32_t numIndices, Utils::OBJSubmesh& submesh)
+        {
+            return ReadString(bytes, submesh.material) and ReadUInt32(bytes, submesh.firstIndex) and ReadUInt32(bytes, submesh.numIndices)
+                and uint64_t(submesh.firstIndex) + submesh.numIndices <= numIndices;
+        }
+
+        std::string SerializeMaterials(const Utils::OBJMaterialData& materialData)
+        {
+            std::string bytes{};
+            AppendUInt32(bytes, static_cast<uint32_t>(materialData.libraries.size()));
+            for (const std::string& library : materialData.libraries)
+                AppendString(bytes, library);
+
+            AppendUInt32(bytes, static_cast<uint32_t>(materialData.submeshes.size()));
+            for (const Utils::OBJSubmesh& submesh : materialData.submeshes)
+                AppendSubmesh(bytes, submesh);
+            return bytes;
+        }
+
+        bool DeserializeMaterials(std::string_view& bytes, uint32_t numIndices, Utils::OBJMaterialData& materialData)
+        {
+            uint32_t numLibraries{};
+            if (!ReadUInt32(bytes, numLibraries))
+                return false;
+            materialData.libraries.resize(std::min<size_t>(numLibraries, bytes.size()));
+            for (std::string& library : materialData.libraries)
+            {
+                if (!ReadString(bytes, library))
+                    return false;
+            }
+
+            uint32_t numSubmeshes{};
+            if (!ReadUInt32(bytes, numSubmeshes))
+                return false;
+            materialData.submeshes.resize(std::min<size_t>(numSubmeshes, bytes.size()));
+            for (Utils::OBJSubmesh& submesh : materialData.submeshes)
+            {
+                if (!ReadSubmesh(bytes, numIndices, submesh))
+                    return false;
+            }
+            return true;
+        }
+
+        void SerializeLevelsOfDetail(std::string& bytes, std::span<const Simplifier::LevelOfDetail> levelsOfDetail)
+        {
+            AppendUInt32(bytes, static_cast<uint32_t>(levelsOfDetail.size()));
+            for (const Simplifier::LevelOfDetail& level : levelsOfDetail)
+            {
+                AppendFloat(bytes, level.ratio);
+                AppendFloat(bytes, level.error);
+                AppendUInt32(bytes, static_cast<uint32_t>(level.submeshes.size()));
+                for (const Utils::OBJSubmesh& submesh : level.submeshes)
+                    AppendSubmesh(bytes, submesh);
+            }
+        }
+
+        bool DeserializeLevelsOfDetail(std::string_view& bytes, uint32_t numIndices, std::vector<Simplifier::LevelOfDetail>& levelsOfDetail)
+        {
+            uint32_t numLevels{};
+            if (!ReadUInt32(bytes, numLevels))
+                return false;
+            levelsOfDetail.resize(std::min<size_t>(numLevels, bytes.size()));
+            for (Simplifier::LevelOfDetail& level : levelsOfDetail)
+            {
+                uint32_t numSubmeshes{};
+                if (!ReadFloat(bytes, level.ratio) or !ReadFloat(bytes, level.error) or !ReadUInt32(bytes, numSubmeshes))
+                    return false;
+                level.submeshes.resize(std::min<size_t>(numSubmeshes, bytes.size()));
+                for (Utils::OBJSubmesh& submesh : level.submeshes)
+                {
+                    if (!ReadSubmesh(bytes, numIndices, submesh))
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        CacheHeader MakeHeader(uint64_t sourceHash, size_t numVertices, size_t numIndices, size_t materialBytes, const Vector3& boundsMin, const Vector3& boundsMax,
+            uint32_t vertexStride = sizeof(Vertex))
+        {
+            CacheHeader header{};
+            std::memcpy(header.magic, CacheMagic, sizeof(CacheMagic));
+            header.version = MeshCache::FormatVersion;
+            header.sourceHash = sourceHash;
+            header.vertexStride = vertexStride;
+            header.numVertices = static_cast<uint32_t>(numVertices);
+            header.numIndices = static_cast<uint32_t>(numIndices);
+            header.vertexOffset = static_cast<uint32_t>(AlignUp(sizeof(CacheHeader), DataAlignment));
+            header.vertexBytes = numVertices * vertexStride;
+            header.indexOffset = AlignUp(header.vertexOffset + header.vertexBytes, DataAlignment);
+            header.indexBytes = numIndices * sizeof(uint32_t);
+            header.materialBytes = materialBytes;
+            header.boundsMin = boundsMin;
+            header.boundsMax = boundsMax;
+            return header;
+        }
+
+        void WritePadding(std::ofstream& file, uint64_t numBytes)
+        {
+            const char padding[DataAlignment]{};
+            file.write(padding, static_cast<std::streamsize>(numBytes));
+        }
+
+        // Files are written next to the cache and renamed at the end, so a crash halfway never leaves a cache that looks valid
+        bool ReplaceFile(const std::string& tempPath, const std::string& path)
+        {
+            std::remove(path.c_str());
+            return std::rename(tempPath.c_str(), path.c_str()) == 0;
+        }
+    }
+
+    MeshCache::~MeshCache() = default;
+
+    std::unique_ptr<MeshCache> MeshCache::Load(const std::string& objPath, const Utils::ParseOBJOptions& options)
+    {
+        std::unique_ptr<MeshCache> meshCachePtr{ new MeshCache() };
+        const std::string cachePath = objPath + ".meshcache";
+
+        uint64_t sourceHash{};
+        if (!HashSourceFile(objPath, options.flipAxisAndWinding, options.weldVertices, 0, sourceHash))
+            return meshCachePtr;
+
+        if (meshCachePtr->Map(cachePath, sourceHash))
+            return meshCachePtr;
+
+        std::vector<Vertex>& vertices = meshCachePtr->m_OwnedVertices;
+        std::vector<uint32_t>& indices = meshCachePtr->m_OwnedIndices;
+        Utils::OBJMaterialData& materialData = meshCachePtr->m_MaterialData;
+        if (!Utils::ParseOBJ(objPath, vertices, indices, options, &materialData))
+        {
+            std::cout << "MeshCache::Load() failed to parse " << objPath << '\n';
+            vertices.clear();
+            indices.clear();
+            return meshCachePtr;
+        }
+        vertices.resize(MeshOptimizer::OptimizeMesh(vertices, indices, materialData.submeshes));
+
+        if (Write(cachePath, vertices, indices, materialData, sourceHash) and meshCachePtr->Map(cachePath, sourceHash))
+        {
+            vertices = {};
+            indices = {};
+            return meshCachePtr;
+        }
+
+        std::cout << "MeshCache::Load() could not write " << cachePath << ", using the parsed mesh\n";
+        meshCachePtr->m_Vertices = vertices;
+        meshCachePtr->m_Indices = indices;
+        ComputeBounds(vertices, meshCachePtr->m_BoundsMin, meshCachePtr->m_BoundsMax);
+        return meshCachePtr;
+    }
+
+    std::unique_ptr<MeshCache> MeshCache::LoadStreamed(const std::string& objPath, const Utils::StreamOBJOptions& options)
+    {
+        std::unique_ptr<MeshCache> meshCachePtr{ new MeshCache() };
+        const std::string cachePath = objPath + ".meshcache";
+
+        uint64_t sourceHash{};
+        if (!HashSourceFile(objPath, options.flipAxisAndWinding, true, options.memoryBudget, sourceHash))
+            return meshCachePtr;
+
+        if (meshCachePtr->Map(cachePath, sourceHash))
+            return meshCachePtr;
+
+        if (!WriteStreamed(objPath, cachePath, options, sourceHash) or !meshCachePtr->Map(cachePath, sourceHash))
+            std::cout << "MeshCache::LoadStreamed() failed to build " << cachePath << '\n';
+        return meshCachePtr;
+    }
+
+    bool MeshCache::Write(const std::string& cachePath, std::span<const Vertex> vertices, std::span<const uint32_t> indices,
+        const Utils::OBJMaterialData& materialData, uint64_t sourceHash, bool packVertices, bool compressIndices, bool compressVertices,
+        std::span<const Simplifier::LevelOfDetail> levelsOfDetail)
+    {
+        Vector3 boundsMin{}, boundsMax{};
+        ComputeBounds(vertices, boundsMin, boundsMax);
+        std::string materialBytes = SerializeMaterials(materialData);
+        SerializeLevelsOfDetail(materialBytes, levelsOfDetail);
+        const uint32_t vertexStride = packVertices ? sizeof(PackedVertex) : sizeof(Vertex);
+        CacheHeader header = MakeHeader(sourceHash, vertices.size(), indices.size(), materialBytes.size(), boundsMin, boundsMax, vertexStride);
+
+        std::vector<PackedVertex> packedVertices{};
+        std::span<const char> vertexBytes{ reinterpret_cast<const char*>(vertices.data()), vertices.size_bytes() };
+        if (packVertices)
+        {
+            packedVertices.resize(vertices.size());
+            VertexQuantization::Pack(vertices, VertexQuantization::ComputePositionQuantization(boundsMin, boundsMax), packedVertices);
+            vertexBytes = { reinterpret_cast<const char*>(packedVertices.data()), packedVertices.size() * sizeof(PackedVertex) };
+        }
+
+        std::string encodedVertices{};
+        if (compressVertices)
+        {
+            encodedVertices = VertexCompression::EncodeVertices(vertexBytes, vertexStride);
+            vertexBytes = encodedVertices;
+            header.vertexEncoding = VertexEncoding::ByteDelta;
+            header.vertexBytes = encodedVertices.size();
+            header.indexOffset = AlignUp(header.vertexOffset + header.vertexBytes, DataAlignment);
+        }
+
+        std::string encodedIndices{};
+        std::span<const char> indexBytes{ reinterpret_cast<const char*>(indices.data()), indices.size_bytes() };
+        if (compressIndices)
+        {
+            // Index lists that are not whole triangles only fit the generic delta coding
+            encodedIndices = IndexCompression::EncodeTriangles(indices);
+            header.indexEncoding = IndexEncoding::Triangles;
+            if (encodedIndices.empty())
+            {
+                encodedIndices = IndexCompression::EncodeIndices(indices);
+                header.indexEncoding = IndexEncoding::DeltaVarint;
+            }
+            indexBytes = encodedIndices;
+            header.indexBytes = encodedIndices.size();
+        }
+
+        const std::string tempPath = cachePath + ".tmp";
+        {
+            std::ofstream file{ tempPath, std::ios::binary | std::ios::trunc };
+            if (!file)
+                return false;
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            WritePadding(file, header.vertexOffset - sizeof(header));
+            file.write(vertexBytes.data(), static_cast<std::streamsize>(vertexBytes.size()));
+            WritePadding(file, header.indexOffset - header.vertexOffset - vertexBytes.size());
+            file.write(indexBytes.data(), static_cast<std::streamsize>(indexBytes.size()));
+            file.write(materialBytes.data(), static_cast<std::streamsize>(materialBytes.size()));
+            if (!file)
+                return false;
+        }
+
+        return ReplaceFile(tempPath, cachePath);
+    }
+
+    bool MeshCache::WriteStreamed(const std::string& objPath, const std::string& cachePath, const Utils::StreamOBJOptions& options, uint64_t sourceHash)
+    {
+        // Vertices go straight into the cache, indices into a side file that is appended once the vertex count is known
+        const std::string tempPath = cachePath + ".tmp";
+        const std::string indexPath = cachePath + ".indices.tmp";
+        std::ofstream file{ tempPath, std::ios::binary | std::ios::trunc };
+        std::ofstream indexFile{ indexPath, std::ios::binary | std::ios::trunc };
+        if (!file or !indexFile)
+            return false;
+
+        CacheHeader header = MakeHeader(sourceHash, 0, 0, 0, {}, {});
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        WritePadding(file, header.vertexOffset - sizeof(header));
+
+        Vector3 boundsMin{}, boundsMax{};
+        std::vector<Vertex> batchVertices{};
+        std::vector<uint32_t> batchIndices{};
+        const auto sink = [&](const Utils::OBJBatch& batch)
+            {
+                Vector3 batchMin{}, batchMax{};
+                ComputeBounds(batch.vertices, batchMin, batchMax);
+                if (batch.baseVertex == 0)
+                {
+                    boundsMin = batchMin;
+                    boundsMax = batchMax;
+                }
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    boundsMin[axis] = std::min(boundsMin[axis], batchMin[axis]);
+                    boundsMax[axis] = std::max(boundsMax[axis], batchMax[axis]);
+                }
+
+                batchVertices.assign(batch.vertices.begin(), batch.vertices.end());
+                batchIndices.assign(batch.indices.begin(), batch.indices.end());
+                MeshOptimizer::OptimizeVertexCache(batchIndices, batchVertices.size());
+                MeshOptimizer::OptimizeVertexFetch(batchVertices, batchIndices);
+                for (uint32_t& index : batchIndices)
+                    index += batch.baseVertex;
+
+                file.write(reinterpret_cast<const char*>(batchVertices.data()), batchVertices.size() * sizeof(Vertex));
+                indexFile.write(reinterpret_cast<const char*>(batchIndices.data()), batchIndices.size() * sizeof(uint32_t));
+            };
+
+        Utils::OBJStreamStats stats{};
+        if (!Utils::StreamOBJ(objPath, sink, options, &stats))
+        {
+            file.close();
+            indexFile.close();
+            std::remove(tempPath.c_str());
+            std::remove(indexPath.c_str());
+            return false;
+        }
+        indexFile.close();
+
+        // Batches know nothing about materials, the whole mesh is one submesh
+        Utils::OBJMaterialData materialData{};
+        materialData.submeshes.push_back({ "", 0, static_cast<uint32_t>(stats.numIndices) });
+        std::string materialBytes = SerializeMaterials(materialData);
+        SerializeLevelsOfDetail(materialBytes, {});
+
+        header = MakeHeader(sourceHash, stats.numVertices, stats.numIndices, materialBytes.size(), boundsMin, boundsMax);
+        WritePadding(file, header.indexOffset - header.vertexOffset - stats.numVertices * sizeof(Vertex));
+        {
+            std::ifstream indexInput{ indexPath, std::ios::binary };
+            std::vector<char> buffer(1 << 20);
+            while (indexInput.read(buffer.data(), buffer.size()) or indexInput.gcount() > 0)
+                file.write(buffer.data(), indexInput.gcount());
+        }
+        std::remove(indexPath.c_str());
+        file.write(materialBytes.data(), static_cast<std::streamsize>(materialBytes.size()));
+
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.close();
+        if (!file)
+            return false;
+
+        return ReplaceFile(tempPath, cachePath);
+    }
+
+    std::unique_ptr<MeshCache> MeshCache::Open(const std::string& cookedPath)
+    {
+        std::unique_ptr<MeshCache> meshCachePtr{ new MeshCache() };
+        if (!meshCachePtr->Map(cookedPath, std::nullopt))
+        {
+            std::cout << "MeshCache::Open() could not map " << cookedPath << '\n';
+            return nullptr;
+        }
+        return meshCachePtr;
+    }
+
+    std::vector<Vector3> MeshCache::GetPositions() const
+    {
+        std::vector<Vector3> positions{};
+        positions.reserve(m_Vertices.size() + m_PackedVertices.size());
+        for (const Vertex& vertex : m_Vertices)
+            positions.push_back(vertex.position);
+
+        const PositionQuantization quantization = GetPositionQuantization();
+        for (const PackedVertex& packedVertex : m_PackedVertices)
+            positions.push_back(VertexQuantization::UnpackPosition(packedVertex, quantization));
+        return positions;
+    }
+
+    bool MeshCache::Map(const std::string& cachePath, std::optional<uint64_t> sourceHash)
+    {
+        auto mappedFilePtr = std::make_unique<MappedFile>(cachePath);
+        if (!mappedFilePtr->IsOpen() or mappedFilePtr->GetSize() < sizeof(CacheHeader))
+            return false;
+
+        CacheHeader header{};
+        std::memcpy(&header, mappedFilePtr->GetData(), sizeof(header));
+
+        const bool isCurrent = std::memcmp(header.magic, CacheMagic, sizeof(CacheMagic)) == 0
+            and header.version == MeshCache::FormatVersion
+            and (!sourceHash or header.sourceHash == *sourceHash)
+            and (header.vertexStride == sizeof(Vertex) or header.vertexStride == sizeof(PackedVertex))
+            and (header.vertexEncoding == VertexEncoding::Raw or header.vertexEncoding == VertexEncoding::ByteDelta)
+            and (header.indexEncoding == IndexEncoding::Raw or header.indexEncoding == IndexEncoding::DeltaVarint
+                or header.indexEncoding == IndexEncoding::Triangles);
+        if (!isCurrent)
+            return false;
+
+        const uint64_t vertexBytes = header.vertexBytes;
+        const uint64_t indexBytes = header.indexBytes;
+        if (header.vertexOffset + vertexBytes > header.indexOffset
+            or (header.vertexEncoding == VertexEncoding::Raw and vertexBytes != uint64_t(header.numVertices) * header.vertexStride)
+            or (header.indexEncoding == IndexEncoding::Raw and indexBytes != uint64_t(header.numIndices) * sizeof(uint32_t))
+            or header.indexOffset + indexBytes + header.materialBytes > mappedFilePtr->GetSize())
+            return false;
+
+        const char* dataPtr = mappedFilePtr->GetData();
+        std::string_view materialBytes{ dataPtr + header.indexOffset + indexBytes, static_cast<size_t>(header.materialBytes) };
+        Utils::OBJMaterialData materialData{};
+        std::vector<Simplifier::LevelOfDetail> levelsOfDetail{};
+        if (!DeserializeMaterials(materialBytes, header.numIndices, materialData)
+            or !DeserializeLevelsOfDetail(materialBytes, header.numIndices, levelsOfDetail))
+            return false;
+
+        // Encoded data is decoded straight into owned arrays, nothing of it is kept mapped
+        const std::string_view encodedVertices{ dataPtr + header.vertexOffset, static_cast<size_t>(vertexBytes) };
+        std::vector<Vertex> decodedVertices{};
+        std::vector<PackedVertex> decodedPackedVertices{};
+        if (header.vertexEncoding == VertexEncoding::ByteDelta)
+        {
+            std::span<char> decodedBytes{};
+            if (header.vertexStride == sizeof(PackedVertex))
+            {
+                decodedPackedVertices.resize(header.numVertices);
+                decodedBytes = { reinterpret_cast<char*>(decodedPackedVertices.data()), decodedPackedVertices.size() * sizeof(PackedVertex) };
+            }
+            else
+            {
+                decodedVertices.resize(header.numVertices);
+                decodedBytes = { reinterpret_cast<char*>(decodedVertices.data()), decodedVertices.size() * sizeof(Vertex) };
+            }
+            if (!VertexCompression::DecodeVertices(encodedVertices, decodedBytes, header.vertexStride))
+                return false;
+        }
+
+        const std::string_view encodedIndices{ dataPtr + header.indexOffset, static_cast<size_t>(indexBytes) };
+        std::vector<uint32_t> decodedIndices{};
+        if (header.indexEncoding == IndexEncoding::DeltaVarint)
+        {
+            decodedIndices.resize(header.numIndices);
+            if (!IndexCompression::DecodeIndices(encodedIndices, decodedIndices))
+                return false;
+        }
+        else if (header.indexEncoding == IndexEncoding::Triangles)
+        {
+            decodedIndices.resize(header.numIndices);
+            if (!IndexCompression::DecodeTriangles(encodedIndices, decodedIndices))
+                return false;
+        }
+
+        m_MaterialData = std::move(materialData);
+        m_LevelsOfDetail = std::move(levelsOfDetail);
+        if (header.vertexEncoding == VertexEncoding::ByteDelta)
+        {
+            m_OwnedVertices = std::move(decodedVertices);
+            m_OwnedPackedVertices = std::move(decodedPackedVertices);
+            m_Vertices = m_OwnedVertices;
+            m_PackedVertices = m_OwnedPackedVertices;
+        }
+        else if (header.vertexStride == sizeof(PackedVertex))
+        {
+            m_PackedVertices = { reinterpret_cast<const PackedVertex*>(encodedVertices.data()), header.numVertices };
+        }
+        else
+        {
+            m_Vertices = { reinterpret_cast<const Vertex*>(encodedVertices.data()), header.numVertices };
+        }
+        if (header.indexEncoding != IndexEncoding::Raw)
+        {
+            m_OwnedIndices = std::move(decodedIndices);
+            m_Indices = m_OwnedIndices;
+        }
+        else
+        {
+            m_Indices = { reinterpret_cast<const uint32_t*>(dataPtr + header.indexOffset), header.numIndices };
+        }
+        m_BoundsMin = header.boundsMin;
+        m_BoundsMax = header.boundsMax;
+        m_MappedFilePtr = std::move(mappedFilePtr);
+        return true;
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "Vertex.h"
+#include "Simplifier.h"
+#include "Utils.h"
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace dae
+{
+    class MappedFile;
+
+    // Final vertex and index arrays of an OBJ, stored next to it in a binary file that is mapped on later loads
+    class MeshCache final
+    {
+    public:
+        // Bumped whenever the file layout or the way the vertices are produced changes
+        static constexpr uint32_t FormatVersion{ 10 };
+
+        ~MeshCache();
+
+        MeshCache(const MeshCache& other) = delete;
+        MeshCache(MeshCache&& other) noexcept = delete;
+        MeshCache& operator=(const MeshCache& other) = delete;
+        MeshCache& operator=(MeshCache&& other) noexcept = delete;
+
+        // Maps <objPath>.meshcache when it was built from the current OBJ contents and options,
+        // otherwise parses the OBJ and writes the cache first
+        static std::unique_ptr<MeshCache> Load(const std::string& objPath, const Utils::ParseOBJOptions& options = {});
+
+        // Same as Load, but a missing cache is built through Utils::StreamOBJ, so the whole OBJ never has to be in memory
+        static std::unique_ptr<MeshCache> LoadStreamed(const std::string& objPath, const Utils::StreamOBJOptions& options = {});
+
+        // Maps a mesh written by the asset cooker as is, the OBJ it was cooked from is neither needed nor checked
+        // Returns nullptr when the file is missing or was written by another cache version
+        static std::unique_ptr<MeshCache> Open(const std::string& cookedPath);
+
+        // packVertices stores PackedVertex quantized inside the bounds instead of Vertex
+        // compressIndices stores the indices through IndexCompression::EncodeTriangles, or EncodeIndices when they are not whole triangles
+        // compressVertices stores the vertices, packed or not, through VertexCompression::EncodeVertices
+        // Compressed data is decoded into memory when mapped
+        // levelsOfDetail index ranges behind the ones of the submeshes, as Simplifier::BuildLevelsOfDetail appends them
+        static bool Write(const std::string& cachePath, std::span<const Vertex> vertices, std::span<const uint32_t> indices,
+            const Utils::OBJMaterialData& materialData, uint64_t sourceHash, bool packVertices = false, bool compressIndices = false,
+            bool compressVertices = false, std::span<const Simplifier::LevelOfDetail> levelsOfDetail = {});
+
+        // Only one of the two is filled, depending on how the file was written
+        std::span<const Vertex> GetVertices() const { return m_Vertices; }
+        std::span<const PackedVertex> GetPackedVertices() const { return m_PackedVertices; }
+        bool HasPackedVertices() const { return !m_PackedVertices.empty(); }
+        // Packed positions span the bounds
+        PositionQuantization GetPositionQuantization() const { return { m_BoundsMin, m_BoundsMax - m_BoundsMin }; }
+        // Decoded from either vertex format, for CPU work like meshlet bounds
+        std::vector<Vector3> GetPositions() const;
+        std::span<const uint32_t> GetIndices() const { return m_Indices; }
+        const Vector3& GetBoundsMin() const { return m_BoundsMin; }
+        const Vector3& GetBoundsMax() const { return m_BoundsMax; }
+        // Index ranges per usemtl material and the mtllib files they come from, a single unnamed submesh for streamed caches
+        const Utils::OBJMaterialData& GetMaterialData() const { return m_MaterialData; }
+        // Coarsest last, empty unless the cooker built them
+        const std::vector<Simplifier::LevelOfDetail>& GetLevelsOfDetail() const { return m_LevelsOfDetail; }
+        bool IsMapped() const { return m_MappedFilePtr != nullptr; }
+
+    private:
+        MeshCache() = default;
+
+        static bool WriteStreamed(const std::string& objPath, const std::string& cachePath, const Utils::StreamOBJOptions& options, uint64_t sourceHash);
+        // Without a source hash any cache of the current version is accepted
+        bool Map(const std::string& cachePath, std::optional<uint64_t> sourceHash);
+
+        std::unique_ptr<MappedFile> m_MappedFilePtr{};
+
+        // Only used when the cache could not be written, or for vertices and indices that were stored compressed
+        std::vector<Vertex> m_OwnedVertices{};
+        std::vector<PackedVertex> m_OwnedPackedVertices{};
+        std::vector<uint32_t> m_OwnedIndices{};
+
+        std::span<const Vertex> m_Vertices{};
+        std::span<const PackedVertex> m_PackedVertices{};
+        std::span<const uint32_t> m_Indices{};
+        Vector3 m_BoundsMin{};
+        Vector3 m_BoundsMax{};
+        Utils::OBJMaterialData m_MaterialData{};
+        std::vector<Simplifier::LevelOfDetail> m_LevelsOfDetail{};
+    };
+}
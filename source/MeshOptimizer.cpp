@@ -0,0 +1,607 @@
+#include "pch.h"
+#include "MeshOptimizer.h"
+
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+
+namespace dae
+{
+	namespace MeshOptimizer
+	{
+		namespace
+		{
+			//Tuning from Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+			constexpr uint32_t ScoredCacheSize{ 32 };
+			constexpr float CacheDecayPower{ 1.5f };
+			constexpr float LastTriangleScore{ 0.75f };
+			constexpr float ValenceBoostScale{ 2.f };
+			constexpr float ValenceBoostPower{ 0.5f };
+			constexpr uint32_t MaxScoredValence{ 32 };
+			constexpr uint32_t NoTriangle{ UINT32_MAX };
+
+			struct ScoreTables
+			{
+				ScoreTables()
+				{
+					for (uint32_t position = 0; position < ScoredCacheSize; ++position)
+					{
+						//The three vertices of the last triangle score the same, so the next one is not biased towards either edge
+						cache[position] = position < 3 ? LastTriangleScore
+							: std::pow(1.f - static_cast<float>(position - 3) / (ScoredCacheSize - 3), CacheDecayPower);
+					}
+					for (uint32_t valence = 1; valence <= MaxScoredValence; ++valence)
+						valences[valence] = ValenceBoostScale * std::pow(static_cast<float>(valence), -ValenceBoostPower);
+				}
+
+				float cache[ScoredCacheSize]{};
+				float valences[MaxScoredValence + 1]{};
+			};
+
+			float VertexScore(const ScoreTables& tables, int cachePosition, uint32_t remainingValence)
+			{
+				//Nothing left to draw with this vertex
+				if (remainingValence == 0)
+					return -1.f;
+
+				const float cacheScore = cachePosition >= 0 ? tables.cache[cachePosition] : 0.f;
+				return cacheScore + tables.valences[std::min(remainingValence, MaxScoredValence)];
+			}
+
+			//Post-transform cache that evicts in insertion order: a vertex is still cached while fewer than size misses happened since it was inserted
+			class FIFOCache final
+			{
+			public:
+				FIFOCache(size_t numVertices, uint32_t size)
+					: m_InsertedAt(numVertices, NotCached)
+					, m_Size{ size }
+				{
+				}
+
+				//Returns true on a miss, the vertex is transformed and inserted
+				bool Access(uint32_t vertex)
+				{
+					if (m_InsertedAt[vertex] != NotCached and m_NumMisses - m_InsertedAt[vertex] < m_Size)
+						return false;
+
+					m_InsertedAt[vertex] = m_NumMisses++;
+					return true;
+				}
+
+				uint32_t AccessTriangle(const uint32_t* cornersPtr)
+				{
+					return uint32_t(Access(cornersPtr[0])) + uint32_t(Access(cornersPtr[1])) + uint32_t(Access(cornersPtr[2]));
+				}
+
+				//Everything inserted so far ends up size misses old, which is evicted
+				void Clear()
+				{
+					m_NumMisses += m_Size;
+				}
+
+			private:
+				static constexpr size_t NotCached{ SIZE_MAX };
+
+				std::vector<size_t> m_InsertedAt;
+				size_t m_NumMisses{};
+				uint32_t m_Size;
+			};
+
+			//Direction index of count, spread evenly over the unit sphere
+			Vector3 FibonacciDirection(uint32_t index, uint32_t count)
+			{
+				constexpr float GoldenAngle{ 2.39996323f };
+				const float y = 1.f - 2.f * (static_cast<float>(index) + 0.5f) / static_cast<float>(count);
+				const float radius = std::sqrt(std::max(0.f, 1.f - y * y));
+				const float angle = GoldenAngle * static_cast<float>(index);
+				return { radius * std::cos(angle), y, radius * std::sin(angle) };
+			}
+
+			float EdgeFunction(const Vector3& from, const Vector3& to, float x, float y)
+			{
+				return (to.x - from.x) * (y - from.y) - (to.y - from.y) * (x - from.x);
+			}
+
+			//Pixels exactly on an edge shared by two triangles belong to only one of them
+			bool IsTopLeftEdge(const Vector3& from, const Vector3& to)
+			{
+				return to.y > from.y or (to.y == from.y and to.x < from.x);
+			}
+
+			bool IsInside(float edgeValue, bool isTopLeft)
+			{
+				return edgeValue > 0.f or (edgeValue == 0.f and isTopLeft);
+			}
+
+			//Triangles whose three vertices all miss the cache, the vertex cache optimized order starts over there anyway
+			std::vector<size_t> FindHardBoundaries(std::span<const uint32_t> indices, size_t numVertices, uint32_t cacheSize, size_t& numMisses)
+			{
+				FIFOCache cache{ numVertices, cacheSize };
+				std::vector<size_t> hardBoundaries{};
+				const size_t numTriangles = indices.size() / 3;
+				for (size_t triangle = 0; triangle < numTriangles; ++triangle)
+				{
+					const uint32_t triangleMisses = cache.AccessTriangle(&indices[triangle * 3]);
+					numMisses += triangleMisses;
+					if (triangle == 0 or triangleMisses == 3)
+						hardBoundaries.push_back(triangle);
+				}
+				hardBoundaries.push_back(numTriangles);
+				return hardBoundaries;
+			}
+
+			//Splits every hard cluster as soon as the part so far is within maxClusterACMR, starting from a cold cache since the
+			//cluster drawn before it will be a different one after sorting. A last part that never gets there joins the one before it
+			//Returns the first triangle of every cluster followed by the number of triangles
+			std::vector<size_t> FindClusters(std::span<const uint32_t> indices, size_t numVertices, uint32_t cacheSize,
+				const std::vector<size_t>& hardBoundaries, float maxClusterACMR)
+			{
+				FIFOCache cache{ numVertices, cacheSize };
+				std::vector<size_t> clusterStarts{};
+				for (size_t hardCluster = 0; hardCluster + 1 < hardBoundaries.size(); ++hardCluster)
+				{
+					const size_t end = hardBoundaries[hardCluster + 1];
+					size_t clusterStart = hardBoundaries[hardCluster];
+					size_t clusterMisses = 0;
+					clusterStarts.push_back(clusterStart);
+					cache.Clear();
+
+					for (size_t triangle = clusterStart; triangle < end; ++triangle)
+					{
+						clusterMisses += cache.AccessTriangle(&indices[triangle * 3]);
+						if (triangle + 1 < end and static_cast<float>(clusterMisses) <= maxClusterACMR * static_cast<float>(triangle + 1 - clusterStart))
+						{
+							clusterStart = triangle + 1;
+							clusterMisses = 0;
+							clusterStarts.push_back(clusterStart);
+							cache.Clear();
+						}
+					}
+
+					if (clusterStart != hardBoundaries[hardCluster] and static_cast<float>(clusterMisses) > maxClusterACMR * static_cast<float>(end - clusterStart))
+						clusterStarts.pop_back();
+				}
+				clusterStarts.push_back(indices.size() / 3);
+				return clusterStarts;
+			}
+
+			//Draws clusters far out along their normal first, they are in front of the rest from most directions they are visible from
+			//Uses the area weighted vertex normals, those face outward whatever the winding
+			void SortClusters(std::span<const uint32_t> indices, std::span<const Vertex> vertices, const std::vector<size_t>& clusterStarts, std::vector<uint32_t>& sorted)
+			{
+				struct Cluster
+				{
+					Vector3 weightedCentroid{};
+					Vector3 normal{};
+					float area{};
+				};
+
+				const size_t numClusters = clusterStarts.size() - 1;
+				std::vector<Cluster> clusters(numClusters);
+				Vector3 meshWeightedCentroid{};
+				float meshArea = 0.f;
+				for (size_t clusterIndex = 0; clusterIndex < numClusters; ++clusterIndex)
+				{
+					Cluster& cluster = clusters[clusterIndex];
+					for (size_t triangle = clusterStarts[clusterIndex]; triangle < clusterStarts[clusterIndex + 1]; ++triangle)
+					{
+						const Vertex& v0 = vertices[indices[triangle * 3]];
+						const Vertex& v1 = vertices[indices[triangle * 3 + 1]];
+						const Vertex& v2 = vertices[indices[triangle * 3 + 2]];
+						const float area = Vector3::Cross(v1.position - v0.position, v2.position - v0.position).Magnitude() * 0.5f;
+						cluster.weightedCentroid += (v0.position + v1.position + v2.position) * (area / 3.f);
+						cluster.normal += (v0.normal + v1.normal + v2.normal) * area;
+						cluster.area += area;
+					}
+					meshWeightedCentroid += cluster.weightedCentroid;
+					meshArea += cluster.area;
+				}
+
+				std::vector<float> sortKeys(numClusters, 0.f);
+				if (meshArea > 0.f)
+				{
+					const Vector3 meshCentroid = meshWeightedCentroid / meshArea;
+					for (size_t clusterIndex = 0; clusterIndex < numClusters; ++clusterIndex)
+					{
+						Cluster& cluster = clusters[clusterIndex];
+						if (cluster.area > 0.f and cluster.normal.Normalize() > 0.f)
+							sortKeys[clusterIndex] = Vector3::Dot(cluster.weightedCentroid / cluster.area - meshCentroid, cluster.normal);
+					}
+				}
+
+				std::vector<size_t> clusterOrder(numClusters);
+				std::iota(clusterOrder.begin(), clusterOrder.end(), size_t{ 0 });
+				std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&sortKeys](size_t a, size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+				auto sortedIt = sorted.begin();
+				for (const size_t clusterIndex : clusterOrder)
+					sortedIt = std::copy(indices.begin() + clusterStarts[clusterIndex] * 3, indices.begin() + clusterStarts[clusterIndex + 1] * 3, sortedIt);
+			}
+
+			size_t CountReferencedVertices(std::span<const uint32_t> indices, size_t numVertices)
+			{
+				std::vector<bool> isReferenced(numVertices, false);
+				size_t numReferenced = 0;
+				for (const uint32_t index : indices)
+				{
+					if (!isReferenced[index])
+					{
+						isReferenced[index] = true;
+						++numReferenced;
+					}
+				}
+				return numReferenced;
+			}
+		}
+
+		VertexCacheStats AnalyzeVertexCache(std::span<const uint32_t> indices, size_t numVertices, uint32_t cacheSize, CacheModel cacheModel)
+		{
+			VertexCacheStats stats{};
+			if (indices.empty() or cacheSize == 0)
+				return stats;
+
+			if (cacheModel == CacheModel::FIFO)
+			{
+				FIFOCache cache{ numVertices, cacheSize };
+				for (const uint32_t index : indices)
+					stats.numTransformed += cache.Access(index) ? 1 : 0;
+			}
+			else
+			{
+				std::vector<uint32_t> cache{};
+				cache.reserve(cacheSize + 1);
+				for (const uint32_t index : indices)
+				{
+					const auto cachedIt = std::find(cache.begin(), cache.end(), index);
+					if (cachedIt != cache.end())
+					{
+						std::rotate(cache.begin(), cachedIt, cachedIt + 1);
+						continue;
+					}
+
+					cache.insert(cache.begin(), index);
+					if (cache.size() > cacheSize)
+						cache.pop_back();
+					++stats.numTransformed;
+				}
+			}
+
+			stats.acmr = static_cast<float>(stats.numTransformed) / static_cast<float>(indices.size() / 3);
+			stats.atvr = static_cast<float>(stats.numTransformed) / static_cast<float>(CountReferencedVertices(indices, numVertices));
+			return stats;
+		}
+
+		void OptimizeVertexCache(std::span<uint32_t> indices, size_t numVertices)
+		{
+			const size_t numTriangles = indices.size() / 3;
+			if (numTriangles < 2)
+				return;
+
+			static const ScoreTables tables{};
+
+			//Triangles of every vertex, the ones that still have to be drawn are kept at the front of each list
+			std::vector<uint32_t> numActive(numVertices, 0);
+			for (const uint32_t index : indices)
+				++numActive[index];
+
+			std::vector<uint32_t> firstTriangle(numVertices + 1, 0);
+			for (size_t vertex = 0; vertex < numVertices; ++vertex)
+				firstTriangle[vertex + 1] = firstTriangle[vertex] + numActive[vertex];
+
+			std::vector<uint32_t> vertexTriangles(indices.size());
+			{
+				std::vector<uint32_t> fillCounts(numVertices, 0);
+				for (size_t corner = 0; corner < indices.size(); ++corner)
+				{
+					const uint32_t vertex = indices[corner];
+					vertexTriangles[firstTriangle[vertex] + fillCounts[vertex]++] = static_cast<uint32_t>(corner / 3);
+				}
+			}
+
+			std::vector<int> cachePositions(numVertices, -1);
+			std::vector<float> vertexScores(numVertices);
+			for (size_t vertex = 0; vertex < numVertices; ++vertex)
+				vertexScores[vertex] = VertexScore(tables, -1, numActive[vertex]);
+
+			std::vector<float> triangleScores(numTriangles);
+			std::vector<bool> isEmitted(numTriangles, false);
+			uint32_t bestTriangle = 0;
+			for (size_t triangle = 0; triangle < numTriangles; ++triangle)
+			{
+				const uint32_t* cornersPtr = &indices[triangle * 3];
+				triangleScores[triangle] = vertexScores[cornersPtr[0]] + vertexScores[cornersPtr[1]] + vertexScores[cornersPtr[2]];
+				if (triangleScores[triangle] > triangleScores[bestTriangle])
+					bestTriangle = static_cast<uint32_t>(triangle);
+			}
+
+			std::vector<uint32_t> optimized(indices.size());
+			std::vector<uint32_t> cache{};
+			std::vector<uint32_t> nextCache{};
+			cache.reserve(ScoredCacheSize + 3);
+			nextCache.reserve(ScoredCacheSize + 3);
+			size_t nextUnemitted = 0;
+
+			for (size_t numEmitted = 0; numEmitted < numTriangles; ++numEmitted)
+			{
+				//Dead end: nothing in the cache has triangles left, continue with the first triangle that is not drawn yet
+				if (bestTriangle == NoTriangle)
+				{
+					while (isEmitted[nextUnemitted])
+						++nextUnemitted;
+					bestTriangle = static_cast<uint32_t>(nextUnemitted);
+				}
+
+				const uint32_t* cornersPtr = &indices[size_t(bestTriangle) * 3];
+				std::copy(cornersPtr, cornersPtr + 3, &optimized[numEmitted * 3]);
+				isEmitted[bestTriangle] = true;
+
+				//Swap the triangle out of the active part of its vertices' lists
+				nextCache.clear();
+				for (int corner = 0; corner < 3; ++corner)
+				{
+					const uint32_t vertex = cornersPtr[corner];
+					uint32_t* trianglesPtr = &vertexTriangles[firstTriangle[vertex]];
+					const uint32_t numVertexTriangles = numActive[vertex]--;
+					std::swap(*std::find(trianglesPtr, trianglesPtr + numVertexTriangles, bestTriangle), trianglesPtr[numVertexTriangles - 1]);
+
+					if (std::find(nextCache.begin(), nextCache.end(), vertex) == nextCache.end())
+						nextCache.push_back(vertex);
+				}
+
+				//The new triangle's vertices move to the front, everything else shifts back
+				for (const uint32_t vertex : cache)
+				{
+					if (std::find(nextCache.begin(), nextCache.end(), vertex) == nextCache.end())
+						nextCache.push_back(vertex);
+				}
+
+				for (size_t position = 0; position < nextCache.size(); ++position)
+				{
+					const uint32_t vertex = nextCache[position];
+					cachePositions[vertex] = position < ScoredCacheSize ? static_cast<int>(position) : -1;
+					vertexScores[vertex] = VertexScore(tables, cachePositions[vertex], numActive[vertex]);
+				}
+
+				//Only triangles touching the cache changed score, the best of them is drawn next
+				bestTriangle = NoTriangle;
+				float bestScore = -1.f;
+				for (const uint32_t vertex : nextCache)
+				{
+					const uint32_t* trianglesPtr = &vertexTriangles[firstTriangle[vertex]];
+					for (uint32_t i = 0; i < numActive[vertex]; ++i)
+					{
+						const uint32_t triangle = trianglesPtr[i];
+						const uint32_t* trianglePtr = &indices[size_t(triangle) * 3];
+						triangleScores[triangle] = vertexScores[trianglePtr[0]] + vertexScores[trianglePtr[1]] + vertexScores[trianglePtr[2]];
+						if (triangleScores[triangle] > bestScore)
+						{
+							bestScore = triangleScores[triangle];
+							bestTriangle = triangle;
+						}
+					}
+				}
+
+				if (nextCache.size() > ScoredCacheSize)
+					nextCache.resize(ScoredCacheSize);
+				cache.swap(nextCache);
+			}
+
+			std::copy(optimized.begin(), optimized.end(), indices.begin());
+		}
+
+		void OptimizeOverdraw(std::span<uint32_t> indices, std::span<const Vertex> vertices, float maxACMRLoss, uint32_t cacheSize)
+		{
+			const size_t numTriangles = indices.size() / 3;
+			if (numTriangles < 2 or cacheSize == 0)
+				return;
+
+			size_t numMisses = 0;
+			const std::vector<size_t> hardBoundaries = FindHardBoundaries(indices, vertices.size(), cacheSize, numMisses);
+			const float maxACMR = static_cast<float>(numMisses) / static_cast<float>(numTriangles) * (1.f + maxACMRLoss);
+
+			//Clusters start from a cold cache but the ACMR they are compared against is measured warm, so the first split
+			//can overshoot the budget. Longer clusters are tried until one fits, down to splitting at hard boundaries only
+			std::vector<uint32_t> sorted(indices.size());
+			for (const float clusterScale : { 1.f, 0.9f, 0.8f, 0.7f, 0.f })
+			{
+				const std::vector<size_t> clusterStarts = FindClusters(indices, vertices.size(), cacheSize, hardBoundaries, maxACMR * clusterScale);
+				SortClusters(indices, vertices, clusterStarts, sorted);
+				if (AnalyzeVertexCache(sorted, vertices.size(), cacheSize).acmr > maxACMR)
+					continue;
+
+				//The cluster directions are only a guess at what occludes what, concave meshes can come out drawing more hidden pixels
+				if (AnalyzeOverdraw(sorted, vertices).overdraw < AnalyzeOverdraw(indices, vertices).overdraw)
+					std::copy(sorted.begin(), sorted.end(), indices.begin());
+				return;
+			}
+		}
+
+		OverdrawStats AnalyzeOverdraw(std::span<const uint32_t> indices, std::span<const Vertex> vertices, bool cullBackFaces, uint32_t numViewpoints, uint32_t resolution)
+		{
+			OverdrawStats stats{};
+			if (indices.size() < 3 or vertices.empty() or numViewpoints == 0 or resolution == 0)
+				return stats;
+
+			//Every view fits the bounding sphere, so the mesh covers about the same pixels from each direction
+			Vector3 boundsMin = vertices[0].position;
+			Vector3 boundsMax = vertices[0].position;
+			for (const Vertex& vertex : vertices)
+			{
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					boundsMin[axis] = std::min(boundsMin[axis], vertex.position[axis]);
+					boundsMax[axis] = std::max(boundsMax[axis], vertex.position[axis]);
+				}
+			}
+			const Vector3 center = (boundsMin + boundsMax) * 0.5f;
+			float radius = 0.f;
+			for (const Vertex& vertex : vertices)
+				radius = std::max(radius, (vertex.position - center).Magnitude());
+			if (radius <= 0.f)
+				return stats;
+
+			const float pixelsPerUnit = static_cast<float>(resolution) * 0.5f / radius;
+			std::vector<Vector3> projected(vertices.size());
+			std::vector<float> depthBuffer(size_t(resolution) * resolution);
+
+			for (uint32_t viewpoint = 0; viewpoint < numViewpoints; ++viewpoint)
+			{
+				const Vector3 forward = FibonacciDirection(viewpoint, numViewpoints);
+				Vector3 right = Vector3::Cross(std::abs(forward.y) < 0.99f ? Vector3::UnitY : Vector3::UnitX, forward);
+				right.Normalize();
+				const Vector3 up = Vector3::Cross(forward, right);
+
+				//x and y in pixels, z the distance along the view direction
+				for (size_t vertex = 0; vertex < vertices.size(); ++vertex)
+				{
+					const Vector3 offset = vertices[vertex].position - center;
+					projected[vertex] = { (Vector3::Dot(offset, right) + radius) * pixelsPerUnit, (Vector3::Dot(offset, up) + radius) * pixelsPerUnit, Vector3::Dot(offset, forward) };
+				}
+				std::fill(depthBuffer.begin(), depthBuffer.end(), FLT_MAX);
+
+				for (size_t corner = 0; corner + 2 < indices.size(); corner += 3)
+				{
+					const Vector3& v0 = projected[indices[corner]];
+					Vector3 v1 = projected[indices[corner + 1]];
+					Vector3 v2 = projected[indices[corner + 2]];
+					//Positive when counterclockwise as the viewer sees it, a back face with FrontCounterClockwise = false
+					float area = EdgeFunction(v0, v1, v2.x, v2.y);
+					if (area == 0.f or (cullBackFaces and area > 0.f))
+						continue;
+					if (area < 0.f)
+					{
+						std::swap(v1, v2);
+						area = -area;
+					}
+
+					const bool isTopLeft0 = IsTopLeftEdge(v1, v2);
+					const bool isTopLeft1 = IsTopLeftEdge(v2, v0);
+					const bool isTopLeft2 = IsTopLeftEdge(v0, v1);
+					const int minX = std::max(0, static_cast<int>(std::floor(std::min({ v0.x, v1.x, v2.x }))));
+					const int minY = std::max(0, static_cast<int>(std::floor(std::min({ v0.y, v1.y, v2.y }))));
+					const int maxX = std::min(static_cast<int>(resolution) - 1, static_cast<int>(std::ceil(std::max({ v0.x, v1.x, v2.x }))));
+					const int maxY = std::min(static_cast<int>(resolution) - 1, static_cast<int>(std::ceil(std::max({ v0.y, v1.y, v2.y }))));
+
+					for (int y = minY; y <= maxY; ++y)
+					{
+						const float pixelY = static_cast<float>(y) + 0.5f;
+						for (int x = minX; x <= maxX; ++x)
+						{
+							const float pixelX = static_cast<float>(x) + 0.5f;
+							const float w0 = EdgeFunction(v1, v2, pixelX, pixelY);
+							const float w1 = EdgeFunction(v2, v0, pixelX, pixelY);
+							const float w2 = EdgeFunction(v0, v1, pixelX, pixelY);
+							if (!IsInside(w0, isTopLeft0) or !IsInside(w1, isTopLeft1) or !IsInside(w2, isTopLeft2))
+								continue;
+
+							const float depth = (w0 * v0.z + w1 * v1.z + w2 * v2.z) / area;
+							float& storedDepth = depthBuffer[size_t(y) * resolution + x];
+							if (depth < storedDepth)
+							{
+								storedDepth = depth;
+								++stats.numShaded;
+							}
+						}
+					}
+				}
+
+				stats.numCovered += static_cast<size_t>(std::count_if(depthBuffer.begin(), depthBuffer.end(), [](float depth) { return depth != FLT_MAX; }));
+			}
+
+			stats.overdraw = stats.numCovered > 0 ? static_cast<float>(stats.numShaded) / static_cast<float>(stats.numCovered) : 0.f;
+			return stats;
+		}
+
+		VertexFetchStats AnalyzeVertexFetch(std::span<const uint32_t> indices, size_t numVertices, size_t vertexSize,
+			uint32_t postTransformCacheSize, uint32_t cacheLineSize, uint32_t numCacheLines)
+		{
+			VertexFetchStats stats{};
+			if (indices.empty() or vertexSize == 0 or cacheLineSize == 0)
+				return stats;
+
+			stats.uniqueBytes = CountReferencedVertices(indices, numVertices) * vertexSize;
+
+			FIFOCache transformCache{ numVertices, postTransformCacheSize };
+			FIFOCache lineCache{ (numVertices * vertexSize + cacheLineSize - 1) / cacheLineSize, numCacheLines };
+			for (const uint32_t index : indices)
+			{
+				if (postTransformCacheSize > 0 and !transformCache.Access(index))
+					continue;
+
+				const size_t firstLine = index * vertexSize / cacheLineSize;
+				const size_t lastLine = ((index + 1) * vertexSize - 1) / cacheLineSize;
+				for (size_t line = firstLine; line <= lastLine; ++line)
+				{
+					if (lineCache.Access(static_cast<uint32_t>(line)))
+						stats.bytesFetched += cacheLineSize;
+				}
+			}
+
+			stats.overfetch = static_cast<float>(stats.bytesFetched) / static_cast<float>(stats.uniqueBytes);
+			return stats;
+		}
+
+		size_t OptimizeVertexFetch(std::span<Vertex> vertices, std::span<uint32_t> indices)
+		{
+			constexpr uint32_t Unreferenced{ UINT32_MAX };
+			std::vector<uint32_t> remap(vertices.size(), Unreferenced);
+			uint32_t numReferenced = 0;
+			for (uint32_t& index : indices)
+			{
+				if (remap[index] == Unreferenced)
+					remap[index] = numReferenced++;
+				index = remap[index];
+			}
+
+			std::vector<Vertex> reordered(vertices.size());
+			uint32_t numUnreferenced = 0;
+			for (size_t vertex = 0; vertex < vertices.size(); ++vertex)
+			{
+				const uint32_t target = remap[vertex] != Unreferenced ? remap[vertex] : numReferenced + numUnreferenced++;
+				reordered[target] = vertices[vertex];
+			}
+			std::copy(reordered.begin(), reordered.end(), vertices.begin());
+			return numReferenced;
+		}
+
+		size_t OptimizeMesh(std::span<Vertex> vertices, std::span<uint32_t> indices, std::span<const Utils::OBJSubmesh> submeshes,
+			const OptimizeOptions& options, OptimizeReport* reportPtr)
+		{
+			if (reportPtr)
+			{
+				reportPtr->before = AnalyzeVertexCache(indices, vertices.size(), options.cacheSize, options.cacheModel);
+				reportPtr->overdrawBefore = AnalyzeOverdraw(indices, vertices, options.cullBackFaces, options.numOverdrawViewpoints, options.overdrawResolution);
+				reportPtr->fetchBefore = AnalyzeVertexFetch(indices, vertices.size(), sizeof(Vertex), options.cacheSize);
+			}
+
+			//Meshes without material data are one range
+			const Utils::OBJSubmesh wholeMesh{ "", 0, static_cast<uint32_t>(indices.size()) };
+			const std::span<const Utils::OBJSubmesh> ranges = submeshes.empty() ? std::span<const Utils::OBJSubmesh>{ &wholeMesh, 1 } : submeshes;
+
+			if (options.optimizeVertexCache)
+			{
+				for (const Utils::OBJSubmesh& range : ranges)
+					OptimizeVertexCache(indices.subspan(range.firstIndex, range.numIndices), vertices.size());
+			}
+
+			if (options.optimizeOverdraw)
+			{
+				for (const Utils::OBJSubmesh& range : ranges)
+					OptimizeOverdraw(indices.subspan(range.firstIndex, range.numIndices), vertices, options.maxACMRLoss, options.cacheSize);
+			}
+
+			//Last, it only renames vertices and keeps the triangle order the other stages chose
+			size_t numReferenced = vertices.size();
+			if (options.optimizeVertexFetch)
+				numReferenced = OptimizeVertexFetch(vertices, indices);
+
+			if (reportPtr)
+			{
+				reportPtr->after = AnalyzeVertexCache(indices, vertices.size(), options.cacheSize, options.cacheModel);
+				reportPtr->overdrawAfter = AnalyzeOverdraw(indices, vertices, options.cullBackFaces, options.numOverdrawViewpoints, options.overdrawResolution);
+				reportPtr->fetchAfter = AnalyzeVertexFetch(indices, vertices.size(), sizeof(Vertex), options.cacheSize);
+			}
+			return numReferenced;
+		}
+	}
+}
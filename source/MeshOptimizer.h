@@ -0,0 +1,110 @@
+#pragma once
+#include "Vertex.h"
+#include "Utils.h"
+#include <span>
+#include <vector>
+
+namespace dae
+{
+	namespace MeshOptimizer
+	{
+		enum class CacheModel
+		{
+			//Fixed size queue, a hit does not move the vertex, like the post-transform cache of most GPUs
+			FIFO,
+			//A hit moves the vertex to the front
+			LRU,
+		};
+
+		struct VertexCacheStats
+		{
+			size_t numTransformed{};
+			//Average cache miss ratio: transformed vertices per triangle, 3 is the worst and about 0.5 the best on a regular grid
+			float acmr{};
+			//Average transformed vertex ratio: transformed vertices per referenced vertex, 1 is the best
+			float atvr{};
+		};
+
+		//Runs the indices through a simulated post-transform cache of cacheSize vertices
+		VertexCacheStats AnalyzeVertexCache(std::span<const uint32_t> indices, size_t numVertices, uint32_t cacheSize = 16, CacheModel cacheModel = CacheModel::FIFO);
+
+		//Forsyth's linear-speed vertex cache optimization: greedily emits the triangle whose vertices score best
+		//for their position in a simulated LRU cache and the number of triangles still using them
+		//Reorders the triangles in place, their winding is kept
+		void OptimizeVertexCache(std::span<uint32_t> indices, size_t numVertices);
+
+		//Splits vertex cache optimized indices into clusters and draws the clusters that face outward, away from the mesh center,
+		//first, so they fill the depth buffer before what they hide. The FIFO ACMR of the result grows by at most maxACMRLoss,
+		//the indices are left as they are when no clustering fits in that or when AnalyzeOverdraw does not measure less overdraw
+		//Only meant for meshes that cull back faces and write depth, blended meshes shade every covered pixel in any order
+		void OptimizeOverdraw(std::span<uint32_t> indices, std::span<const Vertex> vertices, float maxACMRLoss = 0.05f, uint32_t cacheSize = 16);
+
+		struct OverdrawStats
+		{
+			//Pixels covered by the mesh, summed over every viewpoint
+			size_t numCovered{};
+			//Pixels that passed the depth test, each of them runs the pixel shader
+			size_t numShaded{};
+			//Shaded per covered pixel, 1 is the best
+			float overdraw{};
+		};
+
+		//Rasterizes depth only, in index order, from numViewpoints orthographic views spread evenly over a sphere around the mesh,
+		//at resolution x resolution pixels each. Back faces are counterclockwise on screen, FrontCounterClockwise is false in the default
+		//D3D11 rasterizer state the vehicle is drawn with. The FireFX pass culls nothing
+		OverdrawStats AnalyzeOverdraw(std::span<const uint32_t> indices, std::span<const Vertex> vertices, bool cullBackFaces = true,
+			uint32_t numViewpoints = 16, uint32_t resolution = 256);
+
+		struct VertexFetchStats
+		{
+			//Cache lines read from the vertex buffer, in bytes
+			size_t bytesFetched{};
+			//Size of the vertices the indices reference
+			size_t uniqueBytes{};
+			//Fetched per unique byte, 1 is the best and can only be beaten by vertices sharing a line with unreferenced ones
+			float overfetch{};
+		};
+
+		//Reads the vertices of indices through a FIFO cache of numCacheLines lines of cacheLineSize bytes. With a post-transform cache
+		//of postTransformCacheSize vertices in front of it like on the GPU, or 0 for a CPU path that reads every index
+		VertexFetchStats AnalyzeVertexFetch(std::span<const uint32_t> indices, size_t numVertices, size_t vertexSize,
+			uint32_t postTransformCacheSize = 16, uint32_t cacheLineSize = 64, uint32_t numCacheLines = 64);
+
+		//Moves the vertices into the order the indices first reference them and rewrites the indices to match, so consecutive
+		//triangles read neighbouring memory. Unreferenced vertices end up behind the referenced ones, their count is returned
+		size_t OptimizeVertexFetch(std::span<Vertex> vertices, std::span<uint32_t> indices);
+
+		struct OptimizeOptions
+		{
+			bool optimizeVertexCache = true;
+			bool optimizeOverdraw = true;
+			bool optimizeVertexFetch = true;
+			//Fraction the ACMR may grow by to reduce overdraw, 0.05 allows 5% more transformed vertices
+			float maxACMRLoss = 0.05f;
+			//Cache the statistics in the report are measured with, the optimizer itself does not depend on it
+			uint32_t cacheSize = 16;
+			CacheModel cacheModel = CacheModel::FIFO;
+			//Overdraw measurement for the report
+			bool cullBackFaces = true;
+			uint32_t numOverdrawViewpoints = 16;
+			uint32_t overdrawResolution = 256;
+		};
+
+		struct OptimizeReport
+		{
+			VertexCacheStats before{};
+			VertexCacheStats after{};
+			OverdrawStats overdrawBefore{};
+			OverdrawStats overdrawAfter{};
+			//Post-transform cache of OptimizeOptions::cacheSize in front of 64 byte lines, like the GPU reads the vertex buffer
+			VertexFetchStats fetchBefore{};
+			VertexFetchStats fetchAfter{};
+		};
+
+		//Processing stage every mesh goes through before it is cached or cooked, so Mesh uploads buffers that are already in draw order
+		//Every submesh range is optimized on its own, materials keep their contiguous index ranges. The vertices are shared by every range
+		//Returns the number of referenced vertices, the vertex fetch stage moves unreferenced ones behind them to be dropped
+		size_t OptimizeMesh(std::span<Vertex> vertices, std::span<uint32_t> indices, std::span<const Utils::OBJSubmesh> submeshes,
+			const OptimizeOptions& options = {}, OptimizeReport* reportPtr = nullptr);
+	}
+}
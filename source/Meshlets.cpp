@@ -0,0 +1,296 @@
+#include "pch.h"
+#include "Meshlets.h"
+
+#include <cmath>
+
+namespace dae
+{
+	namespace Meshlets
+	{
+		namespace
+		{
+			struct TriangleNormal
+			{
+				Vector3 normal{};
+				Vector3 corner{};
+			};
+
+			void ComputeBounds(Meshlet& meshlet, std::span<const uint32_t> indices, std::span<const Vector3> positions, std::span<const uint32_t> meshletVertices,
+				std::vector<TriangleNormal>& normals)
+			{
+				Vector3 boundsMin = positions[meshletVertices.front()];
+				Vector3 boundsMax = boundsMin;
+				for (const uint32_t vertex : meshletVertices)
+				{
+					for (int axis = 0; axis < 3; ++axis)
+					{
+						boundsMin[axis] = std::min(boundsMin[axis], positions[vertex][axis]);
+						boundsMax[axis] = std::max(boundsMax[axis], positions[vertex][axis]);
+					}
+				}
+				meshlet.center = (boundsMin + boundsMax) * 0.5f;
+				meshlet.radius = 0.f;
+				for (const uint32_t vertex : meshletVertices)
+					meshlet.radius = std::max(meshlet.radius, (positions[vertex] - meshlet.center).Magnitude());
+
+				//With left handed coordinates and clockwise front faces the cross product of the edges points out of the front side
+				normals.clear();
+				Vector3 normalSum{};
+				for (uint32_t corner = meshlet.firstIndex; corner < meshlet.firstIndex + meshlet.numIndices; corner += 3)
+				{
+					const Vector3& v0 = positions[indices[corner]];
+					Vector3 normal = Vector3::Cross(positions[indices[corner + 1]] - v0, positions[indices[corner + 2]] - v0);
+					if (normal.Normalize() <= 0.f)
+						continue;
+					normals.push_back({ normal, v0 });
+					normalSum += normal;
+				}
+
+				meshlet.coneCutoff = 2.f;
+				Vector3 axis = normalSum;
+				if (normals.empty() or axis.Normalize() <= 0.f)
+					return;
+
+				float minDot = 1.f;
+				for (const TriangleNormal& triangle : normals)
+					minDot = std::min(minDot, Vector3::Dot(triangle.normal, axis));
+				//Normals more than 90 degrees apart always have a triangle facing the viewer
+				if (minDot <= 0.f)
+					return;
+
+				//The apex lies behind every triangle plane, so a view direction inside the cone sees the back of every triangle from anywhere
+				float apexDistance = 0.f;
+				for (const TriangleNormal& triangle : normals)
+					apexDistance = std::max(apexDistance, Vector3::Dot(meshlet.center - triangle.corner, triangle.normal) / Vector3::Dot(axis, triangle.normal));
+
+				meshlet.coneApex = meshlet.center - axis * apexDistance;
+				meshlet.coneAxis = axis;
+				meshlet.coneCutoff = std::sqrt(1.f - minDot * minDot);
+			}
+
+			float EdgeFunction(const Vector3& a, const Vector3& b, float x, float y)
+			{
+				return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+			}
+
+			//Pixels with y going down and the depth of D3D, false when the point is in front of the near plane
+			bool ProjectToPixels(const Vector3& position, const Matrix& worldViewProjection, uint32_t width, uint32_t height, Vector3& projected)
+			{
+				const Vector4 clip = worldViewProjection.TransformPoint(Vector4{ position, 1.f });
+				if (clip.z < 0.f or clip.w <= 0.f)
+					return false;
+
+				projected = { (clip.x / clip.w * 0.5f + 0.5f) * static_cast<float>(width), (0.5f - clip.y / clip.w * 0.5f) * static_cast<float>(height), clip.z / clip.w };
+				return true;
+			}
+		}
+
+		std::vector<Meshlet> Build(std::span<const uint32_t> indices, std::span<const Vector3> positions, std::span<const Utils::OBJSubmesh> submeshes,
+			size_t maxVertices, size_t maxTriangles)
+		{
+			std::vector<Meshlet> meshlets{};
+			if (indices.size() < 3 or positions.empty() or maxVertices < 3 or maxTriangles == 0)
+				return meshlets;
+
+			//Meshes without material data are one range
+			const Utils::OBJSubmesh wholeMesh{ "", 0, static_cast<uint32_t>(indices.size()) };
+			const std::span<const Utils::OBJSubmesh> ranges = submeshes.empty() ? std::span<const Utils::OBJSubmesh>{ &wholeMesh, 1 } : submeshes;
+
+			//The meshlet each vertex was last added to, so every vertex is counted once per meshlet
+			std::vector<uint32_t> vertexMeshlets(positions.size(), UINT32_MAX);
+			std::vector<uint32_t> meshletVertices{};
+			std::vector<TriangleNormal> normals{};
+			meshletVertices.reserve(maxVertices);
+			normals.reserve(maxTriangles);
+
+			Meshlet meshlet{};
+			const auto finishMeshlet = [&]()
+				{
+					meshlet.numVertices = static_cast<uint32_t>(meshletVertices.size());
+					ComputeBounds(meshlet, indices, positions, meshletVertices, normals);
+					meshlets.push_back(meshlet);
+					meshletVertices.clear();
+				};
+
+			for (const Utils::OBJSubmesh& range : ranges)
+			{
+				const size_t rangeEnd = std::min<size_t>(size_t(range.firstIndex) + range.numIndices, indices.size());
+				meshlet = { range.firstIndex };
+				for (size_t corner = range.firstIndex; corner + 3 <= rangeEnd; corner += 3)
+				{
+					const uint32_t meshletIndex = static_cast<uint32_t>(meshlets.size());
+					const uint32_t triangle[3]{ indices[corner], indices[corner + 1], indices[corner + 2] };
+					size_t numNewVertices = 0;
+					for (int vertex = 0; vertex < 3; ++vertex)
+					{
+						const bool isRepeated = (vertex > 0 and triangle[vertex] == triangle[0]) or (vertex > 1 and triangle[vertex] == triangle[1]);
+						numNewVertices += !isRepeated and vertexMeshlets[triangle[vertex]] != meshletIndex;
+					}
+
+					if (meshlet.numIndices > 0 and (meshletVertices.size() + numNewVertices > maxVertices or meshlet.numIndices / 3 == maxTriangles))
+					{
+						finishMeshlet();
+						meshlet = { static_cast<uint32_t>(corner) };
+					}
+
+					const uint32_t currentIndex = static_cast<uint32_t>(meshlets.size());
+					for (const uint32_t vertex : triangle)
+					{
+						if (vertexMeshlets[vertex] != currentIndex)
+						{
+							vertexMeshlets[vertex] = currentIndex;
+							meshletVertices.push_back(vertex);
+						}
+					}
+					meshlet.numIndices += 3;
+				}
+
+				if (meshlet.numIndices > 0)
+					finishMeshlet();
+			}
+			return meshlets;
+		}
+
+		Frustum ExtractFrustum(const Matrix& worldViewProjection)
+		{
+			//Column j of the matrix gives clip coordinate j of a point, x, y and z are inside when -w <= x, y <= w and 0 <= z <= w
+			Vector4 columns[4]{};
+			for (int column = 0; column < 4; ++column)
+				columns[column] = { worldViewProjection[0][column], worldViewProjection[1][column], worldViewProjection[2][column], worldViewProjection[3][column] };
+
+			Frustum frustum{};
+			frustum.planes[0] = columns[3] + columns[0];
+			frustum.planes[1] = columns[3] - columns[0];
+			frustum.planes[2] = columns[3] + columns[1];
+			frustum.planes[3] = columns[3] - columns[1];
+			frustum.planes[4] = columns[2];
+			frustum.planes[5] = columns[3] - columns[2];
+			for (Vector4& plane : frustum.planes)
+			{
+				const float length = plane.GetXYZ().Magnitude();
+				if (length > 0.f)
+					plane = plane * (1.f / length);
+			}
+			return frustum;
+		}
+
+		bool IsOutsideFrustum(const Meshlet& meshlet, const Frustum& frustum)
+		{
+			for (const Vector4& plane : frustum.planes)
+			{
+				if (Vector3::Dot(plane.GetXYZ(), meshlet.center) + plane.w < -meshlet.radius)
+					return true;
+			}
+			return false;
+		}
+
+		bool IsBackFacing(const Meshlet& meshlet, const Vector3& cameraPosition)
+		{
+			if (meshlet.coneCutoff > 1.f)
+				return false;
+
+			Vector3 viewDirection = meshlet.coneApex - cameraPosition;
+			if (viewDirection.Normalize() <= 0.f)
+				return false;
+			return Vector3::Dot(viewDirection, meshlet.coneAxis) >= meshlet.coneCutoff;
+		}
+
+		void RasterizeOccluders(OcclusionBuffer& buffer, std::span<const uint32_t> indices, std::span<const Vector3> positions,
+			const Matrix& worldViewProjection, const Vector3& cameraPosition)
+		{
+			buffer.depths.assign(size_t(buffer.width) * buffer.height, 1.f);
+
+			for (size_t corner = 0; corner + 3 <= indices.size(); corner += 3)
+			{
+				const Vector3& p0 = positions[indices[corner]];
+				const Vector3& p1 = positions[indices[corner + 1]];
+				const Vector3& p2 = positions[indices[corner + 2]];
+				//Back faces are culled when drawing, so they hide nothing
+				if (Vector3::Dot(Vector3::Cross(p1 - p0, p2 - p0), p0 - cameraPosition) >= 0.f)
+					continue;
+
+				Vector3 v0{}, v1{}, v2{};
+				if (!ProjectToPixels(p0, worldViewProjection, buffer.width, buffer.height, v0)
+					or !ProjectToPixels(p1, worldViewProjection, buffer.width, buffer.height, v1)
+					or !ProjectToPixels(p2, worldViewProjection, buffer.width, buffer.height, v2))
+					continue;
+
+				float area = EdgeFunction(v0, v1, v2.x, v2.y);
+				if (area == 0.f)
+					continue;
+				if (area < 0.f)
+				{
+					std::swap(v1, v2);
+					area = -area;
+				}
+
+				const int minX = std::max(0, static_cast<int>(std::floor(std::min({ v0.x, v1.x, v2.x }))));
+				const int minY = std::max(0, static_cast<int>(std::floor(std::min({ v0.y, v1.y, v2.y }))));
+				const int maxX = std::min(static_cast<int>(buffer.width) - 1, static_cast<int>(std::ceil(std::max({ v0.x, v1.x, v2.x }))));
+				const int maxY = std::min(static_cast<int>(buffer.height) - 1, static_cast<int>(std::ceil(std::max({ v0.y, v1.y, v2.y }))));
+				for (int y = minY; y <= maxY; ++y)
+				{
+					const float pixelY = static_cast<float>(y) + 0.5f;
+					for (int x = minX; x <= maxX; ++x)
+					{
+						const float pixelX = static_cast<float>(x) + 0.5f;
+						const float w0 = EdgeFunction(v1, v2, pixelX, pixelY);
+						const float w1 = EdgeFunction(v2, v0, pixelX, pixelY);
+						const float w2 = EdgeFunction(v0, v1, pixelX, pixelY);
+						if (w0 < 0.f or w1 < 0.f or w2 < 0.f)
+							continue;
+
+						const float depth = (w0 * v0.z + w1 * v1.z + w2 * v2.z) / area;
+						float& storedDepth = buffer.depths[size_t(y) * buffer.width + x];
+						storedDepth = std::min(storedDepth, depth);
+					}
+				}
+			}
+		}
+
+		bool IsOccluded(const Meshlet& meshlet, const OcclusionBuffer& buffer, const Matrix& worldViewProjection)
+		{
+			if (buffer.depths.empty())
+				return false;
+
+			//The corners of the box around the sphere bound its projection and its nearest depth
+			float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+			float nearestDepth = FLT_MAX;
+			for (int corner = 0; corner < 8; ++corner)
+			{
+				const Vector3 position{
+					meshlet.center.x + ((corner & 1) ? meshlet.radius : -meshlet.radius),
+					meshlet.center.y + ((corner & 2) ? meshlet.radius : -meshlet.radius),
+					meshlet.center.z + ((corner & 4) ? meshlet.radius : -meshlet.radius) };
+
+				Vector3 projected{};
+				if (!ProjectToPixels(position, worldViewProjection, buffer.width, buffer.height, projected))
+					return false;
+
+				minX = std::min(minX, projected.x);
+				minY = std::min(minY, projected.y);
+				maxX = std::max(maxX, projected.x);
+				maxY = std::max(maxY, projected.y);
+				nearestDepth = std::min(nearestDepth, projected.z);
+			}
+
+			//Every pixel center the sphere can cover
+			const int firstX = std::max(0, static_cast<int>(std::floor(minX - 0.5f)));
+			const int firstY = std::max(0, static_cast<int>(std::floor(minY - 0.5f)));
+			const int lastX = std::min(static_cast<int>(buffer.width) - 1, static_cast<int>(std::ceil(maxX - 0.5f)));
+			const int lastY = std::min(static_cast<int>(buffer.height) - 1, static_cast<int>(std::ceil(maxY - 0.5f)));
+			if (firstX > lastX or firstY > lastY)
+				return false;
+
+			for (int y = firstY; y <= lastY; ++y)
+			{
+				for (int x = firstX; x <= lastX; ++x)
+				{
+					if (buffer.depths[size_t(y) * buffer.width + x] >= nearestDepth)
+						return false;
+				}
+			}
+			return true;
+		}
+	}
+}
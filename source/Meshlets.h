@@ -0,0 +1,70 @@
+#pragma once
+#include "Vertex.h"
+#include "Utils.h"
+#include <span>
+#include <vector>
+
+namespace dae
+{
+	//Small clusters of neighbouring triangles with the bounds to reject a whole cluster on the CPU before it is drawn
+	namespace Meshlets
+	{
+		constexpr size_t MaxVertices{ 64 };
+		constexpr size_t MaxTriangles{ 124 };
+
+		struct Meshlet
+		{
+			//A run of whole triangles of the index buffer, drawn as is
+			uint32_t firstIndex{};
+			uint32_t numIndices{};
+			uint32_t numVertices{};
+
+			//Bounding sphere
+			Vector3 center{};
+			float radius{};
+
+			//Normal cone: no triangle faces a viewpoint v with dot(normalize(coneApex - v), coneAxis) >= coneCutoff
+			//A cutoff above 1 marks triangles that face too many directions to ever be rejected together
+			Vector3 coneApex{};
+			Vector3 coneAxis{};
+			float coneCutoff{ 2.f };
+		};
+
+		//Scans the triangles in index order and starts a new meshlet whenever the next triangle would exceed maxVertices or maxTriangles,
+		//so vertex cache optimized indices give compact meshlets. Meshlets never cross a submesh, indices outside every submesh are skipped
+		//Front faces are clockwise as seen by the viewer, like the default D3D11 rasterizer state
+		std::vector<Meshlet> Build(std::span<const uint32_t> indices, std::span<const Vector3> positions, std::span<const Utils::OBJSubmesh> submeshes,
+			size_t maxVertices = MaxVertices, size_t maxTriangles = MaxTriangles);
+
+		//Planes with their normals pointing inside, normalized so the distance to a point is dot(xyz, point) + w
+		struct Frustum
+		{
+			Vector4 planes[6]{};
+		};
+
+		//The frustum in the space the matrix transforms from, object space for a world view projection matrix
+		//Rows are multiplied from the left like in Matrix::TransformPoint, depth goes from 0 to 1 like in D3D
+		Frustum ExtractFrustum(const Matrix& worldViewProjection);
+
+		bool IsOutsideFrustum(const Meshlet& meshlet, const Frustum& frustum);
+		//Every triangle faces away from cameraPosition, given in the same space as the meshlet
+		bool IsBackFacing(const Meshlet& meshlet, const Vector3& cameraPosition);
+
+		//Depth of the nearest front faces at a low resolution, the occluders are usually the mesh itself
+		struct OcclusionBuffer
+		{
+			uint32_t width{};
+			uint32_t height{};
+			std::vector<float> depths{};
+		};
+
+		//Clears the buffer to the far plane and rasterizes the front faces of the occluders, sampled at pixel centers
+		//Triangles that cross the near plane are left out, so they can only make fewer meshlets occluded
+		void RasterizeOccluders(OcclusionBuffer& buffer, std::span<const uint32_t> indices, std::span<const Vector3> positions,
+			const Matrix& worldViewProjection, const Vector3& cameraPosition);
+
+		//True when the screen rectangle of the bounding sphere is covered by occluders that are all nearer than the sphere
+		//Exact at the buffer resolution, a finer render target can still show a meshlet through gaps smaller than a buffer pixel
+		bool IsOccluded(const Meshlet& meshlet, const OcclusionBuffer& buffer, const Matrix& worldViewProjection);
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace dae
+{
+	//Thread count used when a caller asks for 0 threads
+	inline uint32_t GetDefaultThreadCount()
+	{
+		const uint32_t numThreads = std::thread::hardware_concurrency();
+		return numThreads > 0 ? numThreads : 1;
+	}
+
+	//Calls task(taskIndex) for every index in [0, numTasks) on at most numThreads threads, the calling thread included
+	//Tasks are handed out in order from a shared counter, so uneven tasks still balance out
+	template<typename Task>
+	void ParallelFor(size_t numTasks, uint32_t numThreads, const Task& task)
+	{
+		if (numThreads == 0)
+			numThreads = GetDefaultThreadCount();
+		if (numThreads > numTasks)
+			numThreads = static_cast<uint32_t>(numTasks);
+
+		if (numThreads <= 1)
+		{
+			for (size_t taskIndex = 0; taskIndex < numTasks; ++taskIndex)
+				task(taskIndex);
+			return;
+		}
+
+		std::atomic<size_t> nextTask{ 0 };
+		const auto worker = [&]()
+			{
+				for (size_t taskIndex = nextTask++; taskIndex < numTasks; taskIndex = nextTask++)
+					task(taskIndex);
+			};
+
+		std::vector<std::thread> threads{};
+		threads.reserve(numThreads - 1);
+		for (uint32_t i = 1; i < numThreads; ++i)
+			threads.emplace_back(worker);
+
+		worker();
+		for (std::thread& thread : threads)
+			thread.join();
+	}
+}
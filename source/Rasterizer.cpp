@@ -0,0 +1,235 @@
+#include "pch.h"
+#include "Rasterizer.h"
+
+#if defined(_M_X64) || defined(__AVX2__)
+#define DAE_RASTERIZER_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace dae
+{
+	namespace Rasterizer
+	{
+		namespace
+		{
+			//Edge functions of a block that is not trivially accepted, relative to its top left pixel center. They fit in 32 bits as long as the
+			//triangle is within MaxExtent, edges the whole block is inside of are left at 0 so they pass everywhere
+			struct BlockEdges
+			{
+				std::array<int32_t, 3> start{};
+				std::array<int32_t, 3> stepX{};
+				std::array<int32_t, 3> stepY{};
+			};
+
+			//Pixels of the block inside the rectangle
+			uint64_t GetRectangleMask(int blockX, int blockY, int minX, int minY, int maxX, int maxY)
+			{
+				const int firstColumn = std::max(minX - blockX, 0);
+				const int lastColumn = std::min(maxX - blockX, BlockSize - 1);
+				const int firstRow = std::max(minY - blockY, 0);
+				const int lastRow = std::min(maxY - blockY, BlockSize - 1);
+
+				const uint64_t rowMask = ((2ull << lastColumn) - 1) & ~((1ull << firstColumn) - 1);
+				uint64_t mask = 0;
+				for (int row = firstRow; row <= lastRow; ++row)
+					mask |= rowMask << (row * BlockSize);
+				return mask;
+			}
+
+			//The fill rule is folded into start, a pixel is covered when all three values are at least 0, when none has its sign bit set.
+			//Both kernels give the same bits. One step past the block still fits in 32 bits
+			uint64_t CoverScalar(const BlockEdges& blockEdges)
+			{
+				std::array<int32_t, 3> rowValues = blockEdges.start;
+				uint64_t coverage = 0;
+				for (int row = 0; row < BlockSize; ++row)
+				{
+					std::array<int32_t, 3> values = rowValues;
+					for (int column = 0; column < BlockSize; ++column)
+					{
+						const bool isCovered = (values[0] | values[1] | values[2]) >= 0;
+						coverage |= static_cast<uint64_t>(isCovered) << (row * BlockSize + column);
+						for (size_t edge = 0; edge < 3; ++edge)
+							values[edge] += blockEdges.stepX[edge];
+					}
+
+					for (size_t edge = 0; edge < 3; ++edge)
+						rowValues[edge] += blockEdges.stepY[edge];
+				}
+				return coverage;
+			}
+
+#ifdef DAE_RASTERIZER_AVX2
+			//MSVC compiles AVX2 intrinsics without being asked to, so the CPU and the OS support for the ymm registers are checked once
+			bool DetectAVX2()
+			{
+#ifdef __AVX2__
+				return true;
+#else
+				int info[4]{};
+				__cpuid(info, 0);
+				if (info[0] < 7)
+					return false;
+
+				__cpuid(info, 1);
+				const bool hasAVX = (info[2] & (1 << 28)) != 0;
+				const bool hasXSave = (info[2] & (1 << 27)) != 0;
+				if (!hasAVX or !hasXSave or (_xgetbv(0) & 6) != 6)
+					return false;
+
+				__cpuidex(info, 7, 0);
+				return (info[1] & (1 << 5)) != 0;
+#endif
+			}
+			const bool HasAVX2 = DetectAVX2();
+
+			//One row of the block per compare, the sign bits of the 8 lanes are the coverage of the row
+			uint64_t CoverAVX2(const BlockEdges& blockEdges)
+			{
+				const __m256i columns = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+				const __m256i outside = _mm256_set1_epi32(-1);
+				__m256i values[3];
+				__m256i steps[3];
+				for (size_t edge = 0; edge < 3; ++edge)
+				{
+					values[edge] = _mm256_add_epi32(_mm256_set1_epi32(blockEdges.start[edge]), _mm256_mullo_epi32(_mm256_set1_epi32(blockEdges.stepX[edge]), columns));
+					steps[edge] = _mm256_set1_epi32(blockEdges.stepY[edge]);
+				}
+
+				uint64_t coverage = 0;
+				for (int row = 0; row < BlockSize; ++row)
+				{
+					__m256i inside = _mm256_cmpgt_epi32(values[0], outside);
+					inside = _mm256_and_si256(inside, _mm256_cmpgt_epi32(values[1], outside));
+					inside = _mm256_and_si256(inside, _mm256_cmpgt_epi32(values[2], outside));
+					coverage |= static_cast<uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(inside))) << (row * BlockSize);
+
+					for (size_t edge = 0; edge < 3; ++edge)
+						values[edge] = _mm256_add_epi32(values[edge], steps[edge]);
+				}
+				return coverage;
+			}
+#endif
+		}
+
+		int32_t Snap(float coordinate)
+		{
+			return static_cast<int32_t>(std::lround(coordinate * static_cast<float>(SubpixelScale)));
+		}
+
+		int64_t SetupEdges(const std::array<int32_t, 3>& xs, const std::array<int32_t, 3>& ys, Edges& edges)
+		{
+			for (size_t edge = 0; edge < 3; ++edge)
+			{
+				const size_t from = (edge + 1) % 3;
+				const size_t to = (edge + 2) % 3;
+				edges.a[edge] = ys[from] - ys[to];
+				edges.b[edge] = xs[to] - xs[from];
+				edges.c[edge] = -(static_cast<int64_t>(edges.a[edge]) * xs[from] + static_cast<int64_t>(edges.b[edge]) * ys[from]);
+				//Left edges have the inside to their right, top edges are horizontal with the inside below
+				edges.isTopLeft[edge] = edges.a[edge] > 0 or (edges.a[edge] == 0 and edges.b[edge] > 0);
+			}
+			return static_cast<int64_t>(edges.a[0]) * xs[0] + static_cast<int64_t>(edges.b[0]) * ys[0] + edges.c[0];
+		}
+
+		Kernel GetBestKernel()
+		{
+#ifdef DAE_RASTERIZER_AVX2
+			if (HasAVX2)
+				return Kernel::AVX2;
+#endif
+			return Kernel::Scalar;
+		}
+
+		size_t CoverBlocks(const Edges& edges, int minX, int minY, int maxX, int maxY, std::span<Block> blocks, [[maybe_unused]] Kernel kernel, DepthBounds* depthBoundsPtr)
+		{
+#ifdef DAE_RASTERIZER_AVX2
+			const bool useAVX2 = kernel == Kernel::AVX2 and HasAVX2;
+#endif
+			const int firstBlockX = minX / BlockSize * BlockSize;
+			const int firstBlockY = minY / BlockSize * BlockSize;
+			constexpr int PixelCenter{ SubpixelScale / 2 };
+			constexpr int64_t LastPixel{ (BlockSize - 1) * SubpixelScale };
+			constexpr int64_t BlockStep{ BlockSize * SubpixelScale };
+
+			//Edge functions at the first pixel center of the block, stepped from block to block. Lowering the edges that are not top or left
+			//by one turns the fill rule into a test for at least 0, the integer values are never between -1 and 0
+			//The corner furthest inside an edge decides the rejection, the one furthest outside the acceptance
+			std::array<int64_t, 3> rowStart;
+			std::array<int64_t, 3> largestOffset;
+			std::array<int64_t, 3> smallestOffset;
+			for (size_t edge = 0; edge < 3; ++edge)
+			{
+				const int64_t a = edges.a[edge];
+				const int64_t b = edges.b[edge];
+				rowStart[edge] = a * (static_cast<int64_t>(firstBlockX) * SubpixelScale + PixelCenter) + b * (static_cast<int64_t>(firstBlockY) * SubpixelScale + PixelCenter)
+					+ edges.c[edge] - (edges.isTopLeft[edge] ? 0 : 1);
+				largestOffset[edge] = (std::max<int64_t>(a, 0) + std::max<int64_t>(b, 0)) * LastPixel;
+				smallestOffset[edge] = (std::min<int64_t>(a, 0) + std::min<int64_t>(b, 0)) * LastPixel;
+			}
+
+			size_t numBlocks = 0;
+			for (int blockY = firstBlockY; blockY <= maxY; blockY += BlockSize)
+			{
+				std::array<int64_t, 3> start = rowStart;
+				for (int blockX = firstBlockX; blockX <= maxX; blockX += BlockSize)
+				{
+					bool isOutside = false;
+					bool isInside = true;
+					for (size_t edge = 0; edge < 3; ++edge)
+					{
+						isOutside = isOutside or start[edge] + largestOffset[edge] < 0;
+						isInside = isInside and start[edge] + smallestOffset[edge] >= 0;
+					}
+
+					if (!isOutside and depthBoundsPtr)
+					{
+						//Pixel center of the block inside the rectangle where the depth plane is nearest
+						const DepthBounds& depthBounds = *depthBoundsPtr;
+						const int nearestX = depthBounds.a < 0.f ? std::min(blockX + BlockSize - 1, maxX) : std::max(blockX, minX);
+						const int nearestY = depthBounds.b < 0.f ? std::min(blockY + BlockSize - 1, maxY) : std::max(blockY, minY);
+						const float nearestDepth = depthBounds.a * (static_cast<float>(nearestX) + 0.5f) + depthBounds.b * (static_cast<float>(nearestY) + 0.5f) + depthBounds.c;
+						const int blockIndex = (blockY - depthBounds.originY) / BlockSize * depthBounds.blocksPerRow + (blockX - depthBounds.originX) / BlockSize;
+						isOutside = nearestDepth >= depthBounds.blockMaxDepthsPtr[blockIndex];
+						++depthBoundsPtr->numTested;
+						depthBoundsPtr->numRejected += isOutside;
+					}
+
+					if (!isOutside)
+					{
+						uint64_t coverage = GetRectangleMask(blockX, blockY, minX, minY, maxX, maxY);
+						if (!isInside)
+						{
+							BlockEdges blockEdges{};
+							for (size_t edge = 0; edge < 3; ++edge)
+							{
+								if (start[edge] + smallestOffset[edge] >= 0)
+									continue;
+								blockEdges.start[edge] = static_cast<int32_t>(start[edge]);
+								blockEdges.stepX[edge] = edges.a[edge] * SubpixelScale;
+								blockEdges.stepY[edge] = edges.b[edge] * SubpixelScale;
+							}
+#ifdef DAE_RASTERIZER_AVX2
+							coverage &= useAVX2 ? CoverAVX2(blockEdges) : CoverScalar(blockEdges);
+#else
+							coverage &= CoverScalar(blockEdges);
+#endif
+						}
+						if (coverage != 0)
+							blocks[numBlocks++] = { blockX, blockY, coverage };
+					}
+
+					for (size_t edge = 0; edge < 3; ++edge)
+						start[edge] += edges.a[edge] * BlockStep;
+				}
+
+				for (size_t edge = 0; edge < 3; ++edge)
+					rowStart[edge] += edges.b[edge] * BlockStep;
+			}
+			return numBlocks;
+		}
+	}
+}
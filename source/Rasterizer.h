@@ -0,0 +1,80 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <span>
+
+namespace dae
+{
+	//Coverage of screen space triangles in 8x8 pixel blocks, the inner loop of the SoftwareRenderer
+	//Vertices are snapped to 16.8 fixed point and the edge functions are exact integers, so triangles that share an edge cover every pixel
+	//center along it exactly once, whatever kernel or thread count rasterizes them
+	//A block that one edge leaves completely outside is rejected and a block inside all three edges is accepted without testing its pixels,
+	//the others evaluate the three edge functions for a row of 8 pixels per instruction with AVX2 and step to the next row by adding the y gradient
+	namespace Rasterizer
+	{
+		constexpr int BlockSize{ 8 };
+		constexpr int SubpixelBits{ 8 };
+		constexpr int SubpixelScale{ 1 << SubpixelBits };
+		//Largest distance in pixels between the vertices of a triangle along x and along y. Within it the edge functions over a block fit in 32 bits
+		constexpr int MaxExtent{ 2048 };
+
+		//Pixel coordinate to 16.8 fixed point, rounded to the nearest 1/256 pixel
+		int32_t Snap(float coordinate);
+
+		//Edge i is a * X + b * Y + c with X and Y in subpixels, 0 on the edge opposite vertex i and positive inside
+		struct Edges
+		{
+			std::array<int32_t, 3> a{};
+			std::array<int32_t, 3> b{};
+			std::array<int64_t, 3> c{};
+			//Pixel centers on an edge only belong to the triangle when it is a top or left edge, the D3D fill rule
+			std::array<bool, 3> isTopLeft{};
+		};
+
+		//Snapped vertices with y down, clockwise on screen and at most MaxExtent pixels apart. Returns the doubled area in subpixels squared,
+		//what the three edge functions add up to anywhere
+		int64_t SetupEdges(const std::array<int32_t, 3>& xs, const std::array<int32_t, 3>& ys, Edges& edges);
+
+		struct Block
+		{
+			//Top left pixel, a multiple of BlockSize
+			int x{};
+			int y{};
+			//Bit y * BlockSize + x for the pixel at (x, y) in the block
+			uint64_t coverage{};
+		};
+
+		enum class Kernel
+		{
+			Scalar,
+			AVX2,
+		};
+
+		//AVX2 when the build can use it and the CPU has it
+		Kernel GetBestKernel();
+
+		//Hierarchical depth test of one triangle against a grid of blocks, a block the triangle is behind everywhere is skipped before its coverage
+		struct DepthBounds
+		{
+			//Depth plane of the triangle, a * x + b * y + c at a pixel center in pixels. c is lowered by the rounding of evaluating the plane,
+			//so the nearest pixel center of a block gives a depth at or below every depth the triangle writes in it
+			float a{};
+			float b{};
+			float c{};
+			//Farthest depth every block of the grid holds, row by row, the top left block starts at (originX, originY)
+			const float* blockMaxDepthsPtr{};
+			int originX{};
+			int originY{};
+			int blocksPerRow{};
+
+			//Blocks inside the edges that were tested, and the ones that were rejected, added to by CoverBlocks
+			uint32_t numTested{};
+			uint32_t numRejected{};
+		};
+
+		//Blocks with covered pixel centers inside [minX, maxX] x [minY, maxY], which must not be negative, row by row from the top
+		//blocks has to have room for every block the rectangle touches. Returns the number written, both kernels give the same coverage
+		//A block is rejected as well when the nearest depth of the triangle in it is not less than the farthest depth in depthBoundsPtr
+		size_t CoverBlocks(const Edges& edges, int minX, int minY, int maxX, int maxY, std::span<Block> blocks, Kernel kernel, DepthBounds* depthBoundsPtr = nullptr);
+	}
+}
@@ -2,19 +2,43 @@
 #include "Renderer.h"
 #include "Mesh.h"
 #include "Texture.h"
-#include "Utils.h"
+#include "MeshCache.h"
+#include "Effect.h"
+#include "GLBFile.h"
+#include "AssetLoader.h"
+#include "TextureCache.h"
+#include "Meshlets.h"
+#include "SoftwareRenderer.h"
+
+#include <cstring>
+#include <filesystem>
 
 namespace dae {
 
-#pragma region Global
-	std::vector<Vertex>   vehicle_vertices{};
-	std::vector<uint32_t> vehicle_indices{};
-	std::vector<Vertex>   fireFx_vertices{};
-	std::vector<uint32_t> fireFx_indices{};
-#pragma endregion
+	struct Renderer::ModelData
+	{
+		std::unique_ptr<MeshCache> meshCachePtr{};
+		//Set instead of the cache for .glb models, the images are indexed like the glTF images and only decoded when a primitive uses them
+		std::unique_ptr<GLBFile> glbFilePtr{};
+		std::vector<std::shared_ptr<SDL_Surface>> images{};
+		std::vector<Utils::MTLMaterial> materials{};
+		std::vector<Meshlets::Meshlet> meshlets{};
+	};
+
+	namespace
+	{
+		//gRotationSpeed in PosCol3D.fx, the vertex shaders spin every mesh around y by this many radians per second
+		constexpr float RotationSpeed{ PI_DIV_4 };
+
+		float MillisecondsSince(std::chrono::steady_clock::time_point start)
+		{
+			return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+	}
 
 	Renderer::Renderer(SDL_Window* pWindow) :
-		m_WindowPtr(pWindow)
+		m_WindowPtr(pWindow),
+		m_StartTime(std::chrono::steady_clock::now())
 	{
 		//Initialize
 		SDL_GetWindowSize(pWindow, &m_Width, &m_Height);
@@ -31,36 +55,22 @@ namespace dae {
 			std::cout << "DirectX initialization failed!\n";
 		}
 
-		// Load Objects
-		Utils::ParseOBJ("Resources/vehicle.obj", vehicle_vertices, vehicle_indices);
-		Utils::ParseOBJ("Resources/fireFX.obj", fireFx_vertices, fireFx_indices);
-
-		// Create Meshes
-		m_MeshPtr = new Mesh(m_DevicePtr, vehicle_vertices, vehicle_indices);
-		m_FireFXPtr = new Mesh(m_DevicePtr, fireFx_vertices, fireFx_indices);
-		m_FireFXPtr->SetPassIdx(static_cast < UINT>(3));
-		
 		// Initialize Camera
 		const float aspectRatio{ static_cast<float>(m_Width) / static_cast<float>(m_Height) };
 		m_Camera.SetAspectRatio(aspectRatio);
 		m_Camera.Initialize(45.0f, { 0.0f, 0.0f, -50.0f });
 
-		// Load & Set Textures
-		m_DiffuseTexturePtr = Texture::LoadFromFile("Resources/vehicle_diffuse.png", m_DevicePtr);
-		m_NormalTexturePtr = Texture::LoadFromFile("Resources/vehicle_normal.png", m_DevicePtr);
-		m_SpecularTexturePtr = Texture::LoadFromFile("Resources/vehicle_specular.png", m_DevicePtr);
-		m_GlossinessTexturePtr = Texture::LoadFromFile("Resources/vehicle_gloss.png", m_DevicePtr);
-		m_MeshPtr->SetDiffuseMap(m_DiffuseTexturePtr);
-		m_MeshPtr->SetNormalMap(m_NormalTexturePtr);
-		m_MeshPtr->SetSpecularMap(m_SpecularTexturePtr);
-		m_MeshPtr->SetGlossinessMap(m_GlossinessTexturePtr);
-
-		m_FireFXDiffusePtr = Texture::LoadFromFile("Resources/fireFX_diffuse.png", m_DevicePtr);
-		m_FireFXPtr->SetDiffuseMap(m_FireFXDiffusePtr);
+		// Load Objects & Textures, the first frames are drawn while they are still loading
+		if (m_IsInitialized)
+			LoadAssets();
 	}
 
 	Renderer::~Renderer()
 	{
+		// Waits for the loader threads before anything they could still hand back is released
+		m_AssetLoaderPtr.reset();
+		m_TextureCachePtr.reset();
+
 		if (m_RenderTargetViewPtr)   
 			m_RenderTargetViewPtr->Release();
 
@@ -92,24 +102,72 @@ namespace dae {
 		delete m_MeshPtr;
 		delete m_FireFXPtr;
 
-		delete m_DiffuseTexturePtr;
-		delete m_GlossinessTexturePtr;
-		delete m_NormalTexturePtr;
-		delete m_SpecularTexturePtr;
-		delete m_FireFXDiffusePtr;
+		delete m_PlaceholderDiffusePtr;
+		delete m_PlaceholderNormalPtr;
+		delete m_PlaceholderSpecularPtr;
+		delete m_PlaceholderGlossinessPtr;
+		delete m_PlaceholderFireFXPtr;
+		for (const Texture* texturePtr : m_EmbeddedTexturePtrs)
+			delete texturePtr;
 	}
 
 	void Renderer::Update(const Timer* pTimer)
 	{
+		if (m_AssetLoaderPtr and m_AssetLoaderPtr->ProcessCompleted() > 0 and m_AssetLoaderPtr->GetNumPending() == 0)
+		{
+			std::cout << "All assets loaded after " << MillisecondsSince(m_StartTime) << " ms ("
+				<< m_TextureCachePtr->GetNumTextures() << " textures for " << m_TextureCachePtr->GetNumRequests() << " requests)\n";
+
+			// The mapped caches are gone by now, the meshes are all that is left of the geometry
+			Mesh::MemoryUsage meshMemory{};
+			for (const Mesh* meshPtr : { m_MeshPtr, m_FireFXPtr })
+			{
+				if (!meshPtr)
+					continue;
+				const Mesh::MemoryUsage usage = meshPtr->GetMemoryUsage();
+				meshMemory.gpuBytes += usage.gpuBytes;
+				meshMemory.cpuBytes += usage.cpuBytes;
+			}
+			std::cout << "Meshes hold " << meshMemory.gpuBytes / 1024.0 << " KB on the GPU and " << meshMemory.cpuBytes / 1024.0 << " KB on the CPU\n";
+		}
+
 		m_Camera.Update(pTimer);
-		m_MeshPtr->UpdateMatrix(m_Camera.GetInverseViewMatrix(), m_Camera.GetProjectionMatrix());
-		m_MeshPtr->SetCameraPosition(m_Camera.GetPosition());
-		m_MeshPtr->SetDeltaTime(m_TotalTime);
-		m_MeshPtr->SetUseNormalMap(m_UseNormalMap);
 
-		m_FireFXPtr->UpdateMatrix(m_Camera.GetInverseViewMatrix(), m_Camera.GetProjectionMatrix());
-		m_FireFXPtr->SetDeltaTime(m_TotalTime);
+		//Meshlets are culled in object space, so the camera is moved against the rotation the vertex shader applies
+		const Matrix worldMatrix = Matrix::CreateRotationY(RotationSpeed * m_TotalTime);
+		const Matrix worldViewProjection = worldMatrix * m_Camera.GetInverseViewMatrix() * m_Camera.GetProjectionMatrix();
+		const Vector3 objectCameraPosition = Matrix::Inverse(worldMatrix).TransformPoint(m_Camera.GetPosition());
+		for (Mesh* meshPtr : { m_MeshPtr, m_FireFXPtr })
+		{
+			if (!meshPtr)
+				continue;
+
+			//Coarser levels are drawn whole, so their meshlets are only culled at full detail
+			if (meshPtr->SelectLevelOfDetail(objectCameraPosition, m_Camera.GetProjectionMatrix()[1][1], static_cast<float>(m_Height)) > 0)
+				continue;
+
+			//The FireFX pass culls no faces
+			if (m_UseMeshletCulling)
+				meshPtr->CullMeshlets(worldViewProjection, objectCameraPosition, meshPtr == m_MeshPtr);
+			else
+				meshPtr->ResetMeshletCulling();
+		}
+
+		if (m_MeshPtr)
+		{
+			m_MeshPtr->UpdateMatrix(m_Camera.GetInverseViewMatrix(), m_Camera.GetProjectionMatrix());
+			m_MeshPtr->SetCameraPosition(m_Camera.GetPosition());
+			m_MeshPtr->SetDeltaTime(m_TotalTime);
+			m_MeshPtr->SetUseNormalMap(m_UseNormalMap);
+		}
 
+		if (m_FireFXPtr)
+		{
+			m_FireFXPtr->UpdateMatrix(m_Camera.GetInverseViewMatrix(), m_Camera.GetProjectionMatrix());
+			m_FireFXPtr->SetDeltaTime(m_TotalTime);
+		}
+
+		m_FrameTime = m_TotalTime;
 		if (m_Rotate)
 		{
 			m_TotalTime += pTimer->GetElapsed();
@@ -129,11 +187,274 @@ namespace dae {
 
 		// 2. SET PIPELINE + INVOKE DRAW CALLS (= RENDER)
 		//=======
-		m_MeshPtr->Render();
-		if (m_UseFireFX) m_FireFXPtr->Render();
+		if (m_MeshPtr) m_MeshPtr->Render();
+		if (m_UseFireFX and m_FireFXPtr) m_FireFXPtr->Render();
+
+		if (m_IsScreenshotRequested)
+		{
+			m_IsScreenshotRequested = false;
+			WriteScreenshot("screenshot.ppm");
+		}
 
 		// 3. PRESENT BACKBUFFER (SWAP)
 		m_SwapChainPtr->Present(0, 0);
+
+		if (!m_IsFirstFramePresented)
+		{
+			m_IsFirstFramePresented = true;
+			std::cout << "First frame presented after " << MillisecondsSince(m_StartTime) << " ms\n";
+		}
+	}
+
+	void Renderer::LoadAssets()
+	{
+		m_PlaceholderDiffusePtr = Texture::CreateSolidColor(ColorRGB{ 0.5f, 0.5f, 0.5f }, 1.f, m_DevicePtr);
+		m_PlaceholderNormalPtr = Texture::CreateSolidColor(ColorRGB{ 0.5f, 0.5f, 1.f }, 1.f, m_DevicePtr);
+		m_PlaceholderSpecularPtr = Texture::CreateSolidColor(colors::Black, 1.f, m_DevicePtr);
+		m_PlaceholderGlossinessPtr = Texture::CreateSolidColor(colors::Black, 1.f, m_DevicePtr);
+		m_PlaceholderFireFXPtr = Texture::CreateSolidColor(colors::Black, 0.f, m_DevicePtr);
+
+		m_AssetLoaderPtr = std::make_unique<AssetLoader>();
+		m_TextureCachePtr = std::make_unique<TextureCache>(m_DevicePtr);
+
+		// Everything but a .glb comes from Resources/Cooked, written by the AssetCooker project after every build
+		// Both meshes create their effect from the same compiled blob
+		m_AssetLoaderPtr->Enqueue([this]()
+			{
+				const std::shared_ptr<ID3DBlob> blobPtr{ Effect::LoadCompiled(L"Resources/Cooked/PosCol3D.fxo"), [](ID3DBlob* p) { if (p) p->Release(); } };
+				return [this, blobPtr]() { m_EffectBlobPtr = blobPtr; CreateMeshes(); };
+			});
+
+		// A vehicle.glb in Resources replaces the cooked OBJ, glTF needs no cooking
+		const std::string vehicleGLBPath{ "Resources/vehicle.glb" };
+		LoadModel(std::filesystem::exists(vehicleGLBPath) ? vehicleGLBPath : "Resources/Cooked/vehicle.mesh", m_VehicleModelPtr);
+		LoadModel("Resources/Cooked/fireFX.mesh", m_FireFXModelPtr);
+	}
+
+	void Renderer::LoadModel(const std::string& meshPath, std::shared_ptr<ModelData>& modelPtr)
+	{
+		m_AssetLoaderPtr->Enqueue([this, meshPath, &modelPtr]()
+			{
+				const auto loadedPtr = std::make_shared<ModelData>();
+
+				// GLBFile::Open reports what is wrong with a .glb itself
+				const bool isGLB = std::filesystem::path{ meshPath }.extension() == ".glb";
+				if (isGLB)
+					loadedPtr->glbFilePtr = GLBFile::Open(meshPath);
+				else
+					loadedPtr->meshCachePtr = MeshCache::Open(meshPath);
+
+				if (loadedPtr->glbFilePtr)
+				{
+					const GLBFile& glbFile = *loadedPtr->glbFilePtr;
+					loadedPtr->images.resize(glbFile.GetDocument()["images"].GetSize());
+					std::vector<Utils::OBJSubmesh> submeshes{};
+					for (const GLBFile::Primitive& primitive : glbFile.GetPrimitives())
+					{
+						submeshes.push_back({ {}, primitive.firstIndex, primitive.numIndices });
+						for (const int image : { primitive.baseColorImage, primitive.normalImage })
+						{
+							if (image < 0 or static_cast<size_t>(image) >= loadedPtr->images.size() or loadedPtr->images[image])
+								continue;
+							loadedPtr->images[image] = std::shared_ptr<SDL_Surface>{ Texture::DecodeFromMemory(glbFile.GetImage(image)),
+								[](SDL_Surface* p) { if (p) SDL_FreeSurface(p); } };
+						}
+					}
+
+					std::vector<Vector3> positions{};
+					positions.reserve(glbFile.GetVertices().size());
+					for (const Vertex& vertex : glbFile.GetVertices())
+						positions.push_back(vertex.position);
+					loadedPtr->meshlets = Meshlets::Build(glbFile.GetIndices(), positions, submeshes);
+				}
+				else if (loadedPtr->meshCachePtr)
+				{
+					// mtllib paths are relative to the mesh, the cooked MTL files sit next to it
+					const std::filesystem::path folder = std::filesystem::path{ meshPath }.parent_path();
+					for (const std::string& library : loadedPtr->meshCachePtr->GetMaterialData().libraries)
+						Utils::ParseMTL((folder / library).generic_string(), loadedPtr->materials);
+
+					const MeshCache& meshCache = *loadedPtr->meshCachePtr;
+					loadedPtr->meshlets = Meshlets::Build(meshCache.GetIndices(), meshCache.GetPositions(), meshCache.GetMaterialData().submeshes);
+				}
+				else if (!isGLB)
+				{
+					std::cout << "Renderer: " << meshPath << " is missing, run AssetCooker on the Resources folder\n";
+				}
+
+				return [this, loadedPtr, &modelPtr]()
+					{
+						if (!loadedPtr->meshCachePtr and !loadedPtr->glbFilePtr)
+							return;
+
+						// Start decoding right away, the meshes may still be waiting for the effect
+						for (const Utils::MTLMaterial& material : loadedPtr->materials)
+						{
+							for (const std::string* pathPtr : { &material.diffuseMap, &material.normalMap, &material.specularMap, &material.glossinessMap })
+							{
+								if (!pathPtr->empty())
+									m_TextureCachePtr->LoadAsync(*pathPtr, *m_AssetLoaderPtr, nullptr);
+							}
+						}
+
+						modelPtr = loadedPtr;
+						CreateMeshes();
+					};
+			});
+	}
+
+	Mesh* Renderer::CreateMesh(const ModelData& model) const
+	{
+		Effect* effectPtr = new Effect(m_DevicePtr, m_EffectBlobPtr.get());
+		if (model.glbFilePtr)
+			return new Mesh(m_DevicePtr, effectPtr, model.glbFilePtr->GetVertices(), model.glbFilePtr->GetIndices());
+
+		const MeshCache& meshCache = *model.meshCachePtr;
+		if (meshCache.HasPackedVertices())
+			return new Mesh(m_DevicePtr, effectPtr, meshCache.GetPackedVertices(), meshCache.GetPositionQuantization(), meshCache.GetIndices());
+		return new Mesh(m_DevicePtr, effectPtr, meshCache.GetVertices(), meshCache.GetIndices());
+	}
+
+	void Renderer::CreateMeshes()
+	{
+		if (!m_EffectBlobPtr)
+			return;
+
+		// The caches stay mapped only until their data is uploaded
+		if (!m_MeshPtr and m_VehicleModelPtr)
+		{
+			m_MeshPtr = CreateMesh(*m_VehicleModelPtr);
+			m_MeshPtr->SetPassIdx(static_cast<UINT>(m_SampleMethod));
+			m_MeshPtr->SetDiffuseMap(m_PlaceholderDiffusePtr);
+			m_MeshPtr->SetNormalMap(m_PlaceholderNormalPtr);
+			m_MeshPtr->SetSpecularMap(m_PlaceholderSpecularPtr);
+			m_MeshPtr->SetGlossinessMap(m_PlaceholderGlossinessPtr);
+			AddSubmeshes(m_MeshPtr, *m_VehicleModelPtr);
+			m_MeshPtr->SetMeshlets(std::move(m_VehicleModelPtr->meshlets));
+			m_VehicleModelPtr.reset();
+		}
+
+		if (!m_FireFXPtr and m_FireFXModelPtr)
+		{
+			m_FireFXPtr = CreateMesh(*m_FireFXModelPtr);
+			m_FireFXPtr->SetPassIdx(static_cast<UINT>(3));
+			m_FireFXPtr->SetDiffuseMap(m_PlaceholderFireFXPtr);
+			AddSubmeshes(m_FireFXPtr, *m_FireFXModelPtr);
+			m_FireFXPtr->SetMeshlets(std::move(m_FireFXModelPtr->meshlets));
+			m_FireFXModelPtr.reset();
+		}
+
+		if (m_MeshPtr and m_FireFXPtr)
+			m_EffectBlobPtr.reset();
+	}
+
+	void Renderer::AddSubmeshes(Mesh* meshPtr, const ModelData& model)
+	{
+		if (model.glbFilePtr)
+		{
+			AddGLBSubmeshes(meshPtr, model);
+			return;
+		}
+
+		const MeshCache& meshCache = *model.meshCachePtr;
+		for (const Utils::OBJSubmesh& submesh : meshCache.GetMaterialData().submeshes)
+		{
+			const uint32_t submeshIndex = meshPtr->AddSubmesh(submesh.firstIndex, submesh.numIndices);
+
+			const auto materialIt = std::find_if(model.materials.begin(), model.materials.end(),
+				[&submesh](const Utils::MTLMaterial& material) { return material.name == submesh.material; });
+			if (materialIt == model.materials.end())
+				continue;
+
+			// Meshes are deleted after the loader is stopped, so they outlive every callback
+			const auto request = [this, meshPtr, submeshIndex](const std::string& path, Mesh::TextureSlot slot)
+				{
+					if (path.empty())
+						return;
+					m_TextureCachePtr->LoadAsync(path, *m_AssetLoaderPtr, [meshPtr, submeshIndex, slot](Texture* texturePtr)
+						{
+							meshPtr->SetSubmeshTexture(submeshIndex, slot, texturePtr);
+						});
+				};
+			request(materialIt->diffuseMap, Mesh::TextureSlot::Diffuse);
+			request(materialIt->normalMap, Mesh::TextureSlot::Normal);
+			request(materialIt->specularMap, Mesh::TextureSlot::Specular);
+			request(materialIt->glossinessMap, Mesh::TextureSlot::Glossiness);
+		}
+
+		//The levels of detail keep the submesh order
+		for (const Simplifier::LevelOfDetail& level : meshCache.GetLevelsOfDetail())
+		{
+			std::vector<IndexCompression::IndexRange> submeshRanges{};
+			for (const Utils::OBJSubmesh& submesh : level.submeshes)
+				submeshRanges.push_back({ submesh.firstIndex, submesh.numIndices, 0 });
+			meshPtr->AddLevelOfDetail(level.error, std::move(submeshRanges));
+		}
+	}
+
+	void Renderer::AddGLBSubmeshes(Mesh* meshPtr, const ModelData& model)
+	{
+		// Once per image, primitives that share a material share its textures
+		std::vector<Texture*> texturePtrs(model.images.size());
+		for (size_t image = 0; image < model.images.size(); ++image)
+		{
+			texturePtrs[image] = Texture::CreateFromSurface(model.images[image].get(), m_DevicePtr);
+			if (texturePtrs[image])
+				m_EmbeddedTexturePtrs.push_back(texturePtrs[image]);
+		}
+
+		// nullptr keeps the placeholder of the mesh
+		const auto getTexture = [&texturePtrs](int image) { return image >= 0 and static_cast<size_t>(image) < texturePtrs.size() ? texturePtrs[image] : nullptr; };
+		for (const GLBFile::Primitive& primitive : model.glbFilePtr->GetPrimitives())
+		{
+			const uint32_t submeshIndex = meshPtr->AddSubmesh(primitive.firstIndex, primitive.numIndices);
+			meshPtr->SetSubmeshTexture(submeshIndex, Mesh::TextureSlot::Diffuse, getTexture(primitive.baseColorImage));
+			meshPtr->SetSubmeshTexture(submeshIndex, Mesh::TextureSlot::Normal, getTexture(primitive.normalImage));
+		}
+	}
+
+	void Renderer::WriteScreenshot(const std::string& path) const
+	{
+		D3D11_TEXTURE2D_DESC desc{};
+		static_cast<ID3D11Texture2D*>(m_RenderTargetBufferPtr)->GetDesc(&desc);
+		desc.Usage = D3D11_USAGE_STAGING;
+		desc.BindFlags = 0;
+		desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+		desc.MiscFlags = 0;
+
+		ID3D11Texture2D* stagingPtr = nullptr;
+		if (FAILED(m_DevicePtr->CreateTexture2D(&desc, nullptr, &stagingPtr)))
+		{
+			std::cout << "Renderer: failed to create the screenshot staging texture\n";
+			return;
+		}
+		m_DeviceContextPtr->CopyResource(stagingPtr, m_RenderTargetBufferPtr);
+
+		SoftwareRenderer::Framebuffer framebuffer{};
+		framebuffer.width = desc.Width;
+		framebuffer.height = desc.Height;
+		framebuffer.colors.resize(static_cast<size_t>(desc.Width) * desc.Height);
+
+		D3D11_MAPPED_SUBRESOURCE mapped{};
+		const HRESULT result = m_DeviceContextPtr->Map(stagingPtr, 0, D3D11_MAP_READ, 0, &mapped);
+		if (SUCCEEDED(result))
+		{
+			for (uint32_t y = 0; y < desc.Height; ++y)
+				std::memcpy(&framebuffer.colors[static_cast<size_t>(y) * desc.Width], static_cast<const char*>(mapped.pData) + static_cast<size_t>(y) * mapped.RowPitch, desc.Width * sizeof(uint32_t));
+			m_DeviceContextPtr->Unmap(stagingPtr, 0);
+		}
+		stagingPtr->Release();
+
+		if (FAILED(result) or !SoftwareRenderer::WriteImage(path, framebuffer))
+		{
+			std::cout << "Renderer: failed to write " << path << '\n';
+			return;
+		}
+
+		//The headless renderer only knows the start camera and the level of detail picked by distance
+		std::cout << "Screenshot written to " << path << ", the same frame from the start camera renders with --headless <image.ppm> --time " << m_FrameTime
+			<< " --pass " << static_cast<int>(m_SampleMethod) << (m_UseNormalMap ? "" : " --no-normal-map") << (m_UseFireFX ? "" : " --no-firefx")
+			<< " --reference " << path << '\n';
 	}
 
 	HRESULT Renderer::InitializeDirectX()
@@ -260,10 +581,25 @@ namespace dae {
 		return S_OK;
 	}
 
+	void Renderer::CycleLevelOfDetail()
+	{
+		if (!m_MeshPtr)
+			return;
+
+		//Automatic, then every level from full detail to the coarsest
+		m_ForcedLevelOfDetail = !m_ForcedLevelOfDetail ? std::optional<size_t>{ 0 } : *m_ForcedLevelOfDetail + 1 < m_MeshPtr->GetNumLevelsOfDetail() ? std::optional<size_t>{ *m_ForcedLevelOfDetail + 1 } : std::nullopt;
+		m_MeshPtr->ForceLevelOfDetail(m_ForcedLevelOfDetail);
+		if (m_ForcedLevelOfDetail)
+			std::cout << "Level of detail is " << *m_ForcedLevelOfDetail << " of " << m_MeshPtr->GetNumLevelsOfDetail() - 1 << '\n';
+		else
+			std::cout << "Level of detail is picked by distance\n";
+	}
+
 	void Renderer::CycleSamplerState()
 	{
 		m_SampleMethod = static_cast<SampleMethod>((static_cast<int>(m_SampleMethod) + 1) % 3);
-		m_MeshPtr->SetPassIdx(static_cast<UINT>(m_SampleMethod));
+		if (m_MeshPtr)
+			m_MeshPtr->SetPassIdx(static_cast<UINT>(m_SampleMethod));
 		switch (m_SampleMethod)
 		{
 		case SampleMethod::Point:
@@ -1,5 +1,10 @@
 #pragma once
 #include "Camera.h"
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
 struct SDL_Window;
 struct SDL_Surface;
@@ -9,6 +14,9 @@ namespace dae
 	struct Vertex;
 	class Texture;
 	class Mesh;
+	class MeshCache;
+	class AssetLoader;
+	class TextureCache;
 
 	class Renderer final
 	{		
@@ -28,6 +36,10 @@ namespace dae
 		void ToggleRotation() { m_Rotate = !m_Rotate; std::cout << "Rotation is " << (m_Rotate ? "On" : "Off") << std::endl; };
 		void ToggleNormalVisibility() { m_UseNormalMap = !m_UseNormalMap; std::cout << "Normal map is " << (m_UseNormalMap ? "On" : "Off") << std::endl; };
 		void ToggleFireFX() { m_UseFireFX = !m_UseFireFX; std::cout << "FireFx is " << (m_UseFireFX ? "On" : "Off") << std::endl; };
+		void ToggleMeshletCulling() { m_UseMeshletCulling = !m_UseMeshletCulling; std::cout << "Meshlet culling is " << (m_UseMeshletCulling ? "On" : "Off") << std::endl; };
+		void CycleLevelOfDetail();
+		//Writes the next frame to screenshot.ppm and prints the --headless arguments that render the same frame on the CPU
+		void SaveScreenshot() { m_IsScreenshotRequested = true; }
 	private:
 		SDL_Window* m_WindowPtr{};
 
@@ -38,8 +50,13 @@ namespace dae
 		bool m_Rotate{ true };
 		bool m_UseNormalMap{ true };
 		bool m_UseFireFX{ true };
+		bool m_UseMeshletCulling{ true };
+		std::optional<size_t> m_ForcedLevelOfDetail{};
 
 		float m_TotalTime{ 0.f };
+		//gTime of the frame being drawn, m_TotalTime already moved on
+		float m_FrameTime{ 0.f };
+		mutable bool m_IsScreenshotRequested{ false };
 
 		enum class SampleMethod
 		{
@@ -52,6 +69,35 @@ namespace dae
 		//DIRECTX
 		HRESULT InitializeDirectX();
 
+		//ASSETS
+		//Files are read, decoded and parsed on the loader threads, GPU resources are created in Update as they finish
+		//Cooked meshes take their textures from the MTL files they reference, one submesh per material
+		//.glb models are loaded as they are, one submesh per primitive with the images the file embeds
+		//Meshlets for CPU culling are built on the loader threads too
+		struct ModelData;
+
+		void LoadAssets();
+		void LoadModel(const std::string& meshPath, std::shared_ptr<ModelData>& modelPtr);
+		// Packed or float vertices, whichever the cooker wrote, or the vertices of a GLB straight from its mapped buffer views
+		Mesh* CreateMesh(const ModelData& model) const;
+		void CreateMeshes();
+		// Also hands the bounds and levels of detail of the cache to the mesh
+		void AddSubmeshes(Mesh* meshPtr, const ModelData& model);
+		// Uploads the embedded images, GLB models have no levels of detail
+		void AddGLBSubmeshes(Mesh* meshPtr, const ModelData& model);
+
+		//Copies the back buffer through a staging texture
+		void WriteScreenshot(const std::string& path) const;
+
+		std::unique_ptr<AssetLoader> m_AssetLoaderPtr{};
+		std::unique_ptr<TextureCache> m_TextureCachePtr{};
+		std::shared_ptr<ID3DBlob> m_EffectBlobPtr{};
+		std::shared_ptr<ModelData> m_VehicleModelPtr{};
+		std::shared_ptr<ModelData> m_FireFXModelPtr{};
+
+		std::chrono::steady_clock::time_point m_StartTime{};
+		mutable bool m_IsFirstFramePresented{ false };
+
 		IDXGIFactory1* m_DXGIFactoryPtr = nullptr;
 		ID3D11Device* m_DevicePtr = nullptr;
 		ID3D11DeviceContext* m_DeviceContextPtr = nullptr;
@@ -65,11 +111,13 @@ namespace dae
 		Mesh* m_MeshPtr = nullptr;
 		Mesh* m_FireFXPtr = nullptr;
 
-		// Vehicle
-		Texture* m_DiffuseTexturePtr = nullptr;
-		Texture* m_GlossinessTexturePtr = nullptr;
-		Texture* m_NormalTexturePtr = nullptr;
-		Texture* m_SpecularTexturePtr = nullptr;
-		Texture* m_FireFXDiffusePtr = nullptr;
+		// Shown until the material textures are loaded, or when a material has none
+		Texture* m_PlaceholderDiffusePtr = nullptr;
+		Texture* m_PlaceholderNormalPtr = nullptr;
+		Texture* m_PlaceholderSpecularPtr = nullptr;
+		Texture* m_PlaceholderGlossinessPtr = nullptr;
+		Texture* m_PlaceholderFireFXPtr = nullptr;
+		// Images embedded in .glb models, they have no path the TextureCache could own them by
+		std::vector<Texture*> m_EmbeddedTexturePtrs{};
 	};
 }
@@ -12,6 +12,10 @@ float     gTime           : Time;
 float3    gCameraPos      : CameraPos;
 bool      gUseNormalMap   : UseNormalMap;
 
+// Packed vertices: position = gPositionOffset + gPositionScale * unorm position
+float3    gPositionOffset : PositionOffset;
+float3    gPositionScale  : PositionScale;
+
 float gPI = 3.14159265358979311599796346854;
 float gKD = 7.0f;
 float gShininess = 25.0f;
@@ -28,7 +32,16 @@ struct VS_INPUT
     float3 Color    : COLOR;
     float2 Uv       : TEXCOORD;
     float3 Normal   : NORMAL;
-    float3 Tangent  : TANGENT;
+    float4 Tangent  : TANGENT;
+};
+
+// PackedVertex in Mesh.h, 20 bytes
+struct VS_PACKED_INPUT
+{
+    float4 Position : POSITION; // xyz inside the mesh bounds, w the tangent handedness
+    float2 Uv       : TEXCOORD;
+    float2 Normal   : NORMAL;   // octahedral
+    float2 Tangent  : TANGENT;  // octahedral
 };
 
 struct VS_OUTPUT
@@ -37,7 +50,7 @@ struct VS_OUTPUT
     float3 Color    : COLOR;
     float2 Uv       : TEXCOORD;
     float3 Normal   : NORMAL;
-    float3 Tangent  : TANGENT;
+    float4 Tangent  : TANGENT;
     float3 ViewDirection : VERTEX_TO_CAMERA;
 };
 
@@ -159,7 +172,7 @@ VS_OUTPUT VS(VS_INPUT input)
     input.Normal    = mul(input.Normal, RotationMatrix(gRotationSpeed * gTime));
     output.Normal   = input.Normal;
     
-    input.Tangent   = mul(input.Tangent, RotationMatrix(gRotationSpeed * gTime));
+    input.Tangent.xyz = mul(input.Tangent.xyz, RotationMatrix(gRotationSpeed * gTime));
     output.Tangent  = input.Tangent;
     
     output.Color    = input.Color;
@@ -181,6 +194,35 @@ VS_OUTPUT VS_FireFX(VS_INPUT input)
     return output;
 }
 
+float3 DecodeOctahedral(float2 encoded)
+{
+    float3 direction = float3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float fold = saturate(-direction.z);
+    direction.xy += direction.xy >= 0.0f ? -fold : fold;
+    return normalize(direction);
+}
+
+VS_INPUT DecodePacked(VS_PACKED_INPUT input)
+{
+    VS_INPUT decoded = (VS_INPUT)0;
+    decoded.Position = gPositionOffset + gPositionScale * input.Position.xyz;
+    decoded.Color    = float3(1.0f, 1.0f, 1.0f);
+    decoded.Uv       = input.Uv;
+    decoded.Normal   = DecodeOctahedral(input.Normal);
+    decoded.Tangent  = float4(DecodeOctahedral(input.Tangent), input.Position.w * 2.0f - 1.0f);
+    return decoded;
+}
+
+VS_OUTPUT VS_Packed(VS_PACKED_INPUT input)
+{
+    return VS(DecodePacked(input));
+}
+
+VS_OUTPUT VS_FireFX_Packed(VS_PACKED_INPUT input)
+{
+    return VS_FireFX(DecodePacked(input));
+}
+
 //-------------------------------------------------
 // Pixel Shader
 //-------------------------------------------------
@@ -194,11 +236,11 @@ float4 PixelShading(VS_OUTPUT input, SamplerState sampleState)
     float  gloss = gGlossMap.Sample(sampleState, input.Uv).r;
 
     float3 normal = input.Normal;
-    float3 tangent = input.Tangent;
+    float3 tangent = input.Tangent.xyz;
     float3 viewDir = input.ViewDirection;
 
     //normal
-    float3 binormal = cross(normal, tangent);
+    float3 binormal = cross(normal, tangent) * input.Tangent.w;
     float3x3 tangentSpace = float3x3(tangent, binormal, normal);
     normalColor = 2 * normalColor - 1.0f;
     normal = gUseNormalMap ? mul(normalColor, tangentSpace) : normal;
@@ -282,4 +324,46 @@ technique11 DefaultTechnique
         SetGeometryShader( NULL );
         SetPixelShader( CompileShader( ps_5_0, PS_FireFX() ) );
     }
+}
+
+// Same passes for meshes made of PackedVertex
+technique11 PackedTechnique
+{
+    pass P0 // Point sampling
+    {
+        SetDepthStencilState( gNoDepthStencilState, 0 );
+        
+        SetVertexShader( CompileShader( vs_5_0, VS_Packed() ) );
+        SetGeometryShader( NULL );
+        SetPixelShader( CompileShader( ps_5_0, PS_Point() ) );
+    }
+    
+    pass P1 // Linear sampling
+    {
+        SetDepthStencilState( gNoDepthStencilState, 0 );
+
+        SetVertexShader( CompileShader( vs_5_0, VS_Packed() ) );
+        SetGeometryShader( NULL );
+        SetPixelShader( CompileShader( ps_5_0, PS_Linear() ) );
+    }
+    
+    pass P2 // Anisotropic sampling
+    {
+        SetDepthStencilState( gNoDepthStencilState, 0 );
+
+        SetVertexShader( CompileShader( vs_5_0, VS_Packed() ) );
+        SetGeometryShader( NULL );
+        SetPixelShader( CompileShader( ps_5_0, PS_Anisotropic() ) );
+    }
+    
+    pass P3 // FireFX
+    {
+        SetRasterizerState( gRasterizerState );
+        SetDepthStencilState( gDepthStencilState, 0 );
+        SetBlendState( gBlendState, float4( 0.0f, 0.0f, 0.0f, 0.0f ), 0xFFFFFFFF ); 
+        
+        SetVertexShader( CompileShader( vs_5_0, VS_FireFX_Packed() ) );
+        SetGeometryShader( NULL );
+        SetPixelShader( CompileShader( ps_5_0, PS_FireFX() ) );
+    }
 }
\ No newline at end of file
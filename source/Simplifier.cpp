@@ -0,0 +1,602 @@
+#include "pch.h"
+#include "Simplifier.h"
+#include "MeshOptimizer.h"
+
+#include <cmath>
+#include <numeric>
+
+namespace dae
+{
+	namespace Simplifier
+	{
+		namespace
+		{
+			constexpr uint32_t NoVertex{ UINT32_MAX };
+			//Open edges weigh this much more than faces, so borders and seams keep their shape
+			constexpr double EdgeWeight{ 10.0 };
+			//A pass takes collapses up to this many times the error of the one that would reach its goal without any locks
+			constexpr double PassErrorBound{ 1.5 };
+			//A level has to drop at least this share of the triangles of the level before it to be worth its indices
+			constexpr float MinLevelReduction{ 0.2f };
+			//No level moves the surface further than this share of the bounds diagonal, Simplify stops there instead
+			constexpr float MaxLevelError{ 0.05f };
+
+			enum class VertexKind : uint8_t
+			{
+				//Inside the surface, can collapse onto any neighbour
+				Manifold,
+				//On an open border, only collapses along it
+				Border,
+				//One of two vertices at the same position, collapses along the seam together with its twin
+				Seam,
+				//One of several vertices at a position, every one of them collapses onto a vertex at the target position it shares a triangle
+				//with, so those triangles keep their attributes, the others onto the target itself. Where a seam meets a border only along it
+				Complex,
+				//Never moves: single vertices on a border that splits into several loops or meets a seam, non-manifold vertices and vertices
+				//locked by the caller. Borders and seams still collapse onto them
+				Locked,
+			};
+
+			//Sum of squared distances to weighted planes: error(p) = p^T A p + 2 b.p + c, divided by the summed weight
+			struct Quadric
+			{
+				double a00{}, a11{}, a22{}, a10{}, a20{}, a21{};
+				double b0{}, b1{}, b2{};
+				double c{};
+				double weight{};
+
+				void AddPlane(const Vector3& normal, float distance, double planeWeight)
+				{
+					const double x = normal.x, y = normal.y, z = normal.z, d = distance;
+					a00 += planeWeight * x * x;
+					a11 += planeWeight * y * y;
+					a22 += planeWeight * z * z;
+					a10 += planeWeight * y * x;
+					a20 += planeWeight * z * x;
+					a21 += planeWeight * z * y;
+					b0 += planeWeight * x * d;
+					b1 += planeWeight * y * d;
+					b2 += planeWeight * z * d;
+					c += planeWeight * d * d;
+					weight += planeWeight;
+				}
+
+				void Add(const Quadric& other)
+				{
+					a00 += other.a00; a11 += other.a11; a22 += other.a22;
+					a10 += other.a10; a20 += other.a20; a21 += other.a21;
+					b0 += other.b0; b1 += other.b1; b2 += other.b2;
+					c += other.c;
+					weight += other.weight;
+				}
+
+				//Weighted mean squared distance of p to the planes
+				double Error(const Vector3& p) const
+				{
+					if (weight <= 0.0)
+						return 0.0;
+
+					const double x = p.x, y = p.y, z = p.z;
+					const double error = a00 * x * x + a11 * y * y + a22 * z * z + 2.0 * (a10 * x * y + a20 * x * z + a21 * y * z)
+						+ 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+					return std::max(error, 0.0) / weight;
+				}
+			};
+
+			struct Collapse
+			{
+				uint32_t source{};
+				uint32_t target{};
+				double error{};
+			};
+
+			uint64_t EdgeKey(uint32_t from, uint32_t to)
+			{
+				return (uint64_t(from) << 32) | to;
+			}
+
+			//Every vertex of positions points to the lowest vertex at exactly the same position, vertices with used[vertex] == 0 are left out
+			//wedges links the vertices at each position into a circular list
+			void GroupPositions(std::span<const Vector3> positions, std::span<const uint8_t> used, std::vector<uint32_t>& remap, std::vector<uint32_t>& wedges)
+			{
+				const size_t numVertices = positions.size();
+				remap.resize(numVertices);
+				wedges.resize(numVertices);
+				std::iota(remap.begin(), remap.end(), 0u);
+				std::iota(wedges.begin(), wedges.end(), 0u);
+
+				std::vector<uint32_t> order{};
+				order.reserve(numVertices);
+				for (uint32_t vertex = 0; vertex < numVertices; ++vertex)
+				{
+					if (used.empty() or used[vertex])
+						order.push_back(vertex);
+				}
+				std::sort(order.begin(), order.end(), [&positions](uint32_t a, uint32_t b)
+					{
+						const Vector3& pa = positions[a];
+						const Vector3& pb = positions[b];
+						if (pa.x != pb.x)
+							return pa.x < pb.x;
+						if (pa.y != pb.y)
+							return pa.y < pb.y;
+						if (pa.z != pb.z)
+							return pa.z < pb.z;
+						return a < b;
+					});
+				const auto isSamePosition = [&positions](uint32_t a, uint32_t b)
+					{
+						return positions[a].x == positions[b].x and positions[a].y == positions[b].y and positions[a].z == positions[b].z;
+					};
+
+				for (size_t first = 0; first < order.size(); )
+				{
+					size_t last = first + 1;
+					while (last < order.size() and isSamePosition(order[last], order[first]))
+						++last;
+
+					for (size_t index = first; index < last; ++index)
+					{
+						remap[order[index]] = order[first];
+						wedges[order[index]] = order[index + 1 < last ? index + 1 : first];
+					}
+					first = last;
+				}
+			}
+
+			bool HasEdge(const std::vector<uint64_t>& sortedEdges, uint32_t from, uint32_t to)
+			{
+				return std::binary_search(sortedEdges.begin(), sortedEdges.end(), EdgeKey(from, to));
+			}
+		}
+
+		float Simplify(std::span<const uint32_t> indices, std::span<const Vector3> positions, size_t targetIndexCount, std::vector<uint32_t>& result,
+			float maxError, std::span<const uint8_t> lockedVertices)
+		{
+			result.assign(indices.begin(), indices.end());
+			const size_t numVertices = positions.size();
+			if (result.size() <= targetIndexCount)
+				return 0.f;
+
+			std::vector<uint8_t> used(numVertices);
+			for (const uint32_t index : indices)
+				used[index] = 1;
+
+			std::vector<uint32_t> remap{};
+			std::vector<uint32_t> wedges{};
+			GroupPositions(positions, used, remap, wedges);
+
+			//Open edges have no edge in the opposite direction: at vertex level they are borders or seams, at position level only borders
+			std::vector<uint64_t> edges{};
+			std::vector<uint64_t> positionEdges{};
+			edges.reserve(indices.size());
+			positionEdges.reserve(indices.size());
+			for (size_t first = 0; first + 3 <= indices.size(); first += 3)
+			{
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					const uint32_t from = indices[first + corner];
+					const uint32_t to = indices[first + (corner + 1) % 3];
+					edges.push_back(EdgeKey(from, to));
+					positionEdges.push_back(EdgeKey(remap[from], remap[to]));
+				}
+			}
+			std::sort(edges.begin(), edges.end());
+			std::sort(positionEdges.begin(), positionEdges.end());
+
+			std::vector<VertexKind> kinds(numVertices, VertexKind::Manifold);
+			std::vector<uint32_t> openOut(numVertices, NoVertex);
+			std::vector<uint32_t> openIn(numVertices, NoVertex);
+			std::vector<uint8_t> numOpenOut(numVertices);
+			std::vector<uint8_t> numOpenIn(numVertices);
+			std::vector<uint8_t> isBorderPosition(numVertices);
+			for (size_t edge = 0; edge < edges.size(); ++edge)
+			{
+				const uint32_t from = static_cast<uint32_t>(edges[edge] >> 32);
+				const uint32_t to = static_cast<uint32_t>(edges[edge]);
+				//The same directed edge twice is a non-manifold fan
+				if (edge > 0 and edges[edge] == edges[edge - 1])
+				{
+					kinds[from] = kinds[to] = VertexKind::Locked;
+					continue;
+				}
+				if (HasEdge(edges, to, from))
+					continue;
+
+				openOut[from] = to;
+				openIn[to] = from;
+				numOpenOut[from] = static_cast<uint8_t>(std::min(numOpenOut[from] + 1, 2));
+				numOpenIn[to] = static_cast<uint8_t>(std::min(numOpenIn[to] + 1, 2));
+				if (!HasEdge(positionEdges, remap[to], remap[from]))
+					isBorderPosition[remap[from]] = isBorderPosition[remap[to]] = 1;
+			}
+
+			for (uint32_t vertex = 0; vertex < numVertices; ++vertex)
+			{
+				if (!used[vertex] or kinds[vertex] == VertexKind::Locked)
+					continue;
+
+				const bool hasOneLoop = numOpenOut[vertex] == 1 and numOpenIn[vertex] == 1;
+				const uint32_t twin = wedges[vertex];
+				VertexKind kind = VertexKind::Locked;
+				if (!lockedVertices.empty() and lockedVertices[vertex])
+				{
+					kind = VertexKind::Locked;
+				}
+				else if (twin == vertex)
+				{
+					if (numOpenOut[vertex] == 0 and numOpenIn[vertex] == 0)
+						kind = VertexKind::Manifold;
+					//A border that is also a seam at a neighbour would drag the far side of that seam along
+					else if (hasOneLoop and !HasEdge(positionEdges, remap[openOut[vertex]], remap[vertex])
+						and !HasEdge(positionEdges, remap[vertex], remap[openIn[vertex]]))
+						kind = VertexKind::Border;
+				}
+				else if (wedges[twin] == vertex and hasOneLoop and numOpenOut[twin] == 1 and numOpenIn[twin] == 1
+					and remap[openOut[vertex]] == remap[openIn[twin]] and remap[openIn[vertex]] == remap[openOut[twin]])
+				{
+					kind = VertexKind::Seam;
+				}
+				else
+				{
+					kind = VertexKind::Complex;
+				}
+				kinds[vertex] = kind;
+			}
+
+			std::vector<Quadric> quadrics(numVertices);
+			for (size_t first = 0; first + 3 <= indices.size(); first += 3)
+			{
+				const uint32_t triangle[3]{ indices[first], indices[first + 1], indices[first + 2] };
+				const Vector3& p0 = positions[triangle[0]];
+				Vector3 normal = Vector3::Cross(positions[triangle[1]] - p0, positions[triangle[2]] - p0);
+				const float doubleArea = normal.Normalize();
+				if (!(doubleArea > 0.f))
+					continue;
+
+				const float distance = -Vector3::Dot(normal, p0);
+				for (const uint32_t vertex : triangle)
+					quadrics[remap[vertex]].AddPlane(normal, distance, doubleArea * 0.5);
+
+				//A plane through every open edge, perpendicular to the triangle, keeps the edge from moving sideways
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					const uint32_t from = triangle[corner];
+					const uint32_t to = triangle[(corner + 1) % 3];
+					if (openOut[from] != to)
+						continue;
+
+					Vector3 edge = positions[to] - positions[from];
+					const float length = edge.Magnitude();
+					Vector3 edgeNormal = Vector3::Cross(normal, edge);
+					if (!(edgeNormal.Normalize() > 0.f))
+						continue;
+
+					const float edgeDistance = -Vector3::Dot(edgeNormal, positions[from]);
+					quadrics[remap[from]].AddPlane(edgeNormal, edgeDistance, double(length) * length * EdgeWeight);
+					quadrics[remap[to]].AddPlane(edgeNormal, edgeDistance, double(length) * length * EdgeWeight);
+				}
+			}
+
+			//The twin a seam vertex moves along with it, NoVertex when the collapse is not allowed
+			const auto getTwinTarget = [&](uint32_t source, uint32_t target)
+				{
+					const uint32_t twin = wedges[source];
+					const uint32_t twinTarget = target == openOut[source] ? openIn[twin] : openOut[twin];
+					return twinTarget != NoVertex and remap[twinTarget] == remap[target] ? twinTarget : NoVertex;
+				};
+
+			//Pairs every vertex at the position of source with a vertex at the position of target that it shares a triangle with, or with target
+			//when there is none. Those triangles take the attributes of target at that corner, flat shading and hard edges fade a little
+			std::vector<uint32_t> triangleOffsets(numVertices + 1);
+			std::vector<uint32_t> vertexTriangles{};
+			const auto matchWedges = [&](uint32_t source, uint32_t target, std::vector<Collapse>& pairs)
+				{
+					pairs.clear();
+					uint32_t wedge = source;
+					do
+					{
+						if (kinds[wedge] != kinds[source])
+							return false;
+
+						uint32_t match = NoVertex;
+						for (uint32_t entry = triangleOffsets[wedge]; entry < triangleOffsets[wedge + 1] and match == NoVertex; ++entry)
+						{
+							for (int corner = 0; corner < 3; ++corner)
+							{
+								const uint32_t vertex = result[vertexTriangles[entry] * 3 + corner];
+								if (remap[vertex] == remap[target])
+									match = vertex;
+							}
+						}
+						//Wedges without triangles left have nothing to move
+						if (triangleOffsets[wedge] != triangleOffsets[wedge + 1])
+							pairs.push_back({ wedge, match != NoVertex ? match : target });
+						wedge = wedges[wedge];
+					} while (wedge != source);
+					return true;
+				};
+
+			//Whether an open edge of any vertex at the position of source leads to the position of target, and that is on a border too
+			const auto isOpenTowards = [&](uint32_t source, uint32_t target)
+				{
+					if (!isBorderPosition[remap[target]])
+						return false;
+
+					uint32_t wedge = source;
+					do
+					{
+						if ((openOut[wedge] != NoVertex and remap[openOut[wedge]] == remap[target])
+							or (openIn[wedge] != NoVertex and remap[openIn[wedge]] == remap[target]))
+							return true;
+						wedge = wedges[wedge];
+					} while (wedge != source);
+					return false;
+				};
+
+			std::vector<Collapse> wedgeCollapses{};
+			const auto canCollapse = [&](uint32_t source, uint32_t target)
+				{
+					if (remap[source] == remap[target])
+						return false;
+
+					switch (kinds[source])
+					{
+					case VertexKind::Manifold:
+						return true;
+					case VertexKind::Border:
+						return (kinds[target] == VertexKind::Border or kinds[target] == VertexKind::Locked)
+							and (target == openOut[source] or target == openIn[source]);
+					case VertexKind::Seam:
+						return (kinds[target] == VertexKind::Seam or kinds[target] == VertexKind::Locked) and kinds[wedges[source]] == VertexKind::Seam
+							and (target == openOut[source] or target == openIn[source])
+							and getTwinTarget(source, target) != NoVertex;
+					case VertexKind::Complex:
+						return (!isBorderPosition[remap[source]] or isOpenTowards(source, target)) and matchWedges(source, target, wedgeCollapses);
+					default:
+						return false;
+					}
+				};
+
+			const double maxSquaredError = maxError < FLT_MAX ? double(maxError) * maxError : DBL_MAX;
+			double worstError = 0.0;
+
+			std::vector<Collapse> collapses{};
+			std::vector<uint32_t> collapseRemap(numVertices);
+			std::vector<uint8_t> isLocked(numVertices);
+			bool isPassErrorLimited = true;
+			while (result.size() > targetIndexCount)
+			{
+				//Triangles around every vertex, for the flip test
+				std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0u);
+				for (const uint32_t index : result)
+					++triangleOffsets[index + 1];
+				std::partial_sum(triangleOffsets.begin(), triangleOffsets.end(), triangleOffsets.begin());
+				vertexTriangles.resize(result.size());
+				{
+					std::vector<uint32_t> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+					for (size_t index = 0; index < result.size(); ++index)
+						vertexTriangles[fill[result[index]]++] = static_cast<uint32_t>(index / 3);
+				}
+
+				//The cheaper allowed direction of every edge
+				collapses.clear();
+				for (size_t index = 0; index < result.size(); ++index)
+				{
+					const uint32_t a = result[index];
+					const uint32_t b = result[index - index % 3 + (index + 1) % 3];
+					const bool canAB = canCollapse(a, b);
+					const bool canBA = canCollapse(b, a);
+					const double errorAB = canAB ? quadrics[remap[a]].Error(positions[b]) : DBL_MAX;
+					const double errorBA = canBA ? quadrics[remap[b]].Error(positions[a]) : DBL_MAX;
+					if (canAB and errorAB <= errorBA)
+						collapses.push_back({ a, b, errorAB });
+					else if (canBA)
+						collapses.push_back({ b, a, errorBA });
+				}
+				if (collapses.empty())
+					break;
+				std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+				//Every collapse removes about two triangles. Both ends of a collapse are locked for the rest of the pass, collapses skipped
+				//for that wait for the next pass instead of letting much worse ones in. Collapses up to the worst error so far cost nothing,
+				//and when the cheap ones all flip triangles the next pass takes any error up to maxError
+				const size_t collapseGoal = std::max<size_t>((result.size() - targetIndexCount) / 6, 1);
+				const double passErrorLimit = !isPassErrorLimited ? DBL_MAX
+					: std::max(collapses[std::min(collapseGoal, collapses.size()) - 1].error * PassErrorBound * PassErrorBound, worstError);
+				std::iota(collapseRemap.begin(), collapseRemap.end(), 0u);
+				std::fill(isLocked.begin(), isLocked.end(), uint8_t{ 0 });
+
+				//Against the triangles as the collapses accepted so far in this pass leave them
+				const auto hasFlips = [&](uint32_t source, uint32_t target)
+					{
+						for (uint32_t entry = triangleOffsets[source]; entry < triangleOffsets[source + 1]; ++entry)
+						{
+							const uint32_t* trianglePtr = &result[vertexTriangles[entry] * 3];
+							const uint32_t triangle[3]{ collapseRemap[trianglePtr[0]], collapseRemap[trianglePtr[1]], collapseRemap[trianglePtr[2]] };
+							if (triangle[0] == target or triangle[1] == target or triangle[2] == target
+								or triangle[0] == triangle[1] or triangle[1] == triangle[2] or triangle[0] == triangle[2])
+								continue;
+
+							const Vector3& p0 = positions[triangle[0]];
+							const Vector3 before = Vector3::Cross(positions[triangle[1]] - p0, positions[triangle[2]] - p0);
+							Vector3 moved[3]{};
+							for (int corner = 0; corner < 3; ++corner)
+								moved[corner] = positions[triangle[corner] == source ? target : triangle[corner]];
+							const Vector3 after = Vector3::Cross(moved[1] - moved[0], moved[2] - moved[0]);
+							if (Vector3::Dot(before, after) <= 0.f)
+								return true;
+						}
+						return false;
+					};
+
+				size_t numCollapsed = 0;
+				for (const Collapse& collapse : collapses)
+				{
+					if (numCollapsed >= collapseGoal or collapse.error > maxSquaredError or collapse.error > passErrorLimit)
+						break;
+
+					const uint32_t source = collapse.source;
+					const uint32_t target = collapse.target;
+					if (isLocked[remap[source]] or isLocked[remap[target]])
+						continue;
+
+					//Every vertex at the source position that moves, and where to
+					wedgeCollapses.assign(1, { source, target });
+					if (kinds[source] == VertexKind::Seam)
+						wedgeCollapses.push_back({ wedges[source], getTwinTarget(source, target) });
+					else if (kinds[source] == VertexKind::Complex and !matchWedges(source, target, wedgeCollapses))
+						continue;
+					if (std::any_of(wedgeCollapses.begin(), wedgeCollapses.end(), [&](const Collapse& wedge) { return hasFlips(wedge.source, wedge.target); }))
+						continue;
+
+					for (const Collapse& wedge : wedgeCollapses)
+						collapseRemap[wedge.source] = wedge.target;
+					isLocked[remap[source]] = isLocked[remap[target]] = 1;
+					quadrics[remap[target]].Add(quadrics[remap[source]]);
+					worstError = std::max(worstError, collapse.error);
+					++numCollapsed;
+				}
+				if (numCollapsed == 0 and isPassErrorLimited)
+				{
+					isPassErrorLimited = false;
+					continue;
+				}
+				if (numCollapsed == 0)
+					break;
+				isPassErrorLimited = true;
+
+				//Borders and seams that ran through a collapsed vertex now continue to where it went
+				const std::vector<uint32_t> oldOut = openOut;
+				const std::vector<uint32_t> oldIn = openIn;
+				for (uint32_t vertex = 0; vertex < numVertices; ++vertex)
+				{
+					for (auto [loopPtr, oldLoopPtr] : { std::pair{ &openOut, &oldOut }, std::pair{ &openIn, &oldIn } })
+					{
+						const uint32_t next = (*oldLoopPtr)[vertex];
+						if (next == NoVertex)
+							continue;
+
+						const uint32_t moved = collapseRemap[next];
+						if (moved == vertex)
+							(*loopPtr)[vertex] = (*oldLoopPtr)[next] != NoVertex ? collapseRemap[(*oldLoopPtr)[next]] : NoVertex;
+						else
+							(*loopPtr)[vertex] = moved;
+					}
+				}
+
+				size_t numKept = 0;
+				for (size_t first = 0; first + 3 <= result.size(); first += 3)
+				{
+					const uint32_t a = collapseRemap[result[first]];
+					const uint32_t b = collapseRemap[result[first + 1]];
+					const uint32_t c = collapseRemap[result[first + 2]];
+					if (remap[a] == remap[b] or remap[b] == remap[c] or remap[a] == remap[c])
+						continue;
+
+					result[numKept++] = a;
+					result[numKept++] = b;
+					result[numKept++] = c;
+				}
+				result.resize(numKept);
+			}
+
+			return static_cast<float>(std::sqrt(worstError));
+		}
+
+		std::vector<LevelOfDetail> BuildLevelsOfDetail(std::span<const Vertex> vertices, std::vector<uint32_t>& indices,
+			std::span<const Utils::OBJSubmesh> submeshes, std::span<const float> ratios)
+		{
+			std::vector<LevelOfDetail> levels{};
+			std::vector<Vector3> positions(vertices.size());
+			std::transform(vertices.begin(), vertices.end(), positions.begin(), [](const Vertex& vertex) { return vertex.position; });
+			if (positions.empty())
+				return levels;
+
+			Vector3 boundsMin = positions.front();
+			Vector3 boundsMax = positions.front();
+			for (const Vector3& position : positions)
+			{
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					boundsMin[axis] = std::min(boundsMin[axis], position[axis]);
+					boundsMax[axis] = std::max(boundsMax[axis], position[axis]);
+				}
+			}
+			const float maxError = (boundsMax - boundsMin).Magnitude() * MaxLevelError;
+
+			std::vector<Utils::OBJSubmesh> fullSubmeshes(submeshes.begin(), submeshes.end());
+			if (fullSubmeshes.empty())
+				fullSubmeshes.push_back({ "", 0, static_cast<uint32_t>(indices.size()) });
+			const std::vector<uint32_t> fullIndices = indices;
+
+			//Positions used by more than one submesh stay where they are, so the submeshes keep meeting there
+			std::vector<uint32_t> remap{};
+			std::vector<uint32_t> wedges{};
+			GroupPositions(positions, {}, remap, wedges);
+			std::vector<uint32_t> owners(vertices.size(), NoVertex);
+			std::vector<uint8_t> lockedVertices(vertices.size());
+			for (uint32_t submesh = 0; submesh < fullSubmeshes.size(); ++submesh)
+			{
+				const Utils::OBJSubmesh& range = fullSubmeshes[submesh];
+				for (uint32_t index = range.firstIndex; index < range.firstIndex + range.numIndices; ++index)
+				{
+					const uint32_t position = remap[fullIndices[index]];
+					if (owners[position] == NoVertex)
+						owners[position] = submesh;
+					else if (owners[position] != submesh)
+						lockedVertices[position] = 1;
+				}
+			}
+			for (uint32_t vertex = 0; vertex < vertices.size(); ++vertex)
+				lockedVertices[vertex] = lockedVertices[remap[vertex]];
+
+			size_t previousNumIndices = 0;
+			for (const Utils::OBJSubmesh& submesh : fullSubmeshes)
+				previousNumIndices += submesh.numIndices;
+
+			std::vector<uint32_t> levelIndices{};
+			for (const float ratio : ratios)
+			{
+				LevelOfDetail level{ ratio };
+				const size_t levelStart = indices.size();
+				for (const Utils::OBJSubmesh& submesh : fullSubmeshes)
+				{
+					const std::span<const uint32_t> submeshIndices{ fullIndices.data() + submesh.firstIndex, submesh.numIndices };
+					const size_t targetIndexCount = static_cast<size_t>(static_cast<float>(submesh.numIndices / 3) * ratio) * 3;
+					level.error = std::max(level.error, Simplify(submeshIndices, positions, targetIndexCount, levelIndices, maxError, lockedVertices));
+					MeshOptimizer::OptimizeVertexCache(levelIndices, vertices.size());
+
+					level.submeshes.push_back({ submesh.material, static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(levelIndices.size()) });
+					indices.insert(indices.end(), levelIndices.begin(), levelIndices.end());
+				}
+
+				const size_t numLevelIndices = indices.size() - levelStart;
+				if (static_cast<float>(numLevelIndices) > static_cast<float>(previousNumIndices) * (1.f - MinLevelReduction))
+				{
+					indices.resize(levelStart);
+					break;
+				}
+				previousNumIndices = numLevelIndices;
+				levels.push_back(std::move(level));
+			}
+			return levels;
+		}
+
+		size_t SelectLevelOfDetail(std::span<const float> errors, float distance, float projectionScale, float viewportHeight, float maxPixelError)
+		{
+			if (!(distance > 0.f))
+				return 0;
+
+			//Size of one mesh unit at that distance, in pixels
+			const float pixelsPerUnit = projectionScale * viewportHeight * 0.5f / distance;
+			size_t level = 0;
+			for (size_t index = 0; index < errors.size(); ++index)
+			{
+				if (errors[index] * pixelsPerUnit <= maxPixelError)
+					level = index + 1;
+			}
+			return level;
+		}
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "Vertex.h"
+#include "Utils.h"
+#include <cfloat>
+#include <span>
+#include <vector>
+
+namespace dae
+{
+	//Quadric error metric edge collapse (Garland and Heckbert) for automatic levels of detail
+	//A vertex only ever collapses onto one of its neighbours, so a coarser level is just another index list into the same vertices
+	namespace Simplifier
+	{
+		//Collapses edges in order of the quadric error until indices is down to targetIndexCount, or until the next collapse would
+		//move the surface further than maxError in mesh units. Winding is kept, collapses that would flip a triangle are skipped
+		//Vertices that share their position with a vertex of other attributes, UV seams and hard normal edges, only collapse along
+		//that seam together with their twin on the other side, and open borders only along the border, so neither tears nor slides
+		//Where more than two vertices share a position they all move together, triangles without a neighbour at the target position
+		//take the attributes of the target vertex there
+		//Vertices flagged in lockedVertices never move, flag every vertex at a position to keep it. Vertices outside indices are never touched
+		//Returns the error of the result: the distance to the planes of the triangles every collapsed vertex stood for, as the quadrics measure it
+		float Simplify(std::span<const uint32_t> indices, std::span<const Vector3> positions, size_t targetIndexCount, std::vector<uint32_t>& result,
+			float maxError = FLT_MAX, std::span<const uint8_t> lockedVertices = {});
+
+		//A coarser copy of every submesh, stored behind the full detail indices and drawn with the same vertices
+		struct LevelOfDetail
+		{
+			//Share of the full detail triangles the level was built for
+			float ratio{};
+			//Largest Simplify error of its submeshes, in mesh units
+			float error{};
+			//Range and material of every full detail submesh at this level, in the same order
+			std::vector<Utils::OBJSubmesh> submeshes{};
+		};
+
+		constexpr float DefaultRatios[]{ 0.5f, 0.25f, 0.125f, 0.0625f };
+
+		//Simplifies every submesh of the full detail mesh to each ratio of its triangles, appends the results behind the full detail
+		//indices and optimizes their triangle order for the vertex cache. Positions shared by two submeshes are locked,
+		//so materials stay closed against each other. No level moves the surface further than 5% of the bounds diagonal, and the chain
+		//stops early when that leaves a level with more than 80% of the triangles of the one before
+		std::vector<LevelOfDetail> BuildLevelsOfDetail(std::span<const Vertex> vertices, std::vector<uint32_t>& indices,
+			std::span<const Utils::OBJSubmesh> submeshes, std::span<const float> ratios = DefaultRatios);
+
+		//Coarsest level whose error stays within maxPixelError pixels when seen from distance, 0 for the full detail mesh
+		//errors[i] is the error of level i + 1, the first level behind the full detail mesh
+		//projectionScale is the y scale of the projection matrix, 1 / tan(fov / 2), and viewportHeight is in pixels
+		size_t SelectLevelOfDetail(std::span<const float> errors, float distance, float projectionScale, float viewportHeight, float maxPixelError = 1.f);
+	}
+}
@@ -0,0 +1,1351 @@
+#include "pch.h"
+#include "SoftwareRenderer.h"
+#include "DDSFile.h"
+#include "MeshCache.h"
+#include "Parallel.h"
+#include "Rasterizer.h"
+#include "VertexQuantization.h"
+
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <string_view>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define DAE_SOFTWARE_RENDERER_SSE
+#include <immintrin.h>
+#endif
+
+namespace dae
+{
+	namespace SoftwareRenderer
+	{
+		namespace
+		{
+			//Vertices per vertex shading task
+			constexpr size_t ChunkVertices{ 4096 };
+			constexpr size_t BlocksPerRow{ TileSize / Rasterizer::BlockSize };
+			constexpr size_t BlocksPerTile{ BlocksPerRow * BlocksPerRow };
+
+			//The Vector3 constructors, operators and indexing are not inlined, so the pipeline works on plain floats
+			using Float2 = std::array<float, 2>;
+			using Float3 = std::array<float, 3>;
+			using Float4 = std::array<float, 4>;
+
+			//Constants of PosCol3D.fx
+			constexpr float KD{ 7.f };
+			constexpr float Shininess{ 25.f };
+			constexpr float Ambient{ 0.03f };
+			constexpr Float3 LightDirection{ 0.577f, -0.577f, 0.577f };
+			constexpr float RotationSpeed{ PI_DIV_4 };
+			//samAnisotropic leaves MaxAnisotropy at D3D11_DEFAULT_MAX_ANISOTROPY
+			constexpr uint32_t MaxAnisotropy{ 16 };
+
+			//Renderer::Render clears to this
+			constexpr Float4 ClearColor{ 0.39f, 0.59f, 0.93f, 1.f };
+
+			float Dot(const Float3& a, const Float3& b)
+			{
+				return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+			}
+
+			Float3 Cross(const Float3& a, const Float3& b)
+			{
+				return { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+			}
+
+			Float3 Normalize(const Float3& vector)
+			{
+				const float length = std::sqrt(Dot(vector, vector));
+				if (length <= 0.f)
+					return vector;
+				return { vector[0] / length, vector[1] / length, vector[2] / length };
+			}
+
+			template<typename FloatN>
+			FloatN Lerp(const FloatN& a, const FloatN& b, float t)
+			{
+				FloatN result{};
+				for (size_t i = 0; i < result.size(); ++i)
+					result[i] = a[i] + (b[i] - a[i]) * t;
+				return result;
+			}
+
+			Float4 UnpackColor(uint32_t color)
+			{
+				constexpr float Scale{ 1.f / 255.f };
+				return { static_cast<float>(color & 0xFF) * Scale, static_cast<float>((color >> 8) & 0xFF) * Scale,
+					static_cast<float>((color >> 16) & 0xFF) * Scale, static_cast<float>(color >> 24) * Scale };
+			}
+
+			//Saturated and rounded to nearest like a float written to an UNORM render target
+			uint32_t PackColor(const Float4& color)
+			{
+				uint32_t packed{};
+				for (size_t channel = 0; channel < 4; ++channel)
+					packed |= static_cast<uint32_t>(std::clamp(color[channel], 0.f, 1.f) * 255.f + 0.5f) << (channel * 8);
+				return packed;
+			}
+
+			//TEXTURES
+			//Wrap addressing on both axes, like every sampler in PosCol3D.fx
+			uint32_t Wrap(int coordinate, uint32_t size)
+			{
+				const int wrapped = coordinate % static_cast<int>(size);
+				return static_cast<uint32_t>(wrapped < 0 ? wrapped + static_cast<int>(size) : wrapped);
+			}
+
+			Float4 FetchTexel(const Texture::Mip& mip, int x, int y)
+			{
+				return UnpackColor(mip.texels[Wrap(y, mip.height) * mip.width + Wrap(x, mip.width)]);
+			}
+
+			Float4 SampleNearest(const Texture::Mip& mip, const Float2& uv)
+			{
+				const float u = uv[0] - std::floor(uv[0]);
+				const float v = uv[1] - std::floor(uv[1]);
+				return FetchTexel(mip, static_cast<int>(u * static_cast<float>(mip.width)), static_cast<int>(v * static_cast<float>(mip.height)));
+			}
+
+			Float4 SampleBilinear(const Texture::Mip& mip, const Float2& uv)
+			{
+				//Texel centers are at half texels
+				const float x = (uv[0] - std::floor(uv[0])) * static_cast<float>(mip.width) - 0.5f;
+				const float y = (uv[1] - std::floor(uv[1])) * static_cast<float>(mip.height) - 0.5f;
+				const float left = std::floor(x);
+				const float top = std::floor(y);
+				const int x0 = static_cast<int>(left);
+				const int y0 = static_cast<int>(top);
+
+				const Float4 upper = Lerp(FetchTexel(mip, x0, y0), FetchTexel(mip, x0 + 1, y0), x - left);
+				const Float4 lower = Lerp(FetchTexel(mip, x0, y0 + 1), FetchTexel(mip, x0 + 1, y0 + 1), x - left);
+				return Lerp(upper, lower, y - top);
+			}
+
+			Float4 SampleTrilinear(const Texture& texture, const Float2& uv, float levelOfDetail)
+			{
+				const float maxLevel = static_cast<float>(texture.mips.size() - 1);
+				levelOfDetail = std::clamp(levelOfDetail, 0.f, maxLevel);
+				const size_t level = static_cast<size_t>(levelOfDetail);
+				const float fraction = levelOfDetail - static_cast<float>(level);
+
+				const Float4 color = SampleBilinear(texture.mips[level], uv);
+				if (fraction <= 0.f)
+					return color;
+				return Lerp(color, SampleBilinear(texture.mips[level + 1], uv), fraction);
+			}
+
+			//uvDx and uvDy are the change of the UV to the next pixel right and down, what ddx and ddy give the hardware
+			Float4 Sample(const Texture& texture, Pass filter, const Float2& uv, const Float2& uvDx, const Float2& uvDy)
+			{
+				const Texture::Mip& top = texture.mips.front();
+				const float width = static_cast<float>(top.width);
+				const float height = static_cast<float>(top.height);
+				const float lengthX = std::hypot(uvDx[0] * width, uvDx[1] * height);
+				const float lengthY = std::hypot(uvDy[0] * width, uvDy[1] * height);
+
+				switch (filter)
+				{
+				case Pass::Linear:
+					return SampleTrilinear(texture, uv, std::log2(std::max(lengthX, lengthY)));
+				case Pass::Anisotropic:
+				{
+					//Up to MaxAnisotropy trilinear samples along the long axis of the pixel footprint, each filtered to the width of the short one
+					const float major = std::max(lengthX, lengthY);
+					const float minor = std::min(lengthX, lengthY);
+					const float ratio = minor > 0.f ? major / minor : static_cast<float>(MaxAnisotropy);
+					const uint32_t numSamples = std::clamp(static_cast<uint32_t>(std::ceil(ratio)), 1u, MaxAnisotropy);
+					const Float2& majorAxis = lengthX >= lengthY ? uvDx : uvDy;
+					const float levelOfDetail = std::log2(major / static_cast<float>(numSamples));
+
+					Float4 color{};
+					for (uint32_t sample = 0; sample < numSamples; ++sample)
+					{
+						const float offset = (static_cast<float>(sample) + 0.5f) / static_cast<float>(numSamples) - 0.5f;
+						const Float4 sampleColor = SampleTrilinear(texture, { uv[0] + majorAxis[0] * offset, uv[1] + majorAxis[1] * offset }, levelOfDetail);
+						for (size_t channel = 0; channel < 4; ++channel)
+							color[channel] += sampleColor[channel];
+					}
+					for (float& channel : color)
+						channel /= static_cast<float>(numSamples);
+					return color;
+				}
+				default:
+				{
+					//MIN_MAG_MIP_POINT rounds the level of detail to the nearest mip
+					const float levelOfDetail = std::log2(std::max(lengthX, lengthY));
+					const size_t level = levelOfDetail > 0.f ? std::min(static_cast<size_t>(levelOfDetail + 0.5f), texture.mips.size() - 1) : 0;
+					return SampleNearest(texture.mips[level], uv);
+				}
+				}
+			}
+
+			//PIPELINE
+			//Output of VS and VS_FireFX, in pixels
+			struct ShadedVertex
+			{
+				//Clip space, what clipping interpolates
+				Float4 position{};
+				//Set by Project once w is positive
+				float x{};
+				float y{};
+				//z / w, the depth buffer value
+				float depth{};
+				Float2 uv{};
+				Float3 normal{};
+				Float4 tangent{};
+				Float3 viewDirection{};
+				//Sides of the clip volume and the guard band the position is outside of, set by ShadeVertices. Vertices clipping creates do not need it
+				uint32_t outcode{};
+			};
+
+			struct Plane
+			{
+				float a{};
+				float b{};
+				float c{};
+
+				float At(float x, float y) const { return a * x + b * y + c; }
+			};
+
+			struct TriangleSetup
+			{
+				//Edge i is the doubled area at vertex i
+				Rasterizer::Edges edges{};
+				//Linear in screen space: the depth, 1 / w, and the barycentric weights of the second and third vertex divided by w
+				Plane depth{};
+				Plane inverseW{};
+				Plane weight1{};
+				Plane weight2{};
+				//Largest rounding error of evaluating the depth plane inside the bounds, keeps the hierarchical depth test conservative
+				float depthError{};
+				//Inclusive pixel bounds inside the framebuffer
+				int minX{};
+				int minY{};
+				int maxX{};
+				int maxY{};
+				std::array<const ShadedVertex*, 3> vertices{};
+				const Material* materialPtr{};
+				Pass pass{};
+			};
+
+			//Triangles of one submesh range, set up and binned by one task
+			struct Chunk
+			{
+				const ShadedVertex* verticesPtr{};
+				std::span<const uint32_t> indices{};
+				const Material* materialPtr{};
+				Pass pass{};
+
+				std::vector<TriangleSetup> setups{};
+				//Index into setups of every triangle touching a tile, per tile, in submission order
+				std::vector<std::vector<uint32_t>> bins{};
+				//The part of the clipped vertex arena of Render for this chunk, room for the most vertices its clipped triangles can make
+				std::span<ShadedVertex> clippedVertices{};
+				size_t numClippedVertices{};
+				size_t numTriangles{};
+				size_t numCulledTriangles{};
+				size_t numClippedTriangles{};
+			};
+
+			struct FrameInfo
+			{
+				int width{};
+				int height{};
+				int numTilesX{};
+				int numTilesY{};
+				bool useNormalMap{};
+				bool useHierarchicalDepth{};
+				Rasterizer::Kernel kernel{};
+				//Half the size of the guard band over half the size of the framebuffer, its sides are x = +-guardBandX * w and y = +-guardBandY * w
+				float guardBandX{};
+				float guardBandY{};
+			};
+
+			//Perspective divide and viewport transform, w has to be positive
+			void Project(ShadedVertex& vertex, const FrameInfo& frame)
+			{
+				const float inverseW = 1.f / vertex.position[3];
+				vertex.x = (vertex.position[0] * inverseW * 0.5f + 0.5f) * static_cast<float>(frame.width);
+				vertex.y = (0.5f - vertex.position[1] * inverseW * 0.5f) * static_cast<float>(frame.height);
+				vertex.depth = vertex.position[2] * inverseW;
+			}
+
+			//Outcode bits: the sides of the viewport, x = -w, x = w, y = -w and y = w, the same sides of the guard band, then z = 0 and z = w
+			constexpr uint32_t ViewportOutcodes{ 0xF };
+			constexpr uint32_t GuardBandOutcodes{ 0xF0 };
+			constexpr uint32_t NearOutcode{ 0x100 };
+			constexpr uint32_t FarOutcode{ 0x200 };
+			//A triangle with every vertex outside one of these sides is culled
+			constexpr uint32_t CullOutcodes{ ViewportOutcodes | NearOutcode | FarOutcode };
+			//A triangle with a vertex outside one of these sides is clipped against it. Pixels beyond the far plane are left to the depth clipping
+			//of RasterizeInTile and pixels outside the viewport to the bounds of SetupTriangle
+			constexpr uint32_t ClipOutcodes{ GuardBandOutcodes | NearOutcode };
+
+			uint32_t GetOutcode(const Float4& position, const FrameInfo& frame)
+			{
+				const float x = position[0];
+				const float y = position[1];
+				const float w = position[3];
+				const float guardBandX = frame.guardBandX * w;
+				const float guardBandY = frame.guardBandY * w;
+				return (x < -w ? 0x1u : 0u) | (x > w ? 0x2u : 0u) | (y < -w ? 0x4u : 0u) | (y > w ? 0x8u : 0u)
+					| (x < -guardBandX ? 0x10u : 0u) | (x > guardBandX ? 0x20u : 0u) | (y < -guardBandY ? 0x40u : 0u) | (y > guardBandY ? 0x80u : 0u)
+					| (position[2] < 0.f ? NearOutcode : 0u) | (position[2] > w ? FarOutcode : 0u);
+			}
+
+			//Outcodes of four vertices per iteration with SSE, their positions transposed into a register per coordinate. Gives the same bits as GetOutcode
+			void ComputeOutcodes(std::span<ShadedVertex> vertices, const FrameInfo& frame)
+			{
+				size_t first = 0;
+#ifdef DAE_SOFTWARE_RENDERER_SSE
+				const __m128 guardBandX = _mm_set1_ps(frame.guardBandX);
+				const __m128 guardBandY = _mm_set1_ps(frame.guardBandY);
+				const __m128 zero = _mm_setzero_ps();
+				const auto select = [](__m128 mask, uint32_t bit) { return _mm_and_si128(_mm_castps_si128(mask), _mm_set1_epi32(static_cast<int>(bit))); };
+				for (; first + 4 <= vertices.size(); first += 4)
+				{
+					__m128 x = _mm_loadu_ps(vertices[first].position.data());
+					__m128 y = _mm_loadu_ps(vertices[first + 1].position.data());
+					__m128 z = _mm_loadu_ps(vertices[first + 2].position.data());
+					__m128 w = _mm_loadu_ps(vertices[first + 3].position.data());
+					_MM_TRANSPOSE4_PS(x, y, z, w);
+
+					const __m128 negativeW = _mm_sub_ps(zero, w);
+					const __m128 extentX = _mm_mul_ps(guardBandX, w);
+					const __m128 extentY = _mm_mul_ps(guardBandY, w);
+					__m128i outcodes = _mm_or_si128(select(_mm_cmplt_ps(x, negativeW), 0x1), select(_mm_cmpgt_ps(x, w), 0x2));
+					outcodes = _mm_or_si128(outcodes, _mm_or_si128(select(_mm_cmplt_ps(y, negativeW), 0x4), select(_mm_cmpgt_ps(y, w), 0x8)));
+					outcodes = _mm_or_si128(outcodes, _mm_or_si128(select(_mm_cmplt_ps(x, _mm_sub_ps(zero, extentX)), 0x10), select(_mm_cmpgt_ps(x, extentX), 0x20)));
+					outcodes = _mm_or_si128(outcodes, _mm_or_si128(select(_mm_cmplt_ps(y, _mm_sub_ps(zero, extentY)), 0x40), select(_mm_cmpgt_ps(y, extentY), 0x80)));
+					outcodes = _mm_or_si128(outcodes, _mm_or_si128(select(_mm_cmplt_ps(z, zero), NearOutcode), select(_mm_cmpgt_ps(z, w), FarOutcode)));
+
+					alignas(16) std::array<uint32_t, 4> results{};
+					_mm_store_si128(reinterpret_cast<__m128i*>(results.data()), outcodes);
+					for (size_t vertex = 0; vertex < 4; ++vertex)
+						vertices[first + vertex].outcode = results[vertex];
+				}
+#endif
+				for (; first < vertices.size(); ++first)
+					vertices[first].outcode = GetOutcode(vertices[first].position, frame);
+			}
+
+			void ShadeVertices(std::span<const Vertex> vertices, const View& view, const FrameInfo& frame, bool isFireFX, std::span<ShadedVertex> shadedVertices, uint32_t numThreads)
+			{
+				//RotationMatrix(gRotationSpeed * gTime) of the vertex shader, applied before gWorldViewProj
+				const float yaw = RotationSpeed * view.time;
+				const float cosYaw = std::cos(yaw);
+				const float sinYaw = std::sin(yaw);
+				const auto rotate = [cosYaw, sinYaw](const Vector3& vector) -> Float3
+					{
+						return { cosYaw * vector.x + sinYaw * vector.z, vector.y, cosYaw * vector.z - sinYaw * vector.x };
+					};
+
+				const Matrix viewProjection = view.viewMatrix * view.projectionMatrix;
+				std::array<Float4, 4> rows{};
+				for (int row = 0; row < 4; ++row)
+				{
+					const Vector4 axis = viewProjection[row];
+					rows[row] = { axis.x, axis.y, axis.z, axis.w };
+				}
+				const Float3 cameraPosition{ view.cameraPosition.x, view.cameraPosition.y, view.cameraPosition.z };
+
+				const size_t numChunks = (vertices.size() + ChunkVertices - 1) / ChunkVertices;
+				ParallelFor(numChunks, numThreads, [&](size_t chunk)
+					{
+						const size_t end = std::min(vertices.size(), (chunk + 1) * ChunkVertices);
+						for (size_t index = chunk * ChunkVertices; index < end; ++index)
+						{
+							const Vertex& vertex = vertices[index];
+							ShadedVertex& shaded = shadedVertices[index];
+
+							const Float3 position = rotate(vertex.position);
+							Float4 clip{};
+							for (size_t i = 0; i < 4; ++i)
+								clip[i] = position[0] * rows[0][i] + position[1] * rows[1][i] + position[2] * rows[2][i] + rows[3][i];
+
+							//Vertices at or behind the camera are only ever clipped away, so the position is all they need
+							shaded.position = clip;
+							if (clip[3] > 0.f)
+								Project(shaded, frame);
+
+							shaded.uv = { vertex.uv.x, vertex.uv.y };
+							if (isFireFX)
+								continue;
+
+							shaded.normal = rotate(vertex.normal);
+							const Float3 tangent = rotate(Vector3{ vertex.tangent.x, vertex.tangent.y, vertex.tangent.z });
+							shaded.tangent = { tangent[0], tangent[1], tangent[2], vertex.tangent.w };
+							shaded.viewDirection = Normalize({ cameraPosition[0] - position[0], cameraPosition[1] - position[1], cameraPosition[2] - position[2] });
+						}
+						ComputeOutcodes(shadedVertices.subspan(chunk * ChunkVertices, end - chunk * ChunkVertices), frame);
+					});
+			}
+
+			//False when the triangle covers no pixel center or faces away from the camera in a pass that culls back faces
+			//The vertices have to be in front of the near plane and inside the guard band
+			bool SetupTriangle(const ShadedVertex* v0, const ShadedVertex* v1, const ShadedVertex* v2, const FrameInfo& frame, bool cullBackFaces, TriangleSetup& setup)
+			{
+				//Coverage, culling and the interpolation planes all come from the snapped vertices
+				std::array<int32_t, 3> xs{ Rasterizer::Snap(v0->x), Rasterizer::Snap(v1->x), Rasterizer::Snap(v2->x) };
+				std::array<int32_t, 3> ys{ Rasterizer::Snap(v0->y), Rasterizer::Snap(v1->y), Rasterizer::Snap(v2->y) };
+
+				//Clockwise on screen faces the camera, FrontCounterClockwise is false. Setup keeps the vertices clockwise
+				const int64_t area = static_cast<int64_t>(xs[1] - xs[0]) * (ys[2] - ys[0]) - static_cast<int64_t>(xs[2] - xs[0]) * (ys[1] - ys[0]);
+				if (area == 0 or (area < 0 and cullBackFaces))
+					return false;
+				if (area < 0)
+				{
+					std::swap(v1, v2);
+					std::swap(xs[1], xs[2]);
+					std::swap(ys[1], ys[2]);
+				}
+
+				//First and last pixel whose center is inside the snapped bounds, exact since the subpixels fit in a float
+				const auto firstPixel = [](int32_t subpixel) { return std::ceil((static_cast<float>(subpixel) - 0.5f * Rasterizer::SubpixelScale) / Rasterizer::SubpixelScale); };
+				const auto lastPixel = [](int32_t subpixel) { return std::floor((static_cast<float>(subpixel) - 0.5f * Rasterizer::SubpixelScale) / Rasterizer::SubpixelScale); };
+				const float minX = firstPixel(std::min({ xs[0], xs[1], xs[2] }));
+				const float maxX = lastPixel(std::max({ xs[0], xs[1], xs[2] }));
+				const float minY = firstPixel(std::min({ ys[0], ys[1], ys[2] }));
+				const float maxY = lastPixel(std::max({ ys[0], ys[1], ys[2] }));
+				if (maxX < 0.f or maxY < 0.f or minX >= static_cast<float>(frame.width) or minY >= static_cast<float>(frame.height) or minX > maxX or minY > maxY)
+					return false;
+
+				setup.minX = static_cast<int>(std::max(minX, 0.f));
+				setup.minY = static_cast<int>(std::max(minY, 0.f));
+				setup.maxX = static_cast<int>(std::min(maxX, static_cast<float>(frame.width - 1)));
+				setup.maxY = static_cast<int>(std::min(maxY, static_cast<float>(frame.height - 1)));
+
+				setup.vertices = { v0, v1, v2 };
+				const Rasterizer::Edges& edges = setup.edges;
+				const double inverseArea = 1.0 / static_cast<double>(Rasterizer::SetupEdges(xs, ys, setup.edges));
+				//The edge functions over the doubled area are the barycentric weights, in pixels rather than subpixels
+				const auto makePlane = [&edges, inverseArea](float value0, float value1, float value2)
+					{
+						const double values[3]{ value0, value1, value2 };
+						double a{};
+						double b{};
+						double c{};
+						for (size_t vertex = 0; vertex < 3; ++vertex)
+						{
+							a += static_cast<double>(edges.a[vertex]) * values[vertex];
+							b += static_cast<double>(edges.b[vertex]) * values[vertex];
+							c += static_cast<double>(edges.c[vertex]) * values[vertex];
+						}
+						Plane plane{};
+						plane.a = static_cast<float>(a * Rasterizer::SubpixelScale * inverseArea);
+						plane.b = static_cast<float>(b * Rasterizer::SubpixelScale * inverseArea);
+						plane.c = static_cast<float>(c * inverseArea);
+						return plane;
+					};
+				const float inverseW0 = 1.f / v0->position[3];
+				const float inverseW1 = 1.f / v1->position[3];
+				const float inverseW2 = 1.f / v2->position[3];
+				setup.depth = makePlane(v0->depth, v1->depth, v2->depth);
+				setup.inverseW = makePlane(inverseW0, inverseW1, inverseW2);
+				setup.weight1 = makePlane(0.f, inverseW1, 0.f);
+				setup.weight2 = makePlane(0.f, 0.f, inverseW2);
+
+				const float planeMagnitude = std::abs(setup.depth.a) * static_cast<float>(setup.maxX + 1) + std::abs(setup.depth.b) * static_cast<float>(setup.maxY + 1)
+					+ std::abs(setup.depth.c);
+				setup.depthError = 8.f * FLT_EPSILON * planeMagnitude;
+				return true;
+			}
+
+			//Clip space attributes are linear along an edge, Project is left to the caller
+			ShadedVertex Lerp(const ShadedVertex& from, const ShadedVertex& to, float t)
+			{
+				ShadedVertex vertex{};
+				vertex.position = Lerp(from.position, to.position, t);
+				vertex.uv = Lerp(from.uv, to.uv, t);
+				vertex.normal = Lerp(from.normal, to.normal, t);
+				vertex.tangent = Lerp(from.tangent, to.tangent, t);
+				vertex.viewDirection = Lerp(from.viewDirection, to.viewDirection, t);
+				return vertex;
+			}
+
+			//A triangle gains at most one vertex per plane it is clipped against, the near plane and the sides of the guard band
+			constexpr size_t MaxClippedVertices{ 3 + 5 };
+
+			//Sutherland-Hodgman in clip space against the planes of outcode, the near plane first so that w is positive for the guard band
+			//A polygon inside a plane stays inside it, so the planes the vertices of the triangle are outside of are all that need clipping
+			//Returns the number of polygon vertices, 0 when nothing is left
+			size_t ClipTriangle(const std::array<const ShadedVertex*, 3>& triangle, uint32_t outcode, const FrameInfo& frame,
+				std::array<ShadedVertex, MaxClippedVertices>& polygon)
+			{
+				//Positive inside the plane, in the order of the outcode bits
+				const auto getDistance = [&frame](const ShadedVertex& vertex, uint32_t plane)
+					{
+						const Float4& position = vertex.position;
+						if (plane == NearOutcode)
+							return position[2];
+						const int side = std::countr_zero(plane) - std::countr_zero(GuardBandOutcodes);
+						const float extent = side < 2 ? frame.guardBandX * position[3] : frame.guardBandY * position[3];
+						const float coordinate = side < 2 ? position[0] : position[1];
+						return side % 2 == 0 ? extent + coordinate : extent - coordinate;
+					};
+
+				size_t numVertices = 3;
+				for (size_t vertex = 0; vertex < 3; ++vertex)
+					polygon[vertex] = *triangle[vertex];
+
+				std::array<ShadedVertex, MaxClippedVertices> input{};
+				const std::array<uint32_t, 5> planes{ NearOutcode, 0x10, 0x20, 0x40, 0x80 };
+				for (const uint32_t plane : planes)
+				{
+					if ((outcode & plane) == 0)
+						continue;
+
+					std::copy_n(polygon.begin(), numVertices, input.begin());
+					size_t numOutput = 0;
+					for (size_t vertex = 0; vertex < numVertices; ++vertex)
+					{
+						const ShadedVertex& current = input[vertex];
+						const ShadedVertex& next = input[(vertex + 1) % numVertices];
+						const float currentDistance = getDistance(current, plane);
+						const float nextDistance = getDistance(next, plane);
+						if (currentDistance >= 0.f)
+							polygon[numOutput++] = current;
+
+						//Always from the inside vertex, so triangles sharing the edge get the same new vertex
+						if (currentDistance >= 0.f and nextDistance < 0.f)
+							polygon[numOutput++] = Lerp(current, next, currentDistance / (currentDistance - nextDistance));
+						else if (currentDistance < 0.f and nextDistance >= 0.f)
+							polygon[numOutput++] = Lerp(next, current, nextDistance / (nextDistance - currentDistance));
+					}
+
+					numVertices = numOutput;
+					if (numVertices < 3)
+						return 0;
+				}
+				return numVertices;
+			}
+
+			//Triangles with every vertex outside one of CullOutcodes
+			constexpr uint32_t CulledOutcode{ ~0u };
+
+			//The ClipOutcodes planes a triangle crosses from the outcodes of its vertices, 0 when it needs no clipping
+			uint32_t GetTriangleOutcode(const Chunk& chunk, size_t triangle)
+			{
+				const uint32_t outcode0 = chunk.verticesPtr[chunk.indices[triangle * 3]].outcode;
+				const uint32_t outcode1 = chunk.verticesPtr[chunk.indices[triangle * 3 + 1]].outcode;
+				const uint32_t outcode2 = chunk.verticesPtr[chunk.indices[triangle * 3 + 2]].outcode;
+				if ((outcode0 & outcode1 & outcode2 & CullOutcodes) != 0)
+					return CulledOutcode;
+				return (outcode0 | outcode1 | outcode2) & ClipOutcodes;
+			}
+
+			//Counts the triangles to clip before any chunk is set up, so Render can size the clipped vertex arena once for the frame
+			void ClassifyChunk(Chunk& chunk)
+			{
+				chunk.numTriangles = chunk.indices.size() / 3;
+				for (size_t triangle = 0; triangle < chunk.numTriangles; ++triangle)
+				{
+					const uint32_t outcode = GetTriangleOutcode(chunk, triangle);
+					chunk.numCulledTriangles += outcode == CulledOutcode;
+					chunk.numClippedTriangles += outcode != CulledOutcode and outcode != 0;
+				}
+			}
+
+			void SetupChunk(Chunk& chunk, const FrameInfo& frame)
+			{
+				chunk.bins.resize(static_cast<size_t>(frame.numTilesX) * frame.numTilesY);
+				chunk.setups.reserve(chunk.numTriangles);
+
+				const bool cullBackFaces = chunk.pass != Pass::FireFX;
+				const auto addTriangle = [&chunk, &frame, cullBackFaces](const ShadedVertex* v0, const ShadedVertex* v1, const ShadedVertex* v2)
+					{
+						TriangleSetup setup{};
+						if (!SetupTriangle(v0, v1, v2, frame, cullBackFaces, setup))
+							return;
+						setup.materialPtr = chunk.materialPtr;
+						setup.pass = chunk.pass;
+
+						const uint32_t setupIndex = static_cast<uint32_t>(chunk.setups.size());
+						chunk.setups.push_back(setup);
+						for (int tileY = setup.minY / static_cast<int>(TileSize); tileY <= setup.maxY / static_cast<int>(TileSize); ++tileY)
+						{
+							for (int tileX = setup.minX / static_cast<int>(TileSize); tileX <= setup.maxX / static_cast<int>(TileSize); ++tileX)
+								chunk.bins[tileY * frame.numTilesX + tileX].push_back(setupIndex);
+						}
+					};
+
+				for (size_t triangle = 0; triangle < chunk.numTriangles; ++triangle)
+				{
+					const uint32_t outcode = GetTriangleOutcode(chunk, triangle);
+					if (outcode == CulledOutcode)
+						continue;
+
+					const std::array<const ShadedVertex*, 3> vertices{ chunk.verticesPtr + chunk.indices[triangle * 3], chunk.verticesPtr + chunk.indices[triangle * 3 + 1],
+						chunk.verticesPtr + chunk.indices[triangle * 3 + 2] };
+					//In front of the camera and inside the guard band the snapped edge functions cannot overflow and the bounds clamping does the work of clipping
+					if (outcode == 0)
+					{
+						addTriangle(vertices[0], vertices[1], vertices[2]);
+						continue;
+					}
+
+					std::array<ShadedVertex, MaxClippedVertices> polygon{};
+					const size_t numVertices = ClipTriangle(vertices, outcode, frame, polygon);
+					ShadedVertex* polygonPtr = chunk.clippedVertices.data() + chunk.numClippedVertices;
+					for (size_t vertex = 0; vertex < numVertices; ++vertex)
+					{
+						Project(polygon[vertex], frame);
+						polygonPtr[vertex] = polygon[vertex];
+					}
+					chunk.numClippedVertices += numVertices;
+
+					//A fan keeps the winding of the triangle
+					for (size_t vertex = 1; vertex + 1 < numVertices; ++vertex)
+						addTriangle(polygonPtr, polygonPtr + vertex, polygonPtr + vertex + 1);
+				}
+			}
+
+			//Perspective correct weights of the second and third vertex at a pixel center
+			Float2 GetWeights(const TriangleSetup& setup, float x, float y)
+			{
+				const float w = 1.f / setup.inverseW.At(x, y);
+				return { setup.weight1.At(x, y) * w, setup.weight2.At(x, y) * w };
+			}
+
+			template<typename FloatN>
+			FloatN Interpolate(const FloatN& value0, const FloatN& value1, const FloatN& value2, const Float2& weights)
+			{
+				FloatN result{};
+				for (size_t i = 0; i < result.size(); ++i)
+					result[i] = value0[i] + (value1[i] - value0[i]) * weights[0] + (value2[i] - value0[i]) * weights[1];
+				return result;
+			}
+
+			//UV at the pixel center and its change to the pixels right and below, the hardware takes the differences over 2x2 quads
+			void InterpolateUV(const TriangleSetup& setup, float x, float y, Float2& uv, Float2& uvDx, Float2& uvDy)
+			{
+				const Float2& uv0 = setup.vertices[0]->uv;
+				const Float2& uv1 = setup.vertices[1]->uv;
+				const Float2& uv2 = setup.vertices[2]->uv;
+				uv = Interpolate(uv0, uv1, uv2, GetWeights(setup, x, y));
+				const Float2 uvRight = Interpolate(uv0, uv1, uv2, GetWeights(setup, x + 1.f, y));
+				const Float2 uvBelow = Interpolate(uv0, uv1, uv2, GetWeights(setup, x, y + 1.f));
+				uvDx = { uvRight[0] - uv[0], uvRight[1] - uv[1] };
+				uvDy = { uvBelow[0] - uv[0], uvBelow[1] - uv[1] };
+			}
+
+			//PixelShading of PosCol3D.fx
+			Float4 ShadePhong(const TriangleSetup& setup, float x, float y, bool useNormalMap)
+			{
+				Float2 uv{};
+				Float2 uvDx{};
+				Float2 uvDy{};
+				InterpolateUV(setup, x, y, uv, uvDx, uvDy);
+
+				const Material& material = *setup.materialPtr;
+				const Float4 diffuseColor = Sample(*material.diffuseMapPtr, setup.pass, uv, uvDx, uvDy);
+				const Float4 normalColor = Sample(*material.normalMapPtr, setup.pass, uv, uvDx, uvDy);
+				const Float4 specularColor = Sample(*material.specularMapPtr, setup.pass, uv, uvDx, uvDy);
+				const float gloss = Sample(*material.glossinessMapPtr, setup.pass, uv, uvDx, uvDy)[0];
+
+				const Float2 weights = GetWeights(setup, x, y);
+				const ShadedVertex& v0 = *setup.vertices[0];
+				const ShadedVertex& v1 = *setup.vertices[1];
+				const ShadedVertex& v2 = *setup.vertices[2];
+				Float3 normal = Interpolate(v0.normal, v1.normal, v2.normal, weights);
+				const Float4 tangent = Interpolate(v0.tangent, v1.tangent, v2.tangent, weights);
+				const Float3 viewDirection = Interpolate(v0.viewDirection, v1.viewDirection, v2.viewDirection, weights);
+
+				if (useNormalMap)
+				{
+					const Float3 tangentAxis{ tangent[0], tangent[1], tangent[2] };
+					const Float3 binormal = Cross(normal, tangentAxis);
+					Float3 mapped{};
+					for (size_t i = 0; i < 3; ++i)
+					{
+						const float tangentSpace[3]{ tangentAxis[i], binormal[i] * tangent[3], normal[i] };
+						mapped[i] = 0.f;
+						for (size_t axis = 0; axis < 3; ++axis)
+							mapped[i] += (2.f * normalColor[axis] - 1.f) * tangentSpace[axis];
+					}
+					normal = mapped;
+				}
+
+				const Float3 toLight{ -LightDirection[0], -LightDirection[1], -LightDirection[2] };
+				const float observedArea = Dot(normal, toLight);
+				if (observedArea < 0.f)
+					return { 0.f, 0.f, 0.f, 1.f };
+
+				//reflect(-gLightDirection, normal)
+				const float projection = 2.f * Dot(toLight, normal);
+				const Float3 reflectedLight{ toLight[0] - projection * normal[0], toLight[1] - projection * normal[1], toLight[2] - projection * normal[2] };
+				const float cosAlpha = std::clamp(-Dot(reflectedLight, viewDirection), 0.f, 1.f);
+				const float specular = std::pow(cosAlpha, gloss * Shininess);
+
+				Float4 color{ 0.f, 0.f, 0.f, 1.f };
+				for (size_t channel = 0; channel < 3; ++channel)
+					color[channel] = (diffuseColor[channel] * KD / PI + specularColor[channel] * specular + Ambient) * observedArea;
+				return color;
+			}
+
+			//Everything one tile task touches, colors point into the framebuffer
+			struct Tile
+			{
+				int minX{};
+				int minY{};
+				int maxX{};
+				int maxY{};
+				uint32_t* colorsPtr{};
+				int pitch{};
+
+				//Tile local, TileSize pixels per row. Pixels outside the framebuffer hold 0 so they never raise the farthest depth of their block
+				std::vector<float> depths{};
+				//Front opaque triangle of pixels that are not shaded yet
+				std::vector<const TriangleSetup*> visible{};
+
+				//Farthest depth of every 8x8 block and of the whole tile, the hierarchical depth test rejects what lies behind them
+				std::array<float, BlocksPerTile> blockMaxDepths{};
+				float maxDepth{};
+				//Pixels of every block at its farthest depth, the farthest depth only gets nearer once the last of them is written
+				std::array<uint8_t, BlocksPerTile> numBlockMaxPixels{};
+				Statistics statistics{};
+
+				//CoverBlocks output of the triangle being rasterized
+				std::array<Rasterizer::Block, BlocksPerTile> blocks{};
+			};
+
+			void UpdateBlockMaxDepth(Tile& tile, size_t blockIndex)
+			{
+				const float* depthsPtr = tile.depths.data() + blockIndex / BlocksPerRow * Rasterizer::BlockSize * TileSize + blockIndex % BlocksPerRow * Rasterizer::BlockSize;
+				float maxDepth = 0.f;
+				uint8_t numMaxPixels = 0;
+				for (int row = 0; row < Rasterizer::BlockSize; ++row)
+				{
+					for (int column = 0; column < Rasterizer::BlockSize; ++column)
+					{
+						const float depth = depthsPtr[row * TileSize + column];
+						if (depth > maxDepth)
+						{
+							maxDepth = depth;
+							numMaxPixels = 0;
+						}
+						numMaxPixels += depth == maxDepth;
+					}
+				}
+				tile.blockMaxDepths[blockIndex] = maxDepth;
+				tile.numBlockMaxPixels[blockIndex] = numMaxPixels;
+			}
+
+			//Calls pixel(x, y, localIndex, depth) for every pixel center of the tile inside the triangle and inside the depth range, pixel returns whether it
+			//wrote the depth. With the hierarchical depth test the triangle is skipped when it is behind the whole tile, and its blocks when they are behind it
+			template<typename PixelFunction>
+			void RasterizeInTile(const TriangleSetup& setup, Tile& tile, const FrameInfo& frame, const PixelFunction& pixel)
+			{
+				const int minX = std::max(setup.minX, tile.minX);
+				const int minY = std::max(setup.minY, tile.minY);
+				const int maxX = std::min(setup.maxX, tile.maxX);
+				const int maxY = std::min(setup.maxY, tile.maxY);
+
+				++tile.statistics.numTileTriangles;
+				Rasterizer::DepthBounds depthBounds{};
+				if (frame.useHierarchicalDepth)
+				{
+					//Bounded with the plane rather than the vertex depths, the plane of a thin triangle can leave the range of its vertices
+					const float nearestX = static_cast<float>(setup.depth.a < 0.f ? maxX : minX) + 0.5f;
+					const float nearestY = static_cast<float>(setup.depth.b < 0.f ? maxY : minY) + 0.5f;
+					if (setup.depth.At(nearestX, nearestY) - setup.depthError >= tile.maxDepth)
+					{
+						++tile.statistics.numRejectedTriangles;
+						return;
+					}
+
+					depthBounds.a = setup.depth.a;
+					depthBounds.b = setup.depth.b;
+					depthBounds.c = setup.depth.c - setup.depthError;
+					depthBounds.blockMaxDepthsPtr = tile.blockMaxDepths.data();
+					depthBounds.originX = tile.minX;
+					depthBounds.originY = tile.minY;
+					depthBounds.blocksPerRow = static_cast<int>(BlocksPerRow);
+				}
+
+				const size_t numBlocks = Rasterizer::CoverBlocks(setup.edges, minX, minY, maxX, maxY, tile.blocks, frame.kernel,
+					frame.useHierarchicalDepth ? &depthBounds : nullptr);
+				tile.statistics.numBlocks += depthBounds.numTested;
+				tile.statistics.numRejectedBlocks += depthBounds.numRejected;
+
+				bool hasNewMaxDepth = false;
+				for (size_t block = 0; block < numBlocks; ++block)
+				{
+					const Rasterizer::Block& currentBlock = tile.blocks[block];
+					const size_t blockIndex = (currentBlock.y - tile.minY) / Rasterizer::BlockSize * BlocksPerRow + (currentBlock.x - tile.minX) / Rasterizer::BlockSize;
+					const float blockMaxDepth = tile.blockMaxDepths[blockIndex];
+					int numMaxPixels = tile.numBlockMaxPixels[blockIndex];
+					for (uint64_t coverage = currentBlock.coverage; coverage != 0; coverage &= coverage - 1)
+					{
+						const int bit = std::countr_zero(coverage);
+						const int x = currentBlock.x + bit % Rasterizer::BlockSize;
+						const int y = currentBlock.y + bit / Rasterizer::BlockSize;
+						const float depth = setup.depth.At(static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f);
+						//Depth clipping
+						if (depth < 0.f or depth > 1.f)
+							continue;
+
+						const int localIndex = (y - tile.minY) * static_cast<int>(TileSize) + x - tile.minX;
+						const float previousDepth = tile.depths[localIndex];
+						if (pixel(x, y, localIndex, depth) and previousDepth == blockMaxDepth)
+							--numMaxPixels;
+					}
+
+					if (!frame.useHierarchicalDepth)
+						continue;
+					if (numMaxPixels > 0)
+					{
+						tile.numBlockMaxPixels[blockIndex] = static_cast<uint8_t>(numMaxPixels);
+						continue;
+					}
+					UpdateBlockMaxDepth(tile, blockIndex);
+					hasNewMaxDepth = hasNewMaxDepth or blockMaxDepth == tile.maxDepth;
+				}
+
+				if (hasNewMaxDepth)
+					tile.maxDepth = *std::max_element(tile.blockMaxDepths.begin(), tile.blockMaxDepths.end());
+			}
+
+			void ShadeVisible(Tile& tile, const FrameInfo& frame)
+			{
+				for (int y = tile.minY; y <= tile.maxY; ++y)
+				{
+					for (int x = tile.minX; x <= tile.maxX; ++x)
+					{
+						const TriangleSetup*& setupPtr = tile.visible[(y - tile.minY) * TileSize + (x - tile.minX)];
+						if (!setupPtr)
+							continue;
+
+						tile.colorsPtr[y * tile.pitch + x] = PackColor(ShadePhong(*setupPtr, static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f, frame.useNormalMap));
+						setupPtr = nullptr;
+					}
+				}
+			}
+
+			void RenderTile(size_t tileIndex, std::span<const Chunk> chunks, const FrameInfo& frame, Framebuffer& framebuffer, Statistics& statistics)
+			{
+				Tile tile{};
+				tile.minX = static_cast<int>(tileIndex % frame.numTilesX) * static_cast<int>(TileSize);
+				tile.minY = static_cast<int>(tileIndex / frame.numTilesX) * static_cast<int>(TileSize);
+				tile.maxX = std::min(tile.minX + static_cast<int>(TileSize), frame.width) - 1;
+				tile.maxY = std::min(tile.minY + static_cast<int>(TileSize), frame.height) - 1;
+				tile.colorsPtr = framebuffer.colors.data();
+				tile.pitch = frame.width;
+				tile.depths.assign(TileSize * TileSize, 0.f);
+				for (int y = tile.minY; y <= tile.maxY; ++y)
+				{
+					float* rowPtr = tile.depths.data() + (y - tile.minY) * TileSize;
+					std::fill(rowPtr, rowPtr + (tile.maxX - tile.minX + 1), 1.f);
+				}
+				for (size_t block = 0; block < BlocksPerTile; ++block)
+					UpdateBlockMaxDepth(tile, block);
+				tile.maxDepth = 1.f;
+				tile.visible.assign(TileSize * TileSize, nullptr);
+
+				//Opaque triangles are shaded once the tile is done, or before a blended triangle needs the colors below it
+				bool hasUnshadedPixels = false;
+				for (const Chunk& chunk : chunks)
+				{
+					for (const uint32_t setupIndex : chunk.bins[tileIndex])
+					{
+						const TriangleSetup& setup = chunk.setups[setupIndex];
+						if (setup.pass != Pass::FireFX)
+						{
+							RasterizeInTile(setup, tile, frame, [&tile, &setup](int, int, int localIndex, float depth)
+								{
+									if (depth >= tile.depths[localIndex])
+										return false;
+									tile.depths[localIndex] = depth;
+									tile.visible[localIndex] = &setup;
+									return true;
+								});
+							hasUnshadedPixels = true;
+							continue;
+						}
+
+						if (hasUnshadedPixels)
+						{
+							ShadeVisible(tile, frame);
+							hasUnshadedPixels = false;
+						}
+
+						//PS_FireFX with gBlendState, the depth is tested but not written
+						RasterizeInTile(setup, tile, frame, [&tile, &setup](int x, int y, int localIndex, float depth)
+							{
+								if (depth >= tile.depths[localIndex])
+									return false;
+
+								Float2 uv{};
+								Float2 uvDx{};
+								Float2 uvDy{};
+								InterpolateUV(setup, static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f, uv, uvDx, uvDy);
+								const Float4 source = Sample(*setup.materialPtr->diffuseMapPtr, Pass::Point, uv, uvDx, uvDy);
+
+								uint32_t& destinationColor = tile.colorsPtr[y * tile.pitch + x];
+								const Float4 destination = UnpackColor(destinationColor);
+								Float4 blended{};
+								for (size_t channel = 0; channel < 3; ++channel)
+									blended[channel] = source[channel] * source[3] + destination[channel] * (1.f - source[3]);
+								//SrcBlendAlpha and DestBlendAlpha are both zero
+								blended[3] = 0.f;
+								destinationColor = PackColor(blended);
+								return false;
+							});
+					}
+				}
+
+				if (hasUnshadedPixels)
+					ShadeVisible(tile, frame);
+				statistics = tile.statistics;
+			}
+
+			//True when all of text is a number, std::stoi and the like throw on anything else
+			template<typename T, typename... Base>
+			bool ParseNumber(std::string_view text, T& value, Base... base)
+			{
+				const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value, base...);
+				return ec == std::errc{} and ptr == text.data() + text.size();
+			}
+		}
+
+		std::unique_ptr<Texture> LoadTexture(const std::string& ddsPath)
+		{
+			auto texturePtr = std::make_unique<Texture>();
+			texturePtr->ddsFilePtr = DDSFile::Open(ddsPath);
+			if (!texturePtr->ddsFilePtr)
+				return nullptr;
+
+			//The cooker writes the rows of every mip tightly packed
+			for (uint32_t level = 0; level < texturePtr->ddsFilePtr->GetNumMips(); ++level)
+			{
+				const DDSFile::Mip& mip = texturePtr->ddsFilePtr->GetMip(level);
+				texturePtr->mips.push_back({ reinterpret_cast<const uint32_t*>(mip.data.data()), mip.width, mip.height });
+			}
+			return texturePtr;
+		}
+
+		std::unique_ptr<Texture> CreateSolidColor(const ColorRGB& color, float alpha)
+		{
+			auto texturePtr = std::make_unique<Texture>();
+			texturePtr->ownedTexels.push_back(PackColor({ color.r, color.g, color.b, alpha }));
+			texturePtr->mips.push_back({ texturePtr->ownedTexels.data(), 1, 1 });
+			return texturePtr;
+		}
+
+		void Render(std::span<const DrawCall> drawCalls, const View& view, Framebuffer& framebuffer, uint32_t numThreads, bool useHierarchicalDepth,
+			Statistics* statisticsPtr)
+		{
+			FrameInfo frame{};
+			frame.width = static_cast<int>(framebuffer.width);
+			frame.height = static_cast<int>(framebuffer.height);
+			frame.numTilesX = static_cast<int>((framebuffer.width + TileSize - 1) / TileSize);
+			frame.numTilesY = static_cast<int>((framebuffer.height + TileSize - 1) / TileSize);
+			frame.useNormalMap = view.useNormalMap;
+			frame.useHierarchicalDepth = useHierarchicalDepth;
+			frame.kernel = Rasterizer::GetBestKernel();
+			//A pixel short of MaxExtent, so snapping the vertices clipping puts on its sides cannot leave it
+			frame.guardBandX = static_cast<float>(Rasterizer::MaxExtent - 2) / static_cast<float>(frame.width);
+			frame.guardBandY = static_cast<float>(Rasterizer::MaxExtent - 2) / static_cast<float>(frame.height);
+			framebuffer.colors.assign(static_cast<size_t>(framebuffer.width) * framebuffer.height, PackColor(ClearColor));
+
+			std::vector<std::vector<ShadedVertex>> shadedVertices(drawCalls.size());
+			std::vector<Chunk> chunks{};
+			for (size_t drawIndex = 0; drawIndex < drawCalls.size(); ++drawIndex)
+			{
+				const DrawCall& drawCall = drawCalls[drawIndex];
+				shadedVertices[drawIndex].resize(drawCall.vertices.size());
+				ShadeVertices(drawCall.vertices, view, frame, drawCall.pass == Pass::FireFX, shadedVertices[drawIndex], numThreads);
+
+				for (const Submesh& submesh : drawCall.submeshes)
+				{
+					const std::span<const uint32_t> indices = drawCall.indices.subspan(submesh.firstIndex, submesh.numIndices);
+					for (size_t first = 0; first < indices.size(); first += ChunkTriangles * 3)
+					{
+						Chunk chunk{};
+						chunk.verticesPtr = shadedVertices[drawIndex].data();
+						chunk.indices = indices.subspan(first, std::min<size_t>(ChunkTriangles * 3, indices.size() - first));
+						chunk.materialPtr = &submesh.material;
+						chunk.pass = drawCall.pass;
+						chunks.push_back(std::move(chunk));
+					}
+				}
+			}
+
+			ParallelFor(chunks.size(), numThreads, [&](size_t chunk) { ClassifyChunk(chunks[chunk]); });
+
+			//Kept by the thread that calls Render, so later frames reuse its memory and only a frame that clips more than any before it grows it
+			//The worker threads of ParallelFor end with it, while the setups point into the arena until the tiles are rendered
+			thread_local std::vector<ShadedVertex> clippedVertices{};
+			size_t numClippedVertices = 0;
+			for (const Chunk& chunk : chunks)
+				numClippedVertices += chunk.numClippedTriangles * MaxClippedVertices;
+			if (clippedVertices.size() < numClippedVertices)
+				clippedVertices.resize(numClippedVertices);
+			size_t firstClippedVertex = 0;
+			for (Chunk& chunk : chunks)
+			{
+				chunk.clippedVertices = std::span<ShadedVertex>{ clippedVertices }.subspan(firstClippedVertex, chunk.numClippedTriangles * MaxClippedVertices);
+				firstClippedVertex += chunk.clippedVertices.size();
+			}
+
+			ParallelFor(chunks.size(), numThreads, [&](size_t chunk) { SetupChunk(chunks[chunk], frame); });
+
+			const size_t numTiles = static_cast<size_t>(frame.numTilesX) * frame.numTilesY;
+			std::vector<Statistics> tileStatistics(numTiles);
+			ParallelFor(numTiles, numThreads, [&](size_t tile) { RenderTile(tile, chunks, frame, framebuffer, tileStatistics[tile]); });
+
+			if (!statisticsPtr)
+				return;
+			*statisticsPtr = {};
+			for (const Chunk& chunk : chunks)
+			{
+				statisticsPtr->numTriangles += chunk.numTriangles;
+				statisticsPtr->numCulledTriangles += chunk.numCulledTriangles;
+				statisticsPtr->numClippedTriangles += chunk.numClippedTriangles;
+				statisticsPtr->numClippedVertices += chunk.numClippedVertices;
+			}
+			for (const Statistics& statistics : tileStatistics)
+			{
+				statisticsPtr->numTileTriangles += statistics.numTileTriangles;
+				statisticsPtr->numRejectedTriangles += statistics.numRejectedTriangles;
+				statisticsPtr->numBlocks += statistics.numBlocks;
+				statisticsPtr->numRejectedBlocks += statistics.numRejectedBlocks;
+			}
+		}
+
+		bool WriteImage(const std::string& path, const Framebuffer& framebuffer)
+		{
+			std::ofstream file{ path, std::ios::binary };
+			if (!file)
+			{
+				std::cout << "SoftwareRenderer::WriteImage() failed to create " << path << '\n';
+				return false;
+			}
+
+			file << "P6\n" << framebuffer.width << ' ' << framebuffer.height << "\n255\n";
+			std::vector<char> row(framebuffer.width * 3);
+			for (uint32_t y = 0; y < framebuffer.height; ++y)
+			{
+				for (uint32_t x = 0; x < framebuffer.width; ++x)
+				{
+					const uint32_t color = framebuffer.colors[y * framebuffer.width + x];
+					for (uint32_t channel = 0; channel < 3; ++channel)
+						row[x * 3 + channel] = static_cast<char>((color >> (channel * 8)) & 0xFF);
+				}
+				file.write(row.data(), static_cast<std::streamsize>(row.size()));
+			}
+			return static_cast<bool>(file);
+		}
+
+		bool ReadImage(const std::string& path, Framebuffer& framebuffer)
+		{
+			std::ifstream file{ path, std::ios::binary };
+			std::string magic{};
+			uint32_t maxValue{};
+			file >> magic >> framebuffer.width >> framebuffer.height >> maxValue;
+			if (!file or magic != "P6" or maxValue != 255)
+			{
+				std::cout << "SoftwareRenderer::ReadImage() " << path << " is not a binary 8 bit PPM\n";
+				return false;
+			}
+			file.get();
+
+			std::vector<unsigned char> pixels(static_cast<size_t>(framebuffer.width) * framebuffer.height * 3);
+			file.read(reinterpret_cast<char*>(pixels.data()), static_cast<std::streamsize>(pixels.size()));
+			if (!file)
+			{
+				std::cout << "SoftwareRenderer::ReadImage() " << path << " is truncated\n";
+				return false;
+			}
+
+			framebuffer.colors.resize(pixels.size() / 3);
+			for (size_t pixel = 0; pixel < framebuffer.colors.size(); ++pixel)
+				framebuffer.colors[pixel] = pixels[pixel * 3] | (pixels[pixel * 3 + 1] << 8) | (pixels[pixel * 3 + 2] << 16) | 0xFF000000u;
+			return true;
+		}
+
+		uint64_t HashImage(const Framebuffer& framebuffer)
+		{
+			uint64_t hash = 14695981039346656037ull;
+			const auto add = [&hash](uint32_t value)
+				{
+					for (uint32_t byte = 0; byte < 4; ++byte)
+						hash = (hash ^ ((value >> (byte * 8)) & 0xFF)) * 1099511628211ull;
+				};
+			add(framebuffer.width);
+			add(framebuffer.height);
+			for (const uint32_t color : framebuffer.colors)
+				add(color);
+			return hash;
+		}
+
+		ImageDifference CompareImages(const Framebuffer& image, const Framebuffer& reference, uint32_t tolerance)
+		{
+			ImageDifference difference{};
+			uint64_t totalDifference{};
+			for (size_t pixel = 0; pixel < image.colors.size(); ++pixel)
+			{
+				uint32_t pixelDifference{};
+				for (uint32_t channel = 0; channel < 3; ++channel)
+				{
+					const int value = (image.colors[pixel] >> (channel * 8)) & 0xFF;
+					const int referenceValue = (reference.colors[pixel] >> (channel * 8)) & 0xFF;
+					const uint32_t channelDifference = static_cast<uint32_t>(std::abs(value - referenceValue));
+					pixelDifference = std::max(pixelDifference, channelDifference);
+					totalDifference += channelDifference;
+				}
+
+				difference.maxDifference = std::max(difference.maxDifference, pixelDifference);
+				if (pixelDifference > tolerance)
+					++difference.numDifferentPixels;
+			}
+			difference.averageDifference = image.colors.empty() ? 0.0 : static_cast<double>(totalDifference) / (image.colors.size() * 3.0);
+			return difference;
+		}
+
+		bool ParseHeadlessOptions(std::span<char* const> arguments, HeadlessOptions& options)
+		{
+			for (size_t arg = 0; arg < arguments.size(); ++arg)
+			{
+				const std::string_view option{ arguments[arg] };
+				const bool hasValue = arg + 1 < arguments.size();
+				bool isValid{ true };
+				int pass{};
+				if (option == "--time" and hasValue)
+					isValid = ParseNumber(arguments[++arg], options.time);
+				else if (option == "--pass" and hasValue)
+				{
+					isValid = ParseNumber(arguments[++arg], pass);
+					options.pass = static_cast<Pass>(std::clamp(pass, 0, 2));
+				}
+				else if (option == "--threads" and hasValue)
+					isValid = ParseNumber(arguments[++arg], options.numThreads);
+				else if (option == "--reference" and hasValue)
+					options.referencePath = arguments[++arg];
+				else if (option == "--hash" and hasValue)
+					isValid = ParseNumber(arguments[++arg], options.expectedHash, 16);
+				else if (option == "--cooked" and hasValue)
+					options.cookedFolder = arguments[++arg];
+				else if (option == "--no-normal-map")
+					options.useNormalMap = false;
+				else if (option == "--no-firefx")
+					options.useFireFX = false;
+				else if (option == "--no-hierarchical-depth")
+					options.useHierarchicalDepth = false;
+				else
+				{
+					std::cout << "Unknown headless option " << option << "\nHeadless arguments: " << HeadlessArguments << '\n';
+					return false;
+				}
+
+				if (!isValid)
+				{
+					std::cout << option << " needs a number, not " << arguments[arg] << "\nHeadless arguments: " << HeadlessArguments << '\n';
+					return false;
+				}
+			}
+			return true;
+		}
+
+		bool RenderHeadless(const HeadlessOptions& options)
+		{
+			const auto loadStart = std::chrono::steady_clock::now();
+
+			struct Model
+			{
+				std::unique_ptr<MeshCache> meshCachePtr{};
+				std::vector<Vertex> unpackedVertices{};
+				std::vector<Utils::MTLMaterial> materials{};
+			};
+
+			const auto loadModel = [&options](const std::string& name, Model& model)
+				{
+					const std::filesystem::path meshPath = std::filesystem::path{ options.cookedFolder } / name;
+					model.meshCachePtr = MeshCache::Open(meshPath.generic_string());
+					if (!model.meshCachePtr)
+					{
+						std::cout << "SoftwareRenderer: " << meshPath.generic_string() << " is missing, run AssetCooker on the Resources folder\n";
+						return false;
+					}
+
+					for (const std::string& library : model.meshCachePtr->GetMaterialData().libraries)
+						Utils::ParseMTL((meshPath.parent_path() / library).generic_string(), model.materials);
+
+					const MeshCache& meshCache = *model.meshCachePtr;
+					if (meshCache.HasPackedVertices())
+					{
+						for (const PackedVertex& packedVertex : meshCache.GetPackedVertices())
+							model.unpackedVertices.push_back(VertexQuantization::Unpack(packedVertex, meshCache.GetPositionQuantization()));
+					}
+					return true;
+				};
+
+			Model vehicle{};
+			Model fireFX{};
+			if (!loadModel("vehicle.mesh", vehicle) or (options.useFireFX and !loadModel("fireFX.mesh", fireFX)))
+				return false;
+
+			//The start camera of Renderer, built like Camera::CalculateViewMatrix and CalculateProjectionMatrix do, without Camera and its SDL input
+			const Vector3 cameraPosition{ 0.0f, 0.0f, -50.0f };
+			const Vector3 cameraRight = Vector3::Cross(Vector3::UnitY, Vector3::UnitZ).Normalized();
+			const Vector3 cameraUp = Vector3::Cross(Vector3::UnitZ, cameraRight).Normalized();
+			const Matrix cameraMatrix{ Vector4{ cameraRight, 0 }, Vector4{ cameraUp, 0 }, Vector4{ Vector3::UnitZ, 0 }, Vector4{ cameraPosition, 1 } };
+			const float aspectRatio = static_cast<float>(options.width) / static_cast<float>(options.height);
+			const Matrix projectionMatrix = Matrix::CreatePerspectiveFovLH(tanf((45.0f * TO_RADIANS) * 0.5f), aspectRatio, 1.0f, 1000.0f);
+
+			const Matrix worldMatrix = Matrix::CreateRotationY(RotationSpeed * options.time);
+			const Vector3 objectCameraPosition = Matrix::Inverse(worldMatrix).TransformPoint(cameraPosition);
+
+			//Same placeholders as Renderer
+			const std::unique_ptr<Texture> placeholderDiffusePtr = CreateSolidColor(ColorRGB{ 0.5f, 0.5f, 0.5f }, 1.f);
+			const std::unique_ptr<Texture> placeholderNormalPtr = CreateSolidColor(ColorRGB{ 0.5f, 0.5f, 1.f }, 1.f);
+			const std::unique_ptr<Texture> placeholderBlackPtr = CreateSolidColor(colors::Black, 1.f);
+			const std::unique_ptr<Texture> placeholderFireFXPtr = CreateSolidColor(colors::Black, 0.f);
+
+			std::map<std::string, std::unique_ptr<Texture>> textures{};
+			const auto getTexture = [&textures](const std::string& path, const Texture* placeholderPtr)
+				{
+					if (path.empty())
+						return placeholderPtr;
+
+					auto it = textures.find(path);
+					if (it == textures.end())
+					{
+						it = textures.emplace(path, LoadTexture(path)).first;
+						if (!it->second)
+							std::cout << "SoftwareRenderer: " << path << " could not be read\n";
+					}
+					return it->second ? it->second.get() : placeholderPtr;
+				};
+
+			const auto createDrawCall = [&](const Model& model, Pass pass)
+				{
+					const MeshCache& meshCache = *model.meshCachePtr;
+					DrawCall drawCall{};
+					drawCall.vertices = meshCache.HasPackedVertices() ? std::span<const Vertex>{ model.unpackedVertices } : meshCache.GetVertices();
+					drawCall.indices = meshCache.GetIndices();
+					drawCall.pass = pass;
+
+					//Mesh::SelectLevelOfDetail from the nearest point of the bounding sphere around the center of the bounds
+					Vector3 boundsMin{ FLT_MAX, FLT_MAX, FLT_MAX };
+					Vector3 boundsMax{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+					for (const Vertex& vertex : drawCall.vertices)
+					{
+						for (int axis = 0; axis < 3; ++axis)
+						{
+							boundsMin[axis] = std::min(boundsMin[axis], vertex.position[axis]);
+							boundsMax[axis] = std::max(boundsMax[axis], vertex.position[axis]);
+						}
+					}
+					const Vector3 center = (boundsMin + boundsMax) * 0.5f;
+					float radius{};
+					for (const Vertex& vertex : drawCall.vertices)
+						radius = std::max(radius, (vertex.position - center).Magnitude());
+
+					std::vector<float> errors{};
+					for (const Simplifier::LevelOfDetail& level : meshCache.GetLevelsOfDetail())
+						errors.push_back(level.error);
+					const float distance = std::max((objectCameraPosition - center).Magnitude() - radius, 0.f);
+					const size_t level = Simplifier::SelectLevelOfDetail(errors, distance, projectionMatrix[1][1], static_cast<float>(options.height));
+					const std::vector<Utils::OBJSubmesh>& submeshes = level == 0 ? meshCache.GetMaterialData().submeshes : meshCache.GetLevelsOfDetail()[level - 1].submeshes;
+
+					for (const Utils::OBJSubmesh& objSubmesh : submeshes)
+					{
+						Submesh submesh{};
+						submesh.firstIndex = objSubmesh.firstIndex;
+						submesh.numIndices = objSubmesh.numIndices;
+
+						const auto materialIt = std::find_if(model.materials.begin(), model.materials.end(),
+							[&objSubmesh](const Utils::MTLMaterial& material) { return material.name == objSubmesh.material; });
+						const Utils::MTLMaterial material = materialIt != model.materials.end() ? *materialIt : Utils::MTLMaterial{};
+						if (pass == Pass::FireFX)
+						{
+							submesh.material.diffuseMapPtr = getTexture(material.diffuseMap, placeholderFireFXPtr.get());
+						}
+						else
+						{
+							submesh.material.diffuseMapPtr = getTexture(material.diffuseMap, placeholderDiffusePtr.get());
+							submesh.material.normalMapPtr = getTexture(material.normalMap, placeholderNormalPtr.get());
+							submesh.material.specularMapPtr = getTexture(material.specularMap, placeholderBlackPtr.get());
+							submesh.material.glossinessMapPtr = getTexture(material.glossinessMap, placeholderBlackPtr.get());
+						}
+						drawCall.submeshes.push_back(submesh);
+					}
+					return drawCall;
+				};
+
+			std::vector<DrawCall> drawCalls{};
+			drawCalls.push_back(createDrawCall(vehicle, options.pass));
+			if (options.useFireFX)
+				drawCalls.push_back(createDrawCall(fireFX, Pass::FireFX));
+
+			View view{};
+			view.viewMatrix = Matrix::Inverse(cameraMatrix);
+			view.projectionMatrix = projectionMatrix;
+			view.cameraPosition = cameraPosition;
+			view.time = options.time;
+			view.useNormalMap = options.useNormalMap;
+
+			Framebuffer framebuffer{};
+			framebuffer.width = options.width;
+			framebuffer.height = options.height;
+
+			Statistics statistics{};
+			const auto renderStart = std::chrono::steady_clock::now();
+			Render(drawCalls, view, framebuffer, options.numThreads, options.useHierarchicalDepth, &statistics);
+			const auto renderEnd = std::chrono::steady_clock::now();
+
+			std::cout << "SoftwareRenderer: " << options.width << 'x' << options.height << " rendered in "
+				<< std::chrono::duration<double, std::milli>(renderEnd - renderStart).count() << " ms on "
+				<< (options.numThreads > 0 ? options.numThreads : GetDefaultThreadCount()) << " threads, assets loaded in "
+				<< std::chrono::duration<double, std::milli>(renderStart - loadStart).count() << " ms\n";
+			std::cout << "SoftwareRenderer: " << statistics.numCulledTriangles << " of " << statistics.numTriangles << " triangles outside the view, "
+				<< statistics.numClippedTriangles << " clipped into " << statistics.numClippedVertices << " new vertices\n";
+			if (options.useHierarchicalDepth)
+			{
+				std::cout << "SoftwareRenderer: hierarchical depth rejected " << statistics.numRejectedTriangles << " of " << statistics.numTileTriangles
+					<< " triangles in tiles and " << statistics.numRejectedBlocks << " of " << statistics.numBlocks << " blocks\n";
+			}
+
+			const uint64_t hash = HashImage(framebuffer);
+			std::cout << "SoftwareRenderer: frame hash " << std::hex << std::setw(16) << std::setfill('0') << hash << std::dec << std::setfill(' ') << '\n';
+			if (options.expectedHash != 0 and hash != options.expectedHash)
+			{
+				std::cout << "SoftwareRenderer: the frame hash differs from the expected " << std::hex << std::setw(16) << std::setfill('0') << options.expectedHash
+					<< std::dec << std::setfill(' ') << '\n';
+				return false;
+			}
+
+			if (!options.outputPath.empty() and !WriteImage(options.outputPath, framebuffer))
+				return false;
+
+			if (options.referencePath.empty())
+				return true;
+
+			Framebuffer reference{};
+			if (!ReadImage(options.referencePath, reference))
+				return false;
+			if (reference.width != framebuffer.width or reference.height != framebuffer.height)
+			{
+				std::cout << "SoftwareRenderer: " << options.referencePath << " is " << reference.width << 'x' << reference.height << ", not "
+					<< framebuffer.width << 'x' << framebuffer.height << '\n';
+				return false;
+			}
+
+			const ImageDifference difference = CompareImages(framebuffer, reference, options.tolerance);
+			const float differentShare = static_cast<float>(difference.numDifferentPixels) / static_cast<float>(framebuffer.colors.size());
+			std::cout << "SoftwareRenderer: against " << options.referencePath << " max difference " << difference.maxDifference
+				<< ", average " << difference.averageDifference << ", " << differentShare * 100.f << "% of the pixels off by more than "
+				<< options.tolerance << '\n';
+			return differentShare <= options.maxDifferentPixels;
+		}
+	}
+}
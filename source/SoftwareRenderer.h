@@ -0,0 +1,181 @@
+#pragma once
+#include "ColorRGB.h"
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dae
+{
+	struct Vertex;
+	class DDSFile;
+
+	//CPU rasterizer for the DefaultTechnique passes of PosCol3D.fx, so frames can be rendered on machines without a D3D11 device
+	//Triangles are set up and binned into screen tiles on every thread, then every tile is rasterized, shaded and blended on its own
+	//Opaque triangles only fill a per tile visibility buffer, each pixel is shaded once for the triangle that ends up in front
+	namespace SoftwareRenderer
+	{
+		//Square tiles in pixels, the framebuffer does not have to be a multiple of it
+		constexpr uint32_t TileSize{ 64 };
+		//Triangles per setup and binning task
+		constexpr uint32_t ChunkTriangles{ 4096 };
+
+		//The passes of DefaultTechnique, P0 to P2 are Phong with one of the sampler states, P3 the alpha blended FireFX
+		enum class Pass
+		{
+			Point,
+			Linear,
+			Anisotropic,
+			FireFX,
+		};
+
+		//RGBA8 with every mip down to 1x1, like the DDS files the cooker writes
+		struct Texture
+		{
+			struct Mip
+			{
+				const uint32_t* texels{};
+				uint32_t width{};
+				uint32_t height{};
+			};
+			std::vector<Mip> mips{};
+
+			//The mips point into one of the two
+			std::unique_ptr<DDSFile> ddsFilePtr{};
+			std::vector<uint32_t> ownedTexels{};
+		};
+
+		//Maps a cooked DDS, nullptr when DDSFile cannot read it
+		std::unique_ptr<Texture> LoadTexture(const std::string& ddsPath);
+		//1x1, like the placeholders Renderer shows for maps a material does not set
+		std::unique_ptr<Texture> CreateSolidColor(const ColorRGB& color, float alpha);
+
+		//Only the diffuse map is read by the FireFX pass
+		struct Material
+		{
+			const Texture* diffuseMapPtr{};
+			const Texture* normalMapPtr{};
+			const Texture* specularMapPtr{};
+			const Texture* glossinessMapPtr{};
+		};
+
+		struct Submesh
+		{
+			uint32_t firstIndex{};
+			uint32_t numIndices{};
+			Material material{};
+		};
+
+		//One mesh drawn with one pass, like Mesh::Render
+		struct DrawCall
+		{
+			std::span<const Vertex> vertices{};
+			std::span<const uint32_t> indices{};
+			std::vector<Submesh> submeshes{};
+			Pass pass{};
+		};
+
+		//The effect variables Renderer::Update sets
+		struct View
+		{
+			Matrix viewMatrix{};
+			Matrix projectionMatrix{};
+			Vector3 cameraPosition{};
+			//gTime, the vertex shaders rotate the meshes by it
+			float time{};
+			bool useNormalMap{ true };
+		};
+
+		struct Framebuffer
+		{
+			uint32_t width{};
+			uint32_t height{};
+			//RGBA8 like the swap chain, rows from top to bottom
+			std::vector<uint32_t> colors{};
+		};
+
+		//Work of one Render call, summed over the chunks and tiles
+		struct Statistics
+		{
+			//Triangles submitted, the ones outside the view, and the ones that crossed the near plane or the guard band and were clipped,
+			//with the vertices clipping created
+			size_t numTriangles{};
+			size_t numCulledTriangles{};
+			size_t numClippedTriangles{};
+			size_t numClippedVertices{};
+			//Triangles counted once per tile they are binned to, and the ones the farthest depth of the tile rejected before rasterization
+			size_t numTileTriangles{};
+			size_t numRejectedTriangles{};
+			//Blocks inside the edges of the rasterized triangles, and the ones their farthest depth rejected before the coverage test
+			size_t numBlocks{};
+			size_t numRejectedBlocks{};
+		};
+
+		//Clears framebuffer.colors to the clear color of Renderer::Render and draws the calls in order, the framebuffer size has to be set
+		//Opaque draws cull back faces and write depth, FireFX draws cull nothing, test depth without writing it and blend with the source alpha
+		//Triangles are culled and classified from the outcodes of their vertices, those crossing the near plane or the guard band,
+		//Rasterizer::MaxExtent pixels around the center of the framebuffer, are clipped in clip space and the rest go straight to setup.
+		//The guard band limits the framebuffer to a little under MaxExtent pixels on each side. numThreads 0 uses every hardware thread
+		//Vertices snap to 1/256 pixel and the top left rule decides pixel centers on an edge, so the image does not depend on the thread count or
+		//the rasterizer kernel
+		//The hierarchical depth test keeps the farthest depth of every tile and 8x8 block and skips triangles and blocks behind it, the image is the same without it
+		void Render(std::span<const DrawCall> drawCalls, const View& view, Framebuffer& framebuffer, uint32_t numThreads = 0, bool useHierarchicalDepth = true,
+			Statistics* statisticsPtr = nullptr);
+
+		//Binary PPM, the alpha is dropped on write and read back as opaque
+		bool WriteImage(const std::string& path, const Framebuffer& framebuffer);
+		bool ReadImage(const std::string& path, Framebuffer& framebuffer);
+
+		struct ImageDifference
+		{
+			//Largest difference of a color channel, 0 to 255
+			uint32_t maxDifference{};
+			double averageDifference{};
+			//Pixels with a channel that differs by more than the tolerance
+			size_t numDifferentPixels{};
+		};
+
+		//Both images have to be the same size
+		ImageDifference CompareImages(const Framebuffer& image, const Framebuffer& reference, uint32_t tolerance);
+
+		//64 bit FNV-1a of the size and the colors, for regression tests that compare frames exactly
+		uint64_t HashImage(const Framebuffer& framebuffer);
+
+		struct HeadlessOptions
+		{
+			std::string cookedFolder{ "Resources/Cooked" };
+			std::string outputPath{};
+			//Compared against when set, e.g. a capture of the D3D path written by Renderer::SaveScreenshot
+			std::string referencePath{};
+			uint32_t width{ 640 };
+			uint32_t height{ 480 };
+			float time{};
+			//Point, Linear or Anisotropic
+			Pass pass{ Pass::Point };
+			bool useNormalMap{ true };
+			bool useFireFX{ true };
+			bool useHierarchicalDepth{ true };
+			uint32_t numThreads{};
+			//Channel difference a pixel may have against the reference, and the share of pixels allowed to exceed it,
+			//for the rasterization and filtering precision D3D leaves to the hardware
+			uint32_t tolerance{ 8 };
+			float maxDifferentPixels{ 0.01f };
+			//HashImage of the frame the run has to produce when not 0
+			uint64_t expectedHash{};
+		};
+
+		//What follows --headless in main.cpp, or HeadlessRenderer
+		constexpr std::string_view HeadlessArguments{ "<image.ppm> [--time T] [--pass 0-2] [--threads N] [--reference image.ppm] [--hash H] [--cooked folder] "
+			"[--no-normal-map] [--no-firefx] [--no-hierarchical-depth]" };
+
+		//The options after the output path, shared by main.cpp --headless and HeadlessMain.cpp
+		//False after printing the usage for the first option it does not know or whose value is not a number
+		bool ParseHeadlessOptions(std::span<char* const> arguments, HeadlessOptions& options);
+
+		//Loads the cooked vehicle and FireFX with their textures the way Renderer does and renders one frame from the start camera,
+		//with the level of detail Renderer would pick. Needs no window or D3D device. Fails when an asset is missing, the image
+		//differs from the reference by more than the tolerance or its hash is not the expected one
+		bool RenderHeadless(const HeadlessOptions& options);
+	}
+}
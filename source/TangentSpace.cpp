@@ -0,0 +1,280 @@
+#include "pch.h"
+#include "TangentSpace.h"
+#include "Parallel.h"
+
+#include <cmath>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define DAE_TANGENTS_SSE
+#include <immintrin.h>
+#endif
+
+namespace dae
+{
+	namespace TangentSpace
+	{
+		namespace
+		{
+			constexpr size_t TrianglesPerTask{ 1 << 14 };
+			constexpr size_t VerticesPerTask{ 1 << 14 };
+			//Triangles whose UVs span less than this area get no tangent of their own, like MikkTSpace's degenerate faces
+			constexpr float MinUVArea{ 1e-20f };
+
+			//Unnormalized tangent and bitangent of every triangle, and the angle at each of its corners
+			struct FaceFrames
+			{
+				explicit FaceFrames(size_t numTriangles)
+					: tangentX(numTriangles), tangentY(numTriangles), tangentZ(numTriangles)
+					, bitangentX(numTriangles), bitangentY(numTriangles), bitangentZ(numTriangles)
+					, cornerAngles(numTriangles * 3)
+				{
+				}
+
+				std::vector<float> tangentX, tangentY, tangentZ;
+				std::vector<float> bitangentX, bitangentY, bitangentZ;
+				std::vector<float> cornerAngles;
+			};
+
+			float CornerAngle(const Vector3& edge0, const Vector3& edge1)
+			{
+				const float lengths = std::sqrt(edge0.SqrMagnitude() * edge1.SqrMagnitude());
+				if (lengths <= 0.f)
+					return 0.f;
+				return std::acos(std::clamp(Vector3::Dot(edge0, edge1) / lengths, -1.f, 1.f));
+			}
+
+			void ComputeFace(const VertexStreams& streams, const uint32_t* triangle, size_t triangleIndex, FaceFrames& faces)
+			{
+				const uint32_t i0 = triangle[0], i1 = triangle[1], i2 = triangle[2];
+				const Vector3 p0{ streams.positionX[i0], streams.positionY[i0], streams.positionZ[i0] };
+				const Vector3 p1{ streams.positionX[i1], streams.positionY[i1], streams.positionZ[i1] };
+				const Vector3 p2{ streams.positionX[i2], streams.positionY[i2], streams.positionZ[i2] };
+
+				const Vector3 edge1 = p1 - p0;
+				const Vector3 edge2 = p2 - p0;
+				const Vector3 edge3 = p2 - p1;
+				const float du1 = streams.u[i1] - streams.u[i0], dv1 = streams.v[i1] - streams.v[i0];
+				const float du2 = streams.u[i2] - streams.u[i0], dv2 = streams.v[i2] - streams.v[i0];
+
+				const float determinant = du1 * dv2 - du2 * dv1;
+				const float r = std::abs(determinant) > MinUVArea ? 1.f / determinant : 0.f;
+				const Vector3 tangent = (edge1 * dv2 - edge2 * dv1) * r;
+				const Vector3 bitangent = (edge2 * du1 - edge1 * du2) * r;
+
+				faces.tangentX[triangleIndex] = tangent.x;
+				faces.tangentY[triangleIndex] = tangent.y;
+				faces.tangentZ[triangleIndex] = tangent.z;
+				faces.bitangentX[triangleIndex] = bitangent.x;
+				faces.bitangentY[triangleIndex] = bitangent.y;
+				faces.bitangentZ[triangleIndex] = bitangent.z;
+
+				float* angles = &faces.cornerAngles[triangleIndex * 3];
+				angles[0] = CornerAngle(edge1, edge2);
+				angles[1] = CornerAngle(-edge1, edge3);
+				angles[2] = CornerAngle(edge2, edge3);
+			}
+
+#ifdef DAE_TANGENTS_SSE
+			struct Vector3x4
+			{
+				__m128 x, y, z;
+
+				Vector3x4 operator-(const Vector3x4& other) const
+				{
+					return { _mm_sub_ps(x, other.x), _mm_sub_ps(y, other.y), _mm_sub_ps(z, other.z) };
+				}
+			};
+
+			__m128 Gather(std::span<const float> stream, const uint32_t* triangles, size_t corner)
+			{
+				return _mm_setr_ps(stream[triangles[corner]], stream[triangles[3 + corner]], stream[triangles[6 + corner]], stream[triangles[9 + corner]]);
+			}
+
+			Vector3x4 GatherPosition(const VertexStreams& streams, const uint32_t* triangles, size_t corner)
+			{
+				return { Gather(streams.positionX, triangles, corner), Gather(streams.positionY, triangles, corner), Gather(streams.positionZ, triangles, corner) };
+			}
+
+			__m128 Dot(const Vector3x4& v0, const Vector3x4& v1)
+			{
+				return _mm_add_ps(_mm_add_ps(_mm_mul_ps(v0.x, v1.x), _mm_mul_ps(v0.y, v1.y)), _mm_mul_ps(v0.z, v1.z));
+			}
+
+			//(a * s - b * t) * r for every component
+			Vector3x4 Combine(const Vector3x4& a, __m128 s, const Vector3x4& b, __m128 t, __m128 r)
+			{
+				return {
+					_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(a.x, s), _mm_mul_ps(b.x, t)), r),
+					_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(a.y, s), _mm_mul_ps(b.y, t)), r),
+					_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(a.z, s), _mm_mul_ps(b.z, t)), r) };
+			}
+
+			//Cosine of the angle between two edges, 1 (no angle) when one of them has no length
+			__m128 CornerCosine(__m128 dot, __m128 sqrLength0, __m128 sqrLength1)
+			{
+				const __m128 lengths = _mm_sqrt_ps(_mm_mul_ps(sqrLength0, sqrLength1));
+				const __m128 valid = _mm_cmpgt_ps(lengths, _mm_setzero_ps());
+				const __m128 one = _mm_set1_ps(1.f);
+				return _mm_or_ps(_mm_and_ps(valid, _mm_div_ps(dot, lengths)), _mm_andnot_ps(valid, one));
+			}
+
+			//Same math as ComputeFace for 4 consecutive triangles, only the acos is left to the scalar unit
+			void ComputeFaces4(const VertexStreams& streams, const uint32_t* triangles, size_t firstTriangle, FaceFrames& faces)
+			{
+				const Vector3x4 p0 = GatherPosition(streams, triangles, 0);
+				const Vector3x4 p1 = GatherPosition(streams, triangles, 1);
+				const Vector3x4 p2 = GatherPosition(streams, triangles, 2);
+				const __m128 u0 = Gather(streams.u, triangles, 0), v0 = Gather(streams.v, triangles, 0);
+				const __m128 du1 = _mm_sub_ps(Gather(streams.u, triangles, 1), u0), dv1 = _mm_sub_ps(Gather(streams.v, triangles, 1), v0);
+				const __m128 du2 = _mm_sub_ps(Gather(streams.u, triangles, 2), u0), dv2 = _mm_sub_ps(Gather(streams.v, triangles, 2), v0);
+
+				const Vector3x4 edge1 = p1 - p0;
+				const Vector3x4 edge2 = p2 - p0;
+				const Vector3x4 edge3 = p2 - p1;
+
+				const __m128 determinant = _mm_sub_ps(_mm_mul_ps(du1, dv2), _mm_mul_ps(du2, dv1));
+				const __m128 absDeterminant = _mm_andnot_ps(_mm_set1_ps(-0.f), determinant);
+				const __m128 valid = _mm_cmpgt_ps(absDeterminant, _mm_set1_ps(MinUVArea));
+				const __m128 r = _mm_and_ps(valid, _mm_div_ps(_mm_set1_ps(1.f), determinant));
+
+				const Vector3x4 tangent = Combine(edge1, dv2, edge2, dv1, r);
+				const Vector3x4 bitangent = Combine(edge2, du1, edge1, du2, r);
+				_mm_storeu_ps(&faces.tangentX[firstTriangle], tangent.x);
+				_mm_storeu_ps(&faces.tangentY[firstTriangle], tangent.y);
+				_mm_storeu_ps(&faces.tangentZ[firstTriangle], tangent.z);
+				_mm_storeu_ps(&faces.bitangentX[firstTriangle], bitangent.x);
+				_mm_storeu_ps(&faces.bitangentY[firstTriangle], bitangent.y);
+				_mm_storeu_ps(&faces.bitangentZ[firstTriangle], bitangent.z);
+
+				const __m128 sqrLength1 = Dot(edge1, edge1), sqrLength2 = Dot(edge2, edge2), sqrLength3 = Dot(edge3, edge3);
+				alignas(16) float cosines[3][4];
+				_mm_store_ps(cosines[0], CornerCosine(Dot(edge1, edge2), sqrLength1, sqrLength2));
+				_mm_store_ps(cosines[1], CornerCosine(_mm_sub_ps(_mm_setzero_ps(), Dot(edge1, edge3)), sqrLength1, sqrLength3));
+				_mm_store_ps(cosines[2], CornerCosine(Dot(edge2, edge3), sqrLength2, sqrLength3));
+
+				float* angles = &faces.cornerAngles[firstTriangle * 3];
+				for (size_t lane = 0; lane < 4; ++lane)
+				{
+					for (size_t corner = 0; corner < 3; ++corner)
+						angles[lane * 3 + corner] = std::acos(std::clamp(cosines[corner][lane], -1.f, 1.f));
+				}
+			}
+#endif
+
+			void ComputeFaces(const VertexStreams& streams, std::span<const uint32_t> indices, size_t firstTriangle, size_t lastTriangle, FaceFrames& faces)
+			{
+				size_t triangleIndex = firstTriangle;
+#ifdef DAE_TANGENTS_SSE
+				for (; triangleIndex + 4 <= lastTriangle; triangleIndex += 4)
+					ComputeFaces4(streams, &indices[triangleIndex * 3], triangleIndex, faces);
+#endif
+				for (; triangleIndex < lastTriangle; ++triangleIndex)
+					ComputeFace(streams, &indices[triangleIndex * 3], triangleIndex, faces);
+			}
+
+			//Part of v perpendicular to the normal, v itself when there is no normal
+			Vector3 Orthogonalize(const Vector3& v, const Vector3& normal)
+			{
+				return normal.SqrMagnitude() > 0.f ? Vector3::Reject(v, normal) : v;
+			}
+
+			//Any unit vector perpendicular to the normal, for vertices whose faces have no usable UVs
+			Vector3 AnyPerpendicular(const Vector3& normal)
+			{
+				const Vector3 axis = std::abs(normal.x) < 0.9f ? Vector3::UnitX : Vector3::UnitY;
+				const Vector3 tangent = Orthogonalize(axis, normal);
+				return tangent.Normalized();
+			}
+		}
+
+		void Generate(const VertexStreams& streams, std::span<const uint32_t> indices, std::span<Vector4> tangents, uint32_t numThreads)
+		{
+			const size_t numVertices = tangents.size();
+			const size_t numTriangles = indices.size() / 3;
+
+			FaceFrames faces{ numTriangles };
+			ParallelFor((numTriangles + TrianglesPerTask - 1) / TrianglesPerTask, numThreads, [&](size_t taskIndex)
+				{
+					const size_t firstTriangle = taskIndex * TrianglesPerTask;
+					ComputeFaces(streams, indices, firstTriangle, std::min(firstTriangle + TrianglesPerTask, numTriangles), faces);
+				});
+
+			//Corners grouped per vertex, so every vertex can gather its faces without any other thread touching its sums
+			std::vector<uint32_t> cornerStarts(numVertices + 1, 0);
+			for (size_t corner = 0; corner < numTriangles * 3; ++corner)
+				++cornerStarts[indices[corner] + 1];
+			for (size_t vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
+				cornerStarts[vertexIndex + 1] += cornerStarts[vertexIndex];
+
+			std::vector<uint32_t> vertexCorners(numTriangles * 3);
+			{
+				std::vector<uint32_t> nextSlot(cornerStarts.begin(), cornerStarts.end() - 1);
+				for (size_t corner = 0; corner < numTriangles * 3; ++corner)
+					vertexCorners[nextSlot[indices[corner]]++] = static_cast<uint32_t>(corner);
+			}
+
+			ParallelFor((numVertices + VerticesPerTask - 1) / VerticesPerTask, numThreads, [&](size_t taskIndex)
+				{
+					const size_t firstVertex = taskIndex * VerticesPerTask;
+					const size_t lastVertex = std::min(firstVertex + VerticesPerTask, numVertices);
+					for (size_t vertexIndex = firstVertex; vertexIndex < lastVertex; ++vertexIndex)
+					{
+						const Vector3 normal{ streams.normalX[vertexIndex], streams.normalY[vertexIndex], streams.normalZ[vertexIndex] };
+
+						//Every face adds its tangent in the plane of this vertex, at unit length and weighted by the angle of the corner
+						Vector3 tangentSum{}, bitangentSum{};
+						for (uint32_t slot = cornerStarts[vertexIndex]; slot < cornerStarts[vertexIndex + 1]; ++slot)
+						{
+							const uint32_t corner = vertexCorners[slot];
+							const uint32_t triangleIndex = corner / 3;
+							const float angle = faces.cornerAngles[corner];
+
+							const Vector3 tangent = Orthogonalize({ faces.tangentX[triangleIndex], faces.tangentY[triangleIndex], faces.tangentZ[triangleIndex] }, normal);
+							const Vector3 bitangent = Orthogonalize({ faces.bitangentX[triangleIndex], faces.bitangentY[triangleIndex], faces.bitangentZ[triangleIndex] }, normal);
+							const float tangentLength = tangent.Magnitude();
+							const float bitangentLength = bitangent.Magnitude();
+							if (tangentLength > 0.f)
+								tangentSum += tangent * (angle / tangentLength);
+							if (bitangentLength > 0.f)
+								bitangentSum += bitangent * (angle / bitangentLength);
+						}
+
+						Vector3 tangent = Orthogonalize(tangentSum, normal);
+						tangent = tangent.SqrMagnitude() > 0.f ? tangent.Normalized() : AnyPerpendicular(normal);
+						const float handedness = Vector3::Dot(Vector3::Cross(normal, tangent), bitangentSum) < 0.f ? -1.f : 1.f;
+						tangents[vertexIndex] = Vector4{ tangent, handedness };
+					}
+				});
+		}
+
+		void Generate(std::span<Vertex> vertices, std::span<const uint32_t> indices, uint32_t numThreads)
+		{
+			const size_t numVertices = vertices.size();
+			std::vector<float> attributes(numVertices * 8);
+			float* streamPtrs[8]{};
+			for (size_t stream = 0; stream < 8; ++stream)
+				streamPtrs[stream] = &attributes[stream * numVertices];
+
+			for (size_t vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
+			{
+				const Vertex& vertex = vertices[vertexIndex];
+				streamPtrs[0][vertexIndex] = vertex.position.x;
+				streamPtrs[1][vertexIndex] = vertex.position.y;
+				streamPtrs[2][vertexIndex] = vertex.position.z;
+				streamPtrs[3][vertexIndex] = vertex.uv.x;
+				streamPtrs[4][vertexIndex] = vertex.uv.y;
+				streamPtrs[5][vertexIndex] = vertex.normal.x;
+				streamPtrs[6][vertexIndex] = vertex.normal.y;
+				streamPtrs[7][vertexIndex] = vertex.normal.z;
+			}
+
+			const auto stream = [&](size_t index) { return std::span<const float>{ streamPtrs[index], numVertices }; };
+			const VertexStreams streams{ stream(0), stream(1), stream(2), stream(3), stream(4), stream(5), stream(6), stream(7) };
+
+			std::vector<Vector4> tangents(numVertices);
+			Generate(streams, indices, tangents, numThreads);
+			for (size_t vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
+				vertices[vertexIndex].tangent = tangents[vertexIndex];
+		}
+	}
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "Math.h"
+#include "Vertex.h"
+#include <span>
+
+namespace dae
+{
+	namespace TangentSpace
+	{
+		//Vertex attributes as separate float streams, all of the same length
+		struct VertexStreams
+		{
+			std::span<const float> positionX;
+			std::span<const float> positionY;
+			std::span<const float> positionZ;
+			std::span<const float> u;
+			std::span<const float> v;
+			std::span<const float> normalX;
+			std::span<const float> normalY;
+			std::span<const float> normalZ;
+		};
+
+		//MikkTSpace style tangents for an indexed triangle list: face tangents weighted by corner angle, orthogonalized against the normal
+		//w holds the handedness, the bitangent is cross(normal, tangent.xyz) * w
+		//Faces are handled 4 at a time with SSE on triangle ranges spread over numThreads (0 uses every hardware thread)
+		//Every vertex then sums its own corners, so no two threads ever write the same tangent and the result does not depend on the thread count
+		void Generate(const VertexStreams& streams, std::span<const uint32_t> indices, std::span<Vector4> tangents, uint32_t numThreads = 0);
+
+		//Same as above for interleaved vertices, the tangents are written into the vertices
+		void Generate(std::span<Vertex> vertices, std::span<const uint32_t> indices, uint32_t numThreads = 0);
+	}
+}
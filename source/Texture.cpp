@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "Texture.h"
+#include "DDSFile.h"
 
 using namespace dae;
 
@@ -13,12 +14,35 @@ Texture::Texture(SDL_Surface* pSurface) :
 Texture::Texture(SDL_Surface* pSurface, ID3D11Device* devicePtr) :
     m_SurfacePtr{ pSurface },
     m_SurfacePixelsPtr{ (uint32_t*)pSurface->pixels }
+{
+    CreateResource(m_SurfacePtr, devicePtr);
+    if (!m_SRVPtr)
+        return;
+
+    if (m_SurfacePtr)
+    {
+        SDL_FreeSurface(m_SurfacePtr);
+        m_SurfacePtr = nullptr;
+    }
+}
+
+void Texture::CreateResource(SDL_Surface* pSurface, ID3D11Device* devicePtr)
+{
+    D3D11_SUBRESOURCE_DATA initData;
+    initData.pSysMem = pSurface->pixels;
+    initData.SysMemPitch = static_cast<UINT>(pSurface->pitch);
+    initData.SysMemSlicePitch = static_cast<UINT>(pSurface->pitch * pSurface->h);
+
+    CreateResource(&initData, pSurface->w, pSurface->h, 1, devicePtr);
+}
+
+void Texture::CreateResource(const D3D11_SUBRESOURCE_DATA* mipsPtr, uint32_t width, uint32_t height, uint32_t numMips, ID3D11Device* devicePtr)
 {
     DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM;
     D3D11_TEXTURE2D_DESC desc{};
-    desc.Width = m_SurfacePtr->w;
-    desc.Height = m_SurfacePtr->h;
-    desc.MipLevels = 1;
+    desc.Width = width;
+    desc.Height = height;
+    desc.MipLevels = numMips;
     desc.ArraySize = 1;
     desc.Format = format;
     desc.SampleDesc.Count = 1;
@@ -28,12 +52,7 @@ Texture::Texture(SDL_Surface* pSurface, ID3D11Device* devicePtr) :
     desc.CPUAccessFlags = 0;
     desc.MiscFlags = 0;
 
-    D3D11_SUBRESOURCE_DATA initData;
-    initData.pSysMem = m_SurfacePtr->pixels;
-    initData.SysMemPitch = static_cast<UINT>(m_SurfacePtr->pitch);
-    initData.SysMemSlicePitch = static_cast<UINT>(m_SurfacePtr->pitch * m_SurfacePtr->h);
-
-    HRESULT hr = devicePtr->CreateTexture2D(&desc, &initData, &m_ResourcePtr);
+    HRESULT hr = devicePtr->CreateTexture2D(&desc, mipsPtr, &m_ResourcePtr);
     if (FAILED(hr))
     {
         std::cout << "Texture::Texture() failed: " << hr << '\n';
@@ -51,12 +70,6 @@ Texture::Texture(SDL_Surface* pSurface, ID3D11Device* devicePtr) :
         std::cout << "Texture::Texture() failed: " << hr << '\n';
         return;
     }
-
-    if (m_SurfacePtr)
-    {
-        SDL_FreeSurface(m_SurfacePtr);
-        m_SurfacePtr = nullptr;
-    }
 }
 
 Texture::~Texture()
@@ -82,6 +95,74 @@ Texture* Texture::LoadFromFile(const std::string& path, ID3D11Device* devicePtr)
     return new Texture(pSurface, devicePtr);
 }
 
+SDL_Surface* Texture::DecodeFromFile(const std::string& path)
+{
+    SDL_Surface* pSurface = IMG_Load(path.c_str());
+    if (!pSurface)
+        std::cout << "Texture::DecodeFromFile() failed: " << SDL_GetError() << std::endl;
+    return pSurface;
+}
+
+SDL_Surface* Texture::DecodeFromMemory(std::span<const char> encodedImage)
+{
+    SDL_Surface* pDecoded = IMG_Load_RW(SDL_RWFromConstMem(encodedImage.data(), static_cast<int>(encodedImage.size())), 1);
+    if (!pDecoded)
+    {
+        std::cout << "Texture::DecodeFromMemory() failed: " << SDL_GetError() << std::endl;
+        return nullptr;
+    }
+
+    // glTF images are often JPEG or RGB PNG, the upload expects R8G8B8A8_UNORM
+    SDL_Surface* pSurface = SDL_ConvertSurfaceFormat(pDecoded, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(pDecoded);
+    if (!pSurface)
+        std::cout << "Texture::DecodeFromMemory() failed: " << SDL_GetError() << std::endl;
+    return pSurface;
+}
+
+Texture* Texture::CreateFromSurface(SDL_Surface* pSurface, ID3D11Device* devicePtr)
+{
+    if (!pSurface)
+        return nullptr;
+
+    Texture* pTexture = new Texture();
+    pTexture->CreateResource(pSurface, devicePtr);
+    return pTexture;
+}
+
+Texture* Texture::CreateFromDDS(const DDSFile& ddsFile, ID3D11Device* devicePtr)
+{
+    std::vector<D3D11_SUBRESOURCE_DATA> mips(ddsFile.GetNumMips());
+    for (uint32_t level = 0; level < ddsFile.GetNumMips(); ++level)
+    {
+        const DDSFile::Mip& mip = ddsFile.GetMip(level);
+        mips[level].pSysMem = mip.data.data();
+        mips[level].SysMemPitch = mip.rowPitch;
+        mips[level].SysMemSlicePitch = static_cast<UINT>(mip.data.size());
+    }
+
+    Texture* pTexture = new Texture();
+    pTexture->CreateResource(mips.data(), ddsFile.GetWidth(), ddsFile.GetHeight(), ddsFile.GetNumMips(), devicePtr);
+    return pTexture;
+}
+
+Texture* Texture::CreateSolidColor(const ColorRGB& color, float alpha, ID3D11Device* devicePtr)
+{
+    SDL_Surface* pSurface = SDL_CreateRGBSurfaceWithFormat(0, 1, 1, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!pSurface)
+    {
+        std::cout << "Texture::CreateSolidColor() failed: " << SDL_GetError() << std::endl;
+        return nullptr;
+    }
+
+    const auto toByte = [](float value) { return static_cast<Uint8>(std::clamp(value, 0.f, 1.f) * 255.f + 0.5f); };
+    *static_cast<uint32_t*>(pSurface->pixels) = SDL_MapRGBA(pSurface->format, toByte(color.r), toByte(color.g), toByte(color.b), toByte(alpha));
+
+    Texture* pTexture = CreateFromSurface(pSurface, devicePtr);
+    SDL_FreeSurface(pSurface);
+    return pTexture;
+}
+
 ColorRGB Texture::Sample(const Vector2& uv) const
 {
     float x{ std::clamp(uv.x, 0.f, 1.f) };
@@ -1,11 +1,13 @@
 #pragma once
 #include <SDL_surface.h>
+#include <span>
 #include <string>
 #include "ColorRGB.h"
 
 namespace dae
 {
     struct Vector2;
+    class DDSFile;
 
     class Texture
     {
@@ -18,13 +20,29 @@ namespace dae
         Texture& operator=(Texture&& other) noexcept = delete;
 
         static Texture* LoadFromFile(const std::string& path, ID3D11Device* devicePtr);
+
+        // Only decodes the image, safe to call from worker threads, the caller frees the surface with SDL_FreeSurface
+        static SDL_Surface* DecodeFromFile(const std::string& path);
+        // Same for an encoded image that is already in memory, e.g. embedded in a GLB, converted to RGBA8 for CreateFromSurface
+        static SDL_Surface* DecodeFromMemory(std::span<const char> encodedImage);
+        // Uploads already decoded pixels, the surface stays owned by the caller
+        static Texture* CreateFromSurface(SDL_Surface* pSurface, ID3D11Device* devicePtr);
+        // Uploads every mip of a cooked texture in one go
+        static Texture* CreateFromDDS(const DDSFile& ddsFile, ID3D11Device* devicePtr);
+        // 1x1 texture, used as a placeholder while the real one is still loading
+        static Texture* CreateSolidColor(const ColorRGB& color, float alpha, ID3D11Device* devicePtr);
+
         ColorRGB Sample(const Vector2& uv) const;
         ID3D11ShaderResourceView* GetSRV() const { return m_SRVPtr; }
 
     private:
+        Texture() = default;
         Texture(SDL_Surface* pSurface);
         Texture(SDL_Surface* pSurface, ID3D11Device* devicePtr);
 
+        void CreateResource(SDL_Surface* pSurface, ID3D11Device* devicePtr);
+        void CreateResource(const D3D11_SUBRESOURCE_DATA* mipsPtr, uint32_t width, uint32_t height, uint32_t numMips, ID3D11Device* devicePtr);
+
         SDL_Surface* m_SurfacePtr = nullptr;
         uint32_t* m_SurfacePixelsPtr = nullptr;
 
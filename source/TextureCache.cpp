@@ -0,0 +1,108 @@
+#include "pch.h"
+#include "TextureCache.h"
+#include "Texture.h"
+#include "AssetLoader.h"
+#include "DDSFile.h"
+
+#include <filesystem>
+
+namespace dae
+{
+    namespace
+    {
+        // Cooked textures are mapped and uploaded with their mips, anything else is decoded by SDL_image
+        bool IsCooked(const std::string& path)
+        {
+            return std::filesystem::path{ path }.extension() == ".dds";
+        }
+    }
+
+    TextureCache::TextureCache(ID3D11Device* devicePtr)
+        : m_DevicePtr{ devicePtr }
+    {
+    }
+
+    TextureCache::~TextureCache()
+    {
+        for (const auto& [path, entry] : m_Entries)
+            delete entry.texturePtr;
+    }
+
+    Texture* TextureCache::Load(const std::string& path)
+    {
+        ++m_NumRequests;
+        const auto [entryIt, isNew] = m_Entries.try_emplace(NormalizePath(path));
+        Entry& entry = entryIt->second;
+        if (!isNew)
+            return entry.texturePtr;
+
+        if (IsCooked(path))
+        {
+            const std::unique_ptr<DDSFile> ddsFilePtr = DDSFile::Open(path);
+            if (ddsFilePtr)
+                entry.texturePtr = Texture::CreateFromDDS(*ddsFilePtr, m_DevicePtr);
+            return entry.texturePtr;
+        }
+
+        SDL_Surface* pSurface = Texture::DecodeFromFile(path);
+        entry.texturePtr = Texture::CreateFromSurface(pSurface, m_DevicePtr);
+        if (pSurface)
+            SDL_FreeSurface(pSurface);
+        return entry.texturePtr;
+    }
+
+    void TextureCache::LoadAsync(const std::string& path, AssetLoader& assetLoader, Callback callback)
+    {
+        ++m_NumRequests;
+        const std::string key = NormalizePath(path);
+        const auto [entryIt, isNew] = m_Entries.try_emplace(key);
+        Entry& entry = entryIt->second;
+        if (!isNew and !entry.isLoading)
+        {
+            if (callback)
+                callback(entry.texturePtr);
+            return;
+        }
+
+        if (callback)
+            entry.callbacks.push_back(std::move(callback));
+        if (entry.isLoading)
+            return;
+
+        entry.isLoading = true;
+        assetLoader.Enqueue([this, key]()
+            {
+                std::shared_ptr<DDSFile> ddsFilePtr{};
+                std::shared_ptr<SDL_Surface> surfacePtr{};
+                if (IsCooked(key))
+                    ddsFilePtr = DDSFile::Open(key);
+                else
+                    surfacePtr = std::shared_ptr<SDL_Surface>{ Texture::DecodeFromFile(key), [](SDL_Surface* p) { if (p) SDL_FreeSurface(p); } };
+
+                return [this, key, ddsFilePtr, surfacePtr]()
+                    {
+                        Entry& entry = m_Entries[key];
+                        entry.texturePtr = ddsFilePtr ? Texture::CreateFromDDS(*ddsFilePtr, m_DevicePtr) : Texture::CreateFromSurface(surfacePtr.get(), m_DevicePtr);
+                        entry.isLoading = false;
+
+                        // Callbacks may request more textures, which can rehash the map
+                        std::vector<Callback> callbacks{};
+                        callbacks.swap(entry.callbacks);
+                        Texture* texturePtr = entry.texturePtr;
+                        for (const Callback& callback : callbacks)
+                            callback(texturePtr);
+                    };
+            });
+    }
+
+    Texture* TextureCache::Find(const std::string& path) const
+    {
+        const auto entryIt = m_Entries.find(NormalizePath(path));
+        return entryIt != m_Entries.end() ? entryIt->second.texturePtr : nullptr;
+    }
+
+    std::string TextureCache::NormalizePath(const std::string& path)
+    {
+        return std::filesystem::path{ path }.lexically_normal().generic_string();
+    }
+}
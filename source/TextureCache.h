@@ -0,0 +1,57 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dae
+{
+    class AssetLoader;
+    class Texture;
+
+    // Owns every texture loaded through it, keyed by normalized path, so a texture shared by several materials
+    // or meshes is decoded and uploaded only once
+    // Not thread safe: call it from the thread that runs the AssetLoader completions
+    class TextureCache final
+    {
+    public:
+        // Receives nullptr when the texture could not be loaded
+        using Callback = std::function<void(Texture*)>;
+
+        explicit TextureCache(ID3D11Device* devicePtr);
+        ~TextureCache();
+
+        TextureCache(const TextureCache& other) = delete;
+        TextureCache(TextureCache&& other) noexcept = delete;
+        TextureCache& operator=(const TextureCache& other) = delete;
+        TextureCache& operator=(TextureCache&& other) noexcept = delete;
+
+        // Decodes and uploads on the calling thread unless the path was requested before,
+        // returns nullptr while a LoadAsync of the same path is still in flight
+        Texture* Load(const std::string& path);
+        // Decodes (or maps, for cooked .dds files) on the loader threads,
+        // the callback runs once the texture is uploaded (right away when it already is)
+        // Requests for a path that is still loading wait for the same decode
+        void LoadAsync(const std::string& path, AssetLoader& assetLoader, Callback callback);
+
+        // nullptr when the path was never requested, is still loading or failed
+        Texture* Find(const std::string& path) const;
+
+        size_t GetNumTextures() const { return m_Entries.size(); }
+        size_t GetNumRequests() const { return m_NumRequests; }
+
+    private:
+        struct Entry
+        {
+            Texture* texturePtr = nullptr;
+            bool isLoading = false;
+            std::vector<Callback> callbacks{};
+        };
+
+        static std::string NormalizePath(const std::string& path);
+
+        ID3D11Device* m_DevicePtr = nullptr;
+        std::unordered_map<std::string, Entry> m_Entries{};
+        size_t m_NumRequests = 0;
+    };
+}
@@ -0,0 +1,1049 @@
+#include "pch.h"
+#include "Utils.h"
+#include "MappedFile.h"
+#include "Parallel.h"
+#include "TangentSpace.h"
+
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+namespace dae
+{
+	namespace Utils
+	{
+		namespace
+		{
+			constexpr uint32_t NoMaterial = UINT32_MAX;
+			// Files smaller than this are not worth splitting over several threads
+			constexpr size_t MinChunkSize = 1 << 20;
+
+			struct ObjRecordCounts
+			{
+				size_t positions{};
+				size_t UVs{};
+				size_t normals{};
+				size_t faces{};
+			};
+
+			const char* FindLineEnd(const char* pos, const char* end)
+			{
+				const void* newLinePtr = std::memchr(pos, '\n', static_cast<size_t>(end - pos));
+				return newLinePtr ? static_cast<const char*>(newLinePtr) : end;
+			}
+
+			const char* SkipSpaces(const char* pos, const char* end)
+			{
+				while (pos < end and (*pos == ' ' or *pos == '\t' or *pos == '\r'))
+					++pos;
+				return pos;
+			}
+
+			const char* ParseFloat(const char* pos, const char* end, float& value)
+			{
+				pos = SkipSpaces(pos, end);
+				if (pos < end and *pos == '+')
+					++pos;
+
+				const auto [ptr, ec] = std::from_chars(pos, end, value);
+				if (ec != std::errc{})
+					value = 0.f;
+				return ptr;
+			}
+
+			// Returns the zero based index, negative OBJ indices are relative to the records read so far
+			const char* ParseIndex(const char* pos, const char* end, size_t countSoFar, int32_t& index, bool& isRelative, bool& isValid)
+			{
+				int32_t rawIndex{};
+				const auto [ptr, ec] = std::from_chars(pos, end, rawIndex);
+				isValid = ec == std::errc{} and rawIndex != 0;
+				isRelative = rawIndex < 0;
+				index = isRelative ? static_cast<int32_t>(countSoFar) + rawIndex : rawIndex - 1;
+				return ptr;
+			}
+
+			// Index triple of a face corner, attributes a corner does not reference are stored as NoIndex
+			struct CornerKey
+			{
+				static constexpr uint32_t NoIndex = UINT32_MAX;
+
+				uint32_t position{ NoIndex };
+				uint32_t uv{ NoIndex };
+				uint32_t normal{ NoIndex };
+
+				bool operator==(const CornerKey& other) const = default;
+			};
+
+			// Open addressing map from a corner's index triple to the vertex that was emitted for it
+			class VertexWeldMap final
+			{
+			public:
+				VertexWeldMap(size_t expectedCorners)
+				{
+					Rehash(expectedCorners * 2);
+				}
+
+				// Returns the vertex stored for the key, or stores and returns newVertexIndex when the key is new
+				uint32_t FindOrInsert(const CornerKey& key, uint32_t newVertexIndex)
+				{
+					if ((m_NumEntries + 1) * 2 > m_Slots.size())
+						Rehash(m_Slots.size() * 2);
+
+					size_t slotIndex = Hash(key) & m_Mask;
+					while (m_Slots[slotIndex].vertexIndex != CornerKey::NoIndex)
+					{
+						if (m_Slots[slotIndex].key == key)
+							return m_Slots[slotIndex].vertexIndex;
+						slotIndex = (slotIndex + 1) & m_Mask;
+					}
+
+					m_Slots[slotIndex] = { key, newVertexIndex };
+					++m_NumEntries;
+					return newVertexIndex;
+				}
+
+				void Clear()
+				{
+					std::fill(m_Slots.begin(), m_Slots.end(), Slot{});
+					m_NumEntries = 0;
+				}
+
+				size_t GetMemoryBytes() const { return m_Slots.capacity() * sizeof(Slot); }
+
+			private:
+				struct Slot
+				{
+					CornerKey key{};
+					uint32_t vertexIndex{ CornerKey::NoIndex };
+				};
+
+				static size_t Hash(const CornerKey& key)
+				{
+					uint64_t hash = key.position * 0x9E3779B97F4A7C15ull;
+					hash ^= (key.uv + 0x632BE59BD9B4E019ull) * 0xC2B2AE3D27D4EB4Full;
+					hash ^= (key.normal + 0x85EBCA77C2B2AE63ull) * 0x165667B19E3779F9ull;
+					return static_cast<size_t>(hash ^ (hash >> 29));
+				}
+
+				void Rehash(size_t minSlots)
+				{
+					size_t numSlots = 64;
+					while (numSlots < minSlots)
+						numSlots *= 2;
+
+					std::vector<Slot> oldSlots(numSlots);
+					oldSlots.swap(m_Slots);
+					m_Mask = numSlots - 1;
+
+					for (const Slot& slot : oldSlots)
+					{
+						if (slot.vertexIndex == CornerKey::NoIndex)
+							continue;
+
+						size_t slotIndex = Hash(slot.key) & m_Mask;
+						while (m_Slots[slotIndex].vertexIndex != CornerKey::NoIndex)
+							slotIndex = (slotIndex + 1) & m_Mask;
+						m_Slots[slotIndex] = slot;
+					}
+				}
+
+				std::vector<Slot> m_Slots{};
+				size_t m_Mask{};
+				size_t m_NumEntries{};
+			};
+
+			// Face corner as read from the file, relative indices are still relative to the start of their chunk
+			struct ObjCorner
+			{
+				static constexpr uint32_t HasUV = 1 << 0;
+				static constexpr uint32_t HasNormal = 1 << 1;
+				static constexpr uint32_t RelativePosition = 1 << 2;
+				static constexpr uint32_t RelativeUV = 1 << 3;
+				static constexpr uint32_t RelativeNormal = 1 << 4;
+
+				int32_t position{};
+				int32_t uv{};
+				int32_t normal{};
+				uint32_t flags{};
+			};
+
+			// Everything one worker read from its range of lines
+			struct ObjChunk
+			{
+				std::vector<Vector3> positions{};
+				std::vector<Vector3> normals{};
+				std::vector<Vector2> UVs{};
+				std::vector<ObjCorner> corners{};
+				std::vector<uint32_t> faceSizes{};
+				// usemtl names with the number of faces of this chunk that came before them
+				std::vector<std::pair<size_t, std::string>> materialSwitches{};
+				std::vector<std::string> materialLibraries{};
+				ObjRecordCounts counts{};
+				bool isValid{ true };
+			};
+
+			enum class ObjRecordType
+			{
+				Position,
+				UV,
+				Normal,
+				Face,
+				MaterialLibrary,
+				UseMaterial,
+				Other,
+			};
+
+			// Looks at the keyword of a line, pos points past the leading spaces and is moved past the keyword
+			ObjRecordType ClassifyLine(const char*& pos, const char* lineEnd)
+			{
+				if (lineEnd - pos < 2)
+					return ObjRecordType::Other;
+
+				const bool isSeparated = pos[1] == ' ' or pos[1] == '\t';
+				if (pos[0] == 'v')
+				{
+					if (isSeparated) { pos += 1; return ObjRecordType::Position; }
+					if (pos[1] == 't') { pos += 2; return ObjRecordType::UV; }
+					if (pos[1] == 'n') { pos += 2; return ObjRecordType::Normal; }
+				}
+				else if (pos[0] == 'f' and isSeparated)
+				{
+					pos += 1;
+					return ObjRecordType::Face;
+				}
+				else if (lineEnd - pos > 6 and (pos[6] == ' ' or pos[6] == '\t'))
+				{
+					const std::string_view keyword{ pos, 6 };
+					if (keyword == "mtllib") { pos += 6; return ObjRecordType::MaterialLibrary; }
+					if (keyword == "usemtl") { pos += 6; return ObjRecordType::UseMaterial; }
+				}
+				return ObjRecordType::Other;
+			}
+
+			// Rest of the line without surrounding spaces (and without the '\r' of CRLF files)
+			std::string ParseName(const char* pos, const char* lineEnd)
+			{
+				pos = SkipSpaces(pos, lineEnd);
+				while (lineEnd > pos and (lineEnd[-1] == ' ' or lineEnd[-1] == '\t' or lineEnd[-1] == '\r'))
+					--lineEnd;
+				return { pos, lineEnd };
+			}
+
+			Vector3 ParseVector3(const char* pos, const char* lineEnd)
+			{
+				float x, y, z;
+				pos = ParseFloat(pos, lineEnd, x);
+				pos = ParseFloat(pos, lineEnd, y);
+				ParseFloat(pos, lineEnd, z);
+				return { x, y, z };
+			}
+
+			Vector2 ParseUV(const char* pos, const char* lineEnd)
+			{
+				float u, v;
+				pos = ParseFloat(pos, lineEnd, u);
+				ParseFloat(pos, lineEnd, v);
+				return { u, 1 - v };
+			}
+
+			// Appends the corners of one face, relative indices are resolved against the records counted so far
+			// A corner without uv or normal keeps the one of the previous corner like the old tokenizer did
+			bool ParseFace(const char* pos, const char* lineEnd, const ObjRecordCounts& countsSoFar, std::vector<ObjCorner>& corners, uint32_t& faceSize)
+			{
+				ObjCorner corner{};
+				faceSize = 0;
+
+				pos = SkipSpaces(pos, lineEnd);
+				while (pos < lineEnd)
+				{
+					bool isRelative{}, isValid{};
+
+					pos = ParseIndex(pos, lineEnd, countsSoFar.positions, corner.position, isRelative, isValid);
+					if (!isValid)
+						return false;
+					corner.flags = (corner.flags & ~ObjCorner::RelativePosition) | (isRelative ? ObjCorner::RelativePosition : 0u);
+
+					if (pos < lineEnd and *pos == '/')
+					{
+						++pos;
+						if (pos < lineEnd and *pos != '/')
+						{
+							// Optional texture coordinate
+							pos = ParseIndex(pos, lineEnd, countsSoFar.UVs, corner.uv, isRelative, isValid);
+							corner.flags = (corner.flags & ~ObjCorner::RelativeUV) | ObjCorner::HasUV | (isRelative ? ObjCorner::RelativeUV : 0u);
+						}
+
+						if (isValid and pos < lineEnd and *pos == '/')
+						{
+							// Optional vertex normal
+							pos = ParseIndex(pos + 1, lineEnd, countsSoFar.normals, corner.normal, isRelative, isValid);
+							corner.flags = (corner.flags & ~ObjCorner::RelativeNormal) | ObjCorner::HasNormal | (isRelative ? ObjCorner::RelativeNormal : 0u);
+						}
+
+						if (!isValid)
+							return false;
+					}
+
+					corners.push_back(corner);
+					++faceSize;
+					pos = SkipSpaces(pos, lineEnd);
+				}
+				return true;
+			}
+
+			ObjRecordCounts CountRecords(const char* begin, const char* end)
+			{
+				ObjRecordCounts counts{};
+				for (const char* lineBegin = begin; lineBegin < end;)
+				{
+					const char* lineEnd = FindLineEnd(lineBegin, end);
+					const char* pos = SkipSpaces(lineBegin, lineEnd);
+					switch (ClassifyLine(pos, lineEnd))
+					{
+					case ObjRecordType::Position: ++counts.positions; break;
+					case ObjRecordType::UV: ++counts.UVs; break;
+					case ObjRecordType::Normal: ++counts.normals; break;
+					case ObjRecordType::Face: ++counts.faces; break;
+					default: break;
+					}
+					lineBegin = lineEnd + 1;
+				}
+				return counts;
+			}
+
+			// Chunk boundaries for numChunks roughly equal ranges, each boundary moved to the start of a line
+			std::vector<const char*> SplitAtLines(const char* begin, const char* end, size_t numChunks)
+			{
+				std::vector<const char*> bounds{ begin };
+				const size_t chunkSize = static_cast<size_t>(end - begin) / numChunks;
+				for (size_t chunkIndex = 1; chunkIndex < numChunks; ++chunkIndex)
+				{
+					const char* bound = std::max(bounds.back(), begin + chunkIndex * chunkSize);
+					bound = FindLineEnd(bound, end);
+					bounds.push_back(bound < end ? bound + 1 : end);
+				}
+				bounds.push_back(end);
+				return bounds;
+			}
+
+			void ParseChunk(const char* begin, const char* end, ObjChunk& chunk)
+			{
+				// First pass only looks at the start of every line, so that every array is allocated once
+				chunk.counts = CountRecords(begin, end);
+				chunk.positions.reserve(chunk.counts.positions);
+				chunk.normals.reserve(chunk.counts.normals);
+				chunk.UVs.reserve(chunk.counts.UVs);
+				chunk.corners.reserve(chunk.counts.faces * 3);
+				chunk.faceSizes.reserve(chunk.counts.faces);
+
+				ObjRecordCounts countsSoFar{};
+				for (const char* lineBegin = begin; lineBegin < end;)
+				{
+					const char* lineEnd = FindLineEnd(lineBegin, end);
+					const char* pos = SkipSpaces(lineBegin, lineEnd);
+
+					switch (ClassifyLine(pos, lineEnd))
+					{
+					case ObjRecordType::Position:
+						chunk.positions.push_back(ParseVector3(pos, lineEnd));
+						++countsSoFar.positions;
+						break;
+					case ObjRecordType::UV:
+						chunk.UVs.push_back(ParseUV(pos, lineEnd));
+						++countsSoFar.UVs;
+						break;
+					case ObjRecordType::Normal:
+						chunk.normals.push_back(ParseVector3(pos, lineEnd));
+						++countsSoFar.normals;
+						break;
+					case ObjRecordType::Face:
+					{
+						uint32_t faceSize{};
+						if (!ParseFace(pos, lineEnd, countsSoFar, chunk.corners, faceSize))
+						{
+							chunk.isValid = false;
+							return;
+						}
+						chunk.faceSizes.push_back(faceSize);
+						break;
+					}
+					case ObjRecordType::MaterialLibrary:
+						chunk.materialLibraries.push_back(ParseName(pos, lineEnd));
+						break;
+					case ObjRecordType::UseMaterial:
+						chunk.materialSwitches.emplace_back(chunk.faceSizes.size(), ParseName(pos, lineEnd));
+						break;
+					default:
+						break;
+					}
+
+					lineBegin = lineEnd + 1;
+				}
+			}
+
+			// Decodes attribute records of one type on demand, in blocks of BlockSize records, and keeps at most maxBlocks of them
+			// Only the start of every block is remembered, which grows BlockSize times slower than the attributes themselves
+			class AttributeBlockCache final
+			{
+			public:
+				static constexpr size_t BlockSize = 4096;
+
+				AttributeBlockCache(ObjRecordType type, const char* fileEnd, size_t maxBlocks)
+					: m_Type{ type }
+					, m_FileEndPtr{ fileEnd }
+					, m_MaxBlocks{ std::max<size_t>(maxBlocks, 1) }
+				{
+				}
+
+				void AddRecord(const char* lineBegin)
+				{
+					if (m_NumRecords % BlockSize == 0)
+					{
+						m_BlockStarts.push_back(lineBegin);
+						m_BlockSlots.push_back(NoSlot);
+					}
+					++m_NumRecords;
+				}
+
+				size_t GetNumRecords() const { return m_NumRecords; }
+				size_t GetNumBlockLoads() const { return m_NumBlockLoads; }
+
+				size_t GetMemoryBytes() const
+				{
+					return m_Slots.size() * BlockSize * sizeof(Vector3) + m_BlockStarts.capacity() * sizeof(const char*) + m_BlockSlots.capacity() * sizeof(uint32_t);
+				}
+
+				const Vector3& Get(size_t index)
+				{
+					const size_t blockIndex = index / BlockSize;
+					if (blockIndex != m_LastBlockIndex)
+					{
+						m_LastSlot = FindOrLoad(blockIndex);
+						m_LastBlockIndex = blockIndex;
+						m_Slots[m_LastSlot].lastUse = ++m_UseCounter;
+					}
+					return m_Slots[m_LastSlot].records[index % BlockSize];
+				}
+
+			private:
+				static constexpr uint32_t NoSlot = UINT32_MAX;
+
+				struct Slot
+				{
+					size_t blockIndex{};
+					uint64_t lastUse{};
+					std::vector<Vector3> records{};
+				};
+
+				uint32_t FindOrLoad(size_t blockIndex)
+				{
+					if (m_BlockSlots[blockIndex] != NoSlot)
+						return m_BlockSlots[blockIndex];
+
+					uint32_t slotIndex{};
+					if (m_Slots.size() < m_MaxBlocks)
+					{
+						slotIndex = static_cast<uint32_t>(m_Slots.size());
+						m_Slots.emplace_back().records.reserve(BlockSize);
+					}
+					else
+					{
+						// Least recently used block makes room
+						for (uint32_t i = 1; i < m_Slots.size(); ++i)
+						{
+							if (m_Slots[i].lastUse < m_Slots[slotIndex].lastUse)
+								slotIndex = i;
+						}
+						m_BlockSlots[m_Slots[slotIndex].blockIndex] = NoSlot;
+					}
+
+					Slot& slot = m_Slots[slotIndex];
+					slot.blockIndex = blockIndex;
+					slot.records.clear();
+					for (const char* lineBegin = m_BlockStarts[blockIndex]; lineBegin < m_FileEndPtr and slot.records.size() < BlockSize;)
+					{
+						const char* lineEnd = FindLineEnd(lineBegin, m_FileEndPtr);
+						const char* pos = SkipSpaces(lineBegin, lineEnd);
+						if (ClassifyLine(pos, lineEnd) == m_Type)
+						{
+							if (m_Type == ObjRecordType::UV)
+							{
+								const Vector2 uv = ParseUV(pos, lineEnd);
+								slot.records.emplace_back(uv.x, uv.y, 0.f);
+							}
+							else
+							{
+								slot.records.push_back(ParseVector3(pos, lineEnd));
+							}
+						}
+						lineBegin = lineEnd + 1;
+					}
+
+					++m_NumBlockLoads;
+					m_BlockSlots[blockIndex] = slotIndex;
+					return slotIndex;
+				}
+
+				ObjRecordType m_Type;
+				const char* m_FileEndPtr;
+				size_t m_MaxBlocks;
+
+				size_t m_NumRecords{};
+				std::vector<const char*> m_BlockStarts{};
+				std::vector<uint32_t> m_BlockSlots{};
+				std::vector<Slot> m_Slots{};
+
+				size_t m_LastBlockIndex{ SIZE_MAX };
+				uint32_t m_LastSlot{};
+				uint64_t m_UseCounter{};
+				size_t m_NumBlockLoads{};
+			};
+
+			// Polygons are split up as a fan around their first corner
+			void AddFanTriangle(std::vector<uint32_t>& indices, uint32_t firstIndex, uint32_t previousIndex, uint32_t vertexIndex, bool flipWinding)
+			{
+				indices.push_back(firstIndex);
+				if (flipWinding)
+				{
+					indices.push_back(vertexIndex);
+					indices.push_back(previousIndex);
+				}
+				else
+				{
+					indices.push_back(previousIndex);
+					indices.push_back(vertexIndex);
+				}
+			}
+
+			// Stable counting sort of the triangles by material id, then one index range per material
+			std::vector<OBJSubmesh> GroupTrianglesByMaterial(std::vector<uint32_t>& indices, const std::vector<uint32_t>& triangleMaterials, const std::vector<std::string>& materialNames)
+			{
+				std::vector<uint32_t> firstTriangles(materialNames.size() + 1, 0);
+				for (const uint32_t materialId : triangleMaterials)
+					++firstTriangles[materialId + 1];
+				for (size_t materialId = 0; materialId < materialNames.size(); ++materialId)
+					firstTriangles[materialId + 1] += firstTriangles[materialId];
+
+				// With a single material the triangles are already in place
+				if (materialNames.size() > 1)
+				{
+					std::vector<uint32_t> groupedIndices(indices.size());
+					std::vector<uint32_t> nextTriangles(firstTriangles.begin(), firstTriangles.end() - 1);
+					for (size_t triangle = 0; triangle < triangleMaterials.size(); ++triangle)
+					{
+						const size_t target = nextTriangles[triangleMaterials[triangle]]++;
+						std::copy_n(&indices[triangle * 3], 3, &groupedIndices[target * 3]);
+					}
+					indices.swap(groupedIndices);
+				}
+
+				std::vector<OBJSubmesh> submeshes{};
+				for (size_t materialId = 0; materialId < materialNames.size(); ++materialId)
+					submeshes.push_back({ materialNames[materialId], firstTriangles[materialId] * 3, (firstTriangles[materialId + 1] - firstTriangles[materialId]) * 3 });
+				return submeshes;
+			}
+
+			//Tangents are generated after the flip, so their handedness matches the space the shader works in
+			void CalculateTangents(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, bool flipAxisAndWinding, uint32_t numThreads)
+			{
+				if (flipAxisAndWinding)
+				{
+					for (Vertex& vertex : vertices)
+					{
+						vertex.position.z *= -1.f;
+						vertex.normal.z *= -1.f;
+					}
+				}
+
+				TangentSpace::Generate(vertices, indices, numThreads);
+			}
+		}
+
+		bool ParseOBJ(const std::string& filename, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, const ParseOBJOptions& options, OBJMaterialData* materialDataPtr, OBJParseStats* statsPtr)
+		{
+			const MappedFile file{ filename };
+			if (!file.IsOpen())
+				return false;
+
+			const char* begin = file.GetData();
+			const char* end = begin + file.GetSize();
+
+			// Every chunk starts on a line boundary and is read on its own thread
+			const uint32_t numThreads = options.numThreads > 0 ? options.numThreads : GetDefaultThreadCount();
+			const size_t numChunks = std::clamp<size_t>(file.GetSize() / MinChunkSize, 1, numThreads);
+			const std::vector<const char*> chunkBounds = SplitAtLines(begin, end, numChunks);
+
+			std::vector<ObjChunk> chunks(numChunks);
+			ParallelFor(numChunks, numThreads, [&](size_t chunkIndex)
+				{
+					ParseChunk(chunkBounds[chunkIndex], chunkBounds[chunkIndex + 1], chunks[chunkIndex]);
+				});
+
+			// Stitch the chunks back together in file order, so the result does not depend on the thread count
+			size_t numPositions{}, numNormals{}, numUVs{}, numCorners{}, numTriangles{};
+			for (const ObjChunk& chunk : chunks)
+			{
+				if (!chunk.isValid)
+					return false;
+
+				numPositions += chunk.positions.size();
+				numNormals += chunk.normals.size();
+				numUVs += chunk.UVs.size();
+				numCorners += chunk.corners.size();
+				for (const uint32_t faceSize : chunk.faceSizes)
+					numTriangles += faceSize >= 3 ? faceSize - 2 : 0;
+			}
+
+			std::vector<Vector3> positions{};
+			std::vector<Vector3> normals{};
+			std::vector<Vector2> UVs{};
+			positions.reserve(numPositions);
+			normals.reserve(numNormals);
+			UVs.reserve(numUVs);
+			for (ObjChunk& chunk : chunks)
+			{
+				positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+				normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+				UVs.insert(UVs.end(), chunk.UVs.begin(), chunk.UVs.end());
+				chunk.positions = {};
+				chunk.normals = {};
+				chunk.UVs = {};
+			}
+
+			vertices.clear();
+			indices.clear();
+			vertices.reserve(options.weldVertices ? numPositions : numCorners);
+			indices.reserve(numTriangles * 3);
+
+			VertexWeldMap weldMap{ options.weldVertices ? numCorners : 0 };
+
+			// Turns a chunk relative index into an absolute one, using the prefix summed record counts
+			const auto resolve = [](int32_t index, bool isRelative, size_t chunkOffset, size_t count, uint32_t& result)
+				{
+					const int64_t absolute = isRelative ? static_cast<int64_t>(chunkOffset) + index : index;
+					result = static_cast<uint32_t>(absolute);
+					return absolute >= 0 and absolute < static_cast<int64_t>(count);
+				};
+
+			// Every triangle remembers the material of its face, materials get their id when their first face shows up
+			std::vector<std::string> materialNames{};
+			std::unordered_map<std::string, uint32_t> materialIds{};
+			std::vector<uint32_t> triangleMaterials{};
+			triangleMaterials.reserve(numTriangles);
+			std::string currentMaterial{};
+			uint32_t currentMaterialId{ NoMaterial };
+
+			size_t positionOffset{}, normalOffset{}, UVOffset{};
+			for (const ObjChunk& chunk : chunks)
+			{
+				const ObjCorner* cornerPtr = chunk.corners.data();
+				auto materialSwitchIt = chunk.materialSwitches.begin();
+				for (size_t faceIndex = 0; faceIndex < chunk.faceSizes.size(); ++faceIndex)
+				{
+					for (; materialSwitchIt != chunk.materialSwitches.end() and materialSwitchIt->first == faceIndex; ++materialSwitchIt)
+					{
+						currentMaterial = materialSwitchIt->second;
+						currentMaterialId = NoMaterial;
+					}
+					if (currentMaterialId == NoMaterial)
+					{
+						const auto [materialIt, isNew] = materialIds.try_emplace(currentMaterial, static_cast<uint32_t>(materialNames.size()));
+						if (isNew)
+							materialNames.push_back(currentMaterial);
+						currentMaterialId = materialIt->second;
+					}
+
+					const uint32_t faceSize = chunk.faceSizes[faceIndex];
+					if (faceSize >= 3)
+						triangleMaterials.insert(triangleMaterials.end(), faceSize - 2, currentMaterialId);
+
+					Vertex vertex{};
+					uint32_t firstIndex{};
+					uint32_t previousIndex{};
+
+					for (uint32_t cornerIndex = 0; cornerIndex < faceSize; ++cornerIndex, ++cornerPtr)
+					{
+						const ObjCorner& corner = *cornerPtr;
+						CornerKey key{};
+
+						if (!resolve(corner.position, corner.flags & ObjCorner::RelativePosition, positionOffset, numPositions, key.position))
+							return false;
+						vertex.position = positions[key.position];
+
+						if (corner.flags & ObjCorner::HasUV)
+						{
+							if (!resolve(corner.uv, corner.flags & ObjCorner::RelativeUV, UVOffset, numUVs, key.uv))
+								return false;
+							vertex.uv = UVs[key.uv];
+						}
+
+						if (corner.flags & ObjCorner::HasNormal)
+						{
+							if (!resolve(corner.normal, corner.flags & ObjCorner::RelativeNormal, normalOffset, numNormals, key.normal))
+								return false;
+							vertex.normal = normals[key.normal];
+						}
+
+						uint32_t vertexIndex = static_cast<uint32_t>(vertices.size());
+						if (options.weldVertices)
+							vertexIndex = weldMap.FindOrInsert(key, vertexIndex);
+						if (vertexIndex == vertices.size())
+							vertices.push_back(vertex);
+
+						if (cornerIndex == 0)
+							firstIndex = vertexIndex;
+						else if (cornerIndex >= 2)
+							AddFanTriangle(indices, firstIndex, previousIndex, vertexIndex, options.flipAxisAndWinding);
+
+						previousIndex = vertexIndex;
+					}
+				}
+
+				// A usemtl after the last face of a chunk still applies to the faces of the next one
+				for (; materialSwitchIt != chunk.materialSwitches.end(); ++materialSwitchIt)
+				{
+					currentMaterial = materialSwitchIt->second;
+					currentMaterialId = NoMaterial;
+				}
+
+				positionOffset += chunk.counts.positions;
+				normalOffset += chunk.counts.normals;
+				UVOffset += chunk.counts.UVs;
+			}
+
+			// Shared corners accumulate the tangents of all their triangles, so welded tangents come out smoothed
+			CalculateTangents(vertices, indices, options.flipAxisAndWinding, options.numThreads);
+
+			std::vector<OBJSubmesh> submeshes = GroupTrianglesByMaterial(indices, triangleMaterials, materialNames);
+			if (materialDataPtr)
+			{
+				materialDataPtr->libraries.clear();
+				for (const ObjChunk& chunk : chunks)
+					materialDataPtr->libraries.insert(materialDataPtr->libraries.end(), chunk.materialLibraries.begin(), chunk.materialLibraries.end());
+				materialDataPtr->submeshes = std::move(submeshes);
+			}
+
+			if (statsPtr)
+			{
+				statsPtr->numCorners = numCorners;
+				statsPtr->numVertices = vertices.size();
+			}
+			return true;
+		}
+
+		bool StreamOBJ(const std::string& filename, const std::function<void(const OBJBatch&)>& sink, const StreamOBJOptions& options, OBJStreamStats* statsPtr)
+		{
+			const MappedFile file{ filename };
+			if (!file.IsOpen())
+				return false;
+
+			const char* begin = file.GetData();
+			const char* end = begin + file.GetSize();
+
+			// Half of the budget holds decoded attribute blocks, the other half the batch that is being built
+			const size_t blocksPerType = options.memoryBudget / 2 / 3 / (AttributeBlockCache::BlockSize * sizeof(Vector3));
+			AttributeBlockCache positions{ ObjRecordType::Position, end, blocksPerType };
+			AttributeBlockCache UVs{ ObjRecordType::UV, end, blocksPerType };
+			AttributeBlockCache normals{ ObjRecordType::Normal, end, blocksPerType };
+
+			// A triangle adds at most 3 vertices, 3 indices and 3 weld map entries, which take up to 4 slots each after rounding
+			constexpr size_t bytesPerTriangle = 3 * (sizeof(Vertex) + sizeof(uint32_t) + 4 * (sizeof(CornerKey) + sizeof(uint32_t)));
+			const size_t maxBatchTriangles = std::max<size_t>(options.memoryBudget / 2 / bytesPerTriangle, 1);
+
+			std::vector<Vertex> vertices{};
+			std::vector<uint32_t> indices{};
+			vertices.reserve(maxBatchTriangles * 3);
+			indices.reserve(maxBatchTriangles * 3);
+			VertexWeldMap weldMap{ maxBatchTriangles * 3 };
+
+			std::vector<ObjCorner> faceCorners{};
+			OBJStreamStats stats{};
+
+			const auto flush = [&]()
+				{
+					if (indices.empty())
+						return;
+
+					CalculateTangents(vertices, indices, options.flipAxisAndWinding, 0);
+					sink(OBJBatch{ vertices, indices, static_cast<uint32_t>(stats.numVertices) });
+
+					++stats.numBatches;
+					stats.numVertices += vertices.size();
+					stats.numIndices += indices.size();
+					stats.peakBytes = std::max(stats.peakBytes, vertices.capacity() * sizeof(Vertex) + indices.capacity() * sizeof(uint32_t)
+						+ weldMap.GetMemoryBytes() + faceCorners.capacity() * sizeof(ObjCorner)
+						+ positions.GetMemoryBytes() + UVs.GetMemoryBytes() + normals.GetMemoryBytes());
+
+					vertices.clear();
+					indices.clear();
+					weldMap.Clear();
+				};
+
+			for (const char* lineBegin = begin; lineBegin < end;)
+			{
+				const char* lineEnd = FindLineEnd(lineBegin, end);
+				const char* pos = SkipSpaces(lineBegin, lineEnd);
+
+				switch (ClassifyLine(pos, lineEnd))
+				{
+				case ObjRecordType::Position: positions.AddRecord(lineBegin); break;
+				case ObjRecordType::UV: UVs.AddRecord(lineBegin); break;
+				case ObjRecordType::Normal: normals.AddRecord(lineBegin); break;
+				case ObjRecordType::Face:
+				{
+					// Faces may only use attributes defined above them, which is what the OBJ format requires anyway
+					const ObjRecordCounts countsSoFar{ positions.GetNumRecords(), UVs.GetNumRecords(), normals.GetNumRecords(), 0 };
+					uint32_t faceSize{};
+					faceCorners.clear();
+					if (!ParseFace(pos, lineEnd, countsSoFar, faceCorners, faceSize))
+						return false;
+
+					if (faceSize >= 3 and indices.size() / 3 + faceSize - 2 > maxBatchTriangles)
+						flush();
+
+					Vertex vertex{};
+					uint32_t firstIndex{};
+					uint32_t previousIndex{};
+					for (uint32_t cornerIndex = 0; cornerIndex < faceSize; ++cornerIndex)
+					{
+						const ObjCorner& corner = faceCorners[cornerIndex];
+						CornerKey key{};
+
+						// With a single chunk, relative indices were already resolved against the whole file
+						if (corner.position < 0 or static_cast<size_t>(corner.position) >= countsSoFar.positions)
+							return false;
+						key.position = static_cast<uint32_t>(corner.position);
+						vertex.position = positions.Get(key.position);
+
+						if (corner.flags & ObjCorner::HasUV)
+						{
+							if (corner.uv < 0 or static_cast<size_t>(corner.uv) >= countsSoFar.UVs)
+								return false;
+							key.uv = static_cast<uint32_t>(corner.uv);
+							const Vector3& uv = UVs.Get(key.uv);
+							vertex.uv = { uv.x, uv.y };
+						}
+
+						if (corner.flags & ObjCorner::HasNormal)
+						{
+							if (corner.normal < 0 or static_cast<size_t>(corner.normal) >= countsSoFar.normals)
+								return false;
+							key.normal = static_cast<uint32_t>(corner.normal);
+							vertex.normal = normals.Get(key.normal);
+						}
+
+						const uint32_t vertexIndex = weldMap.FindOrInsert(key, static_cast<uint32_t>(vertices.size()));
+						if (vertexIndex == vertices.size())
+							vertices.push_back(vertex);
+
+						if (cornerIndex == 0)
+							firstIndex = vertexIndex;
+						else if (cornerIndex >= 2)
+							AddFanTriangle(indices, firstIndex, previousIndex, vertexIndex, options.flipAxisAndWinding);
+
+						previousIndex = vertexIndex;
+					}
+					break;
+				}
+				default:
+					break;
+				}
+
+				lineBegin = lineEnd + 1;
+			}
+
+			flush();
+
+			stats.numBlockLoads = positions.GetNumBlockLoads() + UVs.GetNumBlockLoads() + normals.GetNumBlockLoads();
+			if (statsPtr)
+				*statsPtr = stats;
+			return true;
+		}
+
+		bool ParseMTL(const std::string& filename, std::vector<MTLMaterial>& materials)
+		{
+			const MappedFile file{ filename };
+			if (!file.IsOpen())
+				return false;
+
+			const std::filesystem::path folder = std::filesystem::path{ filename }.parent_path();
+			const auto resolveMap = [&](const char* pos, const char* lineEnd)
+				{
+					// Options like -bm 1.0 come before the file name, which is the last token of the line
+					const std::string arguments = ParseName(pos, lineEnd);
+					const size_t nameStart = arguments.find_last_of(" \t");
+					const std::string name = nameStart == std::string::npos ? arguments : arguments.substr(nameStart + 1);
+					return (folder / name).generic_string();
+				};
+
+			const char* end = file.GetData() + file.GetSize();
+			MTLMaterial* materialPtr = nullptr;
+			for (const char* lineBegin = file.GetData(); lineBegin < end;)
+			{
+				const char* lineEnd = FindLineEnd(lineBegin, end);
+				const char* pos = SkipSpaces(lineBegin, lineEnd);
+				const char* keywordEnd = pos;
+				while (keywordEnd < lineEnd and *keywordEnd != ' ' and *keywordEnd != '\t')
+					++keywordEnd;
+
+				const std::string_view keyword{ pos, static_cast<size_t>(keywordEnd - pos) };
+				if (keyword == "newmtl")
+				{
+					materialPtr = &materials.emplace_back();
+					materialPtr->name = ParseName(keywordEnd, lineEnd);
+				}
+				else if (materialPtr and keyword == "Kd")
+				{
+					const Vector3 color = ParseVector3(keywordEnd, lineEnd);
+					materialPtr->diffuseColor = { color.x, color.y, color.z };
+				}
+				else if (materialPtr and keyword == "map_Kd")
+					materialPtr->diffuseMap = resolveMap(keywordEnd, lineEnd);
+				else if (materialPtr and (keyword == "norm" or keyword == "map_Bump" or keyword == "map_bump" or keyword == "bump"))
+					materialPtr->normalMap = resolveMap(keywordEnd, lineEnd);
+				else if (materialPtr and keyword == "map_Ks")
+					materialPtr->specularMap = resolveMap(keywordEnd, lineEnd);
+				else if (materialPtr and keyword == "map_Ns")
+					materialPtr->glossinessMap = resolveMap(keywordEnd, lineEnd);
+
+				lineBegin = lineEnd + 1;
+			}
+			return true;
+		}
+
+		bool ParseOBJIfstream(const std::string& filename, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding)
+		{
+			std::ifstream file(filename);
+			if (!file)
+				return false;
+
+			std::vector<Vector3> positions{};
+			std::vector<Vector3> normals{};
+			std::vector<Vector2> UVs{};
+
+			vertices.clear();
+			indices.clear();
+
+			std::string sCommand;
+			// start a while iteration ending when the end of file is reached (ios::eof)
+			while (!file.eof())
+			{
+				//read the first word of the string, use the >> operator (istream::operator>>)
+				file >> sCommand;
+				//use conditional statements to process the different commands
+				if (sCommand == "#")
+				{
+					// Ignore Comment
+				}
+				else if (sCommand == "v")
+				{
+					//Vertex
+					float x, y, z;
+					file >> x >> y >> z;
+
+					positions.emplace_back(x, y, z);
+				}
+				else if (sCommand == "vt")
+				{
+					// Vertex TexCoord
+					float u, v;
+					file >> u >> v;
+					UVs.emplace_back(u, 1 - v);
+				}
+				else if (sCommand == "vn")
+				{
+					// Vertex Normal
+					float x, y, z;
+					file >> x >> y >> z;
+
+					normals.emplace_back(x, y, z);
+				}
+				else if (sCommand == "f")
+				{
+					//if a face is read:
+					//construct the 3 vertices, add them to the vertex array
+					//add three indices to the index array
+					//add the material index as attibute to the attribute array
+					//
+					// Faces or triangles
+					Vertex vertex{};
+					size_t iPosition, iTexCoord, iNormal;
+
+					uint32_t tempIndices[3];
+					for (size_t iFace = 0; iFace < 3; iFace++)
+					{
+						// OBJ format uses 1-based arrays
+						file >> iPosition;
+						vertex.position = positions[iPosition - 1];
+
+						if ('/' == file.peek())//is next in buffer ==  '/' ?
+						{
+							file.ignore();//read and ignore one element ('/')
+
+							if ('/' != file.peek())
+							{
+								// Optional texture coordinate
+								file >> iTexCoord;
+								vertex.uv = UVs[iTexCoord - 1];
+							}
+
+							if ('/' == file.peek())
+							{
+								file.ignore();
+
+								// Optional vertex normal
+								file >> iNormal;
+								vertex.normal = normals[iNormal - 1];
+							}
+						}
+
+						vertices.push_back(vertex);
+						tempIndices[iFace] = uint32_t(vertices.size()) - 1;
+						//indices.push_back(uint32_t(vertices.size()) - 1);
+					}
+
+					indices.push_back(tempIndices[0]);
+					if (flipAxisAndWinding)
+					{
+						indices.push_back(tempIndices[2]);
+						indices.push_back(tempIndices[1]);
+					}
+					else
+					{
+						indices.push_back(tempIndices[1]);
+						indices.push_back(tempIndices[2]);
+					}
+				}
+				//read till end of line and ignore all remaining chars
+				file.ignore(1000, '\n');
+			}
+
+			CalculateTangents(vertices, indices, flipAxisAndWinding, 0);
+			return true;
+		}
+
+		uint64_t HashBytes(const char* dataPtr, size_t size, uint64_t seed)
+		{
+			constexpr uint64_t prime0 = 0x9E3779B185EBCA87ull;
+			constexpr uint64_t prime1 = 0xC2B2AE3D27D4EB4Full;
+
+			uint64_t hash = seed ^ (size * prime0);
+			size_t offset = 0;
+			for (; offset + 8 <= size; offset += 8)
+			{
+				uint64_t word;
+				std::memcpy(&word, dataPtr + offset, sizeof(word));
+				hash ^= word * prime1;
+				hash = ((hash << 31) | (hash >> 33)) * prime0;
+			}
+			for (; offset < size; ++offset)
+				hash = (hash ^ static_cast<uint8_t>(dataPtr[offset])) * prime0;
+
+			hash ^= hash >> 29;
+			hash *= prime1;
+			return hash ^ (hash >> 32);
+		}
+	}
+}
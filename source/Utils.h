@@ -1,165 +1,104 @@
 #pragma once
-#include <fstream>
 #include "Math.h"
-#include "Mesh.h"
+#include "Vertex.h"
+#include <functional>
+#include <span>
+#include <string>
 #include <vector>
 
 namespace dae
 {
 	namespace Utils
 	{
-		//Just parses vertices and indices
-#pragma warning(push)
-#pragma warning(disable : 4505) //Warning unreferenced local function
-		static bool ParseOBJ(const std::string& filename, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding = true)
+		struct ParseOBJOptions
 		{
-			std::ifstream file(filename);
-			if (!file)
-				return false;
-
-			std::vector<Vector3> positions{};
-			std::vector<Vector3> normals{};
-			std::vector<Vector2> UVs{};
-
-			vertices.clear();
-			indices.clear();
-
-			std::string sCommand;
-			// start a while iteration ending when the end of file is reached (ios::eof)
-			while (!file.eof())
-			{
-				//read the first word of the string, use the >> operator (istream::operator>>) 
-				file >> sCommand;
-				//use conditional statements to process the different commands	
-				if (sCommand == "#")
-				{
-					// Ignore Comment
-				}
-				else if (sCommand == "v")
-				{
-					//Vertex
-					float x, y, z;
-					file >> x >> y >> z;
-
-					positions.emplace_back(x, y, z);
-				}
-				else if (sCommand == "vt")
-				{
-					// Vertex TexCoord
-					float u, v;
-					file >> u >> v;
-					UVs.emplace_back(u, 1 - v);
-				}
-				else if (sCommand == "vn")
-				{
-					// Vertex Normal
-					float x, y, z;
-					file >> x >> y >> z;
-
-					normals.emplace_back(x, y, z);
-				}
-				else if (sCommand == "f")
-				{
-					//if a face is read:
-					//construct the 3 vertices, add them to the vertex array
-					//add three indices to the index array
-					//add the material index as attibute to the attribute array
-					//
-					// Faces or triangles
-					Vertex vertex{};
-					size_t iPosition, iTexCoord, iNormal;
-
-					uint32_t tempIndices[3];
-					for (size_t iFace = 0; iFace < 3; iFace++)
-					{
-						// OBJ format uses 1-based arrays
-						file >> iPosition;
-						vertex.position = positions[iPosition - 1];
-
-						if ('/' == file.peek())//is next in buffer ==  '/' ?
-						{
-							file.ignore();//read and ignore one element ('/')
-
-							if ('/' != file.peek())
-							{
-								// Optional texture coordinate
-								file >> iTexCoord;
-								vertex.uv = UVs[iTexCoord - 1];
-							}
-
-							if ('/' == file.peek())
-							{
-								file.ignore();
-
-								// Optional vertex normal
-								file >> iNormal;
-								vertex.normal = normals[iNormal - 1];
-							}
-						}
-
-						vertices.push_back(vertex);
-						tempIndices[iFace] = uint32_t(vertices.size()) - 1;
-						//indices.push_back(uint32_t(vertices.size()) - 1);
-					}
-
-					indices.push_back(tempIndices[0]);
-					if (flipAxisAndWinding)
-					{
-						indices.push_back(tempIndices[2]);
-						indices.push_back(tempIndices[1]);
-					}
-					else
-					{
-						indices.push_back(tempIndices[1]);
-						indices.push_back(tempIndices[2]);
-					}
-				}
-				//read till end of line and ignore all remaining chars
-				file.ignore(1000, '\n');
-			}
-
-			//Cheap Tangent Calculations
-			for (uint32_t i = 0; i < indices.size(); i += 3)
-			{
-				uint32_t index0 = indices[i];
-				uint32_t index1 = indices[size_t(i) + 1];
-				uint32_t index2 = indices[size_t(i) + 2];
-
-				const Vector3& p0 = vertices[index0].position;
-				const Vector3& p1 = vertices[index1].position;
-				const Vector3& p2 = vertices[index2].position;
-				const Vector2& uv0 = vertices[index0].uv;
-				const Vector2& uv1 = vertices[index1].uv;
-				const Vector2& uv2 = vertices[index2].uv;
-
-				const Vector3 edge0 = p1 - p0;
-				const Vector3 edge1 = p2 - p0;
-				const Vector2 diffX = Vector2(uv1.x - uv0.x, uv2.x - uv0.x);
-				const Vector2 diffY = Vector2(uv1.y - uv0.y, uv2.y - uv0.y);
-				float r = 1.f / Vector2::Cross(diffX, diffY);
+			bool flipAxisAndWinding = true;
+			//Corners sharing the same position/uv/normal triple become one vertex with a shared index
+			bool weldVertices = true;
+			//Worker threads reading the file in line aligned chunks, 0 uses every hardware thread
+			//The output does not depend on the thread count
+			uint32_t numThreads = 0;
+		};
+
+		//Triangles that use one usemtl material, faces before the first usemtl get the material ""
+		struct OBJSubmesh
+		{
+			std::string material;
+			uint32_t firstIndex;
+			uint32_t numIndices;
+		};
 
-				Vector3 tangent = (edge0 * diffY.y - edge1 * diffY.x) * r;
-				vertices[index0].tangent += tangent;
-				vertices[index1].tangent += tangent;
-				vertices[index2].tangent += tangent;
-			}
+		struct OBJMaterialData
+		{
+			//mtllib files, relative to the folder of the OBJ
+			std::vector<std::string> libraries;
+			//One range per material in order of first use, together they cover every index
+			std::vector<OBJSubmesh> submeshes;
+		};
 
-			//Create the Tangents (reject)
-			for (auto& v : vertices)
-			{
-				v.tangent = Vector3::Reject(v.tangent, v.normal).Normalized();
+		struct OBJParseStats
+		{
+			//Face corners in the file, and the vertices they became, the same count without welding
+			size_t numCorners{};
+			size_t numVertices{};
+		};
 
-				if (flipAxisAndWinding)
-				{
-					v.position.z *= -1.f;
-					v.normal.z *= -1.f;
-					v.tangent.z *= -1.f;
-				}
+		//Just parses vertices and indices
+		//Memory maps the file and scans it in place, arrays are sized by a first counting pass
+		//Triangles are grouped per material, so every material is one contiguous index range
+		bool ParseOBJ(const std::string& filename, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, const ParseOBJOptions& options = {},
+			OBJMaterialData* materialDataPtr = nullptr, OBJParseStats* statsPtr = nullptr);
 
-			}
+		struct MTLMaterial
+		{
+			std::string name;
+			ColorRGB diffuseColor{ 1.f, 1.f, 1.f };
+			//Texture paths resolved against the folder of the MTL file, empty when the map is not set
+			std::string diffuseMap;
+			std::string normalMap;
+			std::string specularMap;
+			std::string glossinessMap;
+		};
+
+		//Reads newmtl, Kd, map_Kd, norm/map_Bump/bump, map_Ks and map_Ns, everything else is skipped
+		//Appends to materials, so several libraries can be read into one list
+		bool ParseMTL(const std::string& filename, std::vector<MTLMaterial>& materials);
+
+		struct StreamOBJOptions
+		{
+			bool flipAxisAndWinding = true;
+			//Cap for the parser's own buffers: half for decoded attribute blocks, half for the batch being built
+			//The mapped file is not counted, the OS pages it in and out as needed
+			size_t memoryBudget = 64ull << 20;
+		};
+
+		//Finished vertices of one batch, indices are relative to the batch
+		//Welding and tangent smoothing only happen inside a batch, so corners on a batch border are duplicated
+		struct OBJBatch
+		{
+			std::span<const Vertex> vertices;
+			std::span<const uint32_t> indices;
+			//Number of vertices handed out by the batches before this one
+			uint32_t baseVertex;
+		};
 
-			return true;
-		}
-#pragma warning(pop)
+		struct OBJStreamStats
+		{
+			size_t numBatches{};
+			size_t numVertices{};
+			size_t numIndices{};
+			size_t peakBytes{};
+			size_t numBlockLoads{};
+		};
+
+		//Reads the OBJ in a single pass and hands every batch to the sink as soon as it is full
+		//Peak memory is set by options.memoryBudget instead of the file size, faces may only use attributes defined above them
+		bool StreamOBJ(const std::string& filename, const std::function<void(const OBJBatch&)>& sink, const StreamOBJOptions& options = {}, OBJStreamStats* statsPtr = nullptr);
+
+		//Original std::ifstream tokenizer, kept as reference for the benchmarks
+		bool ParseOBJIfstream(const std::string& filename, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding = true);
+
+		//Fast 64 bit content hash, used to tell whether cached or cooked files are still up to date
+		uint64_t HashBytes(const char* dataPtr, size_t size, uint64_t seed = 0);
 	}
 }
@@ -0,0 +1,37 @@
+#pragma once
+#include "Math.h"
+#include <cstdint>
+
+namespace dae
+{
+    // Kept apart from Mesh.h, so the CPU side (caches, cooker, software renderer) builds without the D3D11 headers
+    struct Vertex
+    {
+        Vector3  position = { 0.0f, 0.0f, 0.0f };
+        ColorRGB color = colors::White;
+        Vector2  uv = { 0.0f, 1.0f };
+        Vector3  normal = { 0.0f, 0.0f, 1.0f };
+        // xyz is the tangent, w the handedness: binormal = cross(normal, tangent.xyz) * tangent.w
+        Vector4  tangent = { 0.0f, 0.0f, 1.0f, 1.0f };
+    };
+
+    // 20 byte alternative to Vertex without the color, decoded by VS_Packed in PosCol3D.fx
+    struct PackedVertex
+    {
+        // UNORM inside the mesh bounds, w is the tangent handedness: 0 for -1, 65535 for +1
+        uint16_t position[4]{};
+        // Half floats
+        uint16_t uv[2]{};
+        // Octahedral encoded unit vectors, SNORM
+        int16_t normal[2]{};
+        int16_t tangent[2]{};
+    };
+    static_assert(sizeof(PackedVertex) == 20);
+
+    // Turns the UNORM positions of packed vertices back into object space: offset + scale * position
+    struct PositionQuantization
+    {
+        Vector3 offset{};
+        Vector3 scale{};
+    };
+}
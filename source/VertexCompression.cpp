@@ -0,0 +1,441 @@
+#include "pch.h"
+#include "VertexCompression.h"
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#if defined(_M_X64) || defined(__SSSE3__)
+#define DAE_VERTEX_CODEC_SSSE3
+#include <tmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace dae
+{
+	namespace VertexCompression
+	{
+		namespace
+		{
+			constexpr size_t MaxVertexSize{ 256 };
+			constexpr size_t MaxBlockVertices{ 256 };
+			constexpr size_t MaxBlockBytes{ 8192 };
+			constexpr size_t GroupSize{ 16 };
+			//Behind the encoded data, so a whole group can always be loaded from where the escapes of the last one start
+			constexpr size_t TailPadding{ 16 };
+
+			//Two bits in the group header
+			enum class GroupMode : uint8_t
+			{
+				Zero,
+				Bits2,
+				Bits4,
+				Raw,
+			};
+
+			//Whole groups, so only the last block of a buffer has padding
+			size_t GetBlockVertices(size_t vertexSize)
+			{
+				return std::max(std::min(MaxBlockVertices, MaxBlockBytes / vertexSize) / GroupSize * GroupSize, GroupSize);
+			}
+
+			//Byte deltas of either sign become small unsigned values: 0, -1, 1, -2, 2... -> 0, 1, 2, 3, 4...
+			uint8_t ZigzagEncode(uint8_t difference)
+			{
+				return static_cast<uint8_t>((difference << 1) ^ (0u - (difference >> 7)));
+			}
+
+#ifndef DAE_VERTEX_CODEC_SSSE3
+			//Only the scalar decoder undoes the zigzag per byte
+			uint8_t ZigzagDecode(uint8_t value)
+			{
+				return static_cast<uint8_t>((value >> 1) ^ (0u - (value & 1)));
+			}
+#endif
+
+			template<size_t Bits>
+			size_t GetBitsCost(const uint8_t* values)
+			{
+				constexpr uint8_t sentinel = (1u << Bits) - 1;
+				size_t cost = GroupSize * Bits / 8;
+				for (size_t index = 0; index < GroupSize; ++index)
+					cost += values[index] >= sentinel;
+				return cost;
+			}
+
+			GroupMode ChooseMode(const uint8_t* values)
+			{
+				if (std::all_of(values, values + GroupSize, [](uint8_t value) { return value == 0; }))
+					return GroupMode::Zero;
+
+				const size_t bits2Cost = GetBitsCost<2>(values);
+				const size_t bits4Cost = GetBitsCost<4>(values);
+				if (bits2Cost <= bits4Cost and bits2Cost < GroupSize)
+					return GroupMode::Bits2;
+				return bits4Cost < GroupSize ? GroupMode::Bits4 : GroupMode::Raw;
+			}
+
+			//Packed values first, lowest bits first, then the raw bytes of the values that hit the sentinel
+			template<size_t Bits>
+			void EncodeBits(std::string& bytes, const uint8_t* values)
+			{
+				constexpr uint8_t sentinel = (1u << Bits) - 1;
+				uint8_t packed[GroupSize * Bits / 8]{};
+				for (size_t index = 0; index < GroupSize; ++index)
+					packed[index * Bits / 8] |= static_cast<uint8_t>(std::min(values[index], sentinel) << (index * Bits % 8));
+				bytes.append(reinterpret_cast<const char*>(packed), sizeof(packed));
+
+				for (size_t index = 0; index < GroupSize; ++index)
+				{
+					if (values[index] >= sentinel)
+						bytes.push_back(static_cast<char>(values[index]));
+				}
+			}
+
+			//Every packed byte expands into its 4 two bit or 2 four bit values at once
+			template<size_t Bits>
+			constexpr auto MakeExpandTable()
+			{
+				using Entry = std::conditional_t<Bits == 2, uint32_t, uint16_t>;
+				std::array<Entry, 256> table{};
+				for (uint32_t byte = 0; byte < 256; ++byte)
+				{
+					for (uint32_t index = 0; index < 8 / Bits; ++index)
+						table[byte] |= static_cast<Entry>(((byte >> (index * Bits)) & ((1u << Bits) - 1)) << (index * 8));
+				}
+				return table;
+			}
+			constexpr auto Expand2Table = MakeExpandTable<2>();
+			constexpr auto Expand4Table = MakeExpandTable<4>();
+
+#ifdef DAE_VERTEX_CODEC_SSSE3
+			//MSVC compiles SSSE3 intrinsics without being asked to, so the CPU is checked once instead
+			bool DetectSSSE3()
+			{
+#ifdef __SSSE3__
+				return true;
+#else
+				int info[4]{};
+				__cpuid(info, 1);
+				return (info[2] & (1 << 9)) != 0;
+#endif
+			}
+			const bool HasSSSE3 = DetectSSSE3();
+
+			//pshufb control for 8 values: the escaped ones take the next escape byte in order, the others become zero
+			constexpr std::array<uint64_t, 256> MakeEscapeShuffleTable()
+			{
+				std::array<uint64_t, 256> table{};
+				for (uint32_t mask = 0; mask < 256; ++mask)
+				{
+					uint64_t escape = 0;
+					for (uint32_t index = 0; index < 8; ++index)
+						table[mask] |= ((mask >> index) & 1 ? escape++ : 0x80ull) << (index * 8);
+				}
+				return table;
+			}
+			constexpr auto EscapeShuffleTable = MakeEscapeShuffleTable();
+
+			const uint8_t* FillEscapes(uint64_t low, uint64_t high, uint8_t sentinel, const uint8_t* escapePtr, const uint8_t* endPtr, uint8_t* values)
+			{
+				const __m128i expanded = _mm_set_epi64x(static_cast<int64_t>(high), static_cast<int64_t>(low));
+				const __m128i isEscape = _mm_cmpeq_epi8(expanded, _mm_set1_epi8(static_cast<char>(sentinel)));
+				const uint32_t escapeMask = static_cast<uint32_t>(_mm_movemask_epi8(isEscape));
+				const size_t numLowEscapes = static_cast<size_t>(std::popcount(escapeMask & 0xFF));
+				const size_t numEscapes = numLowEscapes + static_cast<size_t>(std::popcount(escapeMask >> 8));
+				if (static_cast<size_t>(endPtr - escapePtr) < numEscapes)
+					return nullptr;
+
+				//The high half continues after the escapes of the low half, zeroing entries stay above 0x80
+				const __m128i shuffle = _mm_set_epi64x(static_cast<int64_t>(EscapeShuffleTable[escapeMask >> 8] + numLowEscapes * 0x0101'0101'0101'0101ull),
+					static_cast<int64_t>(EscapeShuffleTable[escapeMask & 0xFF]));
+				const __m128i escapes = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(escapePtr)), shuffle);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(values), _mm_or_si128(_mm_andnot_si128(isEscape, expanded), escapes));
+				return escapePtr + numEscapes;
+			}
+#endif
+
+			//Returns the first byte behind the group, nullptr when the group runs past endPtr
+			template<size_t Bits>
+			const uint8_t* DecodeBits(const uint8_t* dataPtr, const uint8_t* endPtr, uint8_t* values)
+			{
+				constexpr size_t packedBytes = GroupSize * Bits / 8;
+				constexpr uint8_t sentinel = (1u << Bits) - 1;
+				if (static_cast<size_t>(endPtr - dataPtr) < packedBytes)
+					return nullptr;
+
+				//Built in registers and stored once, small stores read back by a wider load would stall
+				uint64_t low{};
+				uint64_t high{};
+				if constexpr (Bits == 2)
+				{
+					low = Expand2Table[dataPtr[0]] | uint64_t(Expand2Table[dataPtr[1]]) << 32;
+					high = Expand2Table[dataPtr[2]] | uint64_t(Expand2Table[dataPtr[3]]) << 32;
+				}
+				else
+				{
+					for (size_t byte = 0; byte < 4; ++byte)
+					{
+						low |= uint64_t(Expand4Table[dataPtr[byte]]) << (byte * 16);
+						high |= uint64_t(Expand4Table[dataPtr[byte + 4]]) << (byte * 16);
+					}
+				}
+				const uint8_t* escapePtr = dataPtr + packedBytes;
+#ifdef DAE_VERTEX_CODEC_SSSE3
+				if (HasSSSE3)
+					return FillEscapes(low, high, sentinel, escapePtr, endPtr, values);
+#endif
+				std::memcpy(values, &low, sizeof(low));
+				std::memcpy(values + sizeof(low), &high, sizeof(high));
+
+				//Only the escaped values are visited, a branch per value mispredicts too often in noisy columns
+				uint32_t escapeMask = 0;
+				for (size_t index = 0; index < GroupSize; ++index)
+					escapeMask |= static_cast<uint32_t>(values[index] == sentinel) << index;
+				if (static_cast<size_t>(endPtr - escapePtr) < static_cast<size_t>(std::popcount(escapeMask)))
+					return nullptr;
+				for (; escapeMask != 0; escapeMask &= escapeMask - 1)
+					values[std::countr_zero(escapeMask)] = *escapePtr++;
+				return escapePtr;
+			}
+
+#ifdef DAE_VERTEX_CODEC_SSSE3
+			__m128i UnzigzagBytes(__m128i values)
+			{
+				//SSE2 has no byte shifts, the bits that cross into the next byte are masked off
+				const __m128i halved = _mm_and_si128(_mm_srli_epi16(values, 1), _mm_set1_epi8(0x7F));
+				const __m128i sign = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(values, _mm_set1_epi8(1)));
+				return _mm_xor_si128(halved, sign);
+			}
+
+			//16x16 byte matrix, rows[i] byte j becomes rows[j] byte i
+			void TransposeBytes(__m128i rows[GroupSize])
+			{
+				__m128i temp[GroupSize];
+				for (size_t row = 0; row < 8; ++row)
+				{
+					temp[row * 2] = _mm_unpacklo_epi8(rows[row], rows[row + 8]);
+					temp[row * 2 + 1] = _mm_unpackhi_epi8(rows[row], rows[row + 8]);
+				}
+				for (size_t row = 0; row < 8; ++row)
+				{
+					rows[row * 2] = _mm_unpacklo_epi8(temp[row], temp[row + 8]);
+					rows[row * 2 + 1] = _mm_unpackhi_epi8(temp[row], temp[row + 8]);
+				}
+				for (size_t row = 0; row < 8; ++row)
+				{
+					temp[row * 2] = _mm_unpacklo_epi8(rows[row], rows[row + 8]);
+					temp[row * 2 + 1] = _mm_unpackhi_epi8(rows[row], rows[row + 8]);
+				}
+				for (size_t row = 0; row < 8; ++row)
+				{
+					rows[row * 2] = _mm_unpacklo_epi8(temp[row], temp[row + 8]);
+					rows[row * 2 + 1] = _mm_unpackhi_epi8(temp[row], temp[row + 8]);
+				}
+			}
+#endif
+
+			const uint8_t* DecodeGroup(const uint8_t* dataPtr, const uint8_t* endPtr, GroupMode mode, uint8_t* values)
+			{
+				switch (mode)
+				{
+				case GroupMode::Zero:
+					std::memset(values, 0, GroupSize);
+					return dataPtr;
+				case GroupMode::Bits2:
+					return DecodeBits<2>(dataPtr, endPtr, values);
+				case GroupMode::Bits4:
+					return DecodeBits<4>(dataPtr, endPtr, values);
+				case GroupMode::Raw:
+					if (static_cast<size_t>(endPtr - dataPtr) < GroupSize)
+						return nullptr;
+					std::memcpy(values, dataPtr, GroupSize);
+					return dataPtr + GroupSize;
+				}
+				return nullptr;
+			}
+		}
+
+		std::string EncodeVertices(std::span<const char> vertexBytes, size_t vertexSize)
+		{
+			std::string bytes{};
+			if (vertexSize == 0 or vertexSize > MaxVertexSize)
+				return bytes;
+
+			const size_t numVertices = vertexBytes.size() / vertexSize;
+			const size_t blockVertices = GetBlockVertices(vertexSize);
+			const auto* vertexPtr = reinterpret_cast<const uint8_t*>(vertexBytes.data());
+			bytes.reserve(vertexBytes.size() / 2);
+
+			//The first vertex is delta coded against zeros
+			std::array<uint8_t, MaxVertexSize> lastVertex{};
+			std::array<uint8_t, MaxBlockVertices> deltas{};
+			for (size_t firstVertex = 0; firstVertex < numVertices; firstVertex += blockVertices)
+			{
+				const size_t numBlockVertices = std::min(blockVertices, numVertices - firstVertex);
+				const size_t numGroups = (numBlockVertices + GroupSize - 1) / GroupSize;
+				for (size_t byte = 0; byte < vertexSize; ++byte)
+				{
+					uint8_t previous = lastVertex[byte];
+					for (size_t vertex = 0; vertex < numBlockVertices; ++vertex)
+					{
+						const uint8_t value = vertexPtr[(firstVertex + vertex) * vertexSize + byte];
+						deltas[vertex] = ZigzagEncode(static_cast<uint8_t>(value - previous));
+						previous = value;
+					}
+					std::fill(deltas.begin() + numBlockVertices, deltas.begin() + numGroups * GroupSize, uint8_t{});
+					lastVertex[byte] = previous;
+
+					//The modes of four groups share a header byte, in front of the groups of the column
+					const size_t headerOffset = bytes.size();
+					bytes.append((numGroups + 3) / 4, '\0');
+					for (size_t group = 0; group < numGroups; ++group)
+					{
+						const uint8_t* valuesPtr = deltas.data() + group * GroupSize;
+						const GroupMode mode = ChooseMode(valuesPtr);
+						bytes[headerOffset + group / 4] |= static_cast<char>(static_cast<uint8_t>(mode) << (group % 4 * 2));
+						if (mode == GroupMode::Bits2)
+							EncodeBits<2>(bytes, valuesPtr);
+						else if (mode == GroupMode::Bits4)
+							EncodeBits<4>(bytes, valuesPtr);
+						else if (mode == GroupMode::Raw)
+							bytes.append(reinterpret_cast<const char*>(valuesPtr), GroupSize);
+					}
+				}
+			}
+			bytes.append(TailPadding, '\0');
+			return bytes;
+		}
+
+		bool DecodeVertices(std::string_view bytes, std::span<char> vertexBytes, size_t vertexSize)
+		{
+			if (vertexSize == 0 or vertexSize > MaxVertexSize or vertexBytes.size() % vertexSize != 0)
+				return false;
+
+			if (bytes.size() < TailPadding)
+				return false;
+
+			const size_t numVertices = vertexBytes.size() / vertexSize;
+			const size_t blockVertices = GetBlockVertices(vertexSize);
+			const auto* dataPtr = reinterpret_cast<const uint8_t*>(bytes.data());
+			const auto* endPtr = dataPtr + bytes.size() - TailPadding;
+			auto* vertexPtr = reinterpret_cast<uint8_t*>(vertexBytes.data());
+
+			//Deltas of a block, one column of blockVertices per byte of the vertex. Columns past vertexSize stay zero,
+			//so the SSE path can always transpose 16 of them
+			const size_t numColumns = (vertexSize + GroupSize - 1) / GroupSize * GroupSize;
+			std::vector<uint8_t> deltas(numColumns * blockVertices);
+#ifdef DAE_VERTEX_CODEC_SSSE3
+			__m128i lastVertex[MaxVertexSize / GroupSize]{};
+#else
+			std::array<uint8_t, MaxVertexSize> lastVertex{};
+#endif
+			for (size_t firstVertex = 0; firstVertex < numVertices; firstVertex += blockVertices)
+			{
+				const size_t numBlockVertices = std::min(blockVertices, numVertices - firstVertex);
+				const size_t numGroups = (numBlockVertices + GroupSize - 1) / GroupSize;
+				for (size_t byte = 0; byte < vertexSize; ++byte)
+				{
+					const uint8_t* headerPtr = dataPtr;
+					const size_t headerBytes = (numGroups + 3) / 4;
+					if (static_cast<size_t>(endPtr - dataPtr) < headerBytes)
+						return false;
+					dataPtr += headerBytes;
+
+					uint8_t* columnPtr = deltas.data() + byte * blockVertices;
+					for (size_t group = 0; group < numGroups; ++group)
+					{
+						const auto mode = static_cast<GroupMode>((headerPtr[group / 4] >> (group % 4 * 2)) & 3);
+						dataPtr = DecodeGroup(dataPtr, endPtr, mode, columnPtr + group * GroupSize);
+						if (!dataPtr)
+							return false;
+					}
+				}
+
+#ifdef DAE_VERTEX_CODEC_SSSE3
+				//16 vertices at a time: transpose the deltas into vertex order 16 bytes at a time, then add them up vertex by vertex
+				//A vertex is stored in whole 16 bytes, what spills into the next vertex is overwritten when that one is stored
+				//The last 4 bytes of a 16n + 4 byte vertex, like the 20 byte packed vertex, get a 4 column transpose of their own instead
+				const bool hasNarrowTail = vertexSize % GroupSize == 4;
+				const size_t numChunks = hasNarrowTail ? vertexSize / GroupSize : numColumns / GroupSize;
+				uint8_t* const outputEndPtr = vertexPtr + vertexBytes.size();
+				for (size_t group = 0; group < numGroups; ++group)
+				{
+					__m128i rows[MaxVertexSize / GroupSize][GroupSize];
+					for (size_t chunk = 0; chunk < numChunks; ++chunk)
+					{
+						const uint8_t* chunkPtr = deltas.data() + chunk * GroupSize * blockVertices + group * GroupSize;
+						for (size_t row = 0; row < GroupSize; ++row)
+							rows[chunk][row] = UnzigzagBytes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(chunkPtr + row * blockVertices)));
+						TransposeBytes(rows[chunk]);
+					}
+
+					//Four vertices per register, added up within it and then onto the last vertex of the group before
+					alignas(16) uint32_t tails[GroupSize];
+					if (hasNarrowTail)
+					{
+						const uint8_t* tailPtr = deltas.data() + numChunks * GroupSize * blockVertices + group * GroupSize;
+						__m128i tailRows[4];
+						for (size_t row = 0; row < 4; ++row)
+							tailRows[row] = UnzigzagBytes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tailPtr + row * blockVertices)));
+						const __m128i low01 = _mm_unpacklo_epi8(tailRows[0], tailRows[1]);
+						const __m128i high01 = _mm_unpackhi_epi8(tailRows[0], tailRows[1]);
+						const __m128i low23 = _mm_unpacklo_epi8(tailRows[2], tailRows[3]);
+						const __m128i high23 = _mm_unpackhi_epi8(tailRows[2], tailRows[3]);
+						const __m128i quads[4]{ _mm_unpacklo_epi16(low01, low23), _mm_unpackhi_epi16(low01, low23),
+							_mm_unpacklo_epi16(high01, high23), _mm_unpackhi_epi16(high01, high23) };
+						for (size_t quad = 0; quad < 4; ++quad)
+						{
+							__m128i sums = _mm_add_epi8(quads[quad], _mm_slli_si128(quads[quad], 4));
+							sums = _mm_add_epi8(sums, _mm_slli_si128(sums, 8));
+							lastVertex[numChunks] = _mm_add_epi8(sums, _mm_shuffle_epi32(lastVertex[numChunks], 0xFF));
+							_mm_store_si128(reinterpret_cast<__m128i*>(tails + quad * 4), lastVertex[numChunks]);
+						}
+					}
+
+					const size_t numGroupVertices = std::min(GroupSize, numBlockVertices - group * GroupSize);
+					uint8_t* outputPtr = vertexPtr + (firstVertex + group * GroupSize) * vertexSize;
+					for (size_t vertex = 0; vertex < numGroupVertices; ++vertex, outputPtr += vertexSize)
+					{
+						if (hasNarrowTail)
+							std::memcpy(outputPtr + numChunks * GroupSize, tails + vertex, sizeof(uint32_t));
+						for (size_t chunk = 0; chunk < numChunks; ++chunk)
+						{
+							lastVertex[chunk] = _mm_add_epi8(lastVertex[chunk], rows[chunk][vertex]);
+							uint8_t* chunkPtr = outputPtr + chunk * GroupSize;
+							if (static_cast<size_t>(outputEndPtr - chunkPtr) >= GroupSize)
+							{
+								_mm_storeu_si128(reinterpret_cast<__m128i*>(chunkPtr), lastVertex[chunk]);
+							}
+							else
+							{
+								alignas(16) uint8_t partial[GroupSize];
+								_mm_store_si128(reinterpret_cast<__m128i*>(partial), lastVertex[chunk]);
+								std::memcpy(chunkPtr, partial, static_cast<size_t>(outputEndPtr - chunkPtr));
+							}
+						}
+					}
+				}
+#else
+				for (size_t byte = 0; byte < vertexSize; ++byte)
+				{
+					const uint8_t* columnPtr = deltas.data() + byte * blockVertices;
+					uint8_t* outputPtr = vertexPtr + firstVertex * vertexSize + byte;
+					uint8_t previous = lastVertex[byte];
+					for (size_t vertex = 0; vertex < numBlockVertices; ++vertex)
+					{
+						previous = static_cast<uint8_t>(previous + ZigzagDecode(columnPtr[vertex]));
+						outputPtr[vertex * vertexSize] = previous;
+					}
+					lastVertex[byte] = previous;
+				}
+#endif
+			}
+			return dataPtr == endPtr;
+		}
+	}
+}
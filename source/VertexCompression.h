@@ -0,0 +1,21 @@
+#pragma once
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace dae
+{
+	//Lossless vertex buffer codec in the style of meshoptimizer's vertex codec, for the cooked meshes on disk
+	//Every byte of a vertex is delta coded against the same byte of the vertex before it, so attributes that change slowly
+	//in vertex fetch order, quantized positions and UVs most of all, turn into runs of small values that pack into 0, 2 or 4 bits
+	namespace VertexCompression
+	{
+		//Vertices go in blocks of up to 256 that fit in 8 KB. Per block every byte column is split into groups of 16 deltas,
+		//each stored as zeros, 2 bit, 4 bit or raw bytes, whichever is smallest. Values that do not fit follow their group as raw bytes
+		//vertexBytes holds vertexBytes.size() / vertexSize vertices, vertexSize is at most 256
+		std::string EncodeVertices(std::span<const char> vertexBytes, size_t vertexSize);
+		//Bit exact inverse of EncodeVertices, vertexBytes.size() / vertexSize has to match the number of vertices encoded
+		//Fails on truncated or corrupt data
+		bool DecodeVertices(std::string_view bytes, std::span<char> vertexBytes, size_t vertexSize);
+	}
+}
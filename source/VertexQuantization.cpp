@@ -0,0 +1,206 @@
+#include "pch.h"
+#include "VertexQuantization.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace dae
+{
+	namespace VertexQuantization
+	{
+		namespace
+		{
+			int16_t ToSnorm16(float value)
+			{
+				return static_cast<int16_t>(std::lround(std::clamp(value, -1.f, 1.f) * 32767.f));
+			}
+
+			float FromSnorm16(int16_t value)
+			{
+				//-32768 and -32767 both map to -1, like DXGI SNORM formats
+				return std::max(static_cast<float>(value) / 32767.f, -1.f);
+			}
+
+			uint16_t ToUnorm16(float value)
+			{
+				return static_cast<uint16_t>(std::lround(std::clamp(value, 0.f, 1.f) * 65535.f));
+			}
+
+			float AngleDegrees(Vector3 source, const Vector3& decoded)
+			{
+				if (source.Normalize() <= 0.f)
+					return 0.f;
+				return std::acos(std::clamp(Vector3::Dot(source, decoded), -1.f, 1.f)) * TO_DEGREES;
+			}
+		}
+
+		uint16_t FloatToHalf(float value)
+		{
+			uint32_t bits{};
+			std::memcpy(&bits, &value, sizeof(bits));
+
+			const uint32_t sign = (bits >> 16) & 0x8000;
+			const uint32_t floatExponent = (bits >> 23) & 0xFF;
+			uint32_t mantissa = bits & 0x7FFFFF;
+
+			//Infinity stays infinity, NaN stays NaN
+			if (floatExponent == 0xFF)
+				return static_cast<uint16_t>(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0));
+
+			const int exponent = static_cast<int>(floatExponent) - 127 + 15;
+			if (exponent >= 31)
+				return static_cast<uint16_t>(sign | 0x7C00);
+
+			if (exponent <= 0)
+			{
+				//Denormal, or zero when even that is too small
+				if (exponent < -10)
+					return static_cast<uint16_t>(sign);
+
+				mantissa |= 0x800000;
+				const int shift = 14 - exponent;
+				uint32_t half = mantissa >> shift;
+				const uint32_t remainder = mantissa & ((1u << shift) - 1);
+				const uint32_t halfway = 1u << (shift - 1);
+				if (remainder > halfway or (remainder == halfway and (half & 1)))
+					++half;
+				return static_cast<uint16_t>(sign | half);
+			}
+
+			//A carry out of the mantissa correctly bumps the exponent, up to infinity
+			uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+			const uint32_t remainder = mantissa & 0x1FFF;
+			if (remainder > 0x1000 or (remainder == 0x1000 and (half & 1)))
+				++half;
+			return static_cast<uint16_t>(sign | half);
+		}
+
+		float HalfToFloat(uint16_t half)
+		{
+			const bool isNegative = (half & 0x8000) != 0;
+			const uint32_t exponent = (half >> 10) & 0x1F;
+			const uint32_t mantissa = half & 0x3FF;
+
+			if (exponent == 0)
+			{
+				const float value = std::ldexp(static_cast<float>(mantissa), -24);
+				return isNegative ? -value : value;
+			}
+
+			const uint32_t sign = isNegative ? 0x80000000u : 0u;
+			const uint32_t bits = exponent == 31 ? sign | 0x7F800000 | (mantissa << 13) : sign | ((exponent + 112) << 23) | (mantissa << 13);
+			float value{};
+			std::memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		void EncodeOctahedral(const Vector3& direction, int16_t encoded[2])
+		{
+			const float sum = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+			if (sum <= 0.f)
+			{
+				encoded[0] = encoded[1] = 0;
+				return;
+			}
+
+			float x = direction.x / sum;
+			float y = direction.y / sum;
+			//The lower hemisphere folds over the diagonals
+			if (direction.z < 0.f)
+			{
+				const float foldedX = (1.f - std::abs(y)) * (x >= 0.f ? 1.f : -1.f);
+				const float foldedY = (1.f - std::abs(x)) * (y >= 0.f ? 1.f : -1.f);
+				x = foldedX;
+				y = foldedY;
+			}
+			encoded[0] = ToSnorm16(x);
+			encoded[1] = ToSnorm16(y);
+		}
+
+		Vector3 DecodeOctahedral(const int16_t encoded[2])
+		{
+			Vector3 direction{ FromSnorm16(encoded[0]), FromSnorm16(encoded[1]), 0.f };
+			direction.z = 1.f - std::abs(direction.x) - std::abs(direction.y);
+			const float fold = std::clamp(-direction.z, 0.f, 1.f);
+			direction.x += direction.x >= 0.f ? -fold : fold;
+			direction.y += direction.y >= 0.f ? -fold : fold;
+			direction.Normalize();
+			return direction;
+		}
+
+		PositionQuantization ComputePositionQuantization(const Vector3& boundsMin, const Vector3& boundsMax)
+		{
+			return { boundsMin, boundsMax - boundsMin };
+		}
+
+		PackedVertex Pack(const Vertex& vertex, const PositionQuantization& quantization)
+		{
+			PackedVertex packedVertex{};
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				const float extent = quantization.scale[axis];
+				packedVertex.position[axis] = extent > 0.f ? ToUnorm16((vertex.position[axis] - quantization.offset[axis]) / extent) : 0;
+			}
+			packedVertex.position[3] = vertex.tangent.w < 0.f ? 0 : 65535;
+
+			packedVertex.uv[0] = FloatToHalf(vertex.uv.x);
+			packedVertex.uv[1] = FloatToHalf(vertex.uv.y);
+			EncodeOctahedral(vertex.normal, packedVertex.normal);
+			EncodeOctahedral({ vertex.tangent.x, vertex.tangent.y, vertex.tangent.z }, packedVertex.tangent);
+			return packedVertex;
+		}
+
+		Vertex Unpack(const PackedVertex& packedVertex, const PositionQuantization& quantization)
+		{
+			Vertex vertex{};
+			vertex.position = UnpackPosition(packedVertex, quantization);
+			vertex.color = colors::White;
+			vertex.uv = { HalfToFloat(packedVertex.uv[0]), HalfToFloat(packedVertex.uv[1]) };
+			vertex.normal = DecodeOctahedral(packedVertex.normal);
+			const Vector3 tangent = DecodeOctahedral(packedVertex.tangent);
+			vertex.tangent = { tangent.x, tangent.y, tangent.z, packedVertex.position[3] / 65535.f * 2.f - 1.f };
+			return vertex;
+		}
+
+		Vector3 UnpackPosition(const PackedVertex& packedVertex, const PositionQuantization& quantization)
+		{
+			Vector3 position{};
+			for (int axis = 0; axis < 3; ++axis)
+				position[axis] = quantization.offset[axis] + quantization.scale[axis] * (static_cast<float>(packedVertex.position[axis]) / 65535.f);
+			return position;
+		}
+
+		void Pack(std::span<const Vertex> vertices, const PositionQuantization& quantization, std::span<PackedVertex> packedVertices)
+		{
+			for (size_t vertex = 0; vertex < vertices.size(); ++vertex)
+				packedVertices[vertex] = Pack(vertices[vertex], quantization);
+		}
+
+		QuantizationError MeasureError(std::span<const Vertex> vertices, std::span<const PackedVertex> packedVertices, const PositionQuantization& quantization)
+		{
+			QuantizationError error{};
+			if (vertices.empty())
+				return error;
+
+			double positionErrorSum = 0.0;
+			for (size_t vertex = 0; vertex < vertices.size(); ++vertex)
+			{
+				const Vertex& source = vertices[vertex];
+				const Vertex decoded = Unpack(packedVertices[vertex], quantization);
+
+				const float positionError = (decoded.position - source.position).Magnitude();
+				error.maxPositionError = std::max(error.maxPositionError, positionError);
+				positionErrorSum += positionError;
+
+				error.maxUVError = std::max({ error.maxUVError, std::abs(decoded.uv.x - source.uv.x), std::abs(decoded.uv.y - source.uv.y) });
+				error.maxNormalErrorDegrees = std::max(error.maxNormalErrorDegrees, AngleDegrees(source.normal, decoded.normal));
+				error.maxTangentErrorDegrees = std::max(error.maxTangentErrorDegrees,
+					AngleDegrees({ source.tangent.x, source.tangent.y, source.tangent.z }, { decoded.tangent.x, decoded.tangent.y, decoded.tangent.z }));
+				if ((source.tangent.w < 0.f) != (decoded.tangent.w < 0.f))
+					++error.numHandednessErrors;
+			}
+			error.averagePositionError = static_cast<float>(positionErrorSum / static_cast<double>(vertices.size()));
+			return error;
+		}
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include "Vertex.h"
+#include <span>
+
+namespace dae
+{
+	//Conversion between Vertex and the 20 byte PackedVertex, the decode mirrors DecodePacked in PosCol3D.fx
+	namespace VertexQuantization
+	{
+		//IEEE half floats, rounded to nearest even
+		uint16_t FloatToHalf(float value);
+		float HalfToFloat(uint16_t half);
+
+		//Octahedral mapping of a direction onto the [-1, 1] square, stored as SNORM16
+		//Directions do not need to be normalized, a zero vector decodes to +z
+		void EncodeOctahedral(const Vector3& direction, int16_t encoded[2]);
+		Vector3 DecodeOctahedral(const int16_t encoded[2]);
+
+		//The UNORM range spans the bounds, so the precision is the bounds extent / 65535 on every axis
+		PositionQuantization ComputePositionQuantization(const Vector3& boundsMin, const Vector3& boundsMax);
+
+		PackedVertex Pack(const Vertex& vertex, const PositionQuantization& quantization);
+		//The color is not stored and decodes as white, like the shader does
+		Vertex Unpack(const PackedVertex& packedVertex, const PositionQuantization& quantization);
+		Vector3 UnpackPosition(const PackedVertex& packedVertex, const PositionQuantization& quantization);
+
+		void Pack(std::span<const Vertex> vertices, const PositionQuantization& quantization, std::span<PackedVertex> packedVertices);
+
+		//Largest differences between the float source and what the vertex shader decodes
+		struct QuantizationError
+		{
+			//Object space units
+			float maxPositionError{};
+			float averagePositionError{};
+			float maxUVError{};
+			//Angle between the normalized source and the decoded direction
+			float maxNormalErrorDegrees{};
+			float maxTangentErrorDegrees{};
+			//Vertices whose handedness decodes with the wrong sign, should always be 0
+			size_t numHandednessErrors{};
+		};
+
+		QuantizationError MeasureError(std::span<const Vertex> vertices, std::span<const PackedVertex> packedVertices, const PositionQuantization& quantization);
+	}
+}
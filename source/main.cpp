@@ -6,6 +6,10 @@
 
 #undef main
 #include "Renderer.h"
+#include "Benchmark.h"
+#include "SoftwareRenderer.h"
+
+#include <string_view>
 
 using namespace dae;
 
@@ -17,9 +21,21 @@ void ShutDown(SDL_Window* pWindow)
 
 int main(int argc, char* args[])
 {
-	//Unreferenced parameters
-	(void)argc;
-	(void)args;
+	if (argc > 1 and std::string_view{ args[1] } == "--benchmark")
+	{
+		Benchmark::RunAll();
+		return 0;
+	}
+
+	//--headless <image.ppm> renders one frame on the CPU without a window, the options match what Renderer::SaveScreenshot prints
+	if (argc > 2 and std::string_view{ args[1] } == "--headless")
+	{
+		SoftwareRenderer::HeadlessOptions options{};
+		options.outputPath = args[2];
+		if (!SoftwareRenderer::ParseHeadlessOptions({ args + 3, args + argc }, options))
+			return 1;
+		return SoftwareRenderer::RenderHeadless(options) ? 0 : 1;
+	}
 
 	//Create window + surfaces
 	SDL_Init(SDL_INIT_VIDEO);
@@ -70,6 +86,15 @@ int main(int argc, char* args[])
 				case SDL_SCANCODE_F7:
 					pRenderer->ToggleFireFX();
 					break;
+				case SDL_SCANCODE_F8:
+					pRenderer->ToggleMeshletCulling();
+					break;
+				case SDL_SCANCODE_F9:
+					pRenderer->CycleLevelOfDetail();
+					break;
+				case SDL_SCANCODE_F10:
+					pRenderer->SaveScreenshot();
+					break;
 				}
 				break;
 			default: ;
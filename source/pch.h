@@ -7,6 +7,8 @@
 #include <memory>
 #define NOMINMAX  //for directx
 
+// DAE_HEADLESS builds only the CPU side for HeadlessMain.cpp, without SDL and D3D11 (CMakeLists.txt)
+#ifndef DAE_HEADLESS
 // SDL Headers
 #include "SDL.h"
 #include "SDL_syswm.h"
@@ -21,4 +23,6 @@
 
 // Framework Headers
 #include "Timer.h"
+#endif
+
 #include "Math.h"
\ No newline at end of file